@@ -3,9 +3,24 @@ SOURCES += \
     generator/i2cgenerator.cpp \
     device/devicemanager.cpp \
     device/capturedevice.cpp \
+    device/capturesegment.cpp \
+    device/capturesegmentcondition.cpp \
+    device/protocolcondition.cpp \
+    device/captureconditiontask.cpp \
+    device/capturetriggerengine.cpp \
+    device/digitalsearch.cpp \
+    device/capturehistory.cpp \
+    device/capturefile.cpp \
+    device/capturefilewriter.cpp \
     analyzer/uianalyzer.cpp \
+    analyzer/analyzertask.cpp \
+    analyzer/i2c/i2canalyzertask.cpp \
+    analyzer/spi/spianalyzertask.cpp \
+    analyzer/uart/uartanalyzertask.cpp \
     analyzer/analyzermanager.cpp \
+    analyzer/analyzerlabelcache.cpp \
     device/labtool/labtooldevicetransfer.cpp \
+    device/labtool/labtooltransferbufferpool.cpp \
     device/labtool/labtooldevicecommthread.cpp \
     device/labtool/labtooldevicecomm.cpp \
     device/simulator/uisimulatorconfigdialog.cpp \
@@ -15,7 +30,6 @@ SOURCES += \
     analyzer/uianalyzerconfig.cpp \
     analyzer/uart/uiuartanalyzerconfig.cpp \
     common/inputhelper.cpp \
-    common/types.cpp \
     generator/spigenerator.cpp \
     analyzer/i2c/uii2canalyzerconfig.cpp \
     analyzer/i2c/uii2canalyzer.cpp \
@@ -25,7 +39,10 @@ SOURCES += \
     device/generatordevice.cpp \
     device/simulator/simulatorcapturedevice.cpp \
     device/simulator/simulatordevice.cpp \
+    device/simulator/simulatorsignals.cpp \
     device/labtool/labtoolcapturedevice.cpp \
+    device/labtool/labtoolcapturedecoder.cpp \
+    device/labtool/labtoolsampleunpacker.cpp \
     device/labtool/labtooldevice.cpp \
     generator/uidigitalgenerator.cpp \
     generator/uianaloggenerator.cpp \
@@ -42,8 +59,10 @@ SOURCES += \
     common/stringutil.cpp \
     uimainwindow.cpp \
     capture/uitimeaxis.cpp \
+    capture/uistopconditiondialog.cpp \
     capture/uisimpleabstractsignal.cpp \
     capture/uiselectsignaldialog.cpp \
+    capture/uisearchdialog.cpp \
     capture/uiplot.cpp \
     capture/uimeasurmentarea.cpp \
     capture/uilistspinbox.cpp \
@@ -60,11 +79,16 @@ SOURCES += \
     capture/uiabstractsignal.cpp \
     capture/uiabstractplotitem.cpp \
     capture/signalmanager.cpp \
+    capture/signaldatafile.cpp \
     capture/cursormanager.cpp \
     capture/captureapp.cpp \
     common/configuration.cpp \
     device/analogsignal.cpp \
     capture/uicaptureexporter.cpp \
+    capture/exporttask.cpp \
+    capture/csvexporttask.cpp \
+    capture/vcdexporttask.cpp \
+    capture/binaryexporttask.cpp \
     device/labtool/labtoolcalibrationwizard.cpp \
     device/labtool/labtoolcalibrationwizardintropage.cpp \
     device/labtool/labtoolcalibrationwizardconclusionpage.cpp \
@@ -72,6 +96,8 @@ SOURCES += \
     device/labtool/labtoolcalibrationwizardanalogin.cpp \
     device/labtool/labtoolcalibrationdata.cpp \
     device/digitalsignal.cpp \
+    device/analogminmaxpyramid.cpp \
+    device/analogsamplestore.cpp \
     device/reconfigurelistener.cpp
 
 HEADERS += \
@@ -79,8 +105,22 @@ HEADERS += \
     libusbx/include/libusbx-1.0/libusb.h \
     device/devicemanager.h \
     device/capturedevice.h \
+    device/capturesegment.h \
+    device/capturesegmentcondition.h \
+    device/protocolcondition.h \
+    device/captureconditiontask.h \
+    device/capturetriggerengine.h \
+    device/digitalsearch.h \
+    device/capturehistory.h \
+    device/capturefile.h \
+    device/capturefilewriter.h \
     analyzer/uianalyzer.h \
+    analyzer/analyzertask.h \
+    analyzer/i2c/i2canalyzertask.h \
+    analyzer/spi/spianalyzertask.h \
+    analyzer/uart/uartanalyzertask.h \
     device/labtool/labtooldevicetransfer.h \
+    device/labtool/labtooltransferbufferpool.h \
     device/labtool/labtooldevicecommthread.h \
     device/labtool/labtooldevicecomm.h \
     device/simulator/uisimulatorconfigdialog.h \
@@ -89,7 +129,6 @@ HEADERS += \
     generator/uartgenerator.h \
     analyzer/uianalyzerconfig.h \
     analyzer/uart/uiuartanalyzerconfig.h \
-    common/types.h \
     generator/spigenerator.h \
     analyzer/i2c/uii2canalyzerconfig.h \
     analyzer/i2c/uii2canalyzer.h \
@@ -99,7 +138,10 @@ HEADERS += \
     device/generatordevice.h \
     device/simulator/simulatorcapturedevice.h \
     device/simulator/simulatordevice.h \
+    device/simulator/simulatorsignals.h \
     device/labtool/labtoolcapturedevice.h \
+    device/labtool/labtoolcapturedecoder.h \
+    device/labtool/labtoolsampleunpacker.h \
     device/labtool/labtooldevice.h \
     generator/uidigitalgenerator.h \
     generator/uianaloggenerator.h \
@@ -116,8 +158,10 @@ HEADERS += \
     common/stringutil.h \
     uimainwindow.h \
     capture/uitimeaxis.h \
+    capture/uistopconditiondialog.h \
     capture/uisimpleabstractsignal.h \
     capture/uiselectsignaldialog.h \
+    capture/uisearchdialog.h \
     capture/uiplot.h \
     capture/uimeasurmentarea.h \
     capture/uilistspinbox.h \
@@ -134,13 +178,19 @@ HEADERS += \
     capture/uiabstractsignal.h \
     capture/uiabstractplotitem.h \
     capture/signalmanager.h \
+    capture/signaldatafile.h \
     capture/captureapp.h \
     analyzer/analyzermanager.h \
+    analyzer/analyzerlabelcache.h \
     common/configuration.h \
     capture/cursormanager.h \
     common/inputhelper.h \
     device/analogsignal.h \
     capture/uicaptureexporter.h \
+    capture/exporttask.h \
+    capture/csvexporttask.h \
+    capture/vcdexporttask.h \
+    capture/binaryexporttask.h \
     device/labtool/labtoolcalibrationwizard.h \
     device/labtool/labtoolcalibrationwizardintropage.h \
     device/labtool/labtoolcalibrationwizardconclusionpage.h \
@@ -148,8 +198,12 @@ HEADERS += \
     device/labtool/labtoolcalibrationwizardanalogin.h \
     device/labtool/labtoolcalibrationdata.h \
     device/digitalsignal.h \
+    device/analogminmaxpyramid.h \
+    device/analogsamplestore.h \
     device/reconfigurelistener.h
 
+include(decoder/decoder.pri)
+
 RESOURCES += \
     icons.qrc
 
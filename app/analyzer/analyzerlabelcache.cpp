@@ -0,0 +1,151 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "analyzerlabelcache.h"
+
+#include <QFontMetrics>
+#include <QTransform>
+
+/*!
+    \class AnalyzerLabelCache
+    \brief Cache of the formatted and laid out labels of the items decoded
+        by an analyzer.
+
+    \ingroup Analyzer
+
+    Each decoded item has a short and a long label which is painted if it
+    fits within the item. Formatting the labels and measuring their widths
+    for each item on every repaint is expensive when there are many items.
+
+    The labels are instead formatted the first time an item is painted and
+    kept, together with their widths, as QStaticText laid out for the
+    current font. The cache must be cleared when the labels change, i.e.,
+    when the items are decoded again or when the data format changes, and
+    is cleared automatically when the font changes.
+*/
+
+/*!
+    Constructs an empty cache.
+*/
+AnalyzerLabelCache::AnalyzerLabelCache()
+{
+}
+
+/*!
+    Removes all labels.
+*/
+void AnalyzerLabelCache::clear()
+{
+    resize(mLabels.size());
+}
+
+/*!
+    Removes all labels and makes room for the labels of \a numItems items.
+*/
+void AnalyzerLabelCache::resize(int numItems)
+{
+    mLabels.clear();
+
+    Label empty;
+    empty.valid = false;
+    empty.shortWidth = 0;
+    empty.longWidth = 0;
+
+    mLabels.fill(empty, numItems);
+}
+
+/*!
+    Sets the font used to paint the labels to \a font. All labels are
+    removed if the font has changed.
+*/
+void AnalyzerLabelCache::setFont(const QFont &font)
+{
+    if (font != mFont) {
+        mFont = font;
+        clear();
+    }
+}
+
+/*!
+    \fn bool AnalyzerLabelCache::contains(int i) const
+
+    Returns true if the labels of item \a i are in the cache.
+*/
+
+/*!
+    Adds the short label \a shortTxt and the long label \a longTxt of
+    item \a i to the cache.
+*/
+void AnalyzerLabelCache::insert(int i, const QString &shortTxt,
+                                const QString &longTxt)
+{
+    QFontMetrics fm(mFont);
+    Label &l = mLabels[i];
+
+    l.shortWidth = fm.width(shortTxt);
+    l.longWidth = fm.width(longTxt);
+    prepareText(l.shortText, shortTxt);
+    prepareText(l.longText, longTxt);
+    l.valid = true;
+}
+
+/*!
+    \fn int AnalyzerLabelCache::shortWidth(int i) const
+
+    Returns the width in pixels of the short label of item \a i.
+*/
+
+/*!
+    \fn int AnalyzerLabelCache::longWidth(int i) const
+
+    Returns the width in pixels of the long label of item \a i.
+*/
+
+/*!
+    Draws the long label of item \a i centered between the x-coordinates
+    \a from and \a to, and vertically around y=0, if it fits. Otherwise the
+    short label is drawn if it fits.
+*/
+void AnalyzerLabelCache::drawLabel(QPainter *painter, int i, double from,
+                                   double to) const
+{
+    const Label &l = mLabels.at(i);
+    const QStaticText* text = NULL;
+
+    if (l.longWidth < (to-from)) {
+        text = &l.longText;
+    }
+    else if (l.shortWidth < (to-from)) {
+        text = &l.shortText;
+    }
+
+    if (text == NULL) return;
+
+    QSizeF size = text->size();
+    painter->drawStaticText(QPointF(from+1 + ((to-from) - size.width())/2,
+                                    -size.height()/2), *text);
+}
+
+/*!
+    Sets \a text as the text of \a staticText and lays it out for the
+    current font.
+*/
+void AnalyzerLabelCache::prepareText(QStaticText &staticText,
+                                     const QString &text)
+{
+    staticText.setTextFormat(Qt::PlainText);
+    staticText.setText(text);
+    staticText.prepare(QTransform(), mFont);
+}
@@ -0,0 +1,59 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALYZERLABELCACHE_H
+#define ANALYZERLABELCACHE_H
+
+#include <QFont>
+#include <QPainter>
+#include <QStaticText>
+#include <QString>
+#include <QVector>
+
+class AnalyzerLabelCache
+{
+public:
+    AnalyzerLabelCache();
+
+    void clear();
+    void resize(int numItems);
+    void setFont(const QFont &font);
+
+    bool contains(int i) const {return mLabels.at(i).valid;}
+    void insert(int i, const QString &shortTxt, const QString &longTxt);
+
+    int shortWidth(int i) const {return mLabels.at(i).shortWidth;}
+    int longWidth(int i) const {return mLabels.at(i).longWidth;}
+
+    void drawLabel(QPainter* painter, int i, double from, double to) const;
+
+private:
+
+    struct Label {
+        bool valid;
+        int shortWidth;
+        int longWidth;
+        QStaticText shortText;
+        QStaticText longText;
+    };
+
+    QFont mFont;
+    QVector<Label> mLabels;
+
+    void prepareText(QStaticText &staticText, const QString &text);
+
+};
+
+#endif // ANALYZERLABELCACHE_H
@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "analyzertask.h"
+
+/*!
+    \class AnalyzerTask
+    \brief This is a base class for protocol decoding that runs in a
+        thread pool.
+
+    \ingroup Analyzer
+
+    A task is created by an analyzer (see UiAnalyzer::analyze()) on the
+    GUI thread. All data needed for the decoding, such as the signal data
+    and the analyzer settings, is copied into the task when it is created.
+    The signal data is implicitly shared so the copy is cheap and the task
+    is never affected by new captures.
+
+    The decoding is done by analyze() in a thread from the global
+    QThreadPool. A subclass normally leaves the decoding to a
+    ProtocolDecoder and passes cancelFlag() to it so that the decoder
+    returns as soon as possible when the task is cancelled. The finished()
+    signal is emitted when analyze() has returned, also for a cancelled
+    task.
+*/
+
+/*!
+    Constructs the AnalyzerTask with the given \a parent.
+*/
+AnalyzerTask::AnalyzerTask(QObject *parent) :
+    QObject(parent)
+{
+    // Deallocation: the task is deleted with deleteLater() once
+    // finished() has been delivered, see UiAnalyzer::analyze()
+    setAutoDelete(false);
+}
+
+/*!
+    Runs the decoding. Called by the thread pool.
+*/
+void AnalyzerTask::run()
+{
+    if (!isCancelled()) {
+        analyze();
+    }
+
+    emit finished();
+}
+
+/*!
+    Request the task to stop. The result of a cancelled task must not be
+    used. Can be called from any thread.
+*/
+void AnalyzerTask::cancel()
+{
+    mCancelled.storeRelease(1);
+}
+
+/*!
+    Returns true if the task has been cancelled.
+*/
+bool AnalyzerTask::isCancelled() const
+{
+    return mCancelled.loadAcquire() != 0;
+}
+
+/*!
+    \fn const QAtomicInt* AnalyzerTask::cancelFlag() const
+
+    Returns the flag that is set when the task is cancelled. The flag can
+    be given to a ProtocolDecoder with ProtocolDecoder::setCancelFlag().
+*/
+
+/*!
+    \fn virtual void AnalyzerTask::analyze() = 0
+
+    Decodes the signal data. Called from a thread in the thread pool.
+*/
+
+/*!
+    \fn void AnalyzerTask::finished()
+
+    This signal is emitted from the thread pool when the task has finished.
+*/
@@ -0,0 +1,46 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALYZERTASK_H
+#define ANALYZERTASK_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QAtomicInt>
+
+class AnalyzerTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    explicit AnalyzerTask(QObject *parent = 0);
+
+    void run();
+    void cancel();
+    bool isCancelled() const;
+
+signals:
+    void finished();
+
+protected:
+    const QAtomicInt* cancelFlag() const {return &mCancelled;}
+
+    virtual void analyze() = 0;
+
+private:
+    QAtomicInt mCancelled;
+
+};
+
+#endif // ANALYZERTASK_H
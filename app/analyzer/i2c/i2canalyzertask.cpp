@@ -0,0 +1,54 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "i2canalyzertask.h"
+
+/*!
+    \class I2CAnalyzerTask
+    \brief Decodes I2C protocol data in a background thread.
+
+    \ingroup Analyzer
+
+    The task works on a snapshot of the SCL and SDA transitions taken when
+    the task was created, see UiI2CAnalyzer. The decoding itself is done by
+    an I2CDecoder.
+*/
+
+/*!
+    Constructs the task for the transitions \a sclData and \a sdaData.
+    The decoding starts at sample index \a startPos.
+*/
+I2CAnalyzerTask::I2CAnalyzerTask(const DigitalTransitions &sclData,
+                                 const DigitalTransitions &sdaData,
+                                 int startPos)
+{
+    mDecoder.setSignals(sclData, sdaData);
+    mDecoder.setStartPosition(startPos);
+}
+
+/*!
+    \fn DecodedFrameStore I2CAnalyzerTask::frames() const
+
+    Returns the decoded I2C frames.
+*/
+
+/*!
+    Decodes the signal data.
+*/
+void I2CAnalyzerTask::analyze()
+{
+    mDecoder.setCancelFlag(cancelFlag());
+    mDecoder.decode();
+}
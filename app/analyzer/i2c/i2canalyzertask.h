@@ -0,0 +1,40 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef I2CANALYZERTASK_H
+#define I2CANALYZERTASK_H
+
+#include "analyzer/analyzertask.h"
+#include "decoder/i2cdecoder.h"
+#include "device/digitaltransitions.h"
+
+class I2CAnalyzerTask : public AnalyzerTask
+{
+public:
+    I2CAnalyzerTask(const DigitalTransitions &sclData,
+                    const DigitalTransitions &sdaData, int startPos);
+
+    DecodedFrameStore frames() const {return mDecoder.frames();}
+
+protected:
+    void analyze();
+
+private:
+
+    I2CDecoder mDecoder;
+
+};
+
+#endif // I2CANALYZERTASK_H
@@ -99,6 +99,9 @@ void UiI2CAnalyzer::setSdaSignalId(int sdaSignalId)
 void UiI2CAnalyzer::setDataFormat(Types::DataFormat format)
 {
     mFormat = format;
+
+    // the labels depend on the format
+    mLabels.clear();
 }
 
 /*!
@@ -139,68 +142,21 @@ void UiI2CAnalyzer::setDataFormat(Types::DataFormat format)
 
 
 /*!
-    Start to analyze the signal data.
+    Create a task that analyzes a snapshot of the signal data.
 */
-void UiI2CAnalyzer::analyze()
+AnalyzerTask* UiI2CAnalyzer::createAnalyzerTask()
 {
-    /*
-        Specification details
-
-        1. SDA line can only change when SCL line is LOW for data
-        2. START = HIGH to LOW on SDA line while SCL line is HIGH
-        3. STOP  = LOW to HIGH on SDA line while SCL line is HIGH
-        4. Each byte put on the SDA line must be 8 bits long
-        5. Each byte is followed by an Acknowledge bit (ACK or NACK)
-        6. ACK  = SDA line LOW during ninth clock pulse
-        7. NACK = SDA line HIGH during ninth clock pulse
-        8. 7-bit Address:
-              7 bits + 1 bit which indicate R/W ( Read (1) or Write (0) )
-        9. 10-bit Address:
-              - The 7 first bits of the first byte are the combination 1111 0XX
-                of which the last two bits are the two most-significant bits of
-                the 10-bit address; the eight bit of the first byte is the R/W
-                bit.
-              - As always a byte is followed by an Acknowledge bit
-              - The second byte is the 8 least-significant bits of the 10-bit
-                address.
-
-     */
-
-    mI2cItems.clear();
-
-    if (mSclSignalId == -1 || mSdaSignalId == -1) return;
+    if (mSclSignalId == -1 || mSdaSignalId == -1) return NULL;
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
 
-    QVector<int>* sclData = device->digitalData(mSclSignalId);
-    QVector<int>* sdaData = device->digitalData(mSdaSignalId);
-
-    if (sclData == NULL || sdaData == NULL) return;
-    if (sclData->size() == 0 || sdaData->size() == 0
-            || sclData->size() != sdaData->size()) return;
-
-    int sda = 0;
-    int scl = 0;
-    int prevSda = sdaData->at(0);
-    int prevScl = sclData->at(0);
-    int sclHLIdx = -1;
-
-    int data = 0;
-    int dataBitCnt = 8;
-    int startIdx = -1;
+    DigitalTransitions* sclData = device->digitalTransitions(mSclSignalId);
+    DigitalTransitions* sdaData = device->digitalTransitions(mSdaSignalId);
 
-    bool findAddress = false;
-    bool tenBit = false;
-    int address = 0;
-    int dir = 0;
-
-    int numErrors = 0;
-    bool errorFound = false;
-
-    // start to analyze when start condition has been detected
-    bool detectStart = true;
-    bool startFound = false;
+    if (sclData == NULL || sdaData == NULL) return NULL;
+    if (sclData->numSamples() == 0 || sdaData->numSamples() == 0
+            || sclData->numSamples() != sdaData->numSamples()) return NULL;
 
     int pos = 0;
     if (mSyncCursor != UiCursor::NoCursor) {
@@ -208,231 +164,30 @@ void UiI2CAnalyzer::analyze()
         if (t > 0 && CursorManager::instance().isCursorOn(mSyncCursor)) {
             pos = device->usedSampleRate()*t;
         }
-        if (pos >= sclData->size()) {
+        if (pos >= sclData->numSamples()) {
             pos = 0;
         }
     }
 
-    for (int i = pos; i < sclData->size(); i++) {
-
-        sda = sdaData->at(i);
-        scl = sclData->at(i);
-
-        //
-        // HIGH -> LOW transition for SCL starts a bit transaction. A transition
-        // on SDA is only allowed to occur when SCL is low (except for START/STOP)
-        //
-        if (prevScl > scl) {
-
-            do {
-
-                if (detectStart && !startFound) break;
-
-                // record the HIGH-LOW transition index for SCL.
-                sclHLIdx = i;
-
-                // record start index for a data byte
-                if (dataBitCnt == 8) {
-                    startIdx = i;
-                    break;
-                }
-
-                // nothing to do until dataBitCnt = 0
-                if (dataBitCnt != 0) {
-                    break;
-                }
-
-                // ---
-                // at this point a complete byte has been received
-                // ---
-
-                if (findAddress) {
-                    I2CItem::I2CType i2cType = I2CItem::I2C_7_ADDRESS_WRITE;
-
-                    // 10-bit address: See Spec 9.
-                    if ((data & 0xF8) == 0xF0) {
-                        tenBit = true;
-                        address = ((data & 0x06) << 7);
-
-                        // direction (R/W) is defined by bit 0 in the first byte
-                        dir = (data & 0x01);
-
-                        if (dir) {
-                            i2cType = I2CItem::I2C_10_ADDRESS_READ;
-                        }
-                        else {
-                            i2cType = I2CItem::I2C_10_ADDRESS_WRITE;
-                        }
-                    }
-
-                    // 7-bit address or second byte for 10-bit address
-                    else {
-
-                        if (tenBit) {
-                            address |= (data & 0xFF);
-                        }
-
-                        // 7-bit address
-                        else {
-
-                            address = ((data >> 1) & 0xFF);
-
-                            // direction (R/W) is defined by bit 0 in the address byte
-                            dir = (data & 0x01);
-
-                            if (dir) {
-                                i2cType = I2CItem::I2C_7_ADDRESS_READ;
-                            }
-                            else {
-                                i2cType = I2CItem::I2C_7_ADDRESS_WRITE;
-                            }
-
-                        }
-
-
-                        I2CItem item(i2cType, address, startIdx, i);
-                        mI2cItems.append(item);
-
-
-                        tenBit = false;
-                        findAddress = false;
-                    }
-
-                }
-
-                // DATA
-                else {
-
-                    I2CItem item(I2CItem::I2C_DATA, data, startIdx, i);
-                    mI2cItems.append(item);
-                }
-
-
-
-           } while (0);
-
-        }
-
-
-        //
-        // LOW -> HIGH transition for SCL. SDA should remain stable when SCL
-        // is high to detect a correct bit value.
-        //
-        else if (prevScl < scl){
-
-            do {
-
-                if (detectStart && !startFound) break;
-
-                // SDA must not change when SCL is high (See Spec 1.)
-                if (prevSda != sda) {
-
-                    errorFound = true;
-                    I2CItem item(I2CItem::I2C_ERROR, -1, i, -1);
-                    mI2cItems.append(item);
-
-                    numErrors++;
-                    break;
-                }
-
-                // read data
-                if (dataBitCnt > 0) {
-                    // the left-shift is a bit index (0-7)
-                    // -> decrease dataBitCnt before shifting
-                    data |= (sda << (--dataBitCnt));
-                }
-
-                // check acknowledge bit
-                else {
-
-                    // ACK
-                    if (sda == 0) {
-
-                        // using the last HIGH-LOW transition for SCL as start index
-                        I2CItem item(I2CItem::I2C_ACK, -1, sclHLIdx, -1);
-                        mI2cItems.append(item);
-                    }
-
-                    // NACK
-                    else {
-
-                        // using the last HIGH-LOW transition for SCL as start index
-                        I2CItem item(I2CItem::I2C_NACK, -1, sclHLIdx, -1);
-                        mI2cItems.append(item);
-                    }
-
-
-                    // ready to read a new byte
-                    dataBitCnt = 8;
-                    data = 0;
-                }
-
-
-
-           } while (0);
-
-        }
-
-
-        //
-        // Detect Start and Stop conditions. Transition while SCL is HIGH
-        //
-        if (!errorFound && scl == 1 && sda != prevSda) {
-
-            do {
-
-                // This should not occur while reading a data byte
-                // If it does it is a bus error (See Spec 1.)
-                if (dataBitCnt > 0 && dataBitCnt < 7) {
-
-                    // reset reading data
-                    dataBitCnt = 8;
-
-                    I2CItem item(I2CItem::I2C_ERROR, -1, i, -1);
-                    mI2cItems.append(item);
-
-                    numErrors++;
-                    break;
-                }
-
-                // HIGH -> LOW = Start
-                if (prevSda > sda) {
-
-                    I2CItem item(I2CItem::I2C_START, -1, i, -1);
-                    mI2cItems.append(item);
-
-                    findAddress = true;
-                    startFound = true;
-                }
-
-                // LOW -> HIGH = Stop
-                else {
-
-                    if (!detectStart || (detectStart&&startFound)) {
-                        I2CItem item(I2CItem::I2C_STOP, -1, i, -1);
-                        mI2cItems.append(item);
-                    }
-
-                }
-
-                data = 0;
-                dataBitCnt = 8;
-
-            } while (0);
-        }
-
-
-        prevSda = sda;
-        prevScl = scl;
-        errorFound = false;
+    // Deallocation: The task deletes itself when finished (see UiAnalyzer)
+    return new I2CAnalyzerTask(*sclData, *sdaData, pos);
+}
 
-        if (numErrors > MaxNumBusErrors) {
-            qDebug() << "Too many bus errors "<<numErrors<<" > " << MaxNumBusErrors;
-            break;
-        }
+/*!
+    Take the decoded frames from \a task.
+*/
+void UiI2CAnalyzer::analyzerTaskFinished(AnalyzerTask* task)
+{
+    I2CAnalyzerTask* t = static_cast<I2CAnalyzerTask*>(task);
 
+    if (t != NULL) {
+        mFrames = t->frames();
+    }
+    else {
+        mFrames.clear();
     }
 
+    mLabels.resize(mFrames.size());
 }
 
 /*!
@@ -572,24 +327,29 @@ void UiI2CAnalyzer::paintEvent(QPaintEvent *event)
     pen.setColor(Configuration::instance().analyzerColor());
     painter.setPen(pen);
 
-    for (int i = 0; i < mI2cItems.size(); i++) {
-        I2CItem item = mI2cItems.at(i);
-
-        fromIdx = item.startIdx;
-        toIdx = item.stopIdx;
-
+    mLabels.setFont(painter.font());
 
-        typeAndValueAsString(item.type, item.value, shortTxt, longTxt);
-
-        int shortTextWidth = painter.fontMetrics().width(shortTxt);
-        int longTextWidth = painter.fontMetrics().width(longTxt);
+    // skip the items that end before the plot area
+    int first = mFrames.firstEndingAt(firstVisibleSample(sampleRate));
 
+    for (int i = first; i < mFrames.size(); i++) {
+        fromIdx = mFrames.startIdx(i);
+        toIdx = mFrames.stopIdx(i);
 
         from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
 
         // no need to draw when signal is out of plot area
         if (from > width()) break;
 
+        if (!mLabels.contains(i)) {
+            I2CItem::I2CType type = (I2CItem::I2CType)mFrames.type(i);
+            typeAndValueAsString(type, mFrames.value(i), shortTxt, longTxt);
+            mLabels.insert(i, shortTxt, longTxt);
+        }
+
+        int shortTextWidth = mLabels.shortWidth(i);
+        int longTextWidth = mLabels.longWidth(i);
+
         if (toIdx != -1) {
             to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
         }
@@ -598,11 +358,11 @@ void UiI2CAnalyzer::paintEvent(QPaintEvent *event)
             // see if the long text version fits
             to = from + longTextWidth+textMargin*2;
 
-            if (i+1 < mI2cItems.size()) {
+            if (i+1 < mFrames.size()) {
 
                 // get position for the start of the next item
                 double tmp = mTimeAxis->timeToPixelRelativeRef(
-                            (double)mI2cItems.at(i+1).startIdx/sampleRate);
+                            (double)mFrames.startIdx(i+1)/sampleRate);
 
 
                 // if 'to' overlaps check if short text fits
@@ -639,13 +399,7 @@ void UiI2CAnalyzer::paintEvent(QPaintEvent *event)
         }
 
         // only draw the text if it fits between 'from' and 'to'
-        QRectF textRect(from+1, -h, (to-from), 2*h);
-        if (longTextWidth < (to-from)) {
-            painter.drawText(textRect, Qt::AlignCenter, longTxt);
-        }
-        else if (shortTextWidth < (to-from)) {
-            painter.drawText(textRect, Qt::AlignCenter, shortTxt);
-        }
+        mLabels.drawLabel(&painter, i, from, to);
 
     }
 
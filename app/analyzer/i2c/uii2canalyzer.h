@@ -18,6 +18,7 @@
 
 
 #include "analyzer/uianalyzer.h"
+#include "analyzer/analyzerlabelcache.h"
 
 #include <QLabel>
 #include <QLineEdit>
@@ -25,63 +26,7 @@
 #include <QVector>
 
 #include "capture/uicursor.h"
-
-/*!
-    \class I2CItem
-    \brief Container class for I2C items.
-
-    \ingroup Analyzer
-
-    \internal
-
-*/
-class I2CItem {
-public:
-
-    /*!
-        I2C protocol types
-    */
-    enum I2CType {
-        I2C_START,
-        I2C_STOP,
-        I2C_ACK,
-        I2C_NACK,
-        I2C_DATA,
-        I2C_7_ADDRESS_WRITE,
-        I2C_7_ADDRESS_READ,
-        I2C_10_ADDRESS_WRITE,
-        I2C_10_ADDRESS_READ,
-        I2C_ERROR
-    };
-
-    // default constructor needed in order to add this to QVector
-    /*!
-        Default constructor
-    */
-    I2CItem() {
-    }
-
-    /*!
-        Creates an I2C container item
-    */
-    I2CItem(I2CType type, int value, int startIdx, int stopIdx) {
-        this->type = type;
-        this->value = value;
-        this->startIdx = startIdx;
-        this->stopIdx = stopIdx;
-    }
-
-    /*! type */
-    I2CType type;
-    /*! value */
-    int value;
-    /*! sample index where item starts */
-    int startIdx;
-    /*! sample index where item stop */
-    int stopIdx;
-};
-
-
+#include "i2canalyzertask.h"
 
 class UiI2CAnalyzer : public UiAnalyzer
 {
@@ -102,7 +47,6 @@ public:
     void setSyncCursor(UiCursor::CursorId id) {mSyncCursor = id;}
     UiCursor::CursorId syncCursor() {return mSyncCursor;}
 
-    void analyze();
     void configure(QWidget* parent);
 
     QString toSettingsString() const;
@@ -116,11 +60,13 @@ protected:
     void paintEvent(QPaintEvent *event);
     void showEvent(QShowEvent* event);
 
+    AnalyzerTask* createAnalyzerTask();
+    void analyzerTaskFinished(AnalyzerTask* task);
+
 
 private:
 
     enum {
-        MaxNumBusErrors = 5,
         SignalIdMarginRight = 10
     };
 
@@ -136,7 +82,8 @@ private:
     static int i2cAnalyzerCounter;
 
 
-    QVector<I2CItem> mI2cItems;
+    DecodedFrameStore mFrames;
+    AnalyzerLabelCache mLabels;
 
     void typeAndValueAsString(I2CItem::I2CType type, int value, QString &shortTxt, QString &longTxt);
 
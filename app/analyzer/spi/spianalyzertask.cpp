@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "spianalyzertask.h"
+
+/*!
+    \class SpiAnalyzerTask
+    \brief Decodes SPI protocol data in a background thread.
+
+    \ingroup Analyzer
+
+    The task works on a snapshot of the SCK, MOSI, MISO and Enable
+    transitions taken when the task was created, see UiSpiAnalyzer. The
+    decoding itself is done by a SpiDecoder.
+*/
+
+/*!
+    Constructs the task for the transitions \a sckData, \a mosiData,
+    \a misoData and \a enableData. The decoding starts at sample index
+    \a startPos.
+*/
+SpiAnalyzerTask::SpiAnalyzerTask(const DigitalTransitions &sckData,
+                                 const DigitalTransitions &mosiData,
+                                 const DigitalTransitions &misoData,
+                                 const DigitalTransitions &enableData,
+                                 int startPos)
+{
+    mDecoder.setSignals(sckData, mosiData, misoData, enableData);
+    mDecoder.setStartPosition(startPos);
+}
+
+/*!
+    \fn void SpiAnalyzerTask::setDataBits(int bits)
+
+    Set the number of data bits to \a bits.
+*/
+
+/*!
+    \fn void SpiAnalyzerTask::setMode(Types::SpiMode mode)
+
+    Set the SPI \a mode.
+*/
+
+/*!
+    \fn void SpiAnalyzerTask::setEnableMode(Types::SpiEnable mode)
+
+    Set the enable \a mode.
+*/
+
+/*!
+    \fn DecodedFrameStore SpiAnalyzerTask::frames() const
+
+    Returns the decoded SPI frames.
+*/
+
+/*!
+    Decodes the signal data.
+*/
+void SpiAnalyzerTask::analyze()
+{
+    mDecoder.setCancelFlag(cancelFlag());
+    mDecoder.decode();
+}
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SPIANALYZERTASK_H
+#define SPIANALYZERTASK_H
+
+#include "analyzer/analyzertask.h"
+#include "common/types.h"
+#include "decoder/spidecoder.h"
+#include "device/digitaltransitions.h"
+
+class SpiAnalyzerTask : public AnalyzerTask
+{
+public:
+    SpiAnalyzerTask(const DigitalTransitions &sckData,
+                    const DigitalTransitions &mosiData,
+                    const DigitalTransitions &misoData,
+                    const DigitalTransitions &enableData,
+                    int startPos);
+
+    void setDataBits(int bits) {mDecoder.setDataBits(bits);}
+    void setMode(Types::SpiMode mode) {mDecoder.setMode(mode);}
+    void setEnableMode(Types::SpiEnable mode) {mDecoder.setEnableMode(mode);}
+
+    DecodedFrameStore frames() const {return mDecoder.frames();}
+
+protected:
+    void analyze();
+
+private:
+
+    SpiDecoder mDecoder;
+
+};
+
+#endif // SPIANALYZERTASK_H
@@ -201,10 +201,16 @@ void UiSpiAnalyzer::setEnableSignal(int id)
 */
 
 /*!
-    \fn void UiSpiAnalyzer::setDataFormat(Types::DataFormat format)
-
     Set the data format to \a format.
 */
+void UiSpiAnalyzer::setDataFormat(Types::DataFormat format)
+{
+    mFormat = format;
+
+    // the labels depend on the format
+    mMosiLabels.clear();
+    mMisoLabels.clear();
+}
 
 /*!
     \fn Types::DataFormat UiSpiAnalyzer::dataFormat() const
@@ -226,31 +232,29 @@ void UiSpiAnalyzer::setEnableSignal(int id)
 
 
 /*!
-    Start to analyze the signal data.
+    Create a task that analyzes a snapshot of the signal data.
 */
-void UiSpiAnalyzer::analyze()
+AnalyzerTask* UiSpiAnalyzer::createAnalyzerTask()
 {
-    mSpiItems.clear();
-
     if (mSckSignalId == -1 || mMosiSignalId == -1
-            ||  mMisoSignalId == -1 ||  mEnableSignalId == -1) return;
+            ||  mMisoSignalId == -1 ||  mEnableSignalId == -1) return NULL;
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
 
-    QVector<int>* sckData = device->digitalData(mSckSignalId);
-    QVector<int>* mosiData = device->digitalData(mMosiSignalId);
-    QVector<int>* misoData = device->digitalData(mMisoSignalId);
-    QVector<int>* enableData = device->digitalData(mEnableSignalId);
+    DigitalTransitions* sckData = device->digitalTransitions(mSckSignalId);
+    DigitalTransitions* mosiData = device->digitalTransitions(mMosiSignalId);
+    DigitalTransitions* misoData = device->digitalTransitions(mMisoSignalId);
+    DigitalTransitions* enableData =
+            device->digitalTransitions(mEnableSignalId);
 
     if (sckData == NULL || mosiData == NULL
-            || misoData == NULL || enableData == NULL) return;
-    if (sckData->size() == 0 || mosiData->size() == 0
-            || misoData->size() == 0 || misoData->size() == 0) return;
+            || misoData == NULL || enableData == NULL) return NULL;
+    if (sckData->numSamples() == 0
+            || mosiData->numSamples() != sckData->numSamples()
+            || misoData->numSamples() != sckData->numSamples()
+            || enableData->numSamples() != sckData->numSamples()) return NULL;
 
-
-    bool done = false;
-    bool findCsOn = true;
     int pos = 0;
 
     if (mSyncCursor != UiCursor::NoCursor) {
@@ -259,139 +263,38 @@ void UiSpiAnalyzer::analyze()
             pos = device->usedSampleRate()*t;
         }
 
-        if (pos >= sckData->size()) {
+        if (pos >= sckData->numSamples()) {
             pos = 0;
         }
 
     }
 
+    // Deallocation: The task deletes itself when finished (see UiAnalyzer)
+    SpiAnalyzerTask* task = new SpiAnalyzerTask(*sckData, *mosiData,
+                                                *misoData, *enableData, pos);
+    task->setDataBits(mDataBits);
+    task->setMode(mMode);
+    task->setEnableMode(mEnableMode);
 
-    int prevCs = enableData->at(pos);
-    int currCs = 0;
-    bool csChanged = false;
-    bool csOff = false;
-
-
-    int prevSck = sckData->at(pos);
-    int currSck = 0;
-    bool sckChanged = false;
-    int sckChangeNum = 0;
-
-    int mosi = 0;
-    int miso = 0;
-    int mosiValue = 0;
-    int misoValue = 0;
-    int dataBitCnt = mDataBits;
-
-    int startIdx = -1;
-
-    // CPHA = 0 -> capture data on first clock transition (otherwise second)
-    bool captureOnFirst = (mMode == Types::SpiMode_0
-                           || mMode == Types::SpiMode_2);
-
-
-
-    while (!done) {
-
-        // reached end of data
-        if (pos >= sckData->size()) break;
-
-        currCs  = enableData->at(pos);
-        csChanged = (prevCs != currCs);
-
-        currSck = sckData->at(pos);
-        sckChanged = (prevSck != currSck);
-        if (sckChanged) {
-            sckChangeNum++;
-        }
-
-        mosi = mosiData->at(pos);
-        miso = misoData->at(pos);
-
-
-        do {
-
-            /*
-             * Look for Enable on
-             */
-
-            if (findCsOn) {
-
-                if (csChanged &&
-                        ( ((currCs == 0 && mEnableMode == Types::SpiEnableLow) ||
-                          (currCs == 1 && mEnableMode == Types::SpiEnableHigh))))
-                {
-                    findCsOn = false;
-                }
-
-                else {
-                    // we've not found enable yet -> get next sample
-                    break;
-                }
-            }
-
-            /*
-             * Check if Enable is set to off
-             */
-
-            csOff = (csChanged && ((currCs == 1 && mEnableMode == Types::SpiEnableLow)
-                                   || (currCs == 0 && mEnableMode == Types::SpiEnableHigh)));
-
-            if (csOff) {
-                findCsOn = true;
-
-
-                // enable signal has been set to off, but we haven't received a complete value
-                if (dataBitCnt > 0 && dataBitCnt < 8) {
-                    done = true;
-
-                    SpiItem item(SpiItem::TYPE_FRAME_ERROR, 0, 0, startIdx, -1);
-                    mSpiItems.append(item);
-                }
-
-
-            }
-
-            // capture data when SCK changes
-            if (sckChanged && ((captureOnFirst && (sckChangeNum % 2) != 0)
-                    || (!captureOnFirst && (sckChangeNum % 2) == 0))) {
-
-                if (startIdx == -1) {
-                    startIdx = pos;
-                }
-
-                mosiValue |= (mosi << (--dataBitCnt));
-                misoValue |= (miso << (dataBitCnt));
-
-
-
-                // captured a complete value
-                if (dataBitCnt == 0) {
-                    SpiItem item(SpiItem::TYPE_DATA, mosiValue, misoValue,
-                                 startIdx, pos);
-                    mSpiItems.append(item);
-
-                    startIdx = -1;
-                    mosiValue = 0;
-                    misoValue = 0;
-                    dataBitCnt = mDataBits;
-                }
-
-
-
-                //sckChangeNum = 0;
-            }
-
-
-
+    return task;
+}
 
-        } while (false);
+/*!
+    Take the decoded frames from \a task.
+*/
+void UiSpiAnalyzer::analyzerTaskFinished(AnalyzerTask* task)
+{
+    SpiAnalyzerTask* t = static_cast<SpiAnalyzerTask*>(task);
 
-        pos++;
-        prevCs = currCs;
-        prevSck = currSck;
+    if (t != NULL) {
+        mFrames = t->frames();
+    }
+    else {
+        mFrames.clear();
     }
 
+    mMosiLabels.resize(mFrames.size());
+    mMisoLabels.resize(mFrames.size());
 }
 
 /*!
@@ -586,27 +489,34 @@ void UiSpiAnalyzer::paintEvent(QPaintEvent *event)
     pen.setColor(Configuration::instance().analyzerColor());
     painter.setPen(pen);
 
-    for (int i = 0; i < mSpiItems.size(); i++) {
-        SpiItem item = mSpiItems.at(i);
-
-        fromIdx = item.startIdx;
-        toIdx = item.stopIdx;
-
+    mMosiLabels.setFont(painter.font());
+    mMisoLabels.setFont(painter.font());
 
-        typeAndValueAsString(item.type, item.mosiValue, mosiShortTxt,
-                             mosiLongTxt);
-        typeAndValueAsString(item.type, item.misoValue, misoShortTxt,
-                             misoLongTxt);
-
-        int shortTextWidth = painter.fontMetrics().width(mosiShortTxt);
-        int longTextWidth = painter.fontMetrics().width(mosiLongTxt);
+    // skip the items that end before the plot area
+    int first = mFrames.firstEndingAt(firstVisibleSample(sampleRate));
 
+    for (int i = first; i < mFrames.size(); i++) {
+        fromIdx = mFrames.startIdx(i);
+        toIdx = mFrames.stopIdx(i);
 
         from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
 
         // no need to draw when signal is out of plot area
         if (from > width()) break;
 
+        if (!mMosiLabels.contains(i)) {
+            SpiItem::ItemType type = (SpiItem::ItemType)mFrames.type(i);
+            typeAndValueAsString(type, mFrames.value(i), mosiShortTxt,
+                                 mosiLongTxt);
+            typeAndValueAsString(type, mFrames.secondValue(i), misoShortTxt,
+                                 misoLongTxt);
+            mMosiLabels.insert(i, mosiShortTxt, mosiLongTxt);
+            mMisoLabels.insert(i, misoShortTxt, misoLongTxt);
+        }
+
+        int shortTextWidth = mMosiLabels.shortWidth(i);
+        int longTextWidth = mMosiLabels.longWidth(i);
+
         if (toIdx != -1) {
             to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
         }
@@ -615,11 +525,11 @@ void UiSpiAnalyzer::paintEvent(QPaintEvent *event)
             // see if the long text version fits
             to = from + longTextWidth+textMargin*2;
 
-            if (i+1 < mSpiItems.size()) {
+            if (i+1 < mFrames.size()) {
 
                 // get position for the start of the next item
                 double tmp = mTimeAxis->timeToPixelRelativeRef(
-                            (double)mSpiItems.at(i+1).startIdx/sampleRate);
+                            (double)mFrames.startIdx(i+1)/sampleRate);
 
 
                 // if 'to' overlaps check if short text fits
@@ -641,12 +551,12 @@ void UiSpiAnalyzer::paintEvent(QPaintEvent *event)
 
         painter.save();
         painter.translate(0, height()/4);
-        paintSignal(&painter, from, to, h, mosiShortTxt, mosiLongTxt);
+        paintSignal(&painter, from, to, h, mMosiLabels, i);
         painter.restore();
 
         painter.save();
         painter.translate(0, 3*height()/4);
-        paintSignal(&painter, from, to, h, misoShortTxt, misoLongTxt);
+        paintSignal(&painter, from, to, h, mMisoLabels, i);
         painter.restore();
 
     }
@@ -744,15 +654,12 @@ void UiSpiAnalyzer::typeAndValueAsString(SpiItem::ItemType type,
 }
 
 /*!
-    Paint signal data.
+    Paint signal data for item \a i using the cached \a labels.
 */
 void UiSpiAnalyzer::paintSignal(QPainter* painter, double from, double to,
-                                int h, QString &shortTxt, QString &longTxt)
+                                int h, const AnalyzerLabelCache &labels,
+                                int i)
 {
-
-    int shortTextWidth = painter->fontMetrics().width(shortTxt);
-    int longTextWidth = painter->fontMetrics().width(longTxt);
-
     if (to-from > 4) {
         painter->drawLine(from, 0, from+2, -h);
         painter->drawLine(from, 0, from+2, h);
@@ -770,12 +677,6 @@ void UiSpiAnalyzer::paintSignal(QPainter* painter, double from, double to,
     }
 
     // only draw the text if it fits between 'from' and 'to'
-    QRectF textRect(from+1, -h, (to-from), 2*h);
-    if (longTextWidth < (to-from)) {
-        painter->drawText(textRect, Qt::AlignCenter, longTxt);
-    }
-    else if (shortTextWidth < (to-from)) {
-        painter->drawText(textRect, Qt::AlignCenter, shortTxt);
-    }
+    labels.drawLabel(painter, i, from, to);
 
 }
@@ -19,53 +19,9 @@
 #include <QWidget>
 
 #include "analyzer/uianalyzer.h"
+#include "analyzer/analyzerlabelcache.h"
 #include "capture/uicursor.h"
-
-/*!
-    \class SpiItem
-    \brief Container class for SPi items.
-
-    \ingroup Analyzer
-
-    \internal
-
-*/
-class SpiItem {
-public:
-
-    /*!
-        SPI item type
-    */
-    enum ItemType {
-        TYPE_DATA,
-        TYPE_FRAME_ERROR
-    };
-
-    // default constructor needed in order to add this to QVector
-    /*! Default constructor */
-    SpiItem() {
-    }
-
-    /*! Constructs a new container */
-    SpiItem(ItemType type, int mosiValue, int misoValue, int startIdx, int stopIdx) {
-        this->type = type;
-        this->mosiValue = mosiValue;
-        this->misoValue = misoValue;
-        this->startIdx = startIdx;
-        this->stopIdx = stopIdx;
-    }
-
-    /*! type */
-    ItemType type;
-    /*! mosi value */
-    int mosiValue;
-    /*! miso value */
-    int misoValue;
-    /*! item start index */
-    int startIdx;
-    /*! item stop index */
-    int stopIdx;
-};
+#include "spianalyzertask.h"
 
 class UiSpiAnalyzer : public UiAnalyzer
 {
@@ -100,13 +56,12 @@ public:
     void setEnableMode(Types::SpiEnable mode) {mEnableMode = mode;}
     Types::SpiEnable enableMode() const {return mEnableMode;}
 
-    void setDataFormat(Types::DataFormat format) {mFormat = format;}
+    void setDataFormat(Types::DataFormat format);
     Types::DataFormat dataFormat() const {return mFormat;}
 
     void setSyncCursor(UiCursor::CursorId id) {mSyncCursor = id;}
     UiCursor::CursorId syncCursor() const {return mSyncCursor;}
 
-    void analyze();
     void configure(QWidget* parent);
 
     QString toSettingsString() const;
@@ -119,6 +74,9 @@ public slots:
 protected:
     void paintEvent(QPaintEvent *event);
     void showEvent(QShowEvent* event);
+
+    AnalyzerTask* createAnalyzerTask();
+    void analyzerTaskFinished(AnalyzerTask* task);
     
 
 private:
@@ -145,7 +103,9 @@ private:
     QLabel* mMisoLbl;
     QLabel* mEnableLbl;
 
-    QVector<SpiItem> mSpiItems;
+    DecodedFrameStore mFrames;
+    AnalyzerLabelCache mMosiLabels;
+    AnalyzerLabelCache mMisoLabels;
 
     static int spiAnalyzerCounter;
 
@@ -159,7 +119,7 @@ private:
                                  QString &longTxt);
 
     void paintSignal(QPainter* painter, double from, double to,
-                     int h, QString &shortTxt, QString &longTxt);
+                     int h, const AnalyzerLabelCache &labels, int i);
 };
 
 #endif // UISPIANALYZER_H
@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uartanalyzertask.h"
+
+/*!
+    \class UartAnalyzerTask
+    \brief Decodes UART protocol data in a background thread.
+
+    \ingroup Analyzer
+
+    The task works on a snapshot of the signal transitions taken when the
+    task was created, see UiUartAnalyzer. The decoding itself is done by a
+    UartDecoder.
+
+    Each UART analyzer decodes one channel in its own task. Since the tasks
+    only work on their own snapshot several channels are decoded in
+    parallel by the thread pool used by UiAnalyzer.
+*/
+
+/*!
+    Constructs the task for the signal transitions \a data sampled at
+    \a sampleRate and sent with \a baudRate. The decoding starts at sample
+    index \a startPos.
+*/
+UartAnalyzerTask::UartAnalyzerTask(const DigitalTransitions &data,
+                                   int sampleRate, int baudRate, int startPos)
+{
+    mDecoder.setSignal(data);
+    mDecoder.setSampleRate(sampleRate);
+    mDecoder.setBaudRate(baudRate);
+    mDecoder.setStartPosition(startPos);
+}
+
+/*!
+    \fn void UartAnalyzerTask::setDataBits(int bits)
+
+    Set the number of data bits to \a bits.
+*/
+
+/*!
+    \fn void UartAnalyzerTask::setStopBits(int bits)
+
+    Set the number of stop bits to \a bits.
+*/
+
+/*!
+    \fn void UartAnalyzerTask::setParity(Types::UartParity parity)
+
+    Set the \a parity.
+*/
+
+/*!
+    \fn DecodedFrameStore UartAnalyzerTask::frames() const
+
+    Returns the decoded UART frames.
+*/
+
+/*!
+    Decodes the signal data.
+*/
+void UartAnalyzerTask::analyze()
+{
+    mDecoder.setCancelFlag(cancelFlag());
+    mDecoder.decode();
+}
@@ -0,0 +1,45 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UARTANALYZERTASK_H
+#define UARTANALYZERTASK_H
+
+#include "analyzer/analyzertask.h"
+#include "common/types.h"
+#include "decoder/uartdecoder.h"
+#include "device/digitaltransitions.h"
+
+class UartAnalyzerTask : public AnalyzerTask
+{
+public:
+    UartAnalyzerTask(const DigitalTransitions &data, int sampleRate,
+                     int baudRate, int startPos);
+
+    void setDataBits(int bits) {mDecoder.setDataBits(bits);}
+    void setStopBits(int bits) {mDecoder.setStopBits(bits);}
+    void setParity(Types::UartParity parity) {mDecoder.setParity(parity);}
+
+    DecodedFrameStore frames() const {return mDecoder.frames();}
+
+protected:
+    void analyze();
+
+private:
+
+    UartDecoder mDecoder;
+
+};
+
+#endif // UARTANALYZERTASK_H
@@ -94,6 +94,9 @@ void UiUartAnalyzer::setSignalId(int signalId)
 void UiUartAnalyzer::setDataFormat(Types::DataFormat format)
 {
     mFormat = format;
+
+    // the labels depend on the format
+    mLabels.clear();
 }
 
 /*!
@@ -164,217 +167,58 @@ void UiUartAnalyzer::setDataFormat(Types::DataFormat format)
 
 
 /*!
-    Start to analyze the signal data.
+    Create a task that analyzes a snapshot of the signal data.
 */
-void UiUartAnalyzer::analyze()
+AnalyzerTask* UiUartAnalyzer::createAnalyzerTask()
 {
-    mUartItems.clear();
-
-    if (mSignalId == -1) return;
+    if (mSignalId == -1) return NULL;
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
     int sampleRate = device->usedSampleRate();
-    QVector<int>* uartData = device->digitalData(mSignalId);
+    DigitalTransitions* uartData = device->digitalTransitions(mSignalId);
 
-    if (uartData == NULL || uartData->size() == 0) return;
+    if (uartData == NULL || uartData->numSamples() == 0) return NULL;
 
-    int numSamplesPerBit = sampleRate / mBaudRate;
+    double numSamplesPerBit = (double)sampleRate / mBaudRate;
     // if there aren't enough samples per bit the decoding isn't reliable
-    if (numSamplesPerBit < 3) return;
+    if (numSamplesPerBit < 3) return NULL;
 
-    int startIdx = 0;
-    int value = 0;
-    int numDataBits = 0;
-    int numStopBits = 0;
     int pos = 0;
-    int onesInBit = 0;
-    int onesInValue = 0;
-    int bitValue = 0;
-    int bitStart = 0;
-
-
-    bool startFound = false;
-    bool findTransition = true;
-    bool parityError = false;
-    bool done = false;
-
     if (mSyncCursor != UiCursor::NoCursor) {
         double t = CursorManager::instance().cursorPosition(mSyncCursor);
         if (t > 0 && CursorManager::instance().isCursorOn(mSyncCursor)) {
             pos = sampleRate*t;
         }
-        if (pos >= uartData->size()) {
+        if (pos >= uartData->numSamples()) {
             pos = 0;
         }
     }
 
-    UartState state = STATE_START;
-
-    int prev = uartData->at(pos);
-
-    while(!done) {
-        if (pos + numSamplesPerBit >= uartData->size()) break;
-
-        if (findTransition) {
-            if (uartData->at(pos) != prev) {
-               findTransition = false;
-            }
-            else {
-                prev = uartData->at(pos);
-                pos++;
-
-                continue;
-            }
-        }
-
-        // check value of the bit
-        onesInBit = 0;
-        bitStart = pos;
-
-        for(int i = 0; i < numSamplesPerBit; i++) {
-
-            if (pos > 0 && uartData->at(pos-1) != uartData->at(pos)) {
-
-                // resyncing if a transition occurs when at least half
-                // the bit time has elapsed
-                if (i >= numSamplesPerBit/2) {
-                    break;
-                }
-            }
-
-            if (uartData->at(pos++) == 1) {
-                onesInBit++;
-            }
-        }
-        // value determined by state during at least half the bit time
-        bitValue = (((double)onesInBit/numSamplesPerBit) >= 0.5) ? 1 : 0;
-
-        switch(state) {
-
-        case STATE_START:
-            if (bitValue == 0) {
-                startFound = true;
-                startIdx = bitStart;
-                numDataBits = 0;
-                numStopBits = 0;
-                onesInValue = 0;
-                value = 0;
-                parityError = false;
-
-                state = STATE_DATA;
-            }
-
-            // it was not a start bit
-            else {
-
-                // restart if the start bit has never been seen
-                if (!startFound) {
-                    findTransition = true;
-                }
-
-                // frame error if start bit has been seen at least once
-                else {
-                    UartItem item(UartItem::TYPE_FRAME_ERROR, 0, bitStart, -1);
-                    mUartItems.append(item);
-                    done = true;
-                }
-
-            }
-            break;
-
-
-        case STATE_DATA:
-            // TODO: also support MSB first
-            value |= (bitValue << numDataBits);
-            numDataBits++;
-
-            if (bitValue == 1) {
-                onesInValue++;
-            }
-
-            if (numDataBits == mDataBits) {
-                if (mParity != Types::ParityNone) {
-                    state = STATE_PARITY;
-                }
-                else {
-                    state = STATE_STOP;
-                }
-            }
-            break;
-        case STATE_PARITY:
-
-            parityError = false;
-            switch(mParity) {
-            case Types::ParityNone:
-                break;
-            case Types::ParityOdd:
-                if ( (((onesInValue%2) == 0) && bitValue == 0) ||
-                     (((onesInValue%2) != 0 && bitValue == 1)))
-                {
-                    parityError = true;
-                }
-
-                break;
-            case Types::ParityEven:
-
-                if ( (((onesInValue%2) != 0) && bitValue == 0) ||
-                     (((onesInValue%2) == 0 && bitValue == 1)))
-                {
-                    parityError = true;
-                }
-
-                break;
-            case Types::ParityMark:
-                parityError = (bitValue == 0);
-                break;
-            case Types::ParitySpace:
-                parityError = (bitValue == 1);
-                break;
-            default:
-                break;
-            }
-
-            state = STATE_STOP;
-
-            break;
-        case STATE_STOP:
-            if (bitValue == 1) {
-                numStopBits++;
-
-                if (numStopBits == mStopBits) {
-
-                    if (!parityError) {
-                        UartItem item(UartItem::TYPE_DATA, value, startIdx, pos);
-                        mUartItems.append(item);
-                    }
-                    else {
-                        UartItem item(UartItem::TYPE_PARITY_ERROR, 0, startIdx, pos);
-                        mUartItems.append(item);
-                    }
-
-                    state = STATE_START;
-                    prev = uartData->at(pos-1);
-
-                    if (prev == 1) {
-                        // resync by finding transition
-                        findTransition = true;
-                    }
-
+    // Deallocation: The task deletes itself when finished (see UiAnalyzer)
+    UartAnalyzerTask* task = new UartAnalyzerTask(*uartData, sampleRate,
+                                                  mBaudRate, pos);
+    task->setDataBits(mDataBits);
+    task->setStopBits(mStopBits);
+    task->setParity(mParity);
 
-                }
-            }
+    return task;
+}
 
-            // no stop bit -> frame error
-            else {
-                UartItem item(UartItem::TYPE_FRAME_ERROR, 0, startIdx, -1);
-                mUartItems.append(item);
-                done = true;
-            }
-            break;
-        }
+/*!
+    Take the decoded frames from \a task.
+*/
+void UiUartAnalyzer::analyzerTaskFinished(AnalyzerTask* task)
+{
+    UartAnalyzerTask* t = static_cast<UartAnalyzerTask*>(task);
 
+    if (t != NULL) {
+        mFrames = t->frames();
+    }
+    else {
+        mFrames.clear();
     }
 
+    mLabels.resize(mFrames.size());
 }
 
 /*!
@@ -540,24 +384,29 @@ void UiUartAnalyzer::paintEvent(QPaintEvent *event)
     pen.setColor(Configuration::instance().analyzerColor());
     painter.setPen(pen);
 
-    for (int i = 0; i < mUartItems.size(); i++) {
-        UartItem item = mUartItems.at(i);
+    mLabels.setFont(painter.font());
 
-        fromIdx = item.startIdx;
-        toIdx = item.stopIdx;
-
-
-        typeAndValueAsString(item.type, item.value, shortTxt, longTxt);
-
-        int shortTextWidth = painter.fontMetrics().width(shortTxt);
-        int longTextWidth = painter.fontMetrics().width(longTxt);
+    // skip the items that end before the plot area
+    int first = mFrames.firstEndingAt(firstVisibleSample(sampleRate));
 
+    for (int i = first; i < mFrames.size(); i++) {
+        fromIdx = mFrames.startIdx(i);
+        toIdx = mFrames.stopIdx(i);
 
         from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
 
         // no need to draw when signal is out of plot area
         if (from > width()) break;
 
+        if (!mLabels.contains(i)) {
+            UartItem::ItemType type = (UartItem::ItemType)mFrames.type(i);
+            typeAndValueAsString(type, mFrames.value(i), shortTxt, longTxt);
+            mLabels.insert(i, shortTxt, longTxt);
+        }
+
+        int shortTextWidth = mLabels.shortWidth(i);
+        int longTextWidth = mLabels.longWidth(i);
+
         if (toIdx != -1) {
             to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
         }
@@ -566,11 +415,11 @@ void UiUartAnalyzer::paintEvent(QPaintEvent *event)
             // see if the long text version fits
             to = from + longTextWidth+textMargin*2;
 
-            if (i+1 < mUartItems.size()) {
+            if (i+1 < mFrames.size()) {
 
                 // get position for the start of the next item
                 double tmp = mTimeAxis->timeToPixelRelativeRef(
-                            (double)mUartItems.at(i+1).startIdx/sampleRate);
+                            (double)mFrames.startIdx(i+1)/sampleRate);
 
 
                 // if 'to' overlaps check if short text fits
@@ -607,13 +456,7 @@ void UiUartAnalyzer::paintEvent(QPaintEvent *event)
         }
 
         // only draw the text if it fits between 'from' and 'to'
-        QRectF textRect(from+1, -h, (to-from), 2*h);
-        if (longTextWidth < (to-from)) {
-            painter.drawText(textRect, Qt::AlignCenter, longTxt);
-        }
-        else if (shortTextWidth < (to-from)) {
-            painter.drawText(textRect, Qt::AlignCenter, shortTxt);
-        }
+        mLabels.drawLabel(&painter, i, from, to);
 
     }
 
@@ -19,52 +19,9 @@
 #include <QWidget>
 
 #include "analyzer/uianalyzer.h"
+#include "analyzer/analyzerlabelcache.h"
 #include "capture/uicursor.h"
-
-/*!
-    \class UartItem
-    \brief Container class for UART items.
-
-    \ingroup Analyzer
-
-    \internal
-
-*/
-class UartItem {
-public:
-
-    /*!
-        UART item type
-    */
-    enum ItemType {
-        TYPE_DATA,
-        TYPE_FRAME_ERROR,
-        TYPE_PARITY_ERROR
-    };
-
-    // default constructor needed in order to add this to QVector
-    /*! Default constructor */
-    UartItem() {
-    }
-
-    /*! Constructs a new container */
-    UartItem(ItemType type, int value, int startIdx, int stopIdx) {
-        this->type = type;
-        this->value = value;
-        this->startIdx = startIdx;
-        this->stopIdx = stopIdx;
-    }
-
-    /*! type */
-    ItemType type;
-    /*! value */
-    int value;
-    /*! item start index */
-    int startIdx;
-    /*! item stop index */
-    int stopIdx;    
-
-};
+#include "uartanalyzertask.h"
 
 class UiUartAnalyzer : public UiAnalyzer
 {
@@ -96,7 +53,6 @@ public:
     void setSyncCursor(UiCursor::CursorId id) {mSyncCursor = id;}
     UiCursor::CursorId syncCursor() const {return mSyncCursor;}
 
-    void analyze();
     void configure(QWidget* parent);
 
     QString toSettingsString() const;
@@ -110,19 +66,15 @@ protected:
     void paintEvent(QPaintEvent *event);
     void showEvent(QShowEvent* event);
 
+    AnalyzerTask* createAnalyzerTask();
+    void analyzerTaskFinished(AnalyzerTask* task);
+
 private:
 
     enum {
         SignalIdMarginRight = 10
     };
 
-    enum UartState {
-        STATE_START,
-        STATE_DATA,
-        STATE_PARITY,
-        STATE_STOP
-    };
-
     static int uartAnalyzerCounter;
     int mSignalId;
     int mBaudRate;
@@ -134,7 +86,8 @@ private:
 
     QLabel* mSignalLbl;
 
-    QVector<UartItem> mUartItems;
+    DecodedFrameStore mFrames;
+    AnalyzerLabelCache mLabels;
 
     void infoWidthChanged();
     void doLayout();
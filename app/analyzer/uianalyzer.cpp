@@ -15,12 +15,20 @@
  */
 #include "uianalyzer.h"
 
+#include <QThreadPool>
+
+#include <limits.h>
+
 /*!
     \class UiAnalyzer
     \brief This is a base class for all analyzers.
 
     \ingroup Analyzer
 
+    The decoding of the signal data is done by an AnalyzerTask in a
+    background thread so the GUI isn't blocked while analyzing large
+    captures. The previous result is painted until a new result is
+    available.
 */
 
 
@@ -30,14 +38,60 @@
 UiAnalyzer::UiAnalyzer(QWidget *parent) :
     UiSimpleAbstractSignal(parent)
 {
+    mTask = NULL;
     setConfigurable();
 }
 
+/*!
+    Cancels any ongoing analysis.
+*/
+UiAnalyzer::~UiAnalyzer()
+{
+    // the task deletes itself when it has finished
+    if (mTask != NULL) {
+        mTask->cancel();
+        mTask = NULL;
+    }
+}
+
+/*!
+    Call to start to analyze the signal(s).
+
+    A snapshot of the signal data and settings is taken by
+    createAnalyzerTask() and the decoding is started in the global thread
+    pool. An ongoing analysis is cancelled since its result would be
+    outdated. analyzerTaskFinished() is called on the GUI thread when the
+    result is available.
+*/
+void UiAnalyzer::analyze()
+{
+    if (mTask != NULL) {
+        mTask->cancel();
+        mTask = NULL;
+    }
+
+    AnalyzerTask* task = createAnalyzerTask();
+
+    // nothing to analyze
+    if (task == NULL) {
+        analyzerTaskFinished(NULL);
+        update();
+        return;
+    }
+
+    // the connections are queued since the signal is emitted from the
+    // thread pool
+    connect(task, SIGNAL(finished()), this, SLOT(handleTaskFinished()));
+    connect(task, SIGNAL(finished()), task, SLOT(deleteLater()));
+
+    mTask = task;
+    QThreadPool::globalInstance()->start(task);
+}
 
 /*!
-    \fn virtual void UiAnalyzer::analyze() = 0
+    \fn bool UiAnalyzer::isAnalyzing() const
 
-    Call to start to analyze the signal(s)
+    Returns true if an analysis is ongoing.
 */
 
 /*!
@@ -56,6 +110,40 @@ void UiAnalyzer::handleSignalDataChanged()
 }
 
 
+/*!
+    \fn virtual AnalyzerTask* UiAnalyzer::createAnalyzerTask() = 0
+
+    Creates a task that will analyze the current signal data. Everything the
+    task needs must be copied into it since it runs in another thread.
+    NULL is returned if there isn't anything to analyze.
+*/
+
+/*!
+    \fn virtual void UiAnalyzer::analyzerTaskFinished(AnalyzerTask* task) = 0
+
+    Called on the GUI thread when \a task has finished. The subclass takes
+    the decoded items from the task. \a task is NULL if there wasn't
+    anything to analyze in which case the items should be cleared.
+*/
+
+/*!
+    Called when an analyzer task has finished.
+*/
+void UiAnalyzer::handleTaskFinished()
+{
+    AnalyzerTask* task = qobject_cast<AnalyzerTask*>(sender());
+
+    // the result from a replaced task is outdated
+    if (task == NULL || task != mTask) return;
+
+    mTask = NULL;
+
+    if (!task->isCancelled()) {
+        analyzerTaskFinished(task);
+        update();
+    }
+}
+
 /*!
     \fn virtual void UiAnalyzer::configure(QWidget* parent) = 0
 
@@ -89,3 +177,17 @@ QString UiAnalyzer::formatValue(Types::DataFormat format, int value)
 
     return s;
 }
+
+/*!
+    Returns the index of the sample at the left edge of the plot area given
+    the \a sampleRate. The index is limited to the range of an int.
+*/
+int UiAnalyzer::firstVisibleSample(int sampleRate)
+{
+    double idx = mTimeAxis->pixelToTimeRelativeRef(plotX())*sampleRate;
+
+    if (idx <= 0) return 0;
+    if (idx >= INT_MAX) return INT_MAX;
+
+    return (int)idx;
+}
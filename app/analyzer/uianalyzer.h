@@ -21,6 +21,7 @@
 
 #include "common/types.h"
 #include "capture/uisimpleabstractsignal.h"
+#include "analyzertask.h"
 
 
 class UiAnalyzer : public UiSimpleAbstractSignal
@@ -30,8 +31,10 @@ public:
 
 
     explicit UiAnalyzer(QWidget *parent = 0);
+    ~UiAnalyzer();
 
-    virtual void analyze() = 0;
+    void analyze();
+    bool isAnalyzing() const {return mTask != NULL;}
     virtual QString toSettingsString() const = 0;
     void handleSignalDataChanged();
 
@@ -44,8 +47,16 @@ public slots:
 
 protected:
     QString formatValue(Types::DataFormat format, int value);
+    int firstVisibleSample(int sampleRate);
 
+    virtual AnalyzerTask* createAnalyzerTask() = 0;
+    virtual void analyzerTaskFinished(AnalyzerTask* task) = 0;
 
+private slots:
+    void handleTaskFinished();
+
+private:
+    AnalyzerTask* mTask;
     
 };
 
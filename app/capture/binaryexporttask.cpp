@@ -0,0 +1,319 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "binaryexporttask.h"
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QVector>
+
+#include <string.h>
+
+/*!
+    \class BinaryExportTask
+    \brief Exports raw signal data to a binary file, described by a JSON
+        file, in the thread pool.
+
+    \ingroup Capture
+
+    The binary file contains one block per signal, without any headers or
+    padding, so that it can be read directly by scripts. The layout is
+    described by a JSON file with the same base name as the binary file.
+    The description has the sample rate, the number of samples and the
+    offset, size and encoding of each block:
+
+    \list
+      \li \c bits - digital signal with one bit per sample. The first
+          sample is the least significant bit of the first byte. The
+          block is generated from the transition list by filling whole
+          bytes for each run of samples with the same level.
+      \li \c packed12 - analog signal as 12-bit codes with two codes in
+          three bytes. The first code is in the lower 12 bits of the
+          little endian 24-bit value. The value in volts is
+          \c valueOffset + \c valueScale * code.
+      \li \c float64 - analog signal as doubles in volts in the byte order
+          given by \c byteOrder.
+    \endlist
+*/
+
+/*!
+    \enum BinaryExportTask::Constants
+
+    This enum describes integer constants used by the task.
+
+    \var BinaryExportTask::Constants BinaryExportTask::FormatVersion
+    Version of the JSON description
+
+    \var BinaryExportTask::Constants BinaryExportTask::FillChunkSize
+    The maximum number of bytes written with each call to reserve()
+*/
+
+/*!
+    Constructs a task that exports to \a fileName with the given \a parent.
+*/
+BinaryExportTask::BinaryExportTask(const QString &fileName, QObject *parent) :
+    ExportTask(fileName, false, parent)
+{
+    mPartialByte = 0;
+    mPartialBits = 0;
+}
+
+/*!
+    Returns the name of the JSON file describing the exported file.
+*/
+QString BinaryExportTask::descriptionFileName() const
+{
+    return descriptionFileName(fileName());
+}
+
+/*!
+    Returns the name of the JSON file describing \a dataFileName.
+*/
+QString BinaryExportTask::descriptionFileName(const QString &dataFileName)
+{
+    QFileInfo info(dataFileName);
+
+    // never overwrite the data file
+    if (info.suffix().compare("json", Qt::CaseInsensitive) == 0) {
+        return dataFileName + ".json";
+    }
+
+    return info.path() + "/" + info.completeBaseName() + ".json";
+}
+
+/*!
+    Writes the signal blocks and the JSON description. Returns false if the
+    export was cancelled or failed.
+*/
+bool BinaryExportTask::exportData()
+{
+    const int n = numSamples();
+
+    qint64 total = 0;
+    for (int i = 0; i < mDigitalInputs.size(); i++) {
+        total += digitalSize(n);
+    }
+    for (int i = 0; i < mAnalogInputs.size(); i++) {
+        total += analogSize(mAnalogInputs.at(i).data, n);
+    }
+
+    QJsonArray signalList;
+    qint64 offset = 0;
+
+    for (int i = 0; i < mDigitalInputs.size(); i++) {
+        const DigitalInput &in = mDigitalInputs.at(i);
+        qint64 size = digitalSize(n);
+
+        writeDigital(in.transitions, n);
+
+        QJsonObject s;
+        s.insert("name", QString("D%1").arg(in.id));
+        s.insert("type", QString("digital"));
+        s.insert("id", in.id);
+        s.insert("offset", (double)offset);
+        s.insert("size", (double)size);
+        s.insert("encoding", QString("bits"));
+        signalList.append(s);
+
+        offset += size;
+        if (!updateProgress(offset, total)) return false;
+    }
+
+    for (int i = 0; i < mAnalogInputs.size(); i++) {
+        const AnalogInput &in = mAnalogInputs.at(i);
+        qint64 size = analogSize(in.data, n);
+
+        writeAnalog(in.data, n);
+
+        QJsonObject s;
+        s.insert("name", QString("A%1").arg(in.id));
+        s.insert("type", QString("analog"));
+        s.insert("id", in.id);
+        s.insert("offset", (double)offset);
+        s.insert("size", (double)size);
+        s.insert("unit", QString("V"));
+        if (in.data.hasCodes()) {
+            s.insert("encoding", QString("packed12"));
+            s.insert("valueOffset", in.data.factorA());
+            s.insert("valueScale", in.data.factorB());
+        }
+        else {
+            s.insert("encoding", QString("float64"));
+        }
+        signalList.append(s);
+
+        offset += size;
+        if (!updateProgress(offset, total)) return false;
+    }
+
+    QJsonObject description;
+    description.insert("format", QString("LabTool raw samples"));
+    description.insert("version", (int)FormatVersion);
+    description.insert("dataFile", QFileInfo(fileName()).fileName());
+    description.insert("sampleRate", mSampleRate);
+    description.insert("numSamples", n);
+    description.insert("byteOrder", QString(Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+                                            ? "little" : "big"));
+    description.insert("signals", signalList);
+
+    return writeDescription(description);
+}
+
+/*!
+    Returns the size in bytes of a digital block with \a numSamples samples.
+*/
+qint64 BinaryExportTask::digitalSize(int numSamples) const
+{
+    return ((qint64)numSamples + 7) / 8;
+}
+
+/*!
+    Returns the size in bytes of the block for the first \a numSamples
+    analog samples in \a s.
+*/
+qint64 BinaryExportTask::analogSize(const AnalogSampleStore &s,
+                                    int numSamples) const
+{
+    if (s.hasCodes()) {
+        return AnalogSampleStore::packedSize(numSamples);
+    }
+
+    return (qint64)numSamples * sizeof(double);
+}
+
+/*!
+    Writes the first \a numSamples samples of the digital signal described
+    by the transition list \a t as one bit per sample.
+*/
+void BinaryExportTask::writeDigital(const DigitalTransitions &t, int numSamples)
+{
+    mPartialByte = 0;
+    mPartialBits = 0;
+
+    int level = t.initialLevel();
+    qint64 from = 0;
+
+    for (int i = 0; i < t.size() && t.at(i) < numSamples; i++) {
+        writeBits(level, t.at(i) - from);
+        from = t.at(i);
+        level ^= 1;
+    }
+    writeBits(level, numSamples - from);
+
+    if (mPartialBits > 0) {
+        write((const char*)&mPartialByte, 1);
+    }
+}
+
+/*!
+    Writes \a count bits with the value \a level. Bits that don't fill a
+    whole byte are kept until the next call.
+*/
+void BinaryExportTask::writeBits(int level, qint64 count)
+{
+    // complete the partial byte
+    while (count > 0 && mPartialBits > 0) {
+        if (level) {
+            mPartialByte |= (quint8)(1 << mPartialBits);
+        }
+        mPartialBits++;
+        count--;
+
+        if (mPartialBits == 8) {
+            write((const char*)&mPartialByte, 1);
+            mPartialByte = 0;
+            mPartialBits = 0;
+        }
+    }
+
+    qint64 bytes = count / 8;
+    while (bytes > 0) {
+        int chunk = (int)qMin(bytes, (qint64)FillChunkSize);
+        char* p = reserve(chunk);
+        memset(p, (level ? 0xff : 0), chunk);
+        commit(p + chunk);
+        bytes -= chunk;
+    }
+
+    // start a new partial byte with the remaining bits
+    int rest = (int)(count % 8);
+    if (rest > 0) {
+        mPartialByte = (quint8)(level ? (1 << rest) - 1 : 0);
+        mPartialBits = rest;
+    }
+}
+
+/*!
+    Writes the first \a numSamples samples in \a s as packed 12-bit codes if
+    available or as doubles otherwise.
+*/
+void BinaryExportTask::writeAnalog(const AnalogSampleStore &s, int numSamples)
+{
+    if (numSamples <= 0) return;
+
+    if (s.hasCodes()) {
+        const char* packed = (const char*)s.constPackedCodes();
+        int size = AnalogSampleStore::packedSize(numSamples);
+
+        if ((numSamples % 2) == 0) {
+            write(packed, size);
+            return;
+        }
+
+        // the last code is alone in its byte triplet and the stored
+        // triplet may also contain the code of the next sample
+        write(packed, size - 3);
+
+        int code = s.codeAt(numSamples - 1);
+        char last[3];
+        last[0] = (char)(code & 0xff);
+        last[1] = (char)(code >> 8);
+        last[2] = 0;
+        write(last, 3);
+        return;
+    }
+
+    const int chunkSamples = FillChunkSize / sizeof(double);
+    QVector<double> values(chunkSamples);
+
+    for (int from = 0; from < numSamples; from += chunkSamples) {
+        int count = qMin(chunkSamples, numSamples - from);
+        s.values(from, count, values.data());
+        write((const char*)values.constData(), (qint64)count*sizeof(double));
+    }
+}
+
+/*!
+    Writes the JSON \a description to the description file. Returns false
+    if the file couldn't be written.
+*/
+bool BinaryExportTask::writeDescription(const QJsonObject &description)
+{
+    QFile file(descriptionFileName());
+    if (!file.open(QIODevice::Truncate | QIODevice::WriteOnly
+                   | QIODevice::Text)) {
+        setErrorString(file.errorString());
+        return false;
+    }
+
+    QByteArray json = QJsonDocument(description).toJson();
+    if (file.write(json) != json.size()) {
+        setErrorString(file.errorString());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,56 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef BINARYEXPORTTASK_H
+#define BINARYEXPORTTASK_H
+
+#include <QJsonObject>
+
+#include "exporttask.h"
+
+class BinaryExportTask : public ExportTask
+{
+    Q_OBJECT
+public:
+
+    enum Constants {
+        FormatVersion = 1,
+        FillChunkSize = 64*1024
+    };
+
+    explicit BinaryExportTask(const QString &fileName, QObject *parent = 0);
+
+    QString descriptionFileName() const;
+    static QString descriptionFileName(const QString &dataFileName);
+
+protected:
+    bool exportData();
+
+private:
+
+    quint8 mPartialByte;
+    int mPartialBits;
+
+    qint64 digitalSize(int numSamples) const;
+    qint64 analogSize(const AnalogSampleStore &s, int numSamples) const;
+
+    void writeDigital(const DigitalTransitions &t, int numSamples);
+    void writeBits(int level, qint64 count);
+    void writeAnalog(const AnalogSampleStore &s, int numSamples);
+    bool writeDescription(const QJsonObject &description);
+
+};
+
+#endif // BINARYEXPORTTASK_H
@@ -18,12 +18,18 @@
 #include <QComboBox>
 #include <QFile>
 #include <QDataStream>
+#include <QDir>
+#include <QFileDialog>
+#include <QInputDialog>
 
 #include "uiselectsignaldialog.h"
+#include "uisearchdialog.h"
+#include "uistopconditiondialog.h"
 #include "cursormanager.h"
 #include "uicaptureexporter.h"
 
 #include "device/devicemanager.h"
+#include "device/capturefile.h"
 #include "analyzer/analyzermanager.h"
 #include "common/configuration.h"
 #include "common/stringutil.h"
@@ -61,6 +67,10 @@ CaptureApp::CaptureApp(QWidget* uiContext, QObject *parent) :
 
     mMenu = NULL;
 
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mRecorder = new CaptureFileWriter(this);
+    mRecordingDevice = NULL;
+
     createToolBar();
     createMenu();
 
@@ -72,6 +82,9 @@ CaptureApp::CaptureApp(QWidget* uiContext, QObject *parent) :
             connect(device->captureDevice(),
                     SIGNAL(captureFinished(bool,QString)),
                     this, SLOT(handleCaptureFinished(bool,QString)));
+            connect(&device->captureDevice()->triggerEngine(),
+                    SIGNAL(segmentSkipped(int)),
+                    this, SLOT(handleSegmentSkipped(int)));
         }
     }
 
@@ -82,6 +95,8 @@ CaptureApp::CaptureApp(QWidget* uiContext, QObject *parent) :
 */
 CaptureApp::~CaptureApp()
 {
+    stopRecording();
+
     if (mMenu != NULL) {
         delete mMenu;
     }
@@ -121,6 +136,7 @@ void CaptureApp::resetProject()
 
     Device* device = DeviceManager::instance().activeDevice();
     CaptureDevice* captureDevice = device->captureDevice();
+    clearSearchIndex();
     if (captureDevice != NULL) {
         captureDevice->clearSignalData();
     }
@@ -214,6 +230,7 @@ void CaptureApp::openProject(QSettings &project)
 
     }
 
+    clearSearchIndex();
     mArea->handleSignalDataChanged();
 }
 
@@ -275,7 +292,16 @@ void CaptureApp::saveProject(QSettings &project)
 */
 void CaptureApp::handleDeviceChanged(Device* activeDevice)
 {
-    setupRates(activeDevice->captureDevice());
+    // the recording belongs to the previous device
+    stopRecording();
+    clearSearchIndex();
+
+    CaptureDevice* device = activeDevice->captureDevice();
+    if (device != NULL) {
+        mMenuHistoryAction->setChecked(device->captureHistory().isEnabled());
+    }
+
+    setupRates(device);
     mSignalManager->reloadSignalsFromDevice();
     mArea->updateAnalogGroup();
 }
@@ -350,6 +376,12 @@ void CaptureApp::createToolBar()
                                         "Stop");
     mTbStopAction->setEnabled(false);
     connect(mTbStopAction, SIGNAL(triggered()), this, SLOT(stop()));
+
+    // Deallocation: mToolBar takes ownership when calling addWidget
+    mCaptureRateLabel = new QLabel();
+    mCaptureRateLabel->setToolTip(tr("Continuous capture rate and number of "
+                                     "captures dropped while busy"));
+    mToolBar->addWidget(mCaptureRateLabel);
     mToolBar->addSeparator();
 
     QAction* action = mToolBar->addAction(QIcon(":/resources/16_zoom_in.png"),
@@ -370,6 +402,12 @@ void CaptureApp::createToolBar()
 
     action = mToolBar->addAction("Add Signal");
     connect(action, SIGNAL(triggered()), this, SLOT(selectSignalsToAdd()));
+    mToolBar->addSeparator();
+
+    // Deallocation: mToolBar takes ownership when calling addWidget
+    mSearchLabel = new QLabel();
+    mSearchLabel->setToolTip(tr("Current search match"));
+    mToolBar->addWidget(mSearchLabel);
 }
 
 /*!
@@ -428,6 +466,15 @@ void CaptureApp::createMenu()
     connect(action, SIGNAL(triggered()), this, SLOT(triggerSettings()));
     mMenu->addAction(action);
 
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mMenuStopConditionAction = new QAction(tr("Stop Condition"), this);
+    mMenuStopConditionAction->setData("Stop Condition");
+    mMenuStopConditionAction->setToolTip(
+                "Stop a continuous capture at a protocol event");
+    connect(mMenuStopConditionAction, SIGNAL(triggered()),
+            this, SLOT(stopConditionSettings()));
+    mMenu->addAction(mMenuStopConditionAction);
+
     mMenu->addSeparator();
 
     //
@@ -454,6 +501,83 @@ void CaptureApp::createMenu()
     connect(action, SIGNAL(triggered()), this, SLOT(exportData()));
     mMenu->addAction(action);
 
+    //
+    //    Search
+    //
+
+    mMenu->addSeparator();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    action = new QAction(tr("Search"), this);
+    action->setData("Search");
+    action->setToolTip("Search for a pattern or pulse width in the digital signals");
+    action->setShortcut(QKeySequence::Find);
+    connect(action, SIGNAL(triggered()), this, SLOT(search()));
+    mMenu->addAction(action);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    action = new QAction(tr("Find Next"), this);
+    action->setData("Find Next");
+    action->setToolTip("Move the cursors to the next match");
+    action->setShortcut(QKeySequence::FindNext);
+    connect(action, SIGNAL(triggered()), this, SLOT(findNext()));
+    mMenu->addAction(action);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    action = new QAction(tr("Find Previous"), this);
+    action->setData("Find Previous");
+    action->setToolTip("Move the cursors to the previous match");
+    action->setShortcut(QKeySequence::FindPrevious);
+    connect(action, SIGNAL(triggered()), this, SLOT(findPrevious()));
+    mMenu->addAction(action);
+
+    //
+    //    Recording
+    //
+
+    mMenu->addSeparator();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mMenuRecordAction = new QAction(tr("Record to File"), this);
+    mMenuRecordAction->setData("Record to File");
+    mMenuRecordAction->setToolTip("Record continuous captures to file");
+    mMenuRecordAction->setCheckable(true);
+    connect(mMenuRecordAction, SIGNAL(toggled(bool)),
+            this, SLOT(recordToFile(bool)));
+    mMenu->addAction(mMenuRecordAction);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    action = new QAction(tr("Open Recording"), this);
+    action->setData("Open Recording");
+    action->setToolTip("Show a capture from a recording");
+    connect(action, SIGNAL(triggered()), this, SLOT(openRecording()));
+    mMenu->addAction(action);
+
+    //
+    //    Capture history
+    //
+
+    mMenu->addSeparator();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mMenuHistoryAction = new QAction(tr("Keep Capture History"), this);
+    mMenuHistoryAction->setData("Keep Capture History");
+    mMenuHistoryAction->setToolTip(
+                QString("Keep the latest continuous captures in memory "
+                        "(at most %1 MB)")
+                .arg(CaptureHistory::DefaultMemoryBudgetMB));
+    mMenuHistoryAction->setCheckable(true);
+    connect(mMenuHistoryAction, SIGNAL(toggled(bool)),
+            this, SLOT(keepCaptureHistory(bool)));
+    mMenu->addAction(mMenuHistoryAction);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    action = new QAction(tr("Show Capture from History"), this);
+    action->setData("Show Capture from History");
+    action->setToolTip("Show one of the captures kept in the history");
+    connect(action, SIGNAL(triggered()), this, SLOT(showCaptureFromHistory()));
+    mMenu->addAction(action);
+
 }
 
 /*!
@@ -472,6 +596,8 @@ void CaptureApp::changeCaptureActions(bool captureActive) {
 
         mMenuStopAction->setEnabled(true);
         mTbStopAction->setEnabled(true);
+
+        mMenuStopConditionAction->setEnabled(false);
     } else {
         mMenuStartAction->setEnabled(true);
         mTbStartAction->setEnabled(true);
@@ -480,6 +606,8 @@ void CaptureApp::changeCaptureActions(bool captureActive) {
 
         mMenuStopAction->setEnabled(false);
         mTbStopAction->setEnabled(false);
+
+        mMenuStopConditionAction->setEnabled(true);
     }
 
 }
@@ -573,6 +701,12 @@ void CaptureApp::startContinuous()
         mContinuous = true;
         changeCaptureActions(true);
 
+        if (device->captureDevice() != NULL) {
+            device->captureDevice()->setContinuousCapture(true);
+        }
+        mCaptureRateLabel->clear();
+        mCaptureRateLabel->setStyleSheet("");
+
         doStart();
     }
     else {
@@ -592,11 +726,17 @@ void CaptureApp::startContinuous()
 */
 void CaptureApp::stop()
 {
+    bool continuous = mContinuous;
     mContinuous = false;
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
     if (device != NULL) {
+        device->setContinuousCapture(false);
         device->stop();
+
+        if (continuous) {
+            warnAboutSkippedSegments(device);
+        }
     }
 }
 
@@ -617,10 +757,41 @@ void CaptureApp::handleCaptureFinished(bool successful, QString  msg)
     if (device != NULL) {
 
         if (successful) {
+            clearSearchIndex();
             mArea->handleSignalDataChanged();
 
-            if (mContinuous && device->supportsContinuousCapture()) {
-                doStart();
+            if (mContinuous
+                    && device->triggerEngine().isStopConditionMatched()) {
+                // the device has already stopped, keep the matching capture
+                mContinuous = false;
+                device->setContinuousCapture(false);
+                changeCaptureActions(false);
+
+                QMessageBox::information(mUiContext,
+                                         tr("Capture Stopped"),
+                                         tr("Capture %1 matched the stop condition")
+                                         .arg(device->triggerEngine()
+                                              .matchedSequenceNumber()));
+                warnAboutSkippedSegments(device);
+            }
+            else if (mContinuous && device->supportsContinuousCapture()) {
+                QString rate = tr(" %1 captures/s, %2 dropped ")
+                        .arg(device->capturesPerSecond(), 0, 'f', 1)
+                        .arg(device->droppedFrames());
+
+                CaptureTriggerEngine &engine = device->triggerEngine();
+                if (engine.hasStopCondition()) {
+                    rate += tr("| %1 evaluated/s, %2 skipped ")
+                            .arg(engine.evaluationsPerSecond(), 0, 'f', 1)
+                            .arg(engine.numSkipped());
+                }
+
+                mCaptureRateLabel->setText(rate);
+
+                // a device which restarts by itself is already capturing
+                if (!device->restartsContinuousCapture()) {
+                    doStart();
+                }
             }
         }
         else {
@@ -650,6 +821,57 @@ void CaptureApp::triggerSettings()
     }
 }
 
+/*!
+    Called when the user selects to change the stop condition of
+    continuous captures.
+*/
+void CaptureApp::stopConditionSettings()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (device == NULL) return;
+
+    CaptureTriggerEngine &engine = device->triggerEngine();
+
+    UiStopConditionDialog dialog(engine.stopCondition(), mUiContext);
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    // Deallocation: the engine takes ownership of the condition
+    engine.setStopCondition(dialog.condition());
+}
+
+/*!
+    Called when the trigger engine had to skip the capture with
+    \a sequenceNumber. The rate label is highlighted for the rest of the
+    continuous capture since the capture that should have stopped it may
+    have been missed.
+*/
+void CaptureApp::handleSegmentSkipped(int sequenceNumber)
+{
+    (void)sequenceNumber;
+
+    if (!mContinuous) return;
+
+    mCaptureRateLabel->setStyleSheet("QLabel { color : red; }");
+}
+
+/*!
+    Shows a warning if the trigger engine of \a device had to skip any
+    captures during the continuous capture that just ended.
+*/
+void CaptureApp::warnAboutSkippedSegments(CaptureDevice *device)
+{
+    CaptureTriggerEngine &engine = device->triggerEngine();
+    if (!engine.hasStopCondition() || engine.numSkipped() == 0) return;
+
+    QMessageBox::warning(mUiContext,
+                         tr("Captures Not Evaluated"),
+                         tr("%1 captures were not evaluated against the stop "
+                            "condition since the evaluation could not keep "
+                            "up. The stop condition may have been missed.")
+                         .arg(engine.numSkipped()));
+}
+
 /*!
     Called when the user selects to calibrate the hardware.
 */
@@ -714,8 +936,8 @@ void CaptureApp::exportData()
         bool dataToExport = false;
 
         foreach(DigitalSignal* s, digitalSignals) {
-            QVector<int>* d = device->digitalData(s->id());
-            if (d != NULL && d->size() > 0) {
+            DigitalTransitions* d = device->digitalTransitions(s->id());
+            if (d != NULL && d->numSamples() > 0) {
                 dataToExport = true;
                 break;
             }
@@ -724,7 +946,7 @@ void CaptureApp::exportData()
         if (dataToExport) break;
 
         foreach(AnalogSignal* s, analogSignals) {
-            QVector<double>* d = device->analogData(s->id());
+            AnalogSampleStore* d = device->analogData(s->id());
             if (d != NULL && d->size() > 0) {
                 dataToExport = true;
                 break;
@@ -759,3 +981,375 @@ void CaptureApp::sampleRateChanged(int rateIndex)
         device->reconfigure(rate);
     }
 }
+
+/*!
+    Called when the user toggles recording to file. When \a enable is true
+    the user selects a file and all following captures in continuous mode
+    are written to it, otherwise the recording is closed.
+*/
+void CaptureApp::recordToFile(bool enable)
+{
+    if (!enable) {
+        bool wasRecording = mRecorder->isOpen();
+        stopRecording();
+
+        // failures have already been reported by stopRecording
+        if (wasRecording && mRecorder->errorString().isEmpty()) {
+            QMessageBox::information(mUiContext,
+                                     tr("Record to File"),
+                                     tr("Recorded %1 captures (%2 bytes) "
+                                        "to %3. %4 captures were dropped.")
+                                     .arg(mRecorder->numWritten())
+                                     .arg(mRecorder->bytesWritten())
+                                     .arg(mRecorder->fileName())
+                                     .arg(mRecorder->numDropped()));
+        }
+        return;
+    }
+
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+
+    do {
+        if (device == NULL) break;
+
+        QString name = QFileDialog::getSaveFileName(
+                    mUiContext,
+                    tr("Record to File"),
+                    QDir::currentPath()+"/recording"
+                        +Configuration::RecordingFileExt,
+                    "Recordings (*"+Configuration::RecordingFileExt+")");
+        if (name.isNull() || name.isEmpty()) break;
+
+        if (!mRecorder->open(name)) {
+            QMessageBox::warning(mUiContext,
+                                 tr("Record to File"),
+                                 tr("Failed to create %1: %2")
+                                 .arg(name)
+                                 .arg(mRecorder->errorString()));
+            break;
+        }
+
+        mRecordingDevice = device;
+        mRecordingDevice->setCaptureFileWriter(mRecorder);
+
+        return;
+
+    } while (false);
+
+    // not recording -> uncheck without calling this slot again
+    mMenuRecordAction->blockSignals(true);
+    mMenuRecordAction->setChecked(false);
+    mMenuRecordAction->blockSignals(false);
+}
+
+/*!
+    Closes the recording, if any, and reports if any captures couldn't
+    be written. The number of captures written is kept by the recorder
+    until the next recording is started.
+*/
+void CaptureApp::stopRecording()
+{
+    if (mRecordingDevice != NULL) {
+        mRecordingDevice->setCaptureFileWriter(NULL);
+        mRecordingDevice = NULL;
+    }
+
+    if (!mRecorder->isOpen()) return;
+
+    mRecorder->close();
+
+    mMenuRecordAction->blockSignals(true);
+    mMenuRecordAction->setChecked(false);
+    mMenuRecordAction->blockSignals(false);
+
+    if (!mRecorder->errorString().isEmpty()) {
+        QMessageBox::warning(mUiContext,
+                             tr("Record to File"),
+                             tr("The recording is incomplete: %1")
+                             .arg(mRecorder->errorString()));
+    }
+}
+
+/*!
+    Called when the user selects to open a recording. The user selects the
+    capture to show which then replaces the current signal data.
+*/
+void CaptureApp::openRecording()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (device == NULL) return;
+
+    QString name = QFileDialog::getOpenFileName(
+                mUiContext,
+                tr("Open Recording"),
+                QDir::currentPath(),
+                "Recordings (*"+Configuration::RecordingFileExt+")");
+    if (name.isNull() || name.isEmpty()) return;
+
+    CaptureFile file;
+    if (!file.open(name)) {
+        QMessageBox::warning(mUiContext,
+                             tr("Open Recording"),
+                             tr("Failed to open %1: %2")
+                             .arg(name).arg(file.errorString()));
+        return;
+    }
+
+    if (file.numChunks() == 0) {
+        QMessageBox::warning(mUiContext,
+                             tr("Open Recording"),
+                             tr("The recording doesn't contain any captures"));
+        return;
+    }
+
+    int chunk = 0;
+    if (file.numChunks() > 1) {
+        bool ok = false;
+        chunk = QInputDialog::getInt(mUiContext,
+                                     tr("Open Recording"),
+                                     tr("Capture (1 - %1):")
+                                     .arg(file.numChunks()),
+                                     file.numChunks(), 1, file.numChunks(),
+                                     1, &ok) - 1;
+        if (!ok) return;
+    }
+
+    CaptureSegment segment;
+    if (!file.readSegment(chunk, segment)) {
+        QMessageBox::warning(mUiContext,
+                             tr("Open Recording"),
+                             tr("Failed to read capture %1").arg(chunk+1));
+        return;
+    }
+
+    addSignalsForSegment(device, segment);
+    device->showCaptureSegment(segment);
+    handleSegmentShown(segment);
+}
+
+/*!
+    Called when the user selects to keep, \a enable is true, or discard the
+    captures in the capture history of the active device.
+*/
+void CaptureApp::keepCaptureHistory(bool enable)
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (device == NULL) return;
+
+    device->captureHistory().setEnabled(enable);
+}
+
+/*!
+    Called when the user selects to show a capture from the capture
+    history. The user selects the capture which then replaces the current
+    signal data.
+*/
+void CaptureApp::showCaptureFromHistory()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (device == NULL) return;
+
+    CaptureHistory &history = device->captureHistory();
+    if (history.isEmpty()) {
+        QMessageBox::information(mUiContext,
+                                 tr("Capture History"),
+                                 tr("The history doesn't contain any captures. "
+                                    "Select Keep Capture History before "
+                                    "starting a continuous capture."));
+        return;
+    }
+
+    bool ok = false;
+    int index = QInputDialog::getInt(mUiContext,
+                                     tr("Capture History"),
+                                     tr("Capture (1 - %1, %1 is the latest):")
+                                     .arg(history.size()),
+                                     history.size(), 1, history.size(),
+                                     1, &ok) - 1;
+    if (!ok) return;
+
+    const CaptureSegment &segment = history.at(index);
+
+    addSignalsForSegment(device, segment);
+    device->showCaptureSegment(index);
+    handleSegmentShown(segment);
+}
+
+/*!
+    Adds signals to \a device for the signal data in \a segment that isn't
+    shown yet.
+*/
+void CaptureApp::addSignalsForSegment(CaptureDevice *device,
+                                      const CaptureSegment &segment)
+{
+    QList<int> digitalIds;
+    foreach(DigitalSignal* s, device->digitalSignals()) {
+        digitalIds.append(s->id());
+    }
+    foreach(int id, segment.digitalIds()) {
+        if (!digitalIds.contains(id)) {
+            mSignalManager->addDigitalSignal(id);
+        }
+    }
+
+    QList<int> analogIds;
+    foreach(AnalogSignal* s, device->analogSignals()) {
+        analogIds.append(s->id());
+    }
+    foreach(int id, segment.analogIds()) {
+        if (!analogIds.contains(id)) {
+            mSignalManager->addAnalogSignal(id);
+        }
+    }
+}
+
+/*!
+    Updates the user interface after the signal data of \a segment has
+    replaced the current signal data.
+*/
+void CaptureApp::handleSegmentShown(const CaptureSegment &segment)
+{
+    setSampleRate(segment.sampleRate());
+    clearSearchIndex();
+
+    // see openProject() for why the trigger cursor must be set
+    if (segment.sampleRate() > 0) {
+        CursorManager::instance().setCursorPosition(
+                    UiCursor::Trigger,
+                    (double)segment.triggerIndex()/segment.sampleRate());
+    }
+
+    mArea->handleSignalDataChanged();
+}
+
+/*!
+    Called when the user selects to search the digital signals. The search
+    is defined in a UiSearchDialog and the cursors are then moved to the
+    first match after the current position.
+*/
+void CaptureApp::search()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (device == NULL) return;
+
+    UiSearchDialog dialog(mSearch, device->usedSampleRate(), mUiContext);
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    mSearch = dialog.search();
+    mSearchLabel->clear();
+    findMatch(true);
+}
+
+/*!
+    Called when the user selects to move to the next match.
+*/
+void CaptureApp::findNext()
+{
+    findMatch(true);
+}
+
+/*!
+    Called when the user selects to move to the previous match.
+*/
+void CaptureApp::findPrevious()
+{
+    findMatch(false);
+}
+
+/*!
+    Clears the search index, and the match shown in the toolbar, since
+    the signal data has changed.
+*/
+void CaptureApp::clearSearchIndex()
+{
+    mSearch.clearIndex();
+    mSearchLabel->clear();
+}
+
+/*!
+    Searches the signal data of \a device and stores all matches in the
+    search index. Navigating between the matches is then a lookup in the
+    index until the signal data changes.
+*/
+void CaptureApp::buildSearchIndex(CaptureDevice *device)
+{
+    if (mSearch.type() == DigitalSearch::PatternSearch) {
+        QMap<int, DigitalSampleStore> samples;
+        foreach(int id, mSearch.signalIds()) {
+            DigitalSampleStore* s = device->digitalData(id);
+            if (s != NULL) {
+                samples.insert(id, *s);
+            }
+        }
+
+        mSearch.buildPatternIndex(samples);
+    }
+    else {
+        DigitalTransitions* t = device->digitalTransitions(
+                    mSearch.pulseSignalId());
+        if (t != NULL) {
+            mSearch.buildPulseIndex(*t);
+        }
+        else {
+            mSearch.buildPulseIndex(DigitalTransitions());
+        }
+    }
+}
+
+/*!
+    Moves cursor 1 to the start and cursor 2 to the end of the next
+    (\a forward is true) or previous match. The search starts at cursor 1,
+    or at the start or end of the capture if cursor 1 is disabled.
+*/
+void CaptureApp::findMatch(bool forward)
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (device == NULL) return;
+
+    if (mSearch.isEmpty()) {
+        search();
+        return;
+    }
+
+    int rate = device->usedSampleRate();
+    if (rate <= 0) return;
+
+    if (!mSearch.isIndexed()) {
+        buildSearchIndex(device);
+    }
+
+    CursorManager &cursors = CursorManager::instance();
+
+    qint64 pos = (forward ? -1 : (qint64)device->lastSampleIndex()+1);
+    if (cursors.isCursorOn(UiCursor::Cursor1)) {
+        pos = qRound64(cursors.cursorPosition(UiCursor::Cursor1)*rate);
+    }
+
+    int i = (forward ? mSearch.next(pos) : mSearch.previous(pos));
+    if (i == -1) {
+        QMessageBox::information(mUiContext,
+                                 tr("Search"),
+                                 tr("No more matches (%1 in total)")
+                                 .arg(mSearch.numMatches()));
+        return;
+    }
+
+    double start = (double)mSearch.matchStart(i)/rate;
+    double end = (double)(mSearch.matchEnd(i)+1)/rate;
+
+    cursors.enableCursor(UiCursor::Cursor1, true);
+    cursors.setCursorPosition(UiCursor::Cursor1, start);
+    cursors.enableCursor(UiCursor::Cursor2, true);
+    cursors.setCursorPosition(UiCursor::Cursor2, end);
+
+    mSearchLabel->setText(tr(" Match %1 of %2 ")
+                          .arg(i+1).arg(mSearch.numMatches()));
+
+    mArea->showTime(start);
+}
@@ -21,10 +21,13 @@
 #include <QMenu>
 #include <QAction>
 #include <QComboBox>
+#include <QLabel>
 #include <QSettings>
 
 #include "uicapturearea.h"
 #include "device/device.h"
+#include "device/capturefilewriter.h"
+#include "device/digitalsearch.h"
 
 class CaptureApp : public QObject
 {
@@ -62,20 +65,38 @@ private:
     QAction* mMenuStartAction;
     QAction* mMenuContinuousAction;
     QAction* mMenuStopAction;
+    QAction* mMenuStopConditionAction;
     QAction* mTbStartAction;
     QAction* mTbContinuousAction;
     QAction* mTbStopAction;
 
     QComboBox* mRateBox;
+    QLabel* mCaptureRateLabel;
+    QLabel* mSearchLabel;
+
+    QAction* mMenuRecordAction;
+    QAction* mMenuHistoryAction;
+    CaptureFileWriter* mRecorder;
+    CaptureDevice* mRecordingDevice;
 
     bool mCaptureActive;
 
+    DigitalSearch mSearch;
+
     void createToolBar();
     void createMenu();
     void changeCaptureActions(bool captureActive);
     void doStart();
     void setupRates(CaptureDevice* device);
     void setSampleRate(int rate);
+    void stopRecording();
+    void addSignalsForSegment(CaptureDevice* device,
+                              const CaptureSegment &segment);
+    void handleSegmentShown(const CaptureSegment &segment);
+    void clearSearchIndex();
+    void buildSearchIndex(CaptureDevice* device);
+    void findMatch(bool forward);
+    void warnAboutSkippedSegments(CaptureDevice* device);
 
 
 private slots:
@@ -84,9 +105,18 @@ private slots:
     void stop();
     void handleCaptureFinished(bool successful, QString msg);
     void triggerSettings();
+    void stopConditionSettings();
+    void handleSegmentSkipped(int sequenceNumber);
     void calibrationSettings();
     void selectSignalsToAdd();
     void exportData();
+    void recordToFile(bool enable);
+    void openRecording();
+    void keepCaptureHistory(bool enable);
+    void showCaptureFromHistory();
+    void search();
+    void findNext();
+    void findPrevious();
     void sampleRateChanged(int rateIndex);
 
     
@@ -0,0 +1,318 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "csvexporttask.h"
+
+#include <string.h>
+
+/*!
+    \class CsvExportTask
+    \brief Exports signal data to a CSV file in the thread pool.
+
+    \ingroup Capture
+
+    The file has a header row followed by one row per sample, or one row
+    per change, with the sample number or time in the first column.
+
+    \list
+      \li The levels of the digital signals are tracked by walking the
+          transition lists of all signals in parallel. A level is never
+          looked up per sample.
+      \li The value of each 12-bit analog code is formatted once, before
+          the export starts, and then copied into every row with that code.
+      \li The sample time is formatted with integer arithmetic. For all
+          sample rates that divide a power of ten the time is exact.
+    \endlist
+
+    When only changes are exported the next row is found by merging the
+    transition lists with the positions where the analog codes change,
+    which means that the rows without changes are never formatted.
+*/
+
+/*!
+    \enum CsvExportTask::Constants
+
+    This enum describes integer constants used by the task.
+
+    \var CsvExportTask::Constants CsvExportTask::AnalogDecimals
+    The maximum number of decimals of an analog value
+
+    \var CsvExportTask::Constants CsvExportTask::MaxFormattedLength
+    The maximum length of a formatted value
+*/
+
+/*!
+    Constructs a task that exports to \a fileName with the given \a parent.
+*/
+CsvExportTask::CsvExportTask(const QString &fileName, QObject *parent) :
+    ExportTask(fileName, true, parent)
+{
+    mDelim = ',';
+    mSampleAsTime = false;
+    mOnlyChanges = false;
+    mNumRows = 0;
+    mTimeDecimals = -1;
+    mTimeScale = 1;
+}
+
+/*!
+    \fn void CsvExportTask::setDelimiter(char delim)
+
+    Sets the character separating the columns to \a delim.
+*/
+
+/*!
+    \fn void CsvExportTask::setSampleAsTime(bool asTime)
+
+    Exports the sample column as time in seconds if \a asTime is true or
+    as sample number otherwise. The time is calculated using the
+    sample rate.
+*/
+
+/*!
+    \fn void CsvExportTask::setOnlyChanges(bool onlyChanges)
+
+    Exports only the rows where at least one signal has changed if
+    \a onlyChanges is true. The first row is always exported.
+*/
+
+/*!
+    \fn qint64 CsvExportTask::numRows() const
+
+    Returns the number of exported rows, not counting the header.
+*/
+
+/*!
+    Writes the header and all rows. Returns false if the export was
+    cancelled or failed.
+*/
+bool CsvExportTask::exportData()
+{
+    const int n = numSamples();
+    const int maxRowLength = MaxFormattedLength
+            + mDigitalInputs.size()*2
+            + mAnalogInputs.size()*(MaxFormattedLength+1) + 2;
+
+    //  >>> Header >>>>>>>>>>>>>>>>>>>>>>>>>>
+
+    char* p = reserve(maxRowLength);
+    memcpy(p, "sample", 6);
+    p += 6;
+
+    for (int c = 0; c < mDigitalInputs.size(); c++) {
+        *p++ = mDelim;
+        *p++ = 'D';
+        p = formatInt(p, mDigitalInputs.at(c).id);
+    }
+    for (int c = 0; c < mAnalogInputs.size(); c++) {
+        *p++ = mDelim;
+        *p++ = 'A';
+        p = formatInt(p, mAnalogInputs.at(c).id);
+    }
+    *p++ = '\n';
+    commit(p);
+
+    //  <<< Header <<<<<<<<<<<<<<<<<<<<<<<<<<
+
+    prepareTime();
+
+    mDigital.clear();
+    for (int c = 0; c < mDigitalInputs.size(); c++) {
+        DigitalColumn d;
+        d.transitions = mDigitalInputs.at(c).transitions;
+        d.level = d.transitions.initialLevel();
+        d.next = 0;
+        mDigital.append(d);
+    }
+
+    mAnalog.clear();
+    for (int c = 0; c < mAnalogInputs.size(); c++) {
+        AnalogColumn a;
+        a.data = mAnalogInputs.at(c).data;
+        prepareCodeTable(a);
+        mAnalog.append(a);
+    }
+
+    const int progressStep = qMax(n / 100, 1);
+    int nextProgress = progressStep;
+
+    // sample index of the next digital transition
+    int nextDigital = 0;
+
+    int i = 0;
+    while (i < n) {
+
+        if (i >= nextDigital) {
+            nextDigital = n;
+
+            for (int c = 0; c < mDigital.size(); c++) {
+                DigitalColumn &d = mDigital[c];
+                const DigitalTransitions &t = d.transitions;
+
+                while (d.next < t.size() && t.at(d.next) <= i) {
+                    d.level ^= 1;
+                    d.next++;
+                }
+                if (d.next < t.size() && t.at(d.next) < nextDigital) {
+                    nextDigital = (int)t.at(d.next);
+                }
+            }
+        }
+
+        p = reserve(maxRowLength);
+        p = writeSample(p, i);
+        p = writeDigitalLevels(p);
+        p = writeAnalogValues(p, i);
+        *p++ = '\n';
+        commit(p);
+        mNumRows++;
+
+        if (mOnlyChanges) {
+            int next = nextDigital;
+            for (int c = 0; c < mAnalog.size(); c++) {
+                next = nextAnalogChange(mAnalog.at(c).data, i, next);
+            }
+            i = next;
+        }
+        else {
+            i++;
+        }
+
+        if (i >= nextProgress) {
+            if (!updateProgress(i, n)) return false;
+            nextProgress = i + progressStep;
+        }
+    }
+
+    return true;
+}
+
+/*!
+    Finds the number of decimals needed to format the sample time exactly.
+    This is possible if the sample rate divides a power of ten, which is
+    true for all supported sample rates.
+*/
+void CsvExportTask::prepareTime()
+{
+    mTimeDecimals = -1;
+
+    for (int d = 0; d <= MaxDecimals; d++) {
+        if (powerOfTen(d) % mSampleRate == 0) {
+            mTimeDecimals = d;
+            mTimeScale = powerOfTen(d) / mSampleRate;
+            break;
+        }
+    }
+}
+
+/*!
+    Formats the value of each 12-bit code of the analog signal in
+    \a column. The table isn't used for signals without codes.
+*/
+void CsvExportTask::prepareCodeTable(AnalogColumn &column)
+{
+    column.codeText.clear();
+    column.codeLength.clear();
+
+    if (!column.data.hasCodes()) return;
+
+    const int numCodes = AnalogSampleStore::CodeMask + 1;
+    column.codeText.resize(numCodes*MaxFormattedLength);
+    column.codeLength.resize(numCodes);
+
+    const double a = column.data.factorA();
+    const double b = column.data.factorB();
+
+    for (int code = 0; code < numCodes; code++) {
+        char tmp[64];
+        char* end = formatFixed(tmp, a + b*code, AnalogDecimals);
+        int length = end - tmp;
+
+        if (length > MaxFormattedLength) {
+            // unusual calibration, format each value instead
+            column.codeText.clear();
+            column.codeLength.clear();
+            return;
+        }
+
+        memcpy(&column.codeText[code*MaxFormattedLength], tmp, length);
+        column.codeLength[code] = (quint8)length;
+    }
+}
+
+/*!
+    Writes the sample column of row \a i to \a p.
+*/
+char* CsvExportTask::writeSample(char *p, int i)
+{
+    if (!mSampleAsTime) {
+        return formatInt(p, i);
+    }
+
+    p = formatInt(p, i / mSampleRate);
+
+    const int remainder = i % mSampleRate;
+    if (mTimeDecimals >= 0) {
+        return formatFraction(p, remainder*mTimeScale, mTimeDecimals);
+    }
+
+    // only the fraction is calculated with floating point so that the
+    // rounding error doesn't grow with the sample index
+    const qint64 one = powerOfTen(MaxDecimals);
+    qint64 fraction = (qint64)((double)remainder*one/mSampleRate + 0.5);
+    if (fraction >= one) {
+        // can't round up to a whole second as the rate is below 10^12
+        fraction = one - 1;
+    }
+
+    return formatFraction(p, fraction, MaxDecimals);
+}
+
+/*!
+    Writes the current level of each digital signal to \a p.
+*/
+char* CsvExportTask::writeDigitalLevels(char *p)
+{
+    for (int c = 0; c < mDigital.size(); c++) {
+        *p++ = mDelim;
+        *p++ = (char)('0' + mDigital.at(c).level);
+    }
+
+    return p;
+}
+
+/*!
+    Writes the value of each analog signal at sample \a i to \a p.
+*/
+char* CsvExportTask::writeAnalogValues(char *p, int i)
+{
+    for (int c = 0; c < mAnalog.size(); c++) {
+        const AnalogColumn &a = mAnalog.at(c);
+        *p++ = mDelim;
+
+        if (!a.codeLength.isEmpty()) {
+            int code = a.data.codeAt(i);
+            int length = a.codeLength.at(code);
+            memcpy(p, &a.codeText.constData()[code*MaxFormattedLength],
+                   length);
+            p += length;
+        }
+        else {
+            p = formatFixed(p, a.data.at(i), AnalogDecimals);
+        }
+    }
+
+    return p;
+}
@@ -0,0 +1,80 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef CSVEXPORTTASK_H
+#define CSVEXPORTTASK_H
+
+#include <QList>
+#include <QVector>
+
+#include "exporttask.h"
+
+class CsvExportTask : public ExportTask
+{
+    Q_OBJECT
+public:
+
+    enum Constants {
+        AnalogDecimals = 6,
+        MaxFormattedLength = 32
+    };
+
+    explicit CsvExportTask(const QString &fileName, QObject *parent = 0);
+
+    void setDelimiter(char delim) {mDelim = delim;}
+    void setSampleAsTime(bool asTime) {mSampleAsTime = asTime;}
+    void setOnlyChanges(bool onlyChanges) {mOnlyChanges = onlyChanges;}
+
+    qint64 numRows() const {return mNumRows;}
+
+protected:
+    bool exportData();
+
+private:
+
+    struct DigitalColumn {
+        DigitalTransitions transitions;
+        int next;
+        int level;
+    };
+
+    struct AnalogColumn {
+        AnalogSampleStore data;
+        // preformatted value for each 12-bit code, empty if not used
+        QVector<char> codeText;
+        QVector<quint8> codeLength;
+    };
+
+    char mDelim;
+    bool mSampleAsTime;
+    bool mOnlyChanges;
+
+    QList<DigitalColumn> mDigital;
+    QList<AnalogColumn> mAnalog;
+    qint64 mNumRows;
+
+    int mTimeDecimals;
+    qint64 mTimeScale;
+
+    void prepareTime();
+    void prepareCodeTable(AnalogColumn &column);
+
+    char* writeSample(char* p, int i);
+    char* writeDigitalLevels(char* p);
+    char* writeAnalogValues(char* p, int i);
+
+};
+
+#endif // CSVEXPORTTASK_H
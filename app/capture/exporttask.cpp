@@ -0,0 +1,416 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "exporttask.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/*!
+    \class ExportTask
+    \brief Base class for tasks exporting signal data to a file in the
+        thread pool.
+
+    \ingroup Capture
+
+    The task is created by UiCaptureExporter on the GUI thread with copies
+    of the signal data. The copies are implicitly shared so they are cheap
+    to make and the export isn't affected by new captures.
+
+    A subclass implements \ref exportData() and writes the file content
+    with \ref reserve() and \ref commit(), or \ref write(), which collect
+    the data in a large buffer that is written to the file when it is full.
+    Formatting numbers directly into the buffer with \ref formatInt() and
+    \ref formatFixed() avoids creating a string for each value.
+*/
+
+/*!
+    \enum ExportTask::Constants
+
+    This enum describes integer constants used by the task.
+
+    \var ExportTask::Constants ExportTask::BufferSize
+    The number of bytes buffered before writing to the file
+
+    \var ExportTask::Constants ExportTask::MaxDecimals
+    The maximum number of decimals supported by \ref formatFixed()
+*/
+
+static const qint64 powersOfTen[] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+    100000000LL, 1000000000LL, 10000000000LL, 100000000000LL,
+    1000000000000LL, 10000000000000LL, 100000000000000LL,
+    1000000000000000LL
+};
+
+/*!
+    Constructs a task that exports to \a fileName with the given \a parent.
+    The file is opened in text mode if \a textMode is true, i.e., line
+    endings are converted on platforms where needed.
+*/
+ExportTask::ExportTask(const QString &fileName, bool textMode,
+                       QObject *parent) :
+    QObject(parent)
+{
+    // Deallocation: the task is deleted with deleteLater() once
+    // finished() has been delivered, see UiCaptureExporter::startExport()
+    setAutoDelete(false);
+
+    mFile.setFileName(fileName);
+    mTextMode = textMode;
+    mSampleRate = 1;
+    mBufferUsed = 0;
+    mWriteFailed = false;
+    mLastProgress = -1;
+}
+
+/*!
+    Sets the sample rate of the signal data to \a sampleRate.
+*/
+void ExportTask::setSampleRate(int sampleRate)
+{
+    mSampleRate = (sampleRate > 0 ? sampleRate : 1);
+}
+
+/*!
+    \fn int ExportTask::sampleRate() const
+
+    Returns the sample rate of the signal data.
+*/
+
+/*!
+    Adds the digital signal with \a id described by \a transitions.
+    Signals are exported in the order they are added with all digital
+    signals before the analog signals.
+*/
+void ExportTask::addDigitalSignal(int id, const DigitalTransitions &transitions)
+{
+    DigitalInput in;
+    in.id = id;
+    in.transitions = transitions;
+    mDigitalInputs.append(in);
+}
+
+/*!
+    Adds the analog signal with \a id and the samples \a data.
+*/
+void ExportTask::addAnalogSignal(int id, const AnalogSampleStore &data)
+{
+    AnalogInput in;
+    in.id = id;
+    in.data = data;
+    mAnalogInputs.append(in);
+}
+
+/*!
+    Runs the export. Called by the thread pool.
+*/
+void ExportTask::run()
+{
+    do {
+        if (isCancelled()) break;
+
+        QIODevice::OpenMode mode = QIODevice::Truncate | QIODevice::WriteOnly;
+        if (mTextMode) {
+            mode |= QIODevice::Text;
+        }
+
+        if (!mFile.open(mode)) {
+            mErrorString = mFile.errorString();
+            break;
+        }
+
+        mBuffer.resize(BufferSize);
+        mBufferUsed = 0;
+
+        exportData();
+        flush();
+
+        mBuffer.clear();
+        mFile.close();
+
+        if (mWriteFailed) {
+            mErrorString = mFile.errorString();
+        }
+
+    } while (false);
+
+    emit finished();
+}
+
+/*!
+    Request the task to stop. The file will only contain the data exported
+    so far. Can be called from any thread.
+*/
+void ExportTask::cancel()
+{
+    mCancelled.storeRelease(1);
+}
+
+/*!
+    Returns true if the task has been cancelled.
+*/
+bool ExportTask::isCancelled() const
+{
+    return mCancelled.loadAcquire() != 0;
+}
+
+/*!
+    \fn QString ExportTask::fileName() const
+
+    Returns the name of the exported file.
+*/
+
+/*!
+    \fn QString ExportTask::errorString() const
+
+    Returns a description of the error if the export failed or an empty
+    string if it succeeded.
+*/
+
+/*!
+    Writes the decimal representation of \a v to \a p and returns a pointer
+    to the character after the last digit.
+*/
+char* ExportTask::formatInt(char *p, qint64 v)
+{
+    quint64 u = (quint64)v;
+    if (v < 0) {
+        *p++ = '-';
+        u = 0 - u;
+    }
+
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+
+    return p;
+}
+
+/*!
+    Writes the decimal point followed by \a fraction / 10^\a decimals
+    without trailing zeros to \a p. Nothing is written if \a fraction is 0.
+    Returns a pointer to the character after the last written character.
+*/
+char* ExportTask::formatFraction(char *p, qint64 fraction, int decimals)
+{
+    if (fraction == 0) return p;
+
+    // remove trailing zeros
+    while (fraction % 10 == 0) {
+        fraction /= 10;
+        decimals--;
+    }
+
+    *p++ = '.';
+    for (int i = decimals-1; i >= 0; i--) {
+        p[i] = (char)('0' + fraction % 10);
+        fraction /= 10;
+    }
+
+    return p + decimals;
+}
+
+/*!
+    Writes \a v rounded to \a decimals decimals, without trailing zeros, to
+    \a p and returns a pointer to the character after the last written
+    character. Values too large for fixed point are written in
+    exponent form.
+*/
+char* ExportTask::formatFixed(char *p, double v, int decimals)
+{
+    if (decimals < 0) decimals = 0;
+    if (decimals > MaxDecimals) decimals = MaxDecimals;
+
+    double scaled = fabs(v) * powersOfTen[decimals];
+    if (!(scaled < 9.0e18)) {
+        // also handles NaN
+        return p + sprintf(p, "%g", v);
+    }
+
+    qint64 rounded = (qint64)(scaled + 0.5);
+    if (v < 0 && rounded != 0) {
+        *p++ = '-';
+    }
+
+    p = formatInt(p, rounded / powersOfTen[decimals]);
+    return formatFraction(p, rounded % powersOfTen[decimals], decimals);
+}
+
+/*!
+    Returns 10 raised to \a exponent which must be in the range 0 to 15.
+*/
+qint64 ExportTask::powerOfTen(int exponent)
+{
+    return powersOfTen[qBound(0, exponent, 15)];
+}
+
+/*!
+    \fn void ExportTask::progress(int percent)
+
+    This signal is emitted from the thread pool when another \a percent
+    of the data has been exported.
+*/
+
+/*!
+    \fn void ExportTask::finished()
+
+    This signal is emitted from the thread pool when the task has finished,
+    also if it failed or was cancelled.
+*/
+
+/*!
+    \fn bool ExportTask::exportData()
+
+    Writes the content of the file. Implemented by the subclass. Returns
+    false if the export failed or was cancelled.
+*/
+
+/*!
+    Returns the number of samples to export, i.e., the number of samples
+    in the shortest signal.
+*/
+int ExportTask::numSamples() const
+{
+    int n = -1;
+
+    for (int i = 0; i < mDigitalInputs.size(); i++) {
+        int size = (int)mDigitalInputs.at(i).transitions.numSamples();
+        if (n == -1 || size < n) n = size;
+    }
+    for (int i = 0; i < mAnalogInputs.size(); i++) {
+        int size = mAnalogInputs.at(i).data.size();
+        if (n == -1 || size < n) n = size;
+    }
+
+    return qMax(n, 0);
+}
+
+/*!
+    Returns a pointer to at least \a size free bytes at the end of the
+    buffer. The buffer is written to the file first if needed. \a size must
+    not be larger than BufferSize. The bytes are added to the file with
+    \ref commit().
+*/
+char* ExportTask::reserve(int size)
+{
+    if (mBufferUsed + size > mBuffer.size()) {
+        flush();
+    }
+
+    return mBuffer.data() + mBufferUsed;
+}
+
+/*!
+    Adds the bytes written to the buffer up to, but not including, \a end
+    to the file. \a end must be within the space returned by the last call
+    to \ref reserve().
+*/
+void ExportTask::commit(const char *end)
+{
+    mBufferUsed = end - mBuffer.constData();
+}
+
+/*!
+    Adds \a size bytes from \a data to the file.
+*/
+void ExportTask::write(const char *data, qint64 size)
+{
+    while (size > 0) {
+        int chunk = (int)qMin(size, (qint64)BufferSize);
+        char* p = reserve(chunk);
+        memcpy(p, data, chunk);
+        commit(p + chunk);
+
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+/*!
+    Adds the null terminated \a text, without the terminating null
+    character, to the file.
+*/
+void ExportTask::write(const char *text)
+{
+    write(text, qstrlen(text));
+}
+
+/*!
+    Writes the buffered data to the file.
+*/
+void ExportTask::flush()
+{
+    if (mBufferUsed > 0 && !mWriteFailed) {
+        if (mFile.write(mBuffer.constData(), mBufferUsed) != mBufferUsed) {
+            mWriteFailed = true;
+        }
+    }
+    mBufferUsed = 0;
+}
+
+/*!
+    Emits progress() if the percentage given by \a done out of \a total has
+    changed since the last call. Returns false if the export should stop,
+    i.e., if the task has been cancelled or writing to the file has failed.
+*/
+bool ExportTask::updateProgress(qint64 done, qint64 total)
+{
+    int percent = (total > 0 ? (int)(done*100/total) : 100);
+    if (percent != mLastProgress) {
+        mLastProgress = percent;
+        emit progress(percent);
+    }
+
+    return !isCancelled() && !mWriteFailed;
+}
+
+/*!
+    \fn void ExportTask::setErrorString(const QString &error)
+
+    Sets the description of why the export failed to \a error.
+*/
+
+/*!
+    Returns the first sample after \a from where the analog samples \a s
+    have a different value than at \a from. \a end is returned if the value
+    doesn't change before \a end.
+*/
+int ExportTask::nextAnalogChange(const AnalogSampleStore &s, int from,
+                                 int end)
+{
+    if (s.hasCodes()) {
+        int code = s.codeAt(from);
+        for (int j = from+1; j < end; j++) {
+            if (s.codeAt(j) != code) return j;
+        }
+        return end;
+    }
+
+    double value = s.at(from);
+    for (int j = from+1; j < end; j++) {
+        if (s.at(j) != value) return j;
+    }
+
+    return end;
+}
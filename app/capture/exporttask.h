@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef EXPORTTASK_H
+#define EXPORTTASK_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#include "device/digitaltransitions.h"
+#include "device/analogsamplestore.h"
+
+class ExportTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+
+    enum Constants {
+        BufferSize = 1024*1024,
+        MaxDecimals = 12
+    };
+
+    ExportTask(const QString &fileName, bool textMode, QObject *parent = 0);
+
+    void setSampleRate(int sampleRate);
+    int sampleRate() const {return mSampleRate;}
+
+    void addDigitalSignal(int id, const DigitalTransitions &transitions);
+    void addAnalogSignal(int id, const AnalogSampleStore &data);
+
+    void run();
+    bool isCancelled() const;
+
+    QString fileName() const {return mFile.fileName();}
+    QString errorString() const {return mErrorString;}
+
+    static char* formatInt(char* p, qint64 v);
+    static char* formatFraction(char* p, qint64 fraction, int decimals);
+    static char* formatFixed(char* p, double v, int decimals);
+    static qint64 powerOfTen(int exponent);
+
+public slots:
+    void cancel();
+
+signals:
+    void progress(int percent);
+    void finished();
+
+protected:
+
+    struct DigitalInput {
+        int id;
+        DigitalTransitions transitions;
+    };
+
+    struct AnalogInput {
+        int id;
+        AnalogSampleStore data;
+    };
+
+    QList<DigitalInput> mDigitalInputs;
+    QList<AnalogInput> mAnalogInputs;
+    int mSampleRate;
+
+    virtual bool exportData() = 0;
+
+    int numSamples() const;
+
+    char* reserve(int size);
+    void commit(const char* end);
+    void write(const char* data, qint64 size);
+    void write(const char* text);
+    void flush();
+
+    bool updateProgress(qint64 done, qint64 total);
+    void setErrorString(const QString &error) {mErrorString = error;}
+
+    static int nextAnalogChange(const AnalogSampleStore &s, int from, int end);
+
+private:
+
+    QFile mFile;
+    bool mTextMode;
+    QAtomicInt mCancelled;
+
+    QByteArray mBuffer;
+    int mBufferUsed;
+    bool mWriteFailed;
+    QString mErrorString;
+    int mLastProgress;
+
+};
+
+#endif // EXPORTTASK_H
@@ -0,0 +1,442 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "signaldatafile.h"
+
+#include "device/digitaltransitions.h"
+
+#include <QIODevice>
+#include <QtEndian>
+#include <string.h>
+
+/*!
+    \class SignalDataFile
+    \brief SignalDataFile reads and writes the signal data of a project.
+
+    \ingroup Capture
+
+    The signal data is stored in a binary file next to the project file.
+    The file starts with SignalDataMagic followed by a record for each
+    signal.
+
+    Version 1 files store digital signals as a QBitArray and analog
+    signals as a QVector<double>, both serialized by QDataStream. They are
+    still read, but without the per-element conversions: the bit array is
+    copied into the sample words and the doubles are byte swapped in place.
+
+    Version 2 files have SignalVersionMagic and the version number after
+    SignalDataMagic. Each record has a header with the signal type, id,
+    number of samples, encoding and size in bytes. The data follows as one
+    block that is written and read with a single call:
+
+    \list
+      \li Digital signals are stored as the packed sample words
+          (EncodingRaw) or, if it is smaller, as run lengths
+          (EncodingRunLength).
+      \li Analog signals with 12-bit codes are stored as the packed codes
+          and the two calibration factors (EncodingPacked12). Other analog
+          signals are stored as doubles (EncodingRaw).
+    \endlist
+
+    All block data is in little endian byte order. An older application
+    opening a version 2 file doesn't find a record after SignalDataMagic
+    and loads the project without signal data.
+*/
+
+/*!
+    \enum SignalDataFile::Constants
+
+    This enum describes the magic numbers, signal types and versions of the
+    file format.
+*/
+
+/*!
+    \enum SignalDataFile::Encoding
+
+    This enum describes how the data of a version 2 record is encoded.
+
+    \var SignalDataFile::Encoding SignalDataFile::EncodingRaw
+    Digital: sample words. Analog: doubles
+
+    \var SignalDataFile::Encoding SignalDataFile::EncodingRunLength
+    Digital: the initial level followed by the length of each run except
+    the last as variable length integers
+
+    \var SignalDataFile::Encoding SignalDataFile::EncodingPacked12
+    Analog: two 12-bit codes packed in three bytes
+*/
+
+/*!
+    Writes the file magic and the version to \a out.
+*/
+void SignalDataFile::writeHeader(QDataStream &out)
+{
+    out << (quint32)SignalDataMagic;
+    out << (qint32)SignalVersionMagic;
+    out << (qint32)Version;
+}
+
+/*!
+    Writes the digital signal \a data with \a id to \a out. If \a compress
+    is true the samples are run length encoded when that is smaller than
+    the packed samples.
+*/
+void SignalDataFile::writeDigital(QDataStream &out, int id,
+                                  const DigitalSampleStore &data,
+                                  bool compress)
+{
+    QByteArray encoded;
+    if (compress) {
+        encoded = runLengthEncode(data);
+    }
+
+    int rawSize = data.numWords()*4;
+    bool useRunLength = (compress && encoded.size() < rawSize);
+
+    out << (qint32)SignalStartMagic;
+    out << (qint32)SignalDigital;
+    out << (qint32)id;
+    out << (qint32)data.size();
+    out << (qint32)(useRunLength ? EncodingRunLength : EncodingRaw);
+    out << (qint32)(useRunLength ? encoded.size() : rawSize);
+
+    if (useRunLength) {
+        out.writeRawData(encoded.constData(), encoded.size());
+        return;
+    }
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    out.writeRawData((const char*)data.constWords(), rawSize);
+#else
+    QByteArray words(rawSize, 0);
+    for (int w = 0; w < data.numWords(); w++) {
+        qToLittleEndian<quint32>(data.word(w), (uchar*)words.data() + w*4);
+    }
+    out.writeRawData(words.constData(), rawSize);
+#endif
+}
+
+/*!
+    Writes the analog signal \a data with \a id to \a out.
+*/
+void SignalDataFile::writeAnalog(QDataStream &out, int id,
+                                 const AnalogSampleStore &data)
+{
+    out << (qint32)SignalStartMagic;
+    out << (qint32)SignalAnalog;
+    out << (qint32)id;
+    out << (qint32)data.size();
+
+    if (data.hasCodes()) {
+        int size = AnalogSampleStore::packedSize(data.size());
+        out << (qint32)EncodingPacked12;
+        out << (qint32)size;
+        out << data.factorA();
+        out << data.factorB();
+        out.writeRawData((const char*)data.constPackedCodes(), size);
+        return;
+    }
+
+    QVector<double> values = data.toVector();
+    int size = values.size()*8;
+    out << (qint32)EncodingRaw;
+    out << (qint32)size;
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    out.writeRawData((const char*)values.constData(), size);
+#else
+    QByteArray bytes(size, 0);
+    for (int i = 0; i < values.size(); i++) {
+        quint64 bits;
+        memcpy(&bits, &values.constData()[i], 8);
+        qToLittleEndian<quint64>(bits, (uchar*)bytes.data() + i*8);
+    }
+    out.writeRawData(bytes.constData(), size);
+#endif
+}
+
+/*!
+    Reads the file magic and version from \a in. The version is stored in
+    \a version. Returns false if \a in doesn't contain signal data.
+*/
+bool SignalDataFile::readHeader(QDataStream &in, int &version)
+{
+    quint32 fileMagic = 0;
+    in >> fileMagic;
+    if (fileMagic != SignalDataMagic) return false;
+
+    // version 1 files continue with the start of the first record
+    version = LegacyVersion;
+
+    QByteArray next = in.device()->peek(4);
+    if (next.size() == 4
+            && qFromBigEndian<qint32>((const uchar*)next.constData())
+            == SignalVersionMagic) {
+        qint32 marker;
+        qint32 v;
+        in >> marker;
+        in >> v;
+        version = v;
+    }
+
+    return (in.status() == QDataStream::Ok && version <= Version);
+}
+
+/*!
+    Reads the next signal from \a in which was written with file format
+    \a version. The type of signal is stored in \a type and its id in
+    \a id. The samples are stored in either \a digital or \a analog.
+    Returns false if there aren't any more signals.
+*/
+bool SignalDataFile::readSignal(QDataStream &in, int version, int &type,
+                                int &id, DigitalSampleStore &digital,
+                                AnalogSampleStore &analog)
+{
+    if (in.atEnd()) return false;
+
+    if (version == LegacyVersion) {
+        return readLegacySignal(in, type, id, digital, analog);
+    }
+
+    qint32 startMagic, t, signalId, numSamples, encoding, size;
+    in >> startMagic;
+    if (startMagic != SignalStartMagic) return false;
+
+    in >> t >> signalId >> numSamples >> encoding >> size;
+    if (in.status() != QDataStream::Ok || numSamples < 0 || size < 0) {
+        return false;
+    }
+
+    type = t;
+    id = signalId;
+
+    if (type == SignalDigital) {
+        if (encoding == EncodingRunLength) {
+            QByteArray encoded(size, 0);
+            if (!readRaw(in, encoded.data(), size)) return false;
+
+            return runLengthDecode(encoded, numSamples, digital);
+        }
+
+        int numWords = (numSamples + DigitalSampleStore::BitsPerWord - 1)
+                / DigitalSampleStore::BitsPerWord;
+        if (encoding != EncodingRaw || size != numWords*4) return false;
+
+        digital.resize(numSamples);
+        if (!readRaw(in, (char*)digital.words(), size)) return false;
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+        for (int w = 0; w < numWords; w++) {
+            digital.words()[w] = qFromLittleEndian<quint32>(
+                        (const uchar*)&digital.words()[w]);
+        }
+#endif
+        // clear any bits after the last sample
+        digital.resize(numSamples);
+
+        return true;
+    }
+
+    if (type == SignalAnalog) {
+        if (encoding == EncodingPacked12) {
+            if (size != AnalogSampleStore::packedSize(numSamples)) {
+                return false;
+            }
+
+            double a, b;
+            in >> a >> b;
+
+            QByteArray packed(size, 0);
+            if (!readRaw(in, packed.data(), size)) return false;
+
+            analog = AnalogSampleStore::fromPackedCodes(
+                        (const quint8*)packed.constData(), numSamples, a, b);
+            return true;
+        }
+
+        if (encoding != EncodingRaw || size != numSamples*8) return false;
+
+        QVector<double> values(numSamples);
+        if (!readRaw(in, (char*)values.data(), size)) return false;
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+        for (int i = 0; i < numSamples; i++) {
+            quint64 bits = qFromLittleEndian<quint64>(
+                        (const uchar*)&values.data()[i]);
+            memcpy(&values.data()[i], &bits, 8);
+        }
+#endif
+        analog = AnalogSampleStore(values);
+
+        return true;
+    }
+
+    // unknown signal type, skip the data
+    return (in.skipRawData(size) == size);
+}
+
+/*!
+    Encodes the digital samples in \a data as the level of the first sample
+    followed by the length of each run of equal samples. The last run is
+    given by the number of samples and is left out. The lengths are stored
+    as variable length integers with 7 bits per byte.
+
+    The runs are found with DigitalTransitions which compares a word of
+    samples at a time.
+*/
+QByteArray SignalDataFile::runLengthEncode(const DigitalSampleStore &data)
+{
+    DigitalTransitions t = DigitalTransitions::fromSamples(data);
+
+    // at most five bytes per run
+    QByteArray encoded(1 + t.size()*5, 0);
+    uchar* p = (uchar*)encoded.data();
+
+    *p++ = (uchar)t.initialLevel();
+
+    qint64 prev = 0;
+    const qint64* idx = t.constData();
+    for (int i = 0; i < t.size(); i++) {
+        quint32 run = (quint32)(idx[i] - prev);
+        prev = idx[i];
+
+        while (run >= 0x80) {
+            *p++ = (uchar)(run | 0x80);
+            run >>= 7;
+        }
+        *p++ = (uchar)run;
+    }
+
+    encoded.resize(p - (uchar*)encoded.data());
+
+    return encoded;
+}
+
+/*!
+    Decodes the run lengths in \a encoded to \a numSamples digital samples
+    stored in \a data. Returns false if \a encoded isn't valid.
+*/
+bool SignalDataFile::runLengthDecode(const QByteArray &encoded,
+                                     int numSamples,
+                                     DigitalSampleStore &data)
+{
+    data.clear();
+    if (encoded.isEmpty()) return (numSamples == 0);
+
+    const uchar* p = (const uchar*)encoded.constData();
+    const uchar* end = p + encoded.size();
+
+    int level = (*p++ ? 1 : 0);
+    qint64 pos = 0;
+
+    data.reserve(numSamples);
+
+    while (p < end) {
+        quint32 run = 0;
+        int shift = 0;
+        while (p < end && (*p & 0x80) != 0 && shift < 28) {
+            run |= (quint32)(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        if (p == end) return false;
+        run |= (quint32)(*p++) << shift;
+
+        if (run == 0 || pos + run > numSamples) return false;
+
+        data.append(level, (int)run);
+        pos += run;
+        level ^= 1;
+    }
+
+    data.append(level, (int)(numSamples - pos));
+
+    return true;
+}
+
+/*!
+    Reads a version 1 record, see readSignal().
+*/
+bool SignalDataFile::readLegacySignal(QDataStream &in, int &type, int &id,
+                                      DigitalSampleStore &digital,
+                                      AnalogSampleStore &analog)
+{
+    qint32 startMagic, t, signalId, sz;
+    in >> startMagic;
+    if (startMagic != SignalStartMagic) return false;
+
+    in >> t;
+    if (t != SignalDigital && t != SignalAnalog) return false;
+
+    in >> signalId;
+    in >> sz;
+
+    // both QBitArray and QVector start with the number of elements
+    quint32 count;
+    in >> count;
+    if (in.status() != QDataStream::Ok || (qint32)count != sz || sz < 0) {
+        return false;
+    }
+
+    type = t;
+    id = signalId;
+
+    if (type == SignalDigital) {
+        // the bits of a QBitArray are stored with the first bit in the
+        // least significant bit of the first byte which is the same order
+        // as the sample words on a little endian machine
+        int numBytes = (sz + 7) / 8;
+
+        digital.resize(sz);
+        if (!readRaw(in, (char*)digital.words(), numBytes)) return false;
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+        for (int w = 0; w < digital.numWords(); w++) {
+            digital.words()[w] = qFromLittleEndian<quint32>(
+                        (const uchar*)&digital.words()[w]);
+        }
+#endif
+        // clear any bits after the last sample
+        digital.resize(sz);
+
+        return true;
+    }
+
+    // the doubles are stored in big endian byte order by QDataStream
+    QVector<double> values(sz);
+    if (!readRaw(in, (char*)values.data(), (qint64)sz*8)) return false;
+
+    for (int i = 0; i < sz; i++) {
+        quint64 bits = qFromBigEndian<quint64>((const uchar*)&values.data()[i]);
+        memcpy(&values.data()[i], &bits, 8);
+    }
+    analog = AnalogSampleStore(values);
+
+    return true;
+}
+
+/*!
+    Reads \a size bytes from \a in to \a data. Returns false if there
+    weren't enough bytes.
+*/
+bool SignalDataFile::readRaw(QDataStream &in, char *data, qint64 size)
+{
+    // read in parts since readRawData takes an int
+    while (size > 0) {
+        int part = (int)qMin(size, (qint64)0x40000000);
+        if (in.readRawData(data, part) != part) return false;
+
+        data += part;
+        size -= part;
+    }
+
+    return true;
+}
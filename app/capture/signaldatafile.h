@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SIGNALDATAFILE_H
+#define SIGNALDATAFILE_H
+
+#include <QtGlobal>
+#include <QDataStream>
+#include <QByteArray>
+
+#include "device/digitalsamplestore.h"
+#include "device/analogsamplestore.h"
+
+class SignalDataFile
+{
+public:
+
+    enum Constants {
+        SignalDigital      = 1,
+        SignalAnalog       = 2,
+        SignalDataMagic    = 0xEA0102AE,
+        SignalStartMagic   = 0x000000EB,
+        SignalVersionMagic = 0x000000EC,
+
+        LegacyVersion      = 1,
+        Version            = 2
+    };
+
+    enum Encoding {
+        EncodingRaw       = 0,
+        EncodingRunLength = 1,
+        EncodingPacked12  = 2
+    };
+
+    static void writeHeader(QDataStream &out);
+    static void writeDigital(QDataStream &out, int id,
+                             const DigitalSampleStore &data,
+                             bool compress = true);
+    static void writeAnalog(QDataStream &out, int id,
+                            const AnalogSampleStore &data);
+
+    static bool readHeader(QDataStream &in, int &version);
+    static bool readSignal(QDataStream &in, int version, int &type, int &id,
+                           DigitalSampleStore &digital,
+                           AnalogSampleStore &analog);
+
+    static QByteArray runLengthEncode(const DigitalSampleStore &data);
+    static bool runLengthDecode(const QByteArray &encoded, int numSamples,
+                                DigitalSampleStore &data);
+
+private:
+    SignalDataFile();
+
+    static bool readLegacySignal(QDataStream &in, int &type, int &id,
+                                 DigitalSampleStore &digital,
+                                 AnalogSampleStore &analog);
+    static bool readRaw(QDataStream &in, char* data, qint64 size);
+};
+
+#endif // SIGNALDATAFILE_H
@@ -17,11 +17,11 @@
 
 #include <QDebug>
 
-#include <QBitArray>
 #include <QDataStream>
 #include <QByteArray>
 
 #include "uidigitalsignal.h"
+#include "signaldatafile.h"
 #include "analyzer/analyzermanager.h"
 #include "device/devicemanager.h"
 
@@ -54,6 +54,8 @@ SignalManager::SignalManager(QObject *parent) :
 /*!
     Save signal settings and signal data to persistent storage. The
     settings are stored in \a settings and data are written to \a out.
+
+    The signal data is written with SignalDataFile.
 */
 void SignalManager::saveSignalSettings(QSettings &settings, QDataStream &out)
 {
@@ -66,7 +68,7 @@ void SignalManager::saveSignalSettings(QSettings &settings, QDataStream &out)
 
 
     // the file with signal data must start with a Magic number
-    out << SignalDataMagic;
+    SignalDataFile::writeHeader(out);
 
     foreach(UiAbstractSignal* s, SignalManager::mSignalList) {
 
@@ -77,14 +79,9 @@ void SignalManager::saveSignalSettings(QSettings &settings, QDataStream &out)
             settings.setArrayIndex(idx++);
             settings.setValue("meta", signal->toSettingsString());
 
-            QVector<int>* data = device->digitalData(signal->id());
+            DigitalSampleStore* data = device->digitalData(signal->id());
             if (data != NULL) {
-                QBitArray binData = digitalSignalDataToBitArray(data);
-                out << SignalStartMagic;
-                out << SignalDigital;
-                out << signal->id();
-                out << binData.size();
-                out << binData;
+                SignalDataFile::writeDigital(out, signal->id(), *data);
             }
 
             continue;
@@ -98,13 +95,9 @@ void SignalManager::saveSignalSettings(QSettings &settings, QDataStream &out)
                 settings.setArrayIndex(idx++);
                 settings.setValue("meta", signal->toSettingsString());
 
-                QVector<double>* data = device->analogData(signal->id());
+                AnalogSampleStore* data = device->analogData(signal->id());
                 if (data != NULL) {
-                    out << SignalStartMagic;
-                    out << SignalAnalog;
-                    out << signal->id();
-                    out << data->size();
-                    out << *data;
+                    SignalDataFile::writeAnalog(out, signal->id(), *data);
                 }
             }
 
@@ -120,12 +113,14 @@ void SignalManager::saveSignalSettings(QSettings &settings, QDataStream &out)
 
     }
     settings.endArray();
-
 }
 
 /*!
     Load signal settings and signal data from persistent storage. The
     settings are loaded from \a settings and data are read from \a in.
+
+    Signal data written by SignalDataFile as well as data in the original
+    format can be read.
 */
 void SignalManager::loadSignalsFromSettings(QSettings &settings, QDataStream &in)
 {
@@ -193,46 +188,26 @@ void SignalManager::loadSignalsFromSettings(QSettings &settings, QDataStream &in
     settings.endArray();
 
     // load signal data
-    uint fileMagic;
-    int startMagic;
+    int version = 0;
     int type;
     int id;
-    int sz;
-    QBitArray digitalData;
-    QVector<double> analogData;
-
-    in >> fileMagic;
-    if (fileMagic == SignalDataMagic) {
-        do {
-            in >> startMagic;
-            if (startMagic != SignalStartMagic) break;
-
-            in >> type;
-            if (type != SignalDigital && type != SignalAnalog) break;
-
-            in >> id;
-            in >> sz;
+    DigitalSampleStore digitalData;
+    AnalogSampleStore analogData;
 
-            if (type == SignalDigital) {
-                in >> digitalData;
-                if (sz != digitalData.size()) break;
+    if (SignalDataFile::readHeader(in, version)) {
+        while (SignalDataFile::readSignal(in, version, type, id,
+                                          digitalData, analogData)) {
 
-                device->setDigitalData(id, bitArrayToDigitalSignal(digitalData));
+            if (type == SignalDataFile::SignalDigital) {
+                device->setDigitalData(id, digitalData);
                 digitalData.clear();
             }
-            else {
-                in >> analogData;
-                if (sz != analogData.size()) break;
-
+            else if (type == SignalDataFile::SignalAnalog) {
                 device->setAnalogData(id, analogData);
                 analogData.clear();
             }
-
-
-
-        } while (!in.atEnd());
+        }
     }
-
 }
 
 /*!
@@ -401,34 +376,6 @@ double SignalManager::closestDigitalTransition(double startTime)
 */
 
 
-/*!
-    Converts the digital signal \a data to a bit array
-*/
-QBitArray SignalManager::digitalSignalDataToBitArray(QVector<int>* data)
-{
-    QBitArray a(data->size());
-    for (int i = 0; i < data->size(); i++) {
-        if (data->at(i) == 1) {
-            a.setBit(i, true);
-        }
-    }
-
-    return a;
-}
-
-/*!
-    Converts the bit array \a data to a vector with digital states.
-*/
-QVector<int> SignalManager::bitArrayToDigitalSignal(QBitArray data)
-{
-    QVector<int> v;
-    for (int i = 0; i < data.size(); i++) {
-        v.append( data.at(i) ? 1 :0 );
-    }
-
-    return v;
-}
-
 /*!
     Find the transition closest to time \a t for the signal with given
     \a signalId.
@@ -440,37 +387,9 @@ double SignalManager::getClosestDigitalTransitionForSignal(double t, int signalI
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
 
-    QList<int> data;
-    device->digitalTransitions(signalId, data);
-
-
-    double period = (double)1/device->usedSampleRate();
-
-    if (data.size() > 0) {
-
-        int startIdx = (int)(t/period);
-        int beforeIdx = startIdx;
-        int afterIdx = startIdx;
-
-        for (int i = 1; i < data.size()-1; i++) {
-            if (startIdx > data.at(i)) {
-                beforeIdx = data.at(i);
-            }
-            if (startIdx < data.at(i)) {
-
-                afterIdx = data.at(i);
-
-                break;
-            }
-        }
-
-        if (startIdx - beforeIdx < afterIdx - startIdx) {
-            time = (beforeIdx+1)*period;
-        }
-        else {
-            time = afterIdx*period;
-        }
-
+    qint64 idx = device->nearestDigitalTransition(signalId, t);
+    if (idx != -1) {
+        time = (double)idx/device->usedSampleRate();
     }
 
     return time;
@@ -27,6 +27,7 @@
 #include "uianalogsignal.h"
 
 #include "analyzer/uianalyzer.h"
+#include "device/digitalsamplestore.h"
 
 class SignalManager : public QObject
 {
@@ -61,20 +62,10 @@ public slots:
 
 private:
 
-    enum {
-        SignalDigital    = 1,
-        SignalAnalog     = 2,
-        SignalDataMagic  = 0xEA0102AE,
-        SignalStartMagic = 0x000000EB
-    };
-
     QList<UiAbstractSignal*> mSignalList;
 
     UiAnalogSignal* mAnalogSignalWidget;
 
-    QBitArray digitalSignalDataToBitArray(QVector<int>* data);
-    QVector<int> bitArrayToDigitalSignal(QBitArray data);
-
     double getClosestDigitalTransitionForSignal(double t, int signalId);
     int activeDigitalSignalId();
 
@@ -0,0 +1,351 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <QBitArray>
+#include <QByteArray>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QList>
+#include <QVector>
+
+#include <math.h>
+#include <stdio.h>
+
+#include "capture/signaldatafile.h"
+
+/*
+    Saves and loads the signal data of a capture with all channels enabled
+    and reports the time and file size for:
+
+    - the current format written and read by SignalDataFile
+    - the original format (version 1) written the way the application
+      used to write it and read by the legacy reader in SignalDataFile
+    - the original format read element by element the way the application
+      used to read it
+
+    The loaded signals are compared with the saved ones.
+*/
+
+enum Constants {
+    NumDigital = 11,
+    NumAnalog = 2,
+    NumSamples = 4*1024*1024
+};
+
+static quint32 randomState = 1;
+
+static quint32 nextRandom()
+{
+    // linear congruential generator, the same data on every run
+    randomState = randomState*1103515245 + 12345;
+    return (randomState >> 16);
+}
+
+/*
+    Creates the capture. The first digital channels toggle every few
+    samples (worst case for the run-length encoding), the others have
+    longer and longer runs.
+*/
+static void createCapture(QList<DigitalSampleStore> &digital,
+                          QList<AnalogSampleStore> &analog)
+{
+    for (int c = 0; c < NumDigital; c++) {
+        DigitalSampleStore s;
+        s.reserve(NumSamples);
+
+        int level = 0;
+        while (s.size() < NumSamples) {
+            int run;
+            if (c < 4) {
+                run = 1 + nextRandom()%8;
+            }
+            else {
+                run = 20 + nextRandom()%(c*500);
+            }
+            s.append(level, qMin(run, NumSamples - s.size()));
+            level ^= 1;
+        }
+
+        digital.append(s);
+    }
+
+    for (int c = 0; c < NumAnalog; c++) {
+        QVector<quint16> codes(NumSamples);
+        for (int i = 0; i < NumSamples; i++) {
+            codes[i] = (quint16)(2048 + 2000*sin(i*0.001*(c+1)));
+        }
+
+        analog.append(AnalogSampleStore(codes.constData(), NumSamples,
+                                        -5.0, 0.0025));
+    }
+}
+
+/*
+    Writes the signal data in the current format.
+*/
+static void writeCurrent(QDataStream &out,
+                         const QList<DigitalSampleStore> &digital,
+                         const QList<AnalogSampleStore> &analog)
+{
+    SignalDataFile::writeHeader(out);
+
+    for (int c = 0; c < digital.size(); c++) {
+        SignalDataFile::writeDigital(out, c, digital.at(c));
+    }
+    for (int c = 0; c < analog.size(); c++) {
+        SignalDataFile::writeAnalog(out, c, analog.at(c));
+    }
+}
+
+/*
+    Writes the signal data in the original format: a QBitArray for each
+    digital signal and a QVector<double> for each analog signal.
+*/
+static void writeVersion1(QDataStream &out,
+                          const QList<DigitalSampleStore> &digital,
+                          const QList<AnalogSampleStore> &analog)
+{
+    out << (quint32)SignalDataFile::SignalDataMagic;
+
+    for (int c = 0; c < digital.size(); c++) {
+        const DigitalSampleStore &s = digital.at(c);
+
+        QBitArray bits(s.size());
+        for (int i = 0; i < s.size(); i++) {
+            if (s.at(i) == 1) {
+                bits.setBit(i);
+            }
+        }
+
+        out << (qint32)SignalDataFile::SignalStartMagic;
+        out << (qint32)SignalDataFile::SignalDigital;
+        out << (qint32)c;
+        out << (qint32)bits.size();
+        out << bits;
+    }
+
+    for (int c = 0; c < analog.size(); c++) {
+        QVector<double> values = analog.at(c).toVector();
+
+        out << (qint32)SignalDataFile::SignalStartMagic;
+        out << (qint32)SignalDataFile::SignalAnalog;
+        out << (qint32)c;
+        out << (qint32)values.size();
+        out << values;
+    }
+}
+
+/*
+    Reads the signal data with SignalDataFile, the way SignalManager does.
+    Returns false if the data can't be read.
+*/
+static bool read(QDataStream &in, int &version,
+                 QList<DigitalSampleStore> &digital,
+                 QList<AnalogSampleStore> &analog)
+{
+    if (!SignalDataFile::readHeader(in, version)) return false;
+
+    int type;
+    int id;
+    DigitalSampleStore digitalData;
+    AnalogSampleStore analogData;
+
+    while (SignalDataFile::readSignal(in, version, type, id,
+                                      digitalData, analogData)) {
+
+        if (type == SignalDataFile::SignalDigital) {
+            digital.append(digitalData);
+            digitalData.clear();
+        }
+        else if (type == SignalDataFile::SignalAnalog) {
+            analog.append(analogData);
+            analogData.clear();
+        }
+    }
+
+    return true;
+}
+
+/*
+    Reads the original format element by element the way the application
+    used to read it. Returns the number of signals read.
+*/
+static int readVersion1PerElement(QDataStream &in)
+{
+    quint32 magic;
+    in >> magic;
+    if (magic != (quint32)SignalDataFile::SignalDataMagic) return 0;
+
+    int numSignals = 0;
+    while (!in.atEnd()) {
+        qint32 startMagic, type, id, size;
+        in >> startMagic >> type >> id >> size;
+        if (startMagic != SignalDataFile::SignalStartMagic) break;
+
+        if (type == SignalDataFile::SignalDigital) {
+            QBitArray bits;
+            in >> bits;
+
+            DigitalSampleStore s;
+            s.reserve(bits.size());
+            for (int i = 0; i < bits.size(); i++) {
+                s.append(bits.testBit(i) ? 1 : 0);
+            }
+        }
+        else {
+            QVector<double> values;
+            in >> values;
+
+            AnalogSampleStore s(values);
+        }
+
+        numSignals++;
+    }
+
+    return numSignals;
+}
+
+/*
+    Returns true if the loaded signals are the same as the saved. When
+    \a exactCodes is false the analog signals are compared as values
+    since the original format doesn't store the 12-bit codes.
+*/
+static bool compare(const QList<DigitalSampleStore> &digital,
+                    const QList<AnalogSampleStore> &analog,
+                    const QList<DigitalSampleStore> &loadedDigital,
+                    const QList<AnalogSampleStore> &loadedAnalog,
+                    bool exactCodes)
+{
+    if (loadedDigital.size() != digital.size()
+            || loadedAnalog.size() != analog.size()) {
+        printf("  wrong number of signals: %d digital, %d analog\n",
+               loadedDigital.size(), loadedAnalog.size());
+        return false;
+    }
+
+    for (int c = 0; c < digital.size(); c++) {
+        if (!(loadedDigital.at(c) == digital.at(c))) {
+            printf("  digital signal %d differs\n", c);
+            return false;
+        }
+    }
+
+    for (int c = 0; c < analog.size(); c++) {
+        const AnalogSampleStore &a = analog.at(c);
+        const AnalogSampleStore &b = loadedAnalog.at(c);
+
+        if (a.size() != b.size() || (exactCodes && !b.hasCodes())) {
+            printf("  analog signal %d differs\n", c);
+            return false;
+        }
+
+        for (int i = 0; i < a.size(); i++) {
+            bool same = (exactCodes ? a.codeAt(i) == b.codeAt(i)
+                                    : a.at(i) == b.at(i));
+            if (!same) {
+                printf("  analog signal %d differs at %d\n", c, i);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    QList<DigitalSampleStore> digital;
+    QList<AnalogSampleStore> analog;
+    createCapture(digital, analog);
+
+    printf("%d digital and %d analog signals with %d samples each\n",
+           NumDigital, NumAnalog, NumSamples);
+
+    bool ok = true;
+    QElapsedTimer timer;
+
+    // current format
+    {
+        QByteArray file;
+        QDataStream out(&file, QIODevice::WriteOnly);
+
+        timer.start();
+        writeCurrent(out, digital, analog);
+        qint64 saveMs = timer.elapsed();
+
+        QDataStream in(file);
+        QList<DigitalSampleStore> loadedDigital;
+        QList<AnalogSampleStore> loadedAnalog;
+        int version = 0;
+
+        timer.start();
+        bool loaded = read(in, version, loadedDigital, loadedAnalog);
+        qint64 loadMs = timer.elapsed();
+
+        bool same = (loaded && version == SignalDataFile::Version
+                     && compare(digital, analog, loadedDigital,
+                                loadedAnalog, true));
+        ok &= same;
+
+        printf("version %d:            %6.1f MB, save %5lld ms, "
+               "load %5lld ms %s\n",
+               version, file.size()/1e6, saveMs, loadMs,
+               (same ? "ok" : "MISMATCH"));
+    }
+
+    // original format
+    {
+        QByteArray file;
+        QDataStream out(&file, QIODevice::WriteOnly);
+
+        timer.start();
+        writeVersion1(out, digital, analog);
+        qint64 saveMs = timer.elapsed();
+
+        QDataStream in(file);
+        QList<DigitalSampleStore> loadedDigital;
+        QList<AnalogSampleStore> loadedAnalog;
+        int version = 0;
+
+        timer.start();
+        bool loaded = read(in, version, loadedDigital, loadedAnalog);
+        qint64 loadMs = timer.elapsed();
+
+        bool same = (loaded && version == SignalDataFile::LegacyVersion
+                     && compare(digital, analog, loadedDigital,
+                                loadedAnalog, false));
+        ok &= same;
+
+        QDataStream inPerElement(file);
+        timer.start();
+        int numSignals = readVersion1PerElement(inPerElement);
+        qint64 perElementMs = timer.elapsed();
+
+        printf("version %d (legacy):   %6.1f MB, save %5lld ms, "
+               "load %5lld ms %s\n",
+               version, file.size()/1e6, saveMs, loadMs,
+               (same ? "ok" : "MISMATCH"));
+        printf("version 1 per element:                      load %5lld ms "
+               "(%d signals)\n", perElementMs, numSignals);
+    }
+
+    if (!ok) {
+        printf("FAILED: the loaded signals differ\n");
+        return 1;
+    }
+
+    return 0;
+}
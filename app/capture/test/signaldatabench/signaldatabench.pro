@@ -0,0 +1,27 @@
+# Benchmark of saving and loading the signal data of a project with
+# SignalDataFile. A full capture with all 11 digital and 2 analog channels
+# is saved and loaded in the current format and in the original format
+# (version 1) which is read by the legacy reader. The program fails if any
+# signal differs after the round trip. Only QtCore is needed.
+
+TEMPLATE = app
+TARGET = signaldatabench
+CONFIG += console
+CONFIG -= app_bundle
+
+QT -= gui
+
+INCLUDEPATH += $$PWD/../../..
+
+SOURCES += \
+    main.cpp \
+    $$PWD/../../signaldatafile.cpp \
+    $$PWD/../../../device/digitalsamplestore.cpp \
+    $$PWD/../../../device/digitaltransitions.cpp \
+    $$PWD/../../../device/analogsamplestore.cpp
+
+HEADERS += \
+    $$PWD/../../signaldatafile.h \
+    $$PWD/../../../device/digitalsamplestore.h \
+    $$PWD/../../../device/digitaltransitions.h \
+    $$PWD/../../../device/analogsamplestore.h
@@ -20,6 +20,7 @@
 #include <QDoubleSpinBox>
 #include <QRadioButton>
 #include <QButtonGroup>
+#include <qmath.h>
 
 #include "common/configuration.h"
 #include "uianalogtrigger.h"
@@ -254,20 +255,12 @@ double UiAnalogSignalPrivate::calcPeakToPeak()
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
-    QVector<double>* data = device->analogData(mSignal->id());
-
-    if (data != NULL) {
-        double min = 123456789;
-        double max = 0;
-        for (int i = 0; i < data->size(); i++) {
-            if (data->at(i) > max) {
-                max = data->at(i);
-            }
+    AnalogMinMaxPyramid* minMax = device->analogMinMax(mSignal->id());
 
-            if (data->at(i) < min) {
-                min = data->at(i);
-            }
-        }
+    if (minMax != NULL) {
+        double min;
+        double max;
+        minMax->minMax(0, minMax->size()-1, min, max);
 
         result = max - min;
     }
@@ -895,7 +888,7 @@ void UiAnalogSignal::findIntersect(UiAnalogSignalPrivate* signal, double time,
     // 1. Find the two closest samples from a signal based on the time axis
     // 2. Find the intersect between a vertical line and the signal
 
-    QVector<double>* data = device->analogData(signal->mSignal->id());
+    AnalogSampleStore* data = device->analogData(signal->mSignal->id());
 
     if (data != NULL && idx>= 0 && idx+1 < data->size()) {
         sigPart.setLine(idx, data->at(idx),
@@ -1067,10 +1060,11 @@ void UiAnalogSignal::paintSignals(QPainter* painter)
 
         painter->restore();
 
-        QVector<double>* data = device->analogData(id);
+        AnalogSampleStore* data = device->analogData(id);
+        AnalogMinMaxPyramid* minMax = device->analogMinMax(id);
 
         // no signal data
-        if (data == NULL) continue;
+        if (data == NULL || minMax == NULL) continue;
 
         int rate = device->usedSampleRate();
         int fromIdx = (int)(mTimeAxis->rangeLower()*rate);
@@ -1103,16 +1097,25 @@ void UiAnalogSignal::paintSignals(QPainter* painter)
         double minVal;
         double maxVal;
 
+        // number of samples that fit within one pixel
         double tOnePixel = mTimeAxis->pixelToTime(1)-mTimeAxis->pixelToTime(0);
-        for (int j = fromIdx+1; j < data->size(); j++) {
+        int step = qCeil(tOnePixel*rate);
+        if (step < 1) step = 1;
 
-            if ((double)(j-fromIdx)/rate < tOnePixel) continue;
+        int lastIdx = data->size()-1;
+        while (fromIdx < lastIdx) {
+
+            int j = fromIdx + step;
+            if (j > lastIdx) j = lastIdx;
 
             from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/rate);
             to = mTimeAxis->timeToPixelRelativeRef((double)j/rate);
 
             // no need to draw when signal is out of plot area
-            if (to < 0) continue;
+            if (to < 0) {
+                fromIdx = j;
+                continue;
+            }
             if (from > width()) break;
 
             fromVal = data->at(fromIdx);
@@ -1123,20 +1126,11 @@ void UiAnalogSignal::paintSignals(QPainter* painter)
             // between the 'from' value and 'to' value. Instead we find the minimum
             // and maximum values in the dataset between 'from' and 'to' and draw
             // a line between these values. This gives a more correct view of
-            // the signal.
+            // the signal. The values are taken from the min/max pyramid so
+            // the cost doesn't depend on the number of skipped samples.
             //
             if (j > fromIdx + 1) {
-                minVal = 999;
-                maxVal = -999;
-                for (int k = fromIdx; k <= j; k++) {
-                    if (data->at(k) < minVal) {
-                        minVal = data->at(k);
-                    }
-
-                    if (data->at(k) > maxVal) {
-                        maxVal = data->at(k);
-                    }
-                }
+                minMax->minMax(fromIdx, j, minVal, maxVal);
 
                 if (data->at(fromIdx) < data->at(j)) {
                     fromVal = minVal;
@@ -169,3 +169,11 @@ void UiCaptureArea::zoomAll()
 {
     mPlot->zoomAll();
 }
+
+/*!
+    Request to move the UI plot of signals so that time \a t is visible
+*/
+void UiCaptureArea::showTime(double t)
+{
+    mPlot->showTime(t);
+}
@@ -35,6 +35,7 @@ public slots:
     void zoomIn();
     void zoomOut();
     void zoomAll();
+    void showTime(double t);
 
 private:
     SignalManager* mSignalManager;
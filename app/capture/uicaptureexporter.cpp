@@ -16,9 +16,13 @@
 #include "uicaptureexporter.h"
 
 #include <QFormLayout>
-#include <QPushButton>
 #include <QFileDialog>
-#include <QProgressDialog>
+#include <QMessageBox>
+#include <QThreadPool>
+
+#include "csvexporttask.h"
+#include "vcdexporttask.h"
+#include "binaryexporttask.h"
 
 #define FORMAT_WIDGET_INDEX (1)
 
@@ -31,6 +35,10 @@
     A dialog window will be presented to the user with a number of
     choices and settings related to export of data. The supported formats
     as well as the actual export to file is handled within this class.
+
+    The export is done by an ExportTask subclass in the global thread pool
+    so that the user interface stays responsive while large captures are
+    written. The dialog is closed when the task has finished.
 */
 
 /*!
@@ -44,6 +52,7 @@ UiCaptureExporter::UiCaptureExporter(CaptureDevice* device, QWidget *parent) :
 
     mFormatWidget = NULL;
     mCaptureDevice = device;
+    mExportTask = NULL;
 
     // Deallocation: Ownership changed when calling setLayout.
     mMainLayout = new QVBoxLayout();
@@ -65,19 +74,25 @@ UiCaptureExporter::UiCaptureExporter(CaptureDevice* device, QWidget *parent) :
     mMainLayout->addLayout(formLayout);
 
     // Deallocation: "Qt Object trees" (See UiMainWindow)
-    QPushButton* exportBtn = new QPushButton("Export", this);
-    connect(exportBtn, SIGNAL(clicked()), this, SLOT(exportData()));
+    mExportButton = new QPushButton("Export", this);
+    connect(mExportButton, SIGNAL(clicked()), this, SLOT(exportData()));
 
     QPushButton* cancelBtn = new QPushButton("Cancel", this);
     connect(cancelBtn, SIGNAL(clicked()), this, SLOT(reject()));
 
     // Deallocation: Re-parented when calling mMainLayout->addLayout.
     QHBoxLayout* hLayout = new QHBoxLayout();
-    hLayout->addWidget(exportBtn);
+    hLayout->addWidget(mExportButton);
     hLayout->addWidget(cancelBtn);
     hLayout->addStretch();
     mMainLayout->addLayout(hLayout);
 
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mProgressBar = new QProgressBar(this);
+    mProgressBar->setRange(0, 100);
+    mProgressBar->setVisible(false);
+    mMainLayout->addWidget(mProgressBar);
+
     mMainLayout->addStretch();
 
     setLayout(mMainLayout);
@@ -94,6 +109,8 @@ UiCaptureExporter::UiCaptureExporter(CaptureDevice* device, QWidget *parent) :
 
 
 #define FORMAT_CSV "CSV"
+#define FORMAT_VCD "VCD"
+#define FORMAT_BINARY "Binary"
 
 /*!
     Returns the supported export formats.
@@ -101,12 +118,15 @@ UiCaptureExporter::UiCaptureExporter(CaptureDevice* device, QWidget *parent) :
 QStringList UiCaptureExporter::exportFormats()
 {
     return QList<QString>()
-            << FORMAT_CSV;
+            << FORMAT_CSV
+            << FORMAT_VCD
+            << FORMAT_BINARY;
 }
 
 /*!
     Creates widget used for a the given export format. The widget contains
-    settings specific for the given \a format.
+    settings specific for the given \a format. NULL is returned for formats
+    without settings.
 */
 QWidget* UiCaptureExporter::createFormat(QString format)
 {
@@ -127,6 +147,12 @@ void UiCaptureExporter::exportData(QString format, QWidget* w)
     if (FORMAT_CSV == format) {
         exportToCsv(w);
     }
+    else if (FORMAT_VCD == format) {
+        exportToVcd();
+    }
+    else if (FORMAT_BINARY == format) {
+        exportToBinary();
+    }
 }
 
 /*!
@@ -204,118 +230,90 @@ void UiCaptureExporter::exportToCsv(QWidget* w)
 
         if (filePath.isNull() || filePath.isEmpty()) break;
 
-        QFile file(filePath);
-        file.open(QIODevice::Truncate | QIODevice::WriteOnly | QIODevice::Text);
-        QTextStream out(&file);
-
-
-        QChar delim = ',';
-        if (!delimAsComma) {
-            delim = '\t';
-        }
-
-        QList<DigitalSignal*> digitalSignals = mCaptureDevice->digitalSignals();
-        QList<AnalogSignal*> analogSignals = mCaptureDevice->analogSignals();
-
-        QList<QVector<int>*> digitalData;
-        QList<QVector<double>*> analogData;
-
-        int numSamples = -1;
-        int sampleRate = mCaptureDevice->usedSampleRate();
-
-        //  >>> Header >>>>>>>>>>>>>>>>>>>>>>>>>>
-
-        out << "sample";
-
-        foreach(DigitalSignal* s, digitalSignals) {
-            QVector<int>* data = mCaptureDevice->digitalData(s->id());
-            if (data == NULL) continue;
-
-            out << delim << QString("D%1").arg(s->id());
-
-            digitalData.append(data);
-            if (numSamples == -1 || data->size() < numSamples) {
-                numSamples = data->size();
-            }
-        }
+        // Deallocation: deleted by deleteLater() when the task has finished
+        CsvExportTask* task = new CsvExportTask(filePath);
+        task->setDelimiter(delimAsComma ? ',' : '\t');
+        task->setSampleAsTime(sampleAsTime);
+        task->setOnlyChanges(!rowEachSample);
 
-        foreach(AnalogSignal* s, analogSignals) {
-            QVector<double>* data = mCaptureDevice->analogData(s->id());
-            if (data == NULL) continue;
+        startExport(task);
 
-            out << delim << QString("A%1").arg(s->id());
-
-            analogData.append(data);
-            if (numSamples == -1 || data->size() < numSamples) {
-                numSamples = data->size();
-            }
-        }
-
-        out << '\n';
-
-        //  <<< Header <<<<<<<<<<<<<<<<<<<<<<<<<<
-
-
-        //  >>> Samples >>>>>>>>>>>>>>>>>>>>>>>>>>
-
-        QProgressDialog progress("Exporting data", "Abort", 0, numSamples, this);
-        progress.setWindowModality(Qt::WindowModal);
-
-        QString lastSampleRow;
-        for (int i = 0; i < numSamples; i++) {
-
-            // do not call progress or wasCanceled for each sample
-            // since this greatly slows down the export
-            if ((i % 100) == 0 || i == numSamples-1) {
-                progress.setValue(i);
-
-                if (progress.wasCanceled()) {
-                    break;
-                }
-            }
-
-            QString sample = QString("%1").arg(i);
-            if (sampleAsTime) {
-                sample = QString::number((double)i/sampleRate);
-            }
+    } while(false);
 
-            QString sampleRow;
-            foreach(QVector<int>* d, digitalData) {
-                sampleRow.append(delim);
-                sampleRow.append(QString("%1").arg(d->at(i)));
 
-            }
+}
 
-            foreach(QVector<double>* d, analogData) {
-                sampleRow.append(delim);
-                sampleRow.append(QString("%1").arg(d->at(i)));
-                //out << delim << d->at(i);
-            }
+/*!
+    Export signal data in Value Change Dump (VCD) format.
+*/
+void UiCaptureExporter::exportToVcd()
+{
+    QString filePath = QFileDialog::getSaveFileName(
+                this,
+                tr("Save File"),
+                QDir::currentPath()+"/export.vcd",
+                "Value Change Dump (*.vcd)");
 
-            // only exporting changes
-            if (!rowEachSample && sampleRow == lastSampleRow) {
-                continue;
-            }
+    if (filePath.isNull() || filePath.isEmpty()) return;
 
-            out << sample;
-            out << sampleRow;
+    // Deallocation: deleted by deleteLater() when the task has finished
+    startExport(new VcdExportTask(filePath));
+}
 
-            lastSampleRow = sampleRow;
+/*!
+    Export signal data as raw binary data described by a JSON file.
+*/
+void UiCaptureExporter::exportToBinary()
+{
+    QString filePath = QFileDialog::getSaveFileName(
+                this,
+                tr("Save File"),
+                QDir::currentPath()+"/export.bin",
+                "Binary data (*.bin)");
 
+    if (filePath.isNull() || filePath.isEmpty()) return;
 
+    // Deallocation: deleted by deleteLater() when the task has finished
+    startExport(new BinaryExportTask(filePath));
+}
 
-            out << '\n';
+/*!
+    Gives the export \a task the signal data and starts it in the global
+    thread pool.
+*/
+void UiCaptureExporter::startExport(ExportTask* task)
+{
+    task->setSampleRate(mCaptureDevice->usedSampleRate());
 
-        }
+    // the task gets its own (implicitly shared) copies of the signal
+    // data so that a new capture doesn't affect the export
+    foreach(DigitalSignal* s, mCaptureDevice->digitalSignals()) {
+        DigitalTransitions* t = mCaptureDevice->digitalTransitions(s->id());
+        if (t == NULL) continue;
 
-        //  <<< Samples <<<<<<<<<<<<<<<<<<<<<<<<<<
+        task->addDigitalSignal(s->id(), *t);
+    }
 
+    foreach(AnalogSignal* s, mCaptureDevice->analogSignals()) {
+        AnalogSampleStore* data = mCaptureDevice->analogData(s->id());
+        if (data == NULL) continue;
 
-        file.close();
+        task->addAnalogSignal(s->id(), *data);
+    }
 
-    } while(false);
+    connect(task, SIGNAL(progress(int)),
+            mProgressBar, SLOT(setValue(int)));
+    connect(task, SIGNAL(finished()),
+            this, SLOT(handleExportFinished()));
+    connect(task, SIGNAL(finished()),
+            task, SLOT(deleteLater()));
 
+    mExportTask = task;
+    mExportButton->setEnabled(false);
+    mProgressBar->setValue(0);
+    mProgressBar->setVisible(true);
 
+    QThreadPool::globalInstance()->start(task);
 }
 
 /*
@@ -335,7 +333,9 @@ void UiCaptureExporter::handleFormatChanged(QString format)
     }
 
     mFormatWidget = createFormat(format);
-    mMainLayout->insertWidget(FORMAT_WIDGET_INDEX, mFormatWidget);
+    if (mFormatWidget != NULL) {
+        mMainLayout->insertWidget(FORMAT_WIDGET_INDEX, mFormatWidget);
+    }
 
 
     adjustSize();
@@ -348,5 +348,47 @@ void UiCaptureExporter::exportData()
 {
     exportData(mExportFormatBox->currentText(), mFormatWidget);
 
+    // the dialog is closed by handleExportFinished if an export was started
+    if (mExportTask == NULL) {
+        accept();
+    }
+}
+
+/*!
+    Called when the export task has finished.
+*/
+void UiCaptureExporter::handleExportFinished()
+{
+    ExportTask* task = mExportTask;
+    mExportTask = NULL;
+
+    if (task == NULL) return;
+
+    mExportButton->setEnabled(true);
+    mProgressBar->setVisible(false);
+
+    if (task->isCancelled()) return;
+
+    if (!task->errorString().isEmpty()) {
+        QMessageBox::warning(this, tr("Export Failed"),
+                             tr("Failed to export data: %1")
+                             .arg(task->errorString()));
+        return;
+    }
+
     accept();
 }
+
+/*!
+    Called when the user closes the dialog. An export in progress
+    is cancelled.
+*/
+void UiCaptureExporter::reject()
+{
+    if (mExportTask != NULL) {
+        mExportTask->cancel();
+        mExportTask = NULL;
+    }
+
+    QDialog::reject();
+}
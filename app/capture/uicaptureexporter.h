@@ -19,9 +19,13 @@
 #include <QDialog>
 #include <QVBoxLayout>
 #include <QComboBox>
+#include <QProgressBar>
+#include <QPushButton>
 
 #include "device/capturedevice.h"
 
+class ExportTask;
+
 class UiCaptureExporter : public QDialog
 {
     Q_OBJECT
@@ -31,6 +35,7 @@ public:
 signals:
     
 public slots:
+    void reject();
 
 private:
 
@@ -38,6 +43,9 @@ private:
     QVBoxLayout* mMainLayout;
     QComboBox* mExportFormatBox;
     QWidget* mFormatWidget;
+    QPushButton* mExportButton;
+    QProgressBar* mProgressBar;
+    ExportTask* mExportTask;
 
 
     QStringList exportFormats();
@@ -47,10 +55,15 @@ private:
 
     QWidget* createFormatCsv();
     void exportToCsv(QWidget* w);
+    void exportToVcd();
+    void exportToBinary();
+
+    void startExport(ExportTask* task);
 
 private slots:
     void handleFormatChanged(QString format);
     void exportData();
+    void handleExportFinished();
     
 };
 
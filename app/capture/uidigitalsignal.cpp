@@ -17,6 +17,7 @@
 
 #include <QDebug>
 #include <QPainter>
+#include <qmath.h>
 
 #include <QApplication>
 #include <QDrag>
@@ -139,22 +140,19 @@ void UiDigitalSignal::paintEvent(QPaintEvent *event)
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
-    QVector<int>* data = device->digitalData(mSignal->id());
+    DigitalTransitions* trans = device->digitalTransitions(mSignal->id());
 
-    if (data == NULL) return;
+    if (trans == NULL) return;
 
     // -----------------
     // draw signal
     // -----------------
-    QList<int> trans;
-
-    device->digitalTransitions(mSignal->id(), trans);
 
     QPen pen = painter.pen();
     pen.setColor(Configuration::instance().digitalSignalColor(mSignal->id()));
     painter.setPen(pen);
 
-    paintSignal(&painter, &trans, device->usedSampleRate());
+    paintSignal(&painter, trans, device->usedSampleRate());
 
     if (mMouseOverValid) {
         paintArrows(&painter);
@@ -174,26 +172,21 @@ void UiDigitalSignal::mouseMoveEvent(QMouseEvent *event)
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
-    QVector<int>* data = device->digitalData(mSignal->id());
-    QList<int> trans;
-
-    device->digitalTransitions(mSignal->id(), trans);
+    DigitalTransitions* trans = device->digitalTransitions(mSignal->id());
 
-    if (data != NULL && event->pos().x() >= plotX()) {
+    if (trans != NULL && event->pos().x() >= plotX()) {
         double xTime = mTimeAxis->pixelToTimeRelativeRef(
                     event->pos().x());
 
         // find first sample
-        int idx = (int)(xTime*device->usedSampleRate());
+        qint64 idx = (qint64)(xTime*device->usedSampleRate());
 
         do {
 
             // assuming that t=0 is start for all samples
             if (idx < 0) break;
             // outside of sample data
-            if (idx >= trans.at(trans.size()-1)) break;
-
-            int level = trans.at(0);
+            if (idx >= trans->lastIndex()) break;
 
             /*
                 Need to find one transition to the left of where the mouse
@@ -210,34 +203,31 @@ void UiDigitalSignal::mouseMoveEvent(QMouseEvent *event)
                 1:st  2:nd   3:rd
             */
 
-            // find first transition left of index
-            int leftTransitionIdx = -1;
-            for (int i = 1; i < trans.size(); i++) {
-                if (trans.at(i) > idx && i > 1) {
-                    leftTransitionIdx = trans.at(i-1);
-                    idx = i-1;
-                    break;
-                }
-            }
-            // didn't find a transition left of point
-            if (leftTransitionIdx == -1) break;
+            // find first transition left of index (binary search)
+            int left = trans->previous(idx);
 
+            // didn't find a transition left of point
+            if (left == -1) break;
 
-            idx++;
-            // no transition
-            if (idx > trans.size()-1) break;
+            qint64 leftTransitionIdx = trans->at(left);
+            int right = left + 1;
 
-            int right1TransitionIdx = trans.at(idx);
-            // record logic level at first transition right of point
-            if ((idx % 2) != 0) {
-                level = ((level + 1) % 2);
+            // the last sample index is used when there are no
+            // more transitions
+            qint64 right1TransitionIdx = trans->lastIndex();
+            if (right < trans->size()) {
+                right1TransitionIdx = trans->at(right);
             }
+            // record logic level at first transition right of point
+            int level = trans->levelAfter(right);
 
-            idx++;
             // no transition
-            if (idx > trans.size()-1) break;
+            if (right+1 > trans->size()) break;
 
-            int right2TransitionIdx = trans.at(idx);
+            qint64 right2TransitionIdx = trans->lastIndex();
+            if (right+1 < trans->size()) {
+                right2TransitionIdx = trans->at(right+1);
+            }
 
 
             bool highLow = true;
@@ -305,18 +295,33 @@ void UiDigitalSignal::showEvent(QShowEvent* event)
 /*!
     Paint the signal data.
 */
-void UiDigitalSignal::paintSignal(QPainter* painter, QList<int> *data,
+void UiDigitalSignal::paintSignal(QPainter* painter, DigitalTransitions *data,
                                   int sampleRate)
 {
 
+    // more than one sample per pixel -> several transitions can end up
+    // in the same pixel column
+    double tOnePixel = mTimeAxis->pixelToTime(1)-mTimeAxis->pixelToTime(0);
+    if (tOnePixel*sampleRate > 1) {
+        paintSignalDensity(painter, data, sampleRate);
+        return;
+    }
+
     int yFactor = height()/2;
 
-    int fromIdx = (int)(mTimeAxis->rangeLower()*sampleRate);
+    qint64 fromIdx = (qint64)(mTimeAxis->rangeLower()*sampleRate);
 
     if (fromIdx < 0) fromIdx = 0;
 
-    int toIdx = 0;
-    int level = data->at(0);
+    qint64 toIdx = 0;
+    int numTransitions = data->size();
+
+    // binary search for the first transition in the visible range
+    int start = data->upperBound(fromIdx);
+    int level = data->initialLevel() ^ (start & 1);
+
+    // visible range starts after the last sample
+    if (start == numTransitions && data->lastIndex() <= fromIdx) return;
 
     double from = 0;
     double to = 0;
@@ -328,18 +333,16 @@ void UiDigitalSignal::paintSignal(QPainter* painter, QList<int> *data,
     // vertical: position signal at center
     painter->translate(0, height()-(height()-yFactor)/2);
 
-    int start = 1;
-    for (start = 1; start < data->size(); start++) {
-        if (data->at(start) > fromIdx) break;
-    }
-
-    if ((start % 2) == 0) {
-        level = ((level + 1) % 2);
-    }
+    for (int i = start; i <= numTransitions; i++) {
 
-    for (int i = start; i < data->size(); i++) {
-
-        toIdx = data->at(i);
+        // the last sample index is used as end point after the
+        // last transition
+        if (i < numTransitions) {
+            toIdx = data->at(i);
+        }
+        else {
+            toIdx = data->lastIndex();
+        }
 
         from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
         to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
@@ -362,10 +365,8 @@ void UiDigitalSignal::paintSignal(QPainter* painter, QList<int> *data,
                           to, -level*yFactor);
 
 
-        // the last index of the transition list contains the
-        // last index of the signal data independent of any
-        // transition
-        if (i < data->size()-1) {
+        // no transition at the end point after the last transition
+        if (i < numTransitions) {
             // transition: draw vertical line
             painter->drawLine(to, -level*yFactor,
                               to, -((level + 1)%2)*yFactor);
@@ -381,6 +382,107 @@ void UiDigitalSignal::paintSignal(QPainter* painter, QList<int> *data,
     painter->restore();
 }
 
+/*!
+    Paint the signal data one pixel column at a time. Used when zoomed out
+    so that a pixel column covers more than one sample.
+
+    The number of transitions within a column is found with two binary
+    searches in the transition list. A column without transitions extends
+    the current horizontal line, a column with one transition gets a
+    vertical line and a column with more transitions is "busy". Adjacent
+    busy columns are painted as one filled band, the way a hardware logic
+    analyzer shows a signal that toggles faster than the display resolution.
+
+    The cost depends on the width of the plot area and not on the number
+    of transitions.
+*/
+void UiDigitalSignal::paintSignalDensity(QPainter* painter,
+                                         DigitalTransitions *data,
+                                         int sampleRate)
+{
+    int yFactor = height()/2;
+
+    // pixel columns for which there is signal data
+    double firstPx = mTimeAxis->timeToPixelRelativeRef(0);
+    double lastPx = mTimeAxis->timeToPixelRelativeRef(
+                (double)data->lastIndex()/sampleRate);
+
+    int xStart = qMax(infoWidth(), (int)firstPx);
+    int xEnd = qMin(width(), (int)lastPx + 1);
+
+    if (xStart >= xEnd) return;
+
+    painter->save();
+    painter->setClipRect(infoWidth(), 0, plotWidth(), height());
+
+    // vertical: position signal at center
+    painter->translate(0, height()-(height()-yFactor)/2);
+
+    QColor color = painter->pen().color();
+
+    int runStart = xStart;
+    int busyStart = -1;
+
+    qint64 a = (qint64)qCeil(mTimeAxis->pixelToTimeRelativeRef(xStart)*sampleRate);
+    if (a < 0) a = 0;
+    int first = data->lowerBound(a);
+    int level = data->initialLevel() ^ (first & 1);
+
+    for (int x = xStart; x < xEnd; x++) {
+
+        // samples in column x are [a, b)
+        qint64 b = (qint64)qCeil(mTimeAxis->pixelToTimeRelativeRef(x+1)*sampleRate);
+        if (b > data->numSamples()) b = data->numSamples();
+        if (b < a) b = a;
+
+        int last = data->lowerBound(b);
+        int count = last - first;
+
+        if (count >= 2) {
+            // busy column: end the horizontal line and start/extend band
+            if (busyStart == -1) {
+                if (x > runStart) {
+                    painter->drawLine(runStart, -level*yFactor,
+                                      x, -level*yFactor);
+                }
+                busyStart = x;
+            }
+        }
+        else {
+            if (busyStart != -1) {
+                painter->fillRect(QRectF(busyStart, -yFactor,
+                                         x-busyStart, yFactor), color);
+                busyStart = -1;
+                runStart = x;
+                level = data->initialLevel() ^ (first & 1);
+            }
+
+            if (count == 1) {
+                int newLevel = data->initialLevel() ^ (last & 1);
+                painter->drawLine(runStart, -level*yFactor,
+                                  x, -level*yFactor);
+                painter->drawLine(x, -level*yFactor,
+                                  x, -newLevel*yFactor);
+                level = newLevel;
+                runStart = x;
+            }
+        }
+
+        first = last;
+        a = b;
+    }
+
+    if (busyStart != -1) {
+        painter->fillRect(QRectF(busyStart, -yFactor,
+                                 xEnd-busyStart, yFactor), color);
+    }
+    else {
+        painter->drawLine(runStart, -level*yFactor, xEnd, -level*yFactor);
+    }
+
+    painter->restore();
+}
+
 /*!
     Paint arrows for period and signal width at mouse cursor position
 */
@@ -25,6 +25,7 @@
 #include "uidigitaltrigger.h"
 
 #include "device/digitalsignal.h"
+#include "device/digitaltransitions.h"
 
 class UiDigitalSignal : public UiSimpleAbstractSignal
 {
@@ -65,7 +66,9 @@ private:
         SignalIdMarginRight = 10
     };
 
-    void paintSignal(QPainter* painter, QList<int>* data, int sampleRate);
+    void paintSignal(QPainter* painter, DigitalTransitions* data, int sampleRate);
+    void paintSignalDensity(QPainter* painter, DigitalTransitions* data,
+                            int sampleRate);
     void paintArrows(QPainter* painter);
 
     void infoWidthChanged();
@@ -118,6 +118,21 @@ void UiPlot::zoomAll()
     viewport()->update();
 }
 
+/*!
+    Moves the plot so that time \a t is in the center, unless \a t is
+    already visible. The zoom level is kept.
+*/
+void UiPlot::showTime(double t)
+{
+    if (t < mTimeAxis->rangeLower() || t > mTimeAxis->rangeUpper()) {
+        double center = (mTimeAxis->rangeLower() + mTimeAxis->rangeUpper())/2;
+        mTimeAxis->setReference(mTimeAxis->reference() + t - center);
+        updateHorizontalScrollBar();
+    }
+
+    viewport()->update();
+}
+
 /*!
     Request signals to be redrawn.
 */
@@ -36,6 +36,7 @@ public:
 
     void zoom(int steps, int xCenter = -1);
     void zoomAll();
+    void showTime(double t);
 
     void updateSignals();
     void handleSignalDataChanged();
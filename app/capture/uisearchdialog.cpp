@@ -0,0 +1,277 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uisearchdialog.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QDialogButtonBox>
+#include <QLabel>
+
+#include <qmath.h>
+
+#include "common/configuration.h"
+#include "common/inputhelper.h"
+#include "device/devicemanager.h"
+
+/*!
+    \class UiSearchDialog
+    \brief UI widget used to define a search in the digital signals.
+
+    \ingroup Capture
+
+    The search is either a pattern, with one condition per digital signal,
+    or a pulse width limit for one digital signal. The widths are entered
+    as time and converted to samples with the sample rate of the capture.
+*/
+
+
+/*!
+    Constructs an UiSearchDialog with the given \a parent. The dialog is
+    initialized with the settings of \a search and the widths are converted
+    with \a sampleRate.
+*/
+UiSearchDialog::UiSearchDialog(const DigitalSearch &search, int sampleRate,
+                               QWidget *parent) :
+    QDialog(parent),
+    mConditionBoxes()
+{
+    mSampleRate = qMax(sampleRate, 1);
+
+    setWindowTitle(tr("Search"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    // Deallocation:
+    //   formLayout will be re-parented when calling verticalLayout->addLayout
+    //   which means that it will be deleted when UiSearchDialog is
+    //   deleted.
+    QFormLayout* formLayout = new QFormLayout;
+    formLayout->setRowWrapPolicy(QFormLayout::WrapAllRows);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mTypeBox = new QComboBox(this);
+    mTypeBox->addItem(tr("Pattern"), QVariant(DigitalSearch::PatternSearch));
+    mTypeBox->addItem(tr("Pulse width"), QVariant(DigitalSearch::PulseWidthSearch));
+    formLayout->addRow(tr("Search for: "), mTypeBox);
+
+    mPatternWidget = createPatternWidget(search);
+    formLayout->addRow(mPatternWidget);
+
+    mPulseWidget = createPulseWidget(search);
+    formLayout->addRow(mPulseWidget);
+
+    connect(mTypeBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(typeChanged(int)));
+    InputHelper::setInt(mTypeBox, search.type());
+    typeChanged(mTypeBox->currentIndex());
+
+    // Deallocation:
+    //   Ownership is transfered to UiSearchDialog when calling
+    //   setLayout below.
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDialogButtonBox* bottonBox = new QDialogButtonBox(
+                QDialogButtonBox::Ok|QDialogButtonBox::Cancel,
+                Qt::Horizontal,
+                this);
+    bottonBox->setCenterButtons(true);
+
+    connect(bottonBox, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(bottonBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addWidget(bottonBox);
+
+    setLayout(verticalLayout);
+}
+
+/*!
+    Returns the search defined in the dialog.
+*/
+DigitalSearch UiSearchDialog::search() const
+{
+    DigitalSearch search;
+
+    if (InputHelper::intValue(mTypeBox) == DigitalSearch::PatternSearch) {
+        QMap<int, DigitalSearch::Condition> pattern;
+
+        QMap<int, QComboBox*>::const_iterator it;
+        for (it = mConditionBoxes.constBegin(); it != mConditionBoxes.constEnd(); ++it) {
+            pattern.insert(it.key(), (DigitalSearch::Condition)
+                           InputHelper::intValue(it.value()));
+        }
+
+        search.setPattern(pattern);
+    }
+    else {
+        double unit = mPulseUnitBox->itemData(mPulseUnitBox->currentIndex())
+                .toDouble();
+        double samples = mPulseWidthBox->value()*unit*mSampleRate;
+
+        qint64 minWidth = -1;
+        qint64 maxWidth = -1;
+
+        // a pulse lasts a whole number of samples
+        if (InputHelper::intValue(mPulseCompareBox) == ShorterThan) {
+            maxWidth = (qint64)qCeil(samples) - 1;
+        }
+        else {
+            minWidth = (qint64)qFloor(samples) + 1;
+        }
+
+        search.setPulseWidth(InputHelper::intValue(mPulseSignalBox),
+                             InputHelper::intValue(mPulseLevelBox),
+                             minWidth, maxWidth);
+    }
+
+    return search;
+}
+
+/*!
+    Create the widget with a condition for each digital signal in the plot.
+    The conditions are initialized from \a search.
+*/
+QWidget* UiSearchDialog::createPatternWidget(const DigitalSearch &search)
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+
+    QMap<int, DigitalSearch::Condition> pattern = search.pattern();
+
+    // Deallocation:
+    //   Ownership is taken over by w by the call to w->setLayout
+    QGridLayout* l = new QGridLayout();
+    l->setSizeConstraint(QLayout::SetFixedSize);
+
+    QList<DigitalSignal*> digitalSignals = device->digitalSignals();
+    for (int i = 0; i < digitalSignals.size(); i++) {
+        int id = digitalSignals.at(i)->id();
+
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        QLabel* cl = new QLabel("    ");
+        QString color = Configuration::instance().digitalCableColor(id).name();
+        cl->setStyleSheet(QString("QLabel { background-color : %1; }").arg(color));
+        l->addWidget(cl, 0, i);
+
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        l->addWidget(new QLabel(QString("D%1").arg(id), this), 1, i);
+
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        QComboBox* box = new QComboBox(this);
+        for (int c = 0; c < DigitalSearch::NumConditions; c++) {
+            box->addItem(DigitalSearch::conditionToString(
+                             (DigitalSearch::Condition)c), QVariant(c));
+        }
+        InputHelper::setInt(box, pattern.value(id, DigitalSearch::DontCare));
+        l->addWidget(box, 2, i);
+        mConditionBoxes.insert(id, box);
+    }
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QWidget* w = new QWidget(this);
+    w->setLayout(l);
+
+    return w;
+}
+
+/*!
+    Create the widget with the pulse width settings. The settings are
+    initialized from \a search.
+*/
+QWidget* UiSearchDialog::createPulseWidget(const DigitalSearch &search)
+{
+    // Deallocation:
+    //   Ownership is taken over by w by the call to w->setLayout
+    QFormLayout* l = new QFormLayout();
+
+    mPulseSignalBox = InputHelper::createSignalBox(this, search.pulseSignalId());
+    l->addRow(tr("Signal: "), mPulseSignalBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mPulseLevelBox = new QComboBox(this);
+    mPulseLevelBox->addItem(tr("High pulse"), QVariant(1));
+    mPulseLevelBox->addItem(tr("Low pulse (gap)"), QVariant(0));
+    InputHelper::setInt(mPulseLevelBox, search.pulseLevel());
+    l->addRow(tr("Level: "), mPulseLevelBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mPulseCompareBox = new QComboBox(this);
+    mPulseCompareBox->addItem(tr("Shorter than"), QVariant(ShorterThan));
+    mPulseCompareBox->addItem(tr("Longer than"), QVariant(LongerThan));
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mPulseWidthBox = new QDoubleSpinBox(this);
+    mPulseWidthBox->setRange(0, 999999);
+    mPulseWidthBox->setDecimals(3);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mPulseUnitBox = new QComboBox(this);
+    mPulseUnitBox->addItem("ns", QVariant(1e-9));
+    mPulseUnitBox->addItem("us", QVariant(1e-6));
+    mPulseUnitBox->addItem("ms", QVariant(1e-3));
+
+    // show the width of the previous search with a suitable unit
+    double width = 0;
+    if (search.type() == DigitalSearch::PulseWidthSearch) {
+        if (search.maxPulseWidth() >= 0) {
+            width = (double)(search.maxPulseWidth()+1)/mSampleRate;
+        }
+        else if (search.minPulseWidth() >= 0) {
+            InputHelper::setInt(mPulseCompareBox, LongerThan);
+            width = (double)(search.minPulseWidth()-1)/mSampleRate;
+        }
+    }
+
+    int unitIdx = 0;
+    if (width >= 1e-3) {
+        unitIdx = 2;
+    }
+    else if (width >= 1e-6) {
+        unitIdx = 1;
+    }
+    mPulseUnitBox->setCurrentIndex(unitIdx);
+    mPulseWidthBox->setValue(
+                width / mPulseUnitBox->itemData(unitIdx).toDouble());
+
+    // Deallocation:
+    //   Ownership is transfered to l when calling l->addRow below.
+    QHBoxLayout* widthLayout = new QHBoxLayout();
+    widthLayout->addWidget(mPulseCompareBox);
+    widthLayout->addWidget(mPulseWidthBox);
+    widthLayout->addWidget(mPulseUnitBox);
+    l->addRow(tr("Width: "), widthLayout);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QWidget* w = new QWidget(this);
+    w->setLayout(l);
+
+    return w;
+}
+
+/*!
+    Called when the search type has changed to the one at \a index in the
+    type box. Only the settings of the selected type are shown.
+*/
+void UiSearchDialog::typeChanged(int index)
+{
+    bool pattern = (mTypeBox->itemData(index).toInt()
+                    == DigitalSearch::PatternSearch);
+
+    mPatternWidget->setVisible(pattern);
+    mPulseWidget->setVisible(!pattern);
+}
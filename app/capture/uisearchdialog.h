@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UISEARCHDIALOG_H
+#define UISEARCHDIALOG_H
+
+#include <QWidget>
+#include <QDialog>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QMap>
+
+#include "device/digitalsearch.h"
+
+class UiSearchDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit UiSearchDialog(const DigitalSearch &search, int sampleRate,
+                            QWidget *parent = 0);
+
+    DigitalSearch search() const;
+
+signals:
+
+public slots:
+
+private:
+
+    enum WidthCompare {
+        ShorterThan,
+        LongerThan
+    };
+
+    int mSampleRate;
+
+    QComboBox* mTypeBox;
+    QWidget* mPatternWidget;
+    QWidget* mPulseWidget;
+
+    QMap<int, QComboBox*> mConditionBoxes;
+
+    QComboBox* mPulseSignalBox;
+    QComboBox* mPulseLevelBox;
+    QComboBox* mPulseCompareBox;
+    QDoubleSpinBox* mPulseWidthBox;
+    QComboBox* mPulseUnitBox;
+
+    QWidget* createPatternWidget(const DigitalSearch &search);
+    QWidget* createPulseWidget(const DigitalSearch &search);
+
+private slots:
+    void typeChanged(int index);
+
+};
+
+#endif // UISEARCHDIALOG_H
@@ -0,0 +1,465 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uistopconditiondialog.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QMessageBox>
+#include <QStringList>
+
+#include "common/inputhelper.h"
+#include "device/protocolcondition.h"
+
+/*!
+    \class UiStopConditionDialog
+    \brief UI widget used to define the stop condition of a continuous
+    capture.
+
+    \ingroup Capture
+
+    The stop condition is an I2C event, an UART event or a sequence of SPI
+    values. Each continuous capture is decoded with the selected protocol
+    and the capture stops at the first capture that contains the event.
+    Values are entered in hexadecimal and an empty value matches any value.
+*/
+
+
+/*!
+    Constructs an UiStopConditionDialog with the given \a parent. The dialog
+    is initialized with the settings of \a condition, which can be NULL.
+*/
+UiStopConditionDialog::UiStopConditionDialog(
+        const CaptureSegmentCondition* condition, QWidget *parent) :
+    QDialog(parent)
+{
+    setWindowTitle(tr("Stop Condition"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    // Deallocation:
+    //   formLayout will be re-parented when calling verticalLayout->addLayout
+    //   which means that it will be deleted when UiStopConditionDialog is
+    //   deleted.
+    QFormLayout* formLayout = new QFormLayout;
+    formLayout->setRowWrapPolicy(QFormLayout::WrapAllRows);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mTypeBox = new QComboBox(this);
+    mTypeBox->addItem(tr("None"), QVariant(NoCondition));
+    mTypeBox->addItem(tr("I2C event"), QVariant(I2CConditionType));
+    mTypeBox->addItem(tr("UART event"), QVariant(UartConditionType));
+    mTypeBox->addItem(tr("SPI data"), QVariant(SpiConditionType));
+    formLayout->addRow(tr("Stop at: "), mTypeBox);
+
+    mI2cWidget = createI2cWidget(condition);
+    formLayout->addRow(mI2cWidget);
+
+    mUartWidget = createUartWidget(condition);
+    formLayout->addRow(mUartWidget);
+
+    mSpiWidget = createSpiWidget(condition);
+    formLayout->addRow(mSpiWidget);
+
+    int type = NoCondition;
+    if (dynamic_cast<const I2CCondition*>(condition) != NULL) {
+        type = I2CConditionType;
+    }
+    else if (dynamic_cast<const UartCondition*>(condition) != NULL) {
+        type = UartConditionType;
+    }
+    else if (dynamic_cast<const SpiCondition*>(condition) != NULL) {
+        type = SpiConditionType;
+    }
+
+    connect(mTypeBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(typeChanged(int)));
+    InputHelper::setInt(mTypeBox, type);
+    typeChanged(mTypeBox->currentIndex());
+
+    // Deallocation:
+    //   Ownership is transfered to UiStopConditionDialog when calling
+    //   setLayout below.
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDialogButtonBox* bottonBox = new QDialogButtonBox(
+                QDialogButtonBox::Ok|QDialogButtonBox::Cancel,
+                Qt::Horizontal,
+                this);
+    bottonBox->setCenterButtons(true);
+
+    connect(bottonBox, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(bottonBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addWidget(bottonBox);
+
+    setLayout(verticalLayout);
+}
+
+/*!
+    Returns a new condition with the settings in the dialog or NULL if
+    no condition has been selected.
+
+    Deallocation:
+      The caller takes ownership of the condition.
+*/
+CaptureSegmentCondition* UiStopConditionDialog::condition() const
+{
+    CaptureSegmentCondition* condition = NULL;
+
+    switch (InputHelper::intValue(mTypeBox)) {
+    case I2CConditionType:
+    {
+        int address = -1;
+        int value = -1;
+        hexValue(mI2cAddressBox, address);
+        hexValue(mI2cValueBox, value);
+
+        I2CCondition* c = new I2CCondition(
+                    InputHelper::intValue(mI2cSclBox),
+                    InputHelper::intValue(mI2cSdaBox),
+                    (I2CItem::I2CType)InputHelper::intValue(mI2cTypeBox));
+        c->setAddress(address);
+        c->setValue(value);
+        condition = c;
+        break;
+    }
+    case UartConditionType:
+    {
+        int value = -1;
+        hexValue(mUartValueBox, value);
+
+        UartCondition* c = new UartCondition(
+                    InputHelper::intValue(mUartSignalBox),
+                    InputHelper::intValue(mUartBaudRateBox),
+                    (UartItem::ItemType)InputHelper::intValue(mUartTypeBox));
+        c->setDataBits(InputHelper::intValue(mUartDataBitsBox));
+        c->setStopBits(InputHelper::intValue(mUartStopBitsBox));
+        c->setParity((Types::UartParity)InputHelper::intValue(mUartParityBox));
+        c->setValue(value);
+        condition = c;
+        break;
+    }
+    case SpiConditionType:
+    {
+        QVector<int> pattern;
+        hexPattern(mSpiPatternBox, pattern);
+
+        SpiCondition* c = new SpiCondition(
+                    InputHelper::intValue(mSpiSckBox),
+                    InputHelper::intValue(mSpiMosiBox),
+                    InputHelper::intValue(mSpiMisoBox),
+                    InputHelper::intValue(mSpiEnableBox),
+                    pattern);
+        c->setDataBits(InputHelper::intValue(mSpiDataBitsBox));
+        c->setMode((Types::SpiMode)InputHelper::intValue(mSpiModeBox));
+        c->setEnableMode((Types::SpiEnable)
+                         InputHelper::intValue(mSpiEnableModeBox));
+        c->setMatchMiso(mSpiMatchMisoBox->isChecked());
+        condition = c;
+        break;
+    }
+    default:
+        break;
+    }
+
+    return condition;
+}
+
+/*!
+    Closes the dialog if the settings are valid, otherwise a warning is
+    shown and the dialog stays open.
+*/
+void UiStopConditionDialog::accept()
+{
+    QString msg;
+    int value;
+    QVector<int> pattern;
+
+    switch (InputHelper::intValue(mTypeBox)) {
+    case I2CConditionType:
+        if (InputHelper::intValue(mI2cSclBox)
+                == InputHelper::intValue(mI2cSdaBox)) {
+            msg = tr("SCL and SDA must be different signals");
+        }
+        else if (!hexValue(mI2cAddressBox, value)
+                 || !hexValue(mI2cValueBox, value)) {
+            msg = tr("The address and value must be hexadecimal numbers");
+        }
+        break;
+    case UartConditionType:
+        if (InputHelper::intValue(mUartBaudRateBox) <= 0) {
+            msg = tr("Invalid baud rate");
+        }
+        else if (!hexValue(mUartValueBox, value)) {
+            msg = tr("The value must be a hexadecimal number");
+        }
+        break;
+    case SpiConditionType:
+        if (!hexPattern(mSpiPatternBox, pattern) || pattern.isEmpty()) {
+            msg = tr("The data must be one or more hexadecimal numbers");
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (!msg.isEmpty()) {
+        QMessageBox::warning(this, tr("Invalid stop condition"), msg);
+        return;
+    }
+
+    QDialog::accept();
+}
+
+/*!
+    Create the widget with the I2C settings. The settings are initialized
+    from \a condition if it is an I2C condition.
+*/
+QWidget* UiStopConditionDialog::createI2cWidget(
+        const CaptureSegmentCondition* condition)
+{
+    I2CCondition c(0, 1, I2CItem::I2C_START);
+    const I2CCondition* i2c = dynamic_cast<const I2CCondition*>(condition);
+    if (i2c != NULL) {
+        c = *i2c;
+    }
+
+    // Deallocation:
+    //   Ownership is taken over by w by the call to w->setLayout
+    QFormLayout* l = new QFormLayout();
+
+    mI2cSclBox = InputHelper::createSignalBox(this, c.sclSignalId());
+    l->addRow(tr("SCL: "), mI2cSclBox);
+
+    mI2cSdaBox = InputHelper::createSignalBox(this, c.sdaSignalId());
+    l->addRow(tr("SDA: "), mI2cSdaBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mI2cTypeBox = new QComboBox(this);
+    mI2cTypeBox->addItem(tr("Start"), QVariant(I2CItem::I2C_START));
+    mI2cTypeBox->addItem(tr("Stop"), QVariant(I2CItem::I2C_STOP));
+    mI2cTypeBox->addItem(tr("Address write (7-bit)"),
+                         QVariant(I2CItem::I2C_7_ADDRESS_WRITE));
+    mI2cTypeBox->addItem(tr("Address read (7-bit)"),
+                         QVariant(I2CItem::I2C_7_ADDRESS_READ));
+    mI2cTypeBox->addItem(tr("Address write (10-bit)"),
+                         QVariant(I2CItem::I2C_10_ADDRESS_WRITE));
+    mI2cTypeBox->addItem(tr("Address read (10-bit)"),
+                         QVariant(I2CItem::I2C_10_ADDRESS_READ));
+    mI2cTypeBox->addItem(tr("Data"), QVariant(I2CItem::I2C_DATA));
+    mI2cTypeBox->addItem(tr("ACK"), QVariant(I2CItem::I2C_ACK));
+    mI2cTypeBox->addItem(tr("NACK"), QVariant(I2CItem::I2C_NACK));
+    mI2cTypeBox->addItem(tr("Error"), QVariant(I2CItem::I2C_ERROR));
+    InputHelper::setInt(mI2cTypeBox, c.type());
+    l->addRow(tr("Event: "), mI2cTypeBox);
+
+    mI2cAddressBox = createHexBox(this, c.address());
+    mI2cAddressBox->setToolTip(tr("Empty matches any address"));
+    l->addRow(tr("Address (hex): "), mI2cAddressBox);
+
+    mI2cValueBox = createHexBox(this, c.value());
+    mI2cValueBox->setToolTip(tr("Empty matches any value"));
+    l->addRow(tr("Value (hex): "), mI2cValueBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QWidget* w = new QWidget(this);
+    w->setLayout(l);
+
+    return w;
+}
+
+/*!
+    Create the widget with the UART settings. The settings are initialized
+    from \a condition if it is an UART condition.
+*/
+QWidget* UiStopConditionDialog::createUartWidget(
+        const CaptureSegmentCondition* condition)
+{
+    UartCondition c(0, 115200, UartItem::TYPE_DATA);
+    const UartCondition* uart = dynamic_cast<const UartCondition*>(condition);
+    if (uart != NULL) {
+        c = *uart;
+    }
+
+    // Deallocation:
+    //   Ownership is taken over by w by the call to w->setLayout
+    QFormLayout* l = new QFormLayout();
+
+    mUartSignalBox = InputHelper::createSignalBox(this, c.signalId());
+    l->addRow(tr("RX/TX: "), mUartSignalBox);
+
+    mUartBaudRateBox = InputHelper::createUartBaudRateBox(this, c.baudRate());
+    l->addRow(tr("Baud rate: "), mUartBaudRateBox);
+
+    mUartDataBitsBox = InputHelper::createUartDataBitsBox(this, c.dataBits());
+    l->addRow(tr("Data bits: "), mUartDataBitsBox);
+
+    mUartStopBitsBox = InputHelper::createUartStopBitsBox(this, c.stopBits());
+    l->addRow(tr("Stop bits: "), mUartStopBitsBox);
+
+    mUartParityBox = InputHelper::createUartParityBox(this, c.parity());
+    l->addRow(tr("Parity: "), mUartParityBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mUartTypeBox = new QComboBox(this);
+    mUartTypeBox->addItem(tr("Data"), QVariant(UartItem::TYPE_DATA));
+    mUartTypeBox->addItem(tr("Frame error"),
+                          QVariant(UartItem::TYPE_FRAME_ERROR));
+    mUartTypeBox->addItem(tr("Parity error"),
+                          QVariant(UartItem::TYPE_PARITY_ERROR));
+    InputHelper::setInt(mUartTypeBox, c.type());
+    l->addRow(tr("Event: "), mUartTypeBox);
+
+    mUartValueBox = createHexBox(this, c.value());
+    mUartValueBox->setToolTip(tr("Empty matches any value"));
+    l->addRow(tr("Value (hex): "), mUartValueBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QWidget* w = new QWidget(this);
+    w->setLayout(l);
+
+    return w;
+}
+
+/*!
+    Create the widget with the SPI settings. The settings are initialized
+    from \a condition if it is a SPI condition.
+*/
+QWidget* UiStopConditionDialog::createSpiWidget(
+        const CaptureSegmentCondition* condition)
+{
+    SpiCondition c(0, 1, 2, 3, QVector<int>());
+    const SpiCondition* spi = dynamic_cast<const SpiCondition*>(condition);
+    if (spi != NULL) {
+        c = *spi;
+    }
+
+    // Deallocation:
+    //   Ownership is taken over by w by the call to w->setLayout
+    QFormLayout* l = new QFormLayout();
+
+    mSpiSckBox = InputHelper::createSignalBox(this, c.sckSignalId());
+    l->addRow(tr("SCK: "), mSpiSckBox);
+
+    mSpiMosiBox = InputHelper::createSignalBox(this, c.mosiSignalId());
+    l->addRow(tr("MOSI: "), mSpiMosiBox);
+
+    mSpiMisoBox = InputHelper::createSignalBox(this, c.misoSignalId());
+    l->addRow(tr("MISO: "), mSpiMisoBox);
+
+    mSpiEnableBox = InputHelper::createSignalBox(this, c.enableSignalId());
+    l->addRow(tr("Enable: "), mSpiEnableBox);
+
+    mSpiModeBox = InputHelper::createSpiModeBox(this, c.mode());
+    l->addRow(tr("Mode: "), mSpiModeBox);
+
+    mSpiDataBitsBox = InputHelper::createSpiDataBitsBox(this, c.dataBits());
+    l->addRow(tr("Data bits: "), mSpiDataBitsBox);
+
+    mSpiEnableModeBox = InputHelper::createSpiEnableModeBox(this,
+                                                            c.enableMode());
+    l->addRow(tr("Enable mode: "), mSpiEnableModeBox);
+
+    QStringList values;
+    QVector<int> pattern = c.pattern();
+    for (int i = 0; i < pattern.size(); i++) {
+        values.append(QString::number(pattern.at(i), 16).toUpper());
+    }
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mSpiPatternBox = new QLineEdit(values.join(" "), this);
+    mSpiPatternBox->setToolTip(tr("Consecutive values separated by space"));
+    l->addRow(tr("Data (hex): "), mSpiPatternBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mSpiMatchMisoBox = new QCheckBox(tr("Match MISO instead of MOSI"), this);
+    mSpiMatchMisoBox->setChecked(c.matchMiso());
+    l->addRow(mSpiMatchMisoBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QWidget* w = new QWidget(this);
+    w->setLayout(l);
+
+    return w;
+}
+
+/*!
+    Create an input box for a hexadecimal \a value. The box is empty if
+    \a value is -1, that is, any value.
+*/
+QLineEdit* UiStopConditionDialog::createHexBox(QWidget* parent, int value)
+{
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QLineEdit* box = new QLineEdit(parent);
+    if (value != -1) {
+        box->setText(QString::number(value, 16).toUpper());
+    }
+
+    return box;
+}
+
+/*!
+    Converts the hexadecimal text in \a box to \a value. An empty box
+    results in -1. Returns false if the text isn't a valid number.
+*/
+bool UiStopConditionDialog::hexValue(QLineEdit* box, int &value)
+{
+    QString text = box->text().trimmed();
+    if (text.isEmpty()) {
+        value = -1;
+        return true;
+    }
+
+    bool ok = false;
+    value = text.toInt(&ok, 16);
+
+    return ok && value >= 0;
+}
+
+/*!
+    Converts the space separated hexadecimal values in \a box to
+    \a pattern. Returns false if any of the values isn't a valid number.
+*/
+bool UiStopConditionDialog::hexPattern(QLineEdit* box, QVector<int> &pattern)
+{
+    pattern.clear();
+
+    QStringList values = box->text().split(' ', QString::SkipEmptyParts);
+    for (int i = 0; i < values.size(); i++) {
+        bool ok = false;
+        int value = values.at(i).toInt(&ok, 16);
+        if (!ok || value < 0) return false;
+
+        pattern.append(value);
+    }
+
+    return true;
+}
+
+/*!
+    Called when the condition type has changed to the one at \a index in
+    the type box. Only the settings of the selected type are shown.
+*/
+void UiStopConditionDialog::typeChanged(int index)
+{
+    int type = mTypeBox->itemData(index).toInt();
+
+    mI2cWidget->setVisible(type == I2CConditionType);
+    mUartWidget->setVisible(type == UartConditionType);
+    mSpiWidget->setVisible(type == SpiConditionType);
+}
@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UISTOPCONDITIONDIALOG_H
+#define UISTOPCONDITIONDIALOG_H
+
+#include <QWidget>
+#include <QDialog>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QVector>
+
+#include "device/capturesegmentcondition.h"
+
+class UiStopConditionDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit UiStopConditionDialog(const CaptureSegmentCondition* condition,
+                                   QWidget *parent = 0);
+
+    CaptureSegmentCondition* condition() const;
+
+signals:
+
+public slots:
+    void accept();
+
+private:
+
+    enum ConditionType {
+        NoCondition,
+        I2CConditionType,
+        UartConditionType,
+        SpiConditionType
+    };
+
+    QComboBox* mTypeBox;
+    QWidget* mI2cWidget;
+    QWidget* mUartWidget;
+    QWidget* mSpiWidget;
+
+    QComboBox* mI2cSclBox;
+    QComboBox* mI2cSdaBox;
+    QComboBox* mI2cTypeBox;
+    QLineEdit* mI2cAddressBox;
+    QLineEdit* mI2cValueBox;
+
+    QComboBox* mUartSignalBox;
+    QLineEdit* mUartBaudRateBox;
+    QComboBox* mUartDataBitsBox;
+    QComboBox* mUartStopBitsBox;
+    QComboBox* mUartParityBox;
+    QComboBox* mUartTypeBox;
+    QLineEdit* mUartValueBox;
+
+    QComboBox* mSpiSckBox;
+    QComboBox* mSpiMosiBox;
+    QComboBox* mSpiMisoBox;
+    QComboBox* mSpiEnableBox;
+    QComboBox* mSpiModeBox;
+    QComboBox* mSpiDataBitsBox;
+    QComboBox* mSpiEnableModeBox;
+    QLineEdit* mSpiPatternBox;
+    QCheckBox* mSpiMatchMisoBox;
+
+    QWidget* createI2cWidget(const CaptureSegmentCondition* condition);
+    QWidget* createUartWidget(const CaptureSegmentCondition* condition);
+    QWidget* createSpiWidget(const CaptureSegmentCondition* condition);
+
+    static QLineEdit* createHexBox(QWidget* parent, int value);
+    static bool hexValue(QLineEdit* box, int &value);
+    static bool hexPattern(QLineEdit* box, QVector<int> &pattern);
+
+private slots:
+    void typeChanged(int index);
+
+};
+
+#endif // UISTOPCONDITIONDIALOG_H
@@ -0,0 +1,341 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "vcdexporttask.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+
+/*!
+    \class VcdExportTask
+    \brief Exports signal data to a Value Change Dump (VCD) file in the
+        thread pool.
+
+    \ingroup Capture
+
+    VCD is the format defined by IEEE 1364 for dumping simulation results
+    and can be viewed in waveform viewers such as GTKWave. Digital signals
+    are written as 1-bit wires and analog signals as real variables.
+
+    The file only contains the changes of the signals. The time of the next
+    change is found by merging the transition lists of the digital signals
+    with the positions where the analog codes change, which means that the
+    size of the file and the time needed to write it depend on the number
+    of changes and not on the number of samples.
+
+    The timescale is chosen so that the time of every sample is an exact
+    integer. This is possible for all sample rates that divide a power of
+    ten. For other sample rates the times are rounded to nanoseconds.
+*/
+
+/*!
+    \enum VcdExportTask::Constants
+
+    This enum describes integer constants used by the task.
+
+    \var VcdExportTask::Constants VcdExportTask::AnalogDecimals
+    The maximum number of decimals of an analog value
+
+    \var VcdExportTask::Constants VcdExportTask::MaxIdentifierLength
+    The maximum length of an identifier code
+
+    \var VcdExportTask::Constants VcdExportTask::MaxTimeDecimals
+    The smallest supported timescale as a (negative) power of ten, i.e.,
+    one femtosecond
+*/
+
+// the time unit, 1 ns, used when the sample rate doesn't divide a
+// power of ten
+static const int RoundedTimeDecimals = 9;
+
+/*!
+    Constructs a task that exports to \a fileName with the given \a parent.
+*/
+VcdExportTask::VcdExportTask(const QString &fileName, QObject *parent) :
+    ExportTask(fileName, true, parent)
+{
+    mNumChanges = 0;
+    mTimeDecimals = 0;
+    mTimeScale = 1;
+}
+
+/*!
+    \fn qint64 VcdExportTask::numChanges() const
+
+    Returns the number of exported value changes, not counting the initial
+    values.
+*/
+
+/*!
+    Returns the identifier code of the variable with \a index. The codes
+    consist of the printable ASCII characters '!' to '~'.
+*/
+QByteArray VcdExportTask::identifierCode(int index)
+{
+    const int numChars = '~' - '!' + 1;
+
+    QByteArray code;
+    do {
+        code.append((char)('!' + index % numChars));
+        index = index / numChars - 1;
+    } while (index >= 0);
+
+    return code;
+}
+
+/*!
+    Returns the VCD timescale for a time unit of 10^-\a decimals seconds.
+*/
+QByteArray VcdExportTask::timescale(int decimals)
+{
+    static const char* units[] = {"s", "ms", "us", "ns", "ps", "fs"};
+
+    decimals = qBound(0, decimals, (int)MaxTimeDecimals);
+    int unit = (decimals + 2) / 3;
+
+    QByteArray ts = QByteArray::number(powerOfTen(unit*3 - decimals));
+    ts.append(' ');
+    ts.append(units[unit]);
+
+    return ts;
+}
+
+/*!
+    Writes the header, the initial values and all changes. Returns false
+    if the export was cancelled or failed.
+*/
+bool VcdExportTask::exportData()
+{
+    const int n = numSamples();
+    int numVariables = 0;
+
+    prepareTime();
+
+    mDigital.clear();
+    for (int i = 0; i < mDigitalInputs.size(); i++) {
+        Variable v;
+        v.code = identifierCode(numVariables++);
+        v.transitions = mDigitalInputs.at(i).transitions;
+        v.next = v.transitions.upperBound(0);
+        v.level = v.transitions.levelAt(0);
+        mDigital.append(v);
+    }
+
+    mAnalog.clear();
+    for (int i = 0; i < mAnalogInputs.size(); i++) {
+        Variable v;
+        v.code = identifierCode(numVariables++);
+        v.data = mAnalogInputs.at(i).data;
+        v.next = (n > 0 ? nextAnalogChange(v.data, 0, n) : n);
+        v.level = 0;
+        mAnalog.append(v);
+    }
+
+    writeHeader();
+
+    if (n <= 0) return true;
+
+    // the longest line is an analog value: 'r', the value, a space,
+    // the identifier code and a newline
+    const int maxLineLength = 40 + MaxIdentifierLength;
+
+    //  >>> Initial values >>>>>>>>>>>>>>>>>>>
+
+    write("#0\n$dumpvars\n");
+    for (int i = 0; i < mDigital.size(); i++) {
+        char* p = reserve(maxLineLength);
+        commit(writeDigitalChange(p, mDigital.at(i)));
+    }
+    for (int i = 0; i < mAnalog.size(); i++) {
+        char* p = reserve(maxLineLength);
+        commit(writeAnalogChange(p, mAnalog.at(i), 0));
+    }
+    write("$end\n");
+
+    //  <<< Initial values <<<<<<<<<<<<<<<<<<<
+
+    const int maxChangeLength = maxLineLength
+            * (1 + mDigital.size() + mAnalog.size());
+    qint64 numTimes = 0;
+
+    forever {
+
+        // the time of the next change of any signal
+        int t = n;
+        for (int i = 0; i < mDigital.size(); i++) {
+            const Variable &v = mDigital.at(i);
+            if (v.next < v.transitions.size() && v.transitions.at(v.next) < t) {
+                t = (int)v.transitions.at(v.next);
+            }
+        }
+        for (int i = 0; i < mAnalog.size(); i++) {
+            if (mAnalog.at(i).next < t) {
+                t = mAnalog.at(i).next;
+            }
+        }
+
+        if (t >= n) break;
+
+        char* p = reserve(maxChangeLength);
+        *p++ = '#';
+        p = formatInt(p, time(t));
+        *p++ = '\n';
+
+        for (int i = 0; i < mDigital.size(); i++) {
+            Variable &v = mDigital[i];
+            if (v.next < v.transitions.size() && v.transitions.at(v.next) == t) {
+                v.level ^= 1;
+                v.next++;
+                p = writeDigitalChange(p, v);
+                mNumChanges++;
+            }
+        }
+        for (int i = 0; i < mAnalog.size(); i++) {
+            Variable &v = mAnalog[i];
+            if (v.next == t) {
+                p = writeAnalogChange(p, v, t);
+                v.next = nextAnalogChange(v.data, t, n);
+                mNumChanges++;
+            }
+        }
+
+        commit(p);
+
+        // do not check progress for each change since there may be
+        // millions of them
+        numTimes++;
+        if ((numTimes % 4096) == 0 && !updateProgress(t, n)) return false;
+    }
+
+    // mark the end of the last sample
+    char* p = reserve(maxLineLength);
+    *p++ = '#';
+    p = formatInt(p, time(n));
+    *p++ = '\n';
+    commit(p);
+
+    return updateProgress(n, n);
+}
+
+/*!
+    Finds the time unit to use for the sample rate.
+*/
+void VcdExportTask::prepareTime()
+{
+    mTimeDecimals = RoundedTimeDecimals;
+    mTimeScale = 0;
+
+    for (int d = 0; d <= MaxTimeDecimals; d++) {
+        qint64 p = powerOfTen(d);
+        if (p % mSampleRate == 0) {
+            // the time of the last sample must fit in 63 bits
+            if (p / mSampleRate <= 0x7fffffff) {
+                mTimeDecimals = d;
+                mTimeScale = p / mSampleRate;
+            }
+            break;
+        }
+    }
+}
+
+/*!
+    Writes the header with the declaration of all variables.
+*/
+void VcdExportTask::writeHeader()
+{
+    QByteArray h;
+
+    h.append("$date\n\t");
+    h.append(QDateTime::currentDateTime().toString().toLatin1());
+    h.append("\n$end\n");
+
+    h.append("$version\n\t");
+    h.append(QCoreApplication::applicationName().toLatin1());
+    h.append("\n$end\n");
+
+    h.append("$timescale ");
+    h.append(timescale(mTimeDecimals));
+    h.append(" $end\n");
+
+    h.append("$scope module ");
+    h.append(QCoreApplication::applicationName().toLatin1());
+    h.append(" $end\n");
+
+    for (int i = 0; i < mDigital.size(); i++) {
+        h.append("$var wire 1 ");
+        h.append(mDigital.at(i).code);
+        h.append(" D");
+        h.append(QByteArray::number(mDigitalInputs.at(i).id));
+        h.append(" $end\n");
+    }
+    for (int i = 0; i < mAnalog.size(); i++) {
+        h.append("$var real 64 ");
+        h.append(mAnalog.at(i).code);
+        h.append(" A");
+        h.append(QByteArray::number(mAnalogInputs.at(i).id));
+        h.append(" $end\n");
+    }
+
+    h.append("$upscope $end\n");
+    h.append("$enddefinitions $end\n");
+
+    write(h.constData(), h.size());
+}
+
+/*!
+    Returns the time of \a sample in the time unit of the file.
+*/
+qint64 VcdExportTask::time(int sample) const
+{
+    const qint64 whole = sample / mSampleRate;
+    const int remainder = sample % mSampleRate;
+
+    if (mTimeScale > 0) {
+        return whole*powerOfTen(mTimeDecimals) + remainder*mTimeScale;
+    }
+
+    const qint64 one = powerOfTen(mTimeDecimals);
+    return whole*one + (qint64)((double)remainder*one/mSampleRate + 0.5);
+}
+
+/*!
+    Writes the level of the digital variable \a v to \a p.
+*/
+char* VcdExportTask::writeDigitalChange(char *p, const Variable &v)
+{
+    *p++ = (char)('0' + v.level);
+    for (int i = 0; i < v.code.size(); i++) {
+        *p++ = v.code.at(i);
+    }
+    *p++ = '\n';
+
+    return p;
+}
+
+/*!
+    Writes the value of the analog variable \a v at \a sample to \a p.
+*/
+char* VcdExportTask::writeAnalogChange(char *p, const Variable &v, int sample)
+{
+    *p++ = 'r';
+    p = formatFixed(p, v.data.at(sample), AnalogDecimals);
+    *p++ = ' ';
+    for (int i = 0; i < v.code.size(); i++) {
+        *p++ = v.code.at(i);
+    }
+    *p++ = '\n';
+
+    return p;
+}
@@ -0,0 +1,71 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef VCDEXPORTTASK_H
+#define VCDEXPORTTASK_H
+
+#include <QList>
+
+#include "exporttask.h"
+
+class VcdExportTask : public ExportTask
+{
+    Q_OBJECT
+public:
+
+    enum Constants {
+        AnalogDecimals = 6,
+        MaxIdentifierLength = 4,
+        MaxTimeDecimals = 15
+    };
+
+    explicit VcdExportTask(const QString &fileName, QObject *parent = 0);
+
+    qint64 numChanges() const {return mNumChanges;}
+
+    static QByteArray identifierCode(int index);
+    static QByteArray timescale(int decimals);
+
+protected:
+    bool exportData();
+
+private:
+
+    struct Variable {
+        QByteArray code;
+        DigitalTransitions transitions;
+        AnalogSampleStore data;
+        // digital: position of next transition, analog: next change
+        int next;
+        int level;
+    };
+
+    QList<Variable> mDigital;
+    QList<Variable> mAnalog;
+    qint64 mNumChanges;
+
+    int mTimeDecimals;
+    qint64 mTimeScale;
+
+    void prepareTime();
+    void writeHeader();
+    qint64 time(int sample) const;
+
+    char* writeDigitalChange(char* p, const Variable &v);
+    char* writeAnalogChange(char* p, const Variable &v, int sample);
+
+};
+
+#endif // VCDEXPORTTASK_H
@@ -21,6 +21,7 @@
 const QString Configuration::ProjectFilename   = "Default.prj";
 const QString Configuration::ProjectFileExt    = ".prj";
 const QString Configuration::ProjectBinFileExt = ".eab";
+const QString Configuration::RecordingFileExt  = ".ltc";
 
 /*!
     \class Configuration
@@ -55,6 +56,12 @@ const QString Configuration::ProjectBinFileExt = ".eab";
     The file extension used for binary signal data.
 */
 
+/*!
+    \var const QString Configuration::RecordingFileExt
+
+    The file extension used for recordings of continuous captures.
+*/
+
 
 
 /*!
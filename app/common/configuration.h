@@ -33,6 +33,7 @@ public:
     static const QString ProjectFilename;
     static const QString ProjectFileExt;
     static const QString ProjectBinFileExt;
+    static const QString RecordingFileExt;
 
     QList<QString> colorSchemes();
     QString activeColorScheme();
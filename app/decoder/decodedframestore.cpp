@@ -0,0 +1,450 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "decodedframestore.h"
+
+#include <limits.h>
+
+#include <QtAlgorithms>
+
+/*!
+    \class DecodedFrameStore
+    \brief DecodedFrameStore holds the frames decoded by a protocol decoder
+        in a column per field.
+
+    \ingroup Analyzer
+
+    Every frame has a protocol specific type, flags, a value, a second value
+    (e.g. MISO for SPI), a start sample index and a stop sample index. Each
+    field is kept in its own array which makes the store compact and lets
+    painting, searching and exporting iterate over just the fields they
+    need through the const data pointers, without copying. All arrays are
+    implicitly shared so a store can be handed from a decoder in the thread
+    pool to the GUI thread without copying the frames. The second values
+    are only stored once a frame has a second value other than 0.
+
+    The frames are kept sorted on their start index. A decoder normally
+    appends the frames in this order, but a frame can be completed after a
+    shorter frame starting later, e.g. an I2C bus error in the middle of a
+    byte. Such frames are kept aside and merged into the store in one pass
+    by finish(), which the decoder must call when it is done. The time
+    needed to decode therefore stays proportional to the number of frames.
+    The sorted order makes it possible to find the frames starting around
+    a sample index with a binary search.
+
+    The store also keeps the largest sample index covered by each frame or
+    any frame before it. This value never decreases, which means that the
+    first frame ending at or after a sample index can also be found with a
+    binary search, even if frames overlap.
+
+    A frame without a stop index (-1) is considered to end where the next
+    frame starts. The last frame without a stop index is considered to
+    never end.
+*/
+
+/*!
+    \enum DecodedFrameStore::Flags
+
+    This enum describes the flags that can be set for a frame.
+
+    \var DecodedFrameStore::Flags DecodedFrameStore::FlagError
+    The frame describes a protocol error
+*/
+
+/*!
+    Constructs an empty store.
+*/
+DecodedFrameStore::DecodedFrameStore()
+{
+}
+
+/*!
+    Removes all frames.
+*/
+void DecodedFrameStore::clear()
+{
+    mTypes.clear();
+    mFlags.clear();
+    mValues.clear();
+    mSecondValues.clear();
+    mStartIdx.clear();
+    mStopIdx.clear();
+    mReach.clear();
+    mPending.clear();
+}
+
+/*!
+    Reserves space for \a numFrames frames.
+*/
+void DecodedFrameStore::reserve(int numFrames)
+{
+    mTypes.reserve(numFrames);
+    mFlags.reserve(numFrames);
+    mValues.reserve(numFrames);
+    mSecondValues.reserve(numFrames);
+    mStartIdx.reserve(numFrames);
+    mStopIdx.reserve(numFrames);
+    mReach.reserve(numFrames);
+}
+
+/*!
+    Releases any memory not needed to store the frames.
+*/
+void DecodedFrameStore::squeeze()
+{
+    mTypes.squeeze();
+    mFlags.squeeze();
+    mValues.squeeze();
+    mSecondValues.squeeze();
+    mStartIdx.squeeze();
+    mStopIdx.squeeze();
+    mReach.squeeze();
+    mPending.squeeze();
+}
+
+/*!
+    \fn int DecodedFrameStore::size() const
+
+    Returns the number of frames.
+*/
+
+/*!
+    \fn bool DecodedFrameStore::isEmpty() const
+
+    Returns true if there are no frames.
+*/
+
+/*!
+    Appends a frame of the given \a type starting at \a startIdx and ending
+    at \a stopIdx (-1 if the frame has no duration) with \a value,
+    \a secondValue and \a flags.
+
+    A frame starting before the last frame in the store is kept aside and
+    isn't part of the store until finish() has been called.
+*/
+void DecodedFrameStore::append(int type, int startIdx, int stopIdx,
+                               int value, int secondValue, int flags)
+{
+    if (!mStartIdx.isEmpty() && mStartIdx.last() > startIdx) {
+        PendingFrame f;
+        f.type = type;
+        f.flags = flags;
+        f.value = value;
+        f.secondValue = secondValue;
+        f.startIdx = startIdx;
+        f.stopIdx = stopIdx;
+        f.order = mPending.size();
+        mPending.append(f);
+        return;
+    }
+
+    appendSorted(type, startIdx, stopIdx, value, secondValue, flags);
+
+    // the frame before may end where this frame starts
+    updateReach(qMax(mReach.size()-2, 0));
+}
+
+/*!
+    Merges the frames appended out of order into the store. Frames with the
+    same start index are kept in the order they were appended. Must be
+    called when all frames have been appended.
+
+    The frames in the store are sorted since every frame appended to the
+    store starts at or after the last one. The few pending frames are
+    sorted separately and then the two sorted lists are merged.
+*/
+void DecodedFrameStore::finish()
+{
+    if (mPending.isEmpty()) return;
+
+    qSort(mPending.begin(), mPending.end());
+
+    DecodedFrameStore sorted;
+    sorted.reserve(size() + mPending.size());
+
+    const int* start = mStartIdx.constData();
+    const PendingFrame* pending = mPending.constData();
+    const int numSorted = size();
+    const int numPending = mPending.size();
+
+    int i = 0;
+    int p = 0;
+    while (i < numSorted || p < numPending) {
+
+        // a pending frame was appended after the frames in the store
+        // with the same start index
+        if (p < numPending
+                && (i == numSorted || pending[p].startIdx < start[i])) {
+            const PendingFrame &f = pending[p++];
+            sorted.appendSorted(f.type, f.startIdx, f.stopIdx, f.value,
+                                f.secondValue, f.flags);
+        }
+        else {
+            sorted.appendSorted(mTypes.at(i), start[i], mStopIdx.at(i),
+                                mValues.at(i), secondValue(i), mFlags.at(i));
+            i++;
+        }
+    }
+
+    sorted.updateReach(0);
+
+    *this = sorted;
+}
+
+/*!
+    \fn int DecodedFrameStore::numPending() const
+
+    Returns the number of frames appended out of order that will be merged
+    into the store by finish().
+*/
+
+/*!
+    Appends a frame at the end of the store without updating the reach.
+    The frame must not start before the last frame.
+*/
+void DecodedFrameStore::appendSorted(int type, int startIdx, int stopIdx,
+                                     int value, int secondValue, int flags)
+{
+    mTypes.append((quint8)type);
+    mFlags.append((quint8)flags);
+    mValues.append(value);
+
+    // the second value is only stored once a frame has one
+    if (secondValue != 0 || !mSecondValues.isEmpty()) {
+        if (mSecondValues.isEmpty()) {
+            mSecondValues.fill(0, mStartIdx.size());
+        }
+        mSecondValues.append(secondValue);
+    }
+
+    mStartIdx.append(startIdx);
+    mStopIdx.append(stopIdx);
+    mReach.append(0);
+}
+
+/*!
+    \fn int DecodedFrameStore::type(int i) const
+
+    Returns the protocol specific type of frame \a i.
+*/
+
+/*!
+    \fn int DecodedFrameStore::flags(int i) const
+
+    Returns the flags of frame \a i.
+*/
+
+/*!
+    \fn bool DecodedFrameStore::isError(int i) const
+
+    Returns true if frame \a i describes a protocol error.
+*/
+
+/*!
+    \fn int DecodedFrameStore::value(int i) const
+
+    Returns the value of frame \a i.
+*/
+
+/*!
+    Returns the second value of frame \a i.
+*/
+int DecodedFrameStore::secondValue(int i) const
+{
+    if (mSecondValues.isEmpty()) {
+        return 0;
+    }
+
+    return mSecondValues.at(i);
+}
+
+/*!
+    \fn int DecodedFrameStore::startIdx(int i) const
+
+    Returns the sample index where frame \a i starts.
+*/
+
+/*!
+    \fn int DecodedFrameStore::stopIdx(int i) const
+
+    Returns the sample index where frame \a i stops or -1 if the frame
+    doesn't have a duration.
+*/
+
+/*!
+    Returns the sample index where frame \a i ends. This is the stop index
+    or, for a frame without a stop index, the start of the next frame.
+    INT_MAX is returned for a last frame without a stop index.
+*/
+int DecodedFrameStore::endIdx(int i) const
+{
+    int stop = mStopIdx.at(i);
+    if (stop != -1) {
+        return stop;
+    }
+
+    if (i+1 < mStartIdx.size()) {
+        return mStartIdx.at(i+1);
+    }
+
+    return INT_MAX;
+}
+
+/*!
+    \fn const quint8* DecodedFrameStore::constTypeData() const
+
+    Returns a pointer to the types of all frames.
+*/
+
+/*!
+    \fn const quint8* DecodedFrameStore::constFlagData() const
+
+    Returns a pointer to the flags of all frames.
+*/
+
+/*!
+    \fn const int* DecodedFrameStore::constValueData() const
+
+    Returns a pointer to the values of all frames.
+*/
+
+/*!
+    \fn const int* DecodedFrameStore::constSecondValueData() const
+
+    Returns a pointer to the second values of all frames. NULL is returned
+    if none of the frames has a second value other than 0.
+*/
+
+/*!
+    \fn const int* DecodedFrameStore::constStartData() const
+
+    Returns a pointer to the start indexes of all frames.
+*/
+
+/*!
+    \fn const int* DecodedFrameStore::constStopData() const
+
+    Returns a pointer to the stop indexes of all frames.
+*/
+
+/*!
+    Returns the position of the first frame starting at or after
+    \a sampleIdx. size() is returned if there is no such frame.
+*/
+int DecodedFrameStore::lowerBound(int sampleIdx) const
+{
+    const int* data = mStartIdx.constData();
+    int low = 0;
+    int high = mStartIdx.size();
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (data[mid] < sampleIdx) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/*!
+    Returns the position of the first frame starting after \a sampleIdx.
+    size() is returned if there is no such frame.
+*/
+int DecodedFrameStore::upperBound(int sampleIdx) const
+{
+    const int* data = mStartIdx.constData();
+    int low = 0;
+    int high = mStartIdx.size();
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (data[mid] <= sampleIdx) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/*!
+    Returns the position of the first frame that ends at or after
+    \a sampleIdx, e.g. the first frame to paint when \a sampleIdx is at
+    the left edge of the plot area. size() is returned if there is no
+    such frame.
+*/
+int DecodedFrameStore::firstEndingAt(int sampleIdx) const
+{
+    const int* reach = mReach.constData();
+    int low = 0;
+    int high = mReach.size();
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (reach[mid] < sampleIdx) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/*!
+    Finds the frames that may overlap the samples \a fromIdx to \a toIdx
+    (inclusive). The frames are given as the range from \a first up to, but
+    not including, \a last. Every frame overlapping the samples is within
+    the range. When frames overlap each other the range may also include
+    a frame that ends before \a fromIdx, which can be checked with endIdx().
+*/
+void DecodedFrameStore::range(int fromIdx, int toIdx,
+                              int &first, int &last) const
+{
+    first = firstEndingAt(fromIdx);
+    last = qMax(first, upperBound(toIdx));
+}
+
+/*!
+    Recalculates the largest sample index covered for frame \a from and all
+    frames after it.
+*/
+void DecodedFrameStore::updateReach(int from)
+{
+    int reach = (from > 0 ? mReach.at(from-1) : INT_MIN);
+
+    for (int i = from; i < mReach.size(); i++) {
+        reach = qMax(reach, endIdx(i));
+        mReach[i] = reach;
+    }
+}
+
+/*!
+    Returns the number of bytes used to store the frames.
+*/
+qint64 DecodedFrameStore::memoryUsage() const
+{
+    return (qint64)(mTypes.capacity() + mFlags.capacity())*sizeof(quint8)
+            + (qint64)(mValues.capacity() + mSecondValues.capacity()
+                       + mStartIdx.capacity() + mStopIdx.capacity()
+                       + mReach.capacity())*sizeof(int);
+}
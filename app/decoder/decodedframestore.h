@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DECODEDFRAMESTORE_H
+#define DECODEDFRAMESTORE_H
+
+#include <QtGlobal>
+#include <QVector>
+
+class DecodedFrameStore
+{
+public:
+
+    enum Flags {
+        FlagError = 0x01
+    };
+
+    DecodedFrameStore();
+
+    void clear();
+    void reserve(int numFrames);
+    void squeeze();
+
+    int size() const {return mStartIdx.size();}
+    bool isEmpty() const {return mStartIdx.isEmpty();}
+
+    void append(int type, int startIdx, int stopIdx, int value,
+                int secondValue = 0, int flags = 0);
+    void finish();
+    int numPending() const {return mPending.size();}
+
+    int type(int i) const {return mTypes.at(i);}
+    int flags(int i) const {return mFlags.at(i);}
+    bool isError(int i) const {return (mFlags.at(i) & FlagError) != 0;}
+    int value(int i) const {return mValues.at(i);}
+    int secondValue(int i) const;
+    int startIdx(int i) const {return mStartIdx.at(i);}
+    int stopIdx(int i) const {return mStopIdx.at(i);}
+    int endIdx(int i) const;
+
+    const quint8* constTypeData() const {return mTypes.constData();}
+    const quint8* constFlagData() const {return mFlags.constData();}
+    const int* constValueData() const {return mValues.constData();}
+    const int* constSecondValueData() const
+        {return (mSecondValues.isEmpty() ? NULL : mSecondValues.constData());}
+    const int* constStartData() const {return mStartIdx.constData();}
+    const int* constStopData() const {return mStopIdx.constData();}
+
+    int lowerBound(int sampleIdx) const;
+    int upperBound(int sampleIdx) const;
+    int firstEndingAt(int sampleIdx) const;
+    void range(int fromIdx, int toIdx, int &first, int &last) const;
+
+    qint64 memoryUsage() const;
+
+private:
+
+    struct PendingFrame {
+        int type;
+        int flags;
+        int value;
+        int secondValue;
+        int startIdx;
+        int stopIdx;
+        int order;
+
+        bool operator<(const PendingFrame &other) const {
+            return (startIdx < other.startIdx
+                    || (startIdx == other.startIdx && order < other.order));
+        }
+    };
+
+    QVector<quint8> mTypes;
+    QVector<quint8> mFlags;
+    QVector<int> mValues;
+    QVector<int> mSecondValues;
+    QVector<int> mStartIdx;
+    QVector<int> mStopIdx;
+
+    // the largest sample index covered by frame 0..i
+    QVector<int> mReach;
+
+    // frames appended out of order, merged by finish()
+    QVector<PendingFrame> mPending;
+
+    void appendSorted(int type, int startIdx, int stopIdx, int value,
+                      int secondValue, int flags);
+    void updateReach(int from);
+
+};
+
+#endif // DECODEDFRAMESTORE_H
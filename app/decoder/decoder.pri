@@ -0,0 +1,25 @@
+# Protocol decoders and the signal data classes they depend on. These files
+# only need QtCore and are used both by the application (LabTool.pro) and by
+# the headless static library (decoder.pro).
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    $$PWD/protocoldecoder.cpp \
+    $$PWD/decodedframestore.cpp \
+    $$PWD/i2cdecoder.cpp \
+    $$PWD/spidecoder.cpp \
+    $$PWD/uartdecoder.cpp \
+    $$PWD/../common/types.cpp \
+    $$PWD/../device/digitalsamplestore.cpp \
+    $$PWD/../device/digitaltransitions.cpp
+
+HEADERS += \
+    $$PWD/protocoldecoder.h \
+    $$PWD/decodedframestore.h \
+    $$PWD/i2cdecoder.h \
+    $$PWD/spidecoder.h \
+    $$PWD/uartdecoder.h \
+    $$PWD/../common/types.h \
+    $$PWD/../device/digitalsamplestore.h \
+    $$PWD/../device/digitaltransitions.h
@@ -0,0 +1,10 @@
+# Headless build of the protocol decoders as a static library, e.g. for
+# batch decoding of saved captures. Only QtCore is needed.
+
+TEMPLATE = lib
+CONFIG += staticlib
+TARGET = labtooldecoder
+
+QT -= gui
+
+include(decoder.pri)
@@ -0,0 +1,358 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "i2cdecoder.h"
+
+#include <QDebug>
+
+/*!
+    \class I2CDecoder
+    \brief Decodes I2C protocol data.
+
+    \ingroup Analyzer
+
+    Only the sample indexes where any of the SCL and SDA signals has a
+    transition are visited so the decoding time depends on the bus activity
+    and not on the sample rate.
+*/
+
+/*!
+    Constructs the decoder without any signal data.
+*/
+I2CDecoder::I2CDecoder()
+{
+}
+
+/*!
+    Set the signal data to decode to the transitions \a sclData and
+    \a sdaData. The data is implicitly shared so the copy is cheap.
+*/
+void I2CDecoder::setSignals(const DigitalTransitions &sclData,
+                            const DigitalTransitions &sdaData)
+{
+    mSclData = sclData;
+    mSdaData = sdaData;
+}
+
+/*!
+    \fn DecodedFrameStore I2CDecoder::frames() const
+
+    Returns the decoded I2C frames. The type of each frame is one of the
+    I2CItem::I2CType values.
+*/
+
+/*!
+    Decodes the signal data.
+*/
+void I2CDecoder::decode()
+{
+    mFrames.clear();
+
+    /*
+        Specification details
+
+        1. SDA line can only change when SCL line is LOW for data
+        2. START = HIGH to LOW on SDA line while SCL line is HIGH
+        3. STOP  = LOW to HIGH on SDA line while SCL line is HIGH
+        4. Each byte put on the SDA line must be 8 bits long
+        5. Each byte is followed by an Acknowledge bit (ACK or NACK)
+        6. ACK  = SDA line LOW during ninth clock pulse
+        7. NACK = SDA line HIGH during ninth clock pulse
+        8. 7-bit Address:
+              7 bits + 1 bit which indicate R/W ( Read (1) or Write (0) )
+        9. 10-bit Address:
+              - The 7 first bits of the first byte are the combination 1111 0XX
+                of which the last two bits are the two most-significant bits of
+                the 10-bit address; the eight bit of the first byte is the R/W
+                bit.
+              - As always a byte is followed by an Acknowledge bit
+              - The second byte is the 8 least-significant bits of the 10-bit
+                address.
+
+     */
+
+    // the decoder state only changes when SCL or SDA changes. Instead
+    // of visiting every sample the transitions of both signals are merged
+    // and only the sample indexes with a transition are visited.
+
+    const int startPos = startPosition();
+    const int end = (int)mSclData.numSamples();
+    const int numSclTrans = mSclData.size();
+    const int numSdaTrans = mSdaData.size();
+
+    // position of the next transition for each signal
+    int sclPos = mSclData.upperBound(startPos);
+    int sdaPos = mSdaData.upperBound(startPos);
+
+    // the first visited sample is compared with the first sample of the
+    // signals
+    int i = startPos;
+    int sda = mSdaData.levelAt(i);
+    int scl = mSclData.levelAt(i);
+    int prevSda = mSdaData.initialLevel();
+    int prevScl = mSclData.initialLevel();
+    int sclHLIdx = -1;
+    int numVisited = 0;
+
+    int data = 0;
+    int dataBitCnt = 8;
+    int startIdx = -1;
+
+    bool findAddress = false;
+    bool tenBit = false;
+    int address = 0;
+    int dir = 0;
+
+    int numErrors = 0;
+    bool errorFound = false;
+
+    // start to analyze when start condition has been detected
+    bool detectStart = true;
+    bool startFound = false;
+
+    while (i < end) {
+
+        // stop as soon as possible if a newer capture has arrived
+        if ((++numVisited % CancelCheckInterval) == 0 && isCancelled()) break;
+
+        //
+        // HIGH -> LOW transition for SCL starts a bit transaction. A transition
+        // on SDA is only allowed to occur when SCL is low (except for START/STOP)
+        //
+        if (prevScl > scl) {
+
+            do {
+
+                if (detectStart && !startFound) break;
+
+                // record the HIGH-LOW transition index for SCL.
+                sclHLIdx = i;
+
+                // record start index for a data byte
+                if (dataBitCnt == 8) {
+                    startIdx = i;
+                    break;
+                }
+
+                // nothing to do until dataBitCnt = 0
+                if (dataBitCnt != 0) {
+                    break;
+                }
+
+                // ---
+                // at this point a complete byte has been received
+                // ---
+
+                if (findAddress) {
+                    I2CItem::I2CType i2cType = I2CItem::I2C_7_ADDRESS_WRITE;
+
+                    // 10-bit address: See Spec 9.
+                    if ((data & 0xF8) == 0xF0) {
+                        tenBit = true;
+                        address = ((data & 0x06) << 7);
+
+                        // direction (R/W) is defined by bit 0 in the first byte
+                        dir = (data & 0x01);
+
+                        if (dir) {
+                            i2cType = I2CItem::I2C_10_ADDRESS_READ;
+                        }
+                        else {
+                            i2cType = I2CItem::I2C_10_ADDRESS_WRITE;
+                        }
+                    }
+
+                    // 7-bit address or second byte for 10-bit address
+                    else {
+
+                        if (tenBit) {
+                            address |= (data & 0xFF);
+                        }
+
+                        // 7-bit address
+                        else {
+
+                            address = ((data >> 1) & 0xFF);
+
+                            // direction (R/W) is defined by bit 0 in the address byte
+                            dir = (data & 0x01);
+
+                            if (dir) {
+                                i2cType = I2CItem::I2C_7_ADDRESS_READ;
+                            }
+                            else {
+                                i2cType = I2CItem::I2C_7_ADDRESS_WRITE;
+                            }
+
+                        }
+
+
+                        mFrames.append(i2cType, startIdx, i, address);
+
+
+                        tenBit = false;
+                        findAddress = false;
+                    }
+
+                }
+
+                // DATA
+                else {
+
+                    mFrames.append(I2CItem::I2C_DATA, startIdx, i, data);
+                }
+
+
+
+           } while (0);
+
+        }
+
+
+        //
+        // LOW -> HIGH transition for SCL. SDA should remain stable when SCL
+        // is high to detect a correct bit value.
+        //
+        else if (prevScl < scl){
+
+            do {
+
+                if (detectStart && !startFound) break;
+
+                // SDA must not change when SCL is high (See Spec 1.)
+                if (prevSda != sda) {
+
+                    errorFound = true;
+                    mFrames.append(I2CItem::I2C_ERROR, i, -1, -1, 0,
+                                   DecodedFrameStore::FlagError);
+
+                    numErrors++;
+                    break;
+                }
+
+                // read data
+                if (dataBitCnt > 0) {
+                    // the left-shift is a bit index (0-7)
+                    // -> decrease dataBitCnt before shifting
+                    data |= (sda << (--dataBitCnt));
+                }
+
+                // check acknowledge bit
+                else {
+
+                    // ACK
+                    if (sda == 0) {
+
+                        // using the last HIGH-LOW transition for SCL as start index
+                        mFrames.append(I2CItem::I2C_ACK, sclHLIdx, -1, -1);
+                    }
+
+                    // NACK
+                    else {
+
+                        // using the last HIGH-LOW transition for SCL as start index
+                        mFrames.append(I2CItem::I2C_NACK, sclHLIdx, -1, -1);
+                    }
+
+
+                    // ready to read a new byte
+                    dataBitCnt = 8;
+                    data = 0;
+                }
+
+
+
+           } while (0);
+
+        }
+
+
+        //
+        // Detect Start and Stop conditions. Transition while SCL is HIGH
+        //
+        if (!errorFound && scl == 1 && sda != prevSda) {
+
+            do {
+
+                // This should not occur while reading a data byte
+                // If it does it is a bus error (See Spec 1.)
+                if (dataBitCnt > 0 && dataBitCnt < 7) {
+
+                    // reset reading data
+                    dataBitCnt = 8;
+
+                    mFrames.append(I2CItem::I2C_ERROR, i, -1, -1, 0,
+                                   DecodedFrameStore::FlagError);
+
+                    numErrors++;
+                    break;
+                }
+
+                // HIGH -> LOW = Start
+                if (prevSda > sda) {
+
+                    mFrames.append(I2CItem::I2C_START, i, -1, -1);
+
+                    findAddress = true;
+                    startFound = true;
+                }
+
+                // LOW -> HIGH = Stop
+                else {
+
+                    if (!detectStart || (detectStart&&startFound)) {
+                        mFrames.append(I2CItem::I2C_STOP, i, -1, -1);
+                    }
+
+                }
+
+                data = 0;
+                dataBitCnt = 8;
+
+            } while (0);
+        }
+
+
+        prevSda = sda;
+        prevScl = scl;
+        errorFound = false;
+
+        if (numErrors > MaxNumBusErrors) {
+            qDebug() << "Too many bus errors "<<numErrors<<" > " << MaxNumBusErrors;
+            break;
+        }
+
+        // step to the next transition on any of the signals
+        int nextScl = (sclPos < numSclTrans ? (int)mSclData.at(sclPos) : end);
+        int nextSda = (sdaPos < numSdaTrans ? (int)mSdaData.at(sdaPos) : end);
+
+        i = qMin(nextScl, nextSda);
+
+        if (i == nextScl && sclPos < numSclTrans) {
+            scl ^= 1;
+            sclPos++;
+        }
+        if (i == nextSda && sdaPos < numSdaTrans) {
+            sda ^= 1;
+            sdaPos++;
+        }
+
+    }
+
+    mFrames.finish();
+
+    // the frames may be kept for a long time by the analyzer
+    mFrames.squeeze();
+}
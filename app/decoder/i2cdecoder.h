@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef I2CDECODER_H
+#define I2CDECODER_H
+
+#include "decoder/decodedframestore.h"
+#include "decoder/protocoldecoder.h"
+#include "device/digitaltransitions.h"
+
+/*!
+    \class I2CItem
+    \brief Frame types decoded by the I2CDecoder.
+
+    \ingroup Analyzer
+
+    \internal
+
+    The type of every frame in the DecodedFrameStore of a I2CDecoder is one of
+    the I2CType values.
+*/
+class I2CItem {
+public:
+
+    /*!
+        I2C protocol types
+    */
+    enum I2CType {
+        I2C_START,
+        I2C_STOP,
+        I2C_ACK,
+        I2C_NACK,
+        I2C_DATA,
+        I2C_7_ADDRESS_WRITE,
+        I2C_7_ADDRESS_READ,
+        I2C_10_ADDRESS_WRITE,
+        I2C_10_ADDRESS_READ,
+        I2C_ERROR
+    };
+};
+
+class I2CDecoder : public ProtocolDecoder
+{
+public:
+    I2CDecoder();
+
+    void setSignals(const DigitalTransitions &sclData,
+                    const DigitalTransitions &sdaData);
+
+    void decode();
+
+    DecodedFrameStore frames() const {return mFrames;}
+
+private:
+
+    enum {
+        MaxNumBusErrors = 5
+    };
+
+    DigitalTransitions mSclData;
+    DigitalTransitions mSdaData;
+
+    DecodedFrameStore mFrames;
+
+};
+
+#endif // I2CDECODER_H
@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "protocoldecoder.h"
+
+/*!
+    \class ProtocolDecoder
+    \brief This is the base class for the protocol decoders.
+
+    \ingroup Analyzer
+
+    A decoder turns the transitions of one or more digital signals into a
+    list of decoded frames. It only depends on QtCore and the signal data
+    classes in the device directory, which makes it possible to build the
+    decoders as a static library (see decoder.pro) and run them without
+    a user interface, e.g. for batch decoding of saved captures or in unit
+    tests.
+
+    In the application a decoder is owned by an AnalyzerTask which runs
+    decode() in a thread from the thread pool and passes its cancellation
+    flag with setCancelFlag(). The analyzer widgets only configure the
+    decoder and paint the frames.
+
+    A subclass should check isCancelled() every CancelCheckInterval visited
+    positions and return as soon as possible when it is set.
+*/
+
+/*!
+    Constructs the decoder. The sample rate is 0 and decoding starts at the
+    first sample.
+*/
+ProtocolDecoder::ProtocolDecoder()
+{
+    mSampleRate = 0;
+    mStartPos = 0;
+    mCancelled = NULL;
+}
+
+/*!
+    Deletes the decoder.
+*/
+ProtocolDecoder::~ProtocolDecoder()
+{
+}
+
+/*!
+    \fn void ProtocolDecoder::setSampleRate(int sampleRate)
+
+    Set the rate of the decoded signal data to \a sampleRate samples per
+    second.
+*/
+
+/*!
+    \fn int ProtocolDecoder::sampleRate() const
+
+    Returns the sample rate of the decoded signal data.
+*/
+
+/*!
+    \fn void ProtocolDecoder::setStartPosition(int startPos)
+
+    Set the sample index where the decoding starts to \a startPos.
+*/
+
+/*!
+    \fn int ProtocolDecoder::startPosition() const
+
+    Returns the sample index where the decoding starts.
+*/
+
+/*!
+    \fn void ProtocolDecoder::setCancelFlag(const QAtomicInt* cancelled)
+
+    Use \a cancelled to find out if the decoding should be stopped. The
+    decoding is stopped when the flag is set to a non-zero value. The flag
+    is not owned by the decoder and must be valid until decode() returns.
+    NULL means that the decoding can't be cancelled.
+*/
+
+/*!
+    Returns true if the decoding has been cancelled.
+*/
+bool ProtocolDecoder::isCancelled() const
+{
+    return mCancelled != NULL && mCancelled->loadAcquire() != 0;
+}
+
+/*!
+    \fn virtual void ProtocolDecoder::decode() = 0
+
+    Decodes the signal data. The frames from a previous call are removed.
+*/
@@ -0,0 +1,54 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef PROTOCOLDECODER_H
+#define PROTOCOLDECODER_H
+
+#include <QtGlobal>
+#include <QAtomicInt>
+
+class ProtocolDecoder
+{
+public:
+    ProtocolDecoder();
+    virtual ~ProtocolDecoder();
+
+    void setSampleRate(int sampleRate) {mSampleRate = sampleRate;}
+    int sampleRate() const {return mSampleRate;}
+
+    void setStartPosition(int startPos) {mStartPos = startPos;}
+    int startPosition() const {return mStartPos;}
+
+    void setCancelFlag(const QAtomicInt* cancelled) {mCancelled = cancelled;}
+    bool isCancelled() const;
+
+    virtual void decode() = 0;
+
+protected:
+
+    enum {
+        // number of visited positions between checks for cancellation
+        CancelCheckInterval = 65536
+    };
+
+private:
+
+    int mSampleRate;
+    int mStartPos;
+    const QAtomicInt* mCancelled;
+
+};
+
+#endif // PROTOCOLDECODER_H
@@ -0,0 +1,265 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "spidecoder.h"
+
+/*!
+    \class SpiDecoder
+    \brief Decodes SPI protocol data.
+
+    \ingroup Analyzer
+
+    The decoder state only changes on SCK and Enable transitions so the
+    transition lists of the signals are merged and only those sample
+    indexes are visited. The decoding time therefore depends on the bus
+    activity and not on the sample rate.
+*/
+
+/*!
+    Constructs the decoder without any signal data. The default settings
+    are 8 data bits, mode 0 and an active low enable signal.
+*/
+SpiDecoder::SpiDecoder()
+{
+    mDataBits = 8;
+    mMode = Types::SpiMode_0;
+    mEnableMode = Types::SpiEnableLow;
+}
+
+/*!
+    Set the signal data to decode to the transitions \a sckData,
+    \a mosiData, \a misoData and \a enableData. The data is implicitly
+    shared so the copy is cheap.
+*/
+void SpiDecoder::setSignals(const DigitalTransitions &sckData,
+                            const DigitalTransitions &mosiData,
+                            const DigitalTransitions &misoData,
+                            const DigitalTransitions &enableData)
+{
+    mSckData = sckData;
+    mMosiData = mosiData;
+    mMisoData = misoData;
+    mEnableData = enableData;
+}
+
+/*!
+    \fn void SpiDecoder::setDataBits(int bits)
+
+    Set the number of data bits to \a bits.
+*/
+
+/*!
+    \fn void SpiDecoder::setMode(Types::SpiMode mode)
+
+    Set the SPI \a mode.
+*/
+
+/*!
+    \fn void SpiDecoder::setEnableMode(Types::SpiEnable mode)
+
+    Set the enable \a mode.
+*/
+
+/*!
+    \fn DecodedFrameStore SpiDecoder::frames() const
+
+    Returns the decoded SPI frames. The type of each frame is one of the
+    SpiItem::ItemType values. The value of a frame is the MOSI value and the
+    second value is the MISO value.
+*/
+
+/*!
+    Decodes the signal data.
+
+    A frame error is added when the enable signal is set to off before all
+    data bits of a value have been received. The bits of the incomplete
+    value are discarded and the decoding continues with the next value.
+*/
+void SpiDecoder::decode()
+{
+    mFrames.clear();
+
+    bool findCsOn = true;
+    int pos = startPosition();
+
+    // A sample without a transition on SCK or Enable never changes the
+    // decoder state. The four transition lists are merged in time order:
+    // SCK and Enable decide which sample index to visit next while the
+    // MOSI and MISO cursors are only moved forward to get the data levels
+    // at that index.
+
+    const qint64 end = mSckData.numSamples();
+
+    const qint64* sckTrans = mSckData.constData();
+    const qint64* csTrans = mEnableData.constData();
+    const qint64* mosiTrans = mMosiData.constData();
+    const qint64* misoTrans = mMisoData.constData();
+    const int numSckTrans = mSckData.size();
+    const int numCsTrans = mEnableData.size();
+    const int numMosiTrans = mMosiData.size();
+    const int numMisoTrans = mMisoData.size();
+
+    // position of the next transition for each signal
+    int sckPos = mSckData.upperBound(pos);
+    int csPos = mEnableData.upperBound(pos);
+    int mosiPos = mMosiData.upperBound(pos);
+    int misoPos = mMisoData.upperBound(pos);
+    int numVisited = 0;
+
+    // the first sample is compared with itself -> nothing changes there
+    int currCs = mEnableData.levelAt(pos);
+    bool csChanged = false;
+    bool csOff = false;
+
+    bool sckChanged = false;
+    int sckChangeNum = 0;
+
+    int mosi = mMosiData.levelAt(pos);
+    int miso = mMisoData.levelAt(pos);
+    int mosiValue = 0;
+    int misoValue = 0;
+    int dataBitCnt = mDataBits;
+
+    int startIdx = -1;
+
+    // CPHA = 0 -> capture data on first clock transition (otherwise second)
+    bool captureOnFirst = (mMode == Types::SpiMode_0
+                           || mMode == Types::SpiMode_2);
+
+
+
+    while (true) {
+
+        qint64 nextSck = (sckPos < numSckTrans ? sckTrans[sckPos] : end);
+        qint64 nextCs = (csPos < numCsTrans ? csTrans[csPos] : end);
+
+        // reached end of data
+        if (nextSck >= end && nextCs >= end) break;
+
+        // stop as soon as possible if a newer capture has arrived
+        if ((++numVisited % CancelCheckInterval) == 0 && isCancelled()) break;
+
+        pos = (int)qMin(nextSck, nextCs);
+
+        csChanged = (nextCs == pos);
+        if (csChanged) {
+            currCs ^= 1;
+            csPos++;
+        }
+
+        sckChanged = (nextSck == pos);
+        if (sckChanged) {
+            sckPos++;
+            sckChangeNum++;
+        }
+
+        while (mosiPos < numMosiTrans && mosiTrans[mosiPos] <= pos) {
+            mosi ^= 1;
+            mosiPos++;
+        }
+        while (misoPos < numMisoTrans && misoTrans[misoPos] <= pos) {
+            miso ^= 1;
+            misoPos++;
+        }
+
+
+        do {
+
+            /*
+             * Look for Enable on
+             */
+
+            if (findCsOn) {
+
+                if (csChanged &&
+                        ( ((currCs == 0 && mEnableMode == Types::SpiEnableLow) ||
+                          (currCs == 1 && mEnableMode == Types::SpiEnableHigh))))
+                {
+                    findCsOn = false;
+                }
+
+                else {
+                    // we've not found enable yet -> get next sample
+                    break;
+                }
+            }
+
+            /*
+             * Check if Enable is set to off
+             */
+
+            csOff = (csChanged && ((currCs == 1 && mEnableMode == Types::SpiEnableLow)
+                                   || (currCs == 0 && mEnableMode == Types::SpiEnableHigh)));
+
+            if (csOff) {
+                findCsOn = true;
+
+
+                // enable signal has been set to off, but we haven't received
+                // a complete value (any number of data bits)
+                if (dataBitCnt > 0 && dataBitCnt < mDataBits) {
+                    mFrames.append(SpiItem::TYPE_FRAME_ERROR, startIdx, -1, 0, 0,
+                                   DecodedFrameStore::FlagError);
+                }
+
+                // the next value starts when enable is set to on again,
+                // the bits of an incomplete value are discarded
+                startIdx = -1;
+                mosiValue = 0;
+                misoValue = 0;
+                dataBitCnt = mDataBits;
+            }
+
+            // capture data when SCK changes
+            if (sckChanged && ((captureOnFirst && (sckChangeNum % 2) != 0)
+                    || (!captureOnFirst && (sckChangeNum % 2) == 0))) {
+
+                if (startIdx == -1) {
+                    startIdx = pos;
+                }
+
+                mosiValue |= (mosi << (--dataBitCnt));
+                misoValue |= (miso << (dataBitCnt));
+
+
+
+                // captured a complete value
+                if (dataBitCnt == 0) {
+                    mFrames.append(SpiItem::TYPE_DATA, startIdx, pos,
+                                   mosiValue, misoValue);
+
+                    startIdx = -1;
+                    mosiValue = 0;
+                    misoValue = 0;
+                    dataBitCnt = mDataBits;
+                }
+
+
+
+                //sckChangeNum = 0;
+            }
+
+
+
+
+        } while (false);
+
+    }
+
+    mFrames.finish();
+
+    // the frames may be kept for a long time by the analyzer
+    mFrames.squeeze();
+}
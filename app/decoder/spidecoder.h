@@ -0,0 +1,80 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SPIDECODER_H
+#define SPIDECODER_H
+
+#include "decoder/decodedframestore.h"
+#include "decoder/protocoldecoder.h"
+#include "common/types.h"
+#include "device/digitaltransitions.h"
+
+/*!
+    \class SpiItem
+    \brief Frame types decoded by the SpiDecoder.
+
+    \ingroup Analyzer
+
+    \internal
+
+    The type of every frame in the DecodedFrameStore of a SpiDecoder is one of
+    the ItemType values.
+*/
+class SpiItem {
+public:
+
+    /*!
+        SPI item type
+    */
+    enum ItemType {
+        TYPE_DATA,
+        TYPE_FRAME_ERROR
+    };
+};
+
+class SpiDecoder : public ProtocolDecoder
+{
+public:
+    SpiDecoder();
+
+    void setSignals(const DigitalTransitions &sckData,
+                    const DigitalTransitions &mosiData,
+                    const DigitalTransitions &misoData,
+                    const DigitalTransitions &enableData);
+
+    void setDataBits(int bits) {mDataBits = bits;}
+    void setMode(Types::SpiMode mode) {mMode = mode;}
+    void setEnableMode(Types::SpiEnable mode) {mEnableMode = mode;}
+
+    void decode();
+
+    DecodedFrameStore frames() const {return mFrames;}
+
+private:
+
+    DigitalTransitions mSckData;
+    DigitalTransitions mMosiData;
+    DigitalTransitions mMisoData;
+    DigitalTransitions mEnableData;
+
+    int mDataBits;
+    Types::SpiMode mMode;
+    Types::SpiEnable mEnableMode;
+
+    DecodedFrameStore mFrames;
+
+};
+
+#endif // SPIDECODER_H
@@ -0,0 +1,24 @@
+# Common settings for the decoder tests and benchmarks. The protocol signals
+# are created by SimulatorSignals, i.e. they are the same signals as the ones
+# shown by the simulator, and decoded by the decoders in decoder.pri. Only
+# QtCore is needed.
+
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+QT -= gui
+
+include(../decoder.pri)
+
+SOURCES += \
+    $$PWD/../../device/simulator/simulatorsignals.cpp \
+    $$PWD/../../generator/i2cgenerator.cpp \
+    $$PWD/../../generator/spigenerator.cpp \
+    $$PWD/../../generator/uartgenerator.cpp
+
+HEADERS += \
+    $$PWD/../../device/simulator/simulatorsignals.h \
+    $$PWD/../../generator/i2cgenerator.h \
+    $$PWD/../../generator/spigenerator.h \
+    $$PWD/../../generator/uartgenerator.h
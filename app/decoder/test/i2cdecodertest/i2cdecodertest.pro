@@ -0,0 +1,11 @@
+# Regression test of the I2CDecoder. The I2C signals of the simulator are
+# decoded at every supported sample rate by the I2CDecoder and by the
+# original sample by sample decoding loop. The program fails if the decoded
+# items differ.
+
+TARGET = i2cdecodertest
+
+include(../decodertest.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,408 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <QtAlgorithms>
+#include <QVector>
+
+#include <stdio.h>
+
+#include "common/types.h"
+#include "decoder/i2cdecoder.h"
+#include "device/digitalsamplestore.h"
+#include "device/digitaltransitions.h"
+#include "device/simulator/simulatorsignals.h"
+
+/*
+    Generates the I2C signals of the simulator with SimulatorSignals for
+    every sample rate supported by the SimulatorCaptureDevice, both address
+    types and a few I2C rates. The signals are decoded by the I2CDecoder
+    and by the original loop which visited every sample (decodeReference()).
+
+    The decoders emit the items in the same order but the DecodedFrameStore
+    sorts them by start index. The reference items are therefore sorted the
+    same way (stable) before they are compared item by item.
+*/
+
+enum Constants {
+    // the simulator uses all 262144*8 bits of the sample buffer, two
+    // signals are needed for I2C
+    NumSamples = (262144*8)/2,
+
+    // the same limit as in the I2CDecoder
+    MaxNumBusErrors = 5
+};
+
+// sample rates supported by the SimulatorCaptureDevice
+static const int sampleRates[] = {
+    100000000, 50000000, 20000000, 10000000, 5000000, 2000000, 1000000,
+    500000, 200000, 100000, 50000, 20000, 10000, 5000, 2000, 1000
+};
+
+static const int i2cRates[] = {
+    100000, 400000, 1000000
+};
+
+struct Item {
+    int type;
+    int value;
+    int startIdx;
+    int stopIdx;
+
+    // position in the decoded sequence
+    int order;
+
+    bool operator<(const Item &other) const {
+        return (startIdx < other.startIdx
+                || (startIdx == other.startIdx && order < other.order));
+    }
+};
+
+static void addItem(QVector<Item> &items, int type, int value, int startIdx,
+                    int stopIdx)
+{
+    Item item;
+    item.type = type;
+    item.value = value;
+    item.startIdx = startIdx;
+    item.stopIdx = stopIdx;
+    item.order = items.size();
+    items.append(item);
+}
+
+/*
+    The I2C decoding loop as it was before the I2CDecoder stepped through
+    the transitions. Every sample from startPos is visited.
+*/
+static void decodeReference(const DigitalSampleStore &sclData,
+                            const DigitalSampleStore &sdaData,
+                            int startPos, QVector<Item> &items)
+{
+    int sda = 0;
+    int scl = 0;
+    int prevSda = sdaData.at(0);
+    int prevScl = sclData.at(0);
+    int sclHLIdx = -1;
+
+    int data = 0;
+    int dataBitCnt = 8;
+    int startIdx = -1;
+
+    bool findAddress = false;
+    bool tenBit = false;
+    int address = 0;
+    int dir = 0;
+
+    int numErrors = 0;
+    bool errorFound = false;
+
+    // start to analyze when start condition has been detected
+    bool detectStart = true;
+    bool startFound = false;
+
+    for (int i = startPos; i < sclData.size(); i++) {
+
+        sda = sdaData.at(i);
+        scl = sclData.at(i);
+
+        //
+        // HIGH -> LOW transition for SCL starts a bit transaction. A transition
+        // on SDA is only allowed to occur when SCL is low (except for START/STOP)
+        //
+        if (prevScl > scl) {
+
+            do {
+
+                if (detectStart && !startFound) break;
+
+                // record the HIGH-LOW transition index for SCL.
+                sclHLIdx = i;
+
+                // record start index for a data byte
+                if (dataBitCnt == 8) {
+                    startIdx = i;
+                    break;
+                }
+
+                // nothing to do until dataBitCnt = 0
+                if (dataBitCnt != 0) {
+                    break;
+                }
+
+                // ---
+                // at this point a complete byte has been received
+                // ---
+
+                if (findAddress) {
+                    int i2cType = I2CItem::I2C_7_ADDRESS_WRITE;
+
+                    // 10-bit address
+                    if ((data & 0xF8) == 0xF0) {
+                        tenBit = true;
+                        address = ((data & 0x06) << 7);
+
+                        // direction (R/W) is defined by bit 0 in the first byte
+                        dir = (data & 0x01);
+
+                        if (dir) {
+                            i2cType = I2CItem::I2C_10_ADDRESS_READ;
+                        }
+                        else {
+                            i2cType = I2CItem::I2C_10_ADDRESS_WRITE;
+                        }
+                    }
+
+                    // 7-bit address or second byte for 10-bit address
+                    else {
+
+                        if (tenBit) {
+                            address |= (data & 0xFF);
+                        }
+
+                        // 7-bit address
+                        else {
+
+                            address = ((data >> 1) & 0xFF);
+
+                            // direction (R/W) is defined by bit 0 in the address byte
+                            dir = (data & 0x01);
+
+                            if (dir) {
+                                i2cType = I2CItem::I2C_7_ADDRESS_READ;
+                            }
+                            else {
+                                i2cType = I2CItem::I2C_7_ADDRESS_WRITE;
+                            }
+
+                        }
+
+                        addItem(items, i2cType, address, startIdx, i);
+
+                        tenBit = false;
+                        findAddress = false;
+                    }
+
+                }
+
+                // DATA
+                else {
+                    addItem(items, I2CItem::I2C_DATA, data, startIdx, i);
+                }
+
+           } while (0);
+
+        }
+
+
+        //
+        // LOW -> HIGH transition for SCL. SDA should remain stable when SCL
+        // is high to detect a correct bit value.
+        //
+        else if (prevScl < scl){
+
+            do {
+
+                if (detectStart && !startFound) break;
+
+                // SDA must not change when SCL is high
+                if (prevSda != sda) {
+
+                    errorFound = true;
+                    addItem(items, I2CItem::I2C_ERROR, -1, i, -1);
+
+                    numErrors++;
+                    break;
+                }
+
+                // read data
+                if (dataBitCnt > 0) {
+                    // the left-shift is a bit index (0-7)
+                    // -> decrease dataBitCnt before shifting
+                    data |= (sda << (--dataBitCnt));
+                }
+
+                // check acknowledge bit
+                else {
+
+                    // using the last HIGH-LOW transition for SCL as start index
+                    if (sda == 0) {
+                        addItem(items, I2CItem::I2C_ACK, -1, sclHLIdx, -1);
+                    }
+                    else {
+                        addItem(items, I2CItem::I2C_NACK, -1, sclHLIdx, -1);
+                    }
+
+                    // ready to read a new byte
+                    dataBitCnt = 8;
+                    data = 0;
+                }
+
+           } while (0);
+
+        }
+
+
+        //
+        // Detect Start and Stop conditions. Transition while SCL is HIGH
+        //
+        if (!errorFound && scl == 1 && sda != prevSda) {
+
+            do {
+
+                // This should not occur while reading a data byte
+                // If it does it is a bus error
+                if (dataBitCnt > 0 && dataBitCnt < 7) {
+
+                    // reset reading data
+                    dataBitCnt = 8;
+
+                    addItem(items, I2CItem::I2C_ERROR, -1, i, -1);
+
+                    numErrors++;
+                    break;
+                }
+
+                // HIGH -> LOW = Start
+                if (prevSda > sda) {
+
+                    addItem(items, I2CItem::I2C_START, -1, i, -1);
+
+                    findAddress = true;
+                    startFound = true;
+                }
+
+                // LOW -> HIGH = Stop
+                else {
+
+                    if (!detectStart || (detectStart&&startFound)) {
+                        addItem(items, I2CItem::I2C_STOP, -1, i, -1);
+                    }
+
+                }
+
+                data = 0;
+                dataBitCnt = 8;
+
+            } while (0);
+        }
+
+
+        prevSda = sda;
+        prevScl = scl;
+        errorFound = false;
+
+        if (numErrors > MaxNumBusErrors) {
+            break;
+        }
+
+    }
+
+    qStableSort(items);
+}
+
+/*
+    Compares the frames decoded by the I2CDecoder with the reference items.
+    Returns the index of the first difference or -1 if they are equal.
+*/
+static int compare(const DecodedFrameStore &frames, const QVector<Item> &items)
+{
+    int n = qMin(frames.size(), items.size());
+
+    for (int i = 0; i < n; i++) {
+        const Item &item = items.at(i);
+
+        if (frames.type(i) != item.type
+                || frames.value(i) != item.value
+                || frames.startIdx(i) != item.startIdx
+                || frames.stopIdx(i) != item.stopIdx
+                || frames.isError(i) != (item.type == I2CItem::I2C_ERROR)) {
+            return i;
+        }
+    }
+
+    if (frames.size() != items.size()) return n;
+
+    return -1;
+}
+
+int main()
+{
+    const int numSampleRates = sizeof(sampleRates)/sizeof(sampleRates[0]);
+    const int numI2CRates = sizeof(i2cRates)/sizeof(i2cRates[0]);
+    const Types::I2CAddress addressTypes[] = {
+        Types::I2CAddress_7bit, Types::I2CAddress_10bit
+    };
+
+    int numCases = 0;
+    int numItems = 0;
+
+    for (int a = 0; a < 2; a++) {
+        for (int r = 0; r < numI2CRates; r++) {
+            for (int s = 0; s < numSampleRates; s++) {
+
+                DigitalSampleStore scl;
+                DigitalSampleStore sda;
+
+                if (!SimulatorSignals::generateI2C(addressTypes[a], i2cRates[r],
+                                                   sampleRates[s], NumSamples,
+                                                   scl, sda)) {
+                    printf("FAILED: no I2C signals generated\n");
+                    return 1;
+                }
+
+                DigitalTransitions sclTrans = DigitalTransitions::fromSamples(scl);
+                DigitalTransitions sdaTrans = DigitalTransitions::fromSamples(sda);
+
+                // from the first sample and from somewhere in a transfer
+                const int startPositions[] = {0, 37};
+
+                for (int p = 0; p < 2; p++) {
+                    QVector<Item> items;
+                    decodeReference(scl, sda, startPositions[p], items);
+
+                    I2CDecoder decoder;
+                    decoder.setSignals(sclTrans, sdaTrans);
+                    decoder.setSampleRate(sampleRates[s]);
+                    decoder.setStartPosition(startPositions[p]);
+                    decoder.decode();
+
+                    DecodedFrameStore frames = decoder.frames();
+
+                    int diff = compare(frames, items);
+                    if (diff != -1) {
+                        printf("FAILED: %d-bit address, I2C rate %d Hz, "
+                               "sample rate %d Hz, start %d: item %d differs "
+                               "(%d items, reference %d items)\n",
+                               (a == 0 ? 7 : 10), i2cRates[r], sampleRates[s],
+                               startPositions[p], diff, frames.size(),
+                               items.size());
+                        return 1;
+                    }
+
+                    numCases++;
+                    numItems += items.size();
+                }
+            }
+        }
+    }
+
+    if (numItems == 0) {
+        printf("FAILED: no items decoded\n");
+        return 1;
+    }
+
+    printf("%d cases, %d items compared\n", numCases, numItems);
+
+    return 0;
+}
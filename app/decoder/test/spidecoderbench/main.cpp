@@ -0,0 +1,502 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <QElapsedTimer>
+#include <QtAlgorithms>
+#include <QVector>
+
+#include <stdio.h>
+
+#include "common/types.h"
+#include "decoder/spidecoder.h"
+#include "device/digitalsamplestore.h"
+#include "device/digitaltransitions.h"
+#include "device/simulator/simulatorsignals.h"
+
+/*
+    Generates the SPI signals of the simulator with SimulatorSignals for
+    every sample rate supported by the SimulatorCaptureDevice, every SPI
+    mode, every number of data bits (4-16) and both enable modes. The
+    signals are decoded by the SpiDecoder and by the original loop which
+    visited every sample (decodeReference()).
+
+    For each sample rate the total decoding time of all configurations is
+    reported for both decoders. Only the decoding is measured, the
+    transitions of the signals are created once like the capture device
+    does when the signal data is set.
+
+    The DecodedFrameStore sorts the frames by start index. The reference
+    items are therefore sorted the same way (stable) before they are
+    compared item by item.
+
+    Finally checkIncompleteValue() decodes a transfer which is interrupted
+    by the enable signal with a number of data bits other than 8.
+*/
+
+enum Constants {
+    // the simulator uses all 262144*8 bits of the sample buffer, four
+    // signals are needed for SPI
+    NumSamples = (262144*8)/4,
+
+    // the SPI rate used by the simulator by default
+    SpiRate = 1000000,
+
+    MinDataBits = 4,
+    MaxDataBits = 16,
+
+    Repetitions = 3
+};
+
+// sample rates supported by the SimulatorCaptureDevice
+static const int sampleRates[] = {
+    100000000, 50000000, 20000000, 10000000, 5000000, 2000000, 1000000,
+    500000, 200000, 100000, 50000, 20000, 10000, 5000, 2000, 1000
+};
+
+struct Item {
+    int type;
+    int mosiValue;
+    int misoValue;
+    int startIdx;
+    int stopIdx;
+
+    // position in the decoded sequence
+    int order;
+
+    bool operator<(const Item &other) const {
+        return (startIdx < other.startIdx
+                || (startIdx == other.startIdx && order < other.order));
+    }
+};
+
+struct Signals {
+    DigitalSampleStore sck;
+    DigitalSampleStore mosi;
+    DigitalSampleStore miso;
+    DigitalSampleStore enable;
+
+    DigitalTransitions sckTrans;
+    DigitalTransitions mosiTrans;
+    DigitalTransitions misoTrans;
+    DigitalTransitions enableTrans;
+};
+
+struct Config {
+    Types::SpiMode mode;
+    Types::SpiEnable enableMode;
+    int dataBits;
+};
+
+static void addItem(QVector<Item> &items, int type, int mosiValue,
+                    int misoValue, int startIdx, int stopIdx)
+{
+    Item item;
+    item.type = type;
+    item.mosiValue = mosiValue;
+    item.misoValue = misoValue;
+    item.startIdx = startIdx;
+    item.stopIdx = stopIdx;
+    item.order = items.size();
+    items.append(item);
+}
+
+/*
+    The SPI decoding loop as it was before the SpiDecoder merged the
+    transitions of the signals. Every sample is visited.
+
+    Only the handling of an incomplete value intentionally differs from
+    the original loop. The original loop only detected an incomplete value
+    correctly for 8 data bits (it checked dataBitCnt < 8), kept the bits of
+    an undetected incomplete value for the next value and stopped decoding
+    at the first frame error. Like the SpiDecoder this loop reports an
+    incomplete value for any number of data bits, discards its bits and
+    continues.
+*/
+static void decodeReference(const Signals &s, const Config &config,
+                            QVector<Item> &items)
+{
+    bool findCsOn = true;
+    int pos = 0;
+
+    int prevCs = s.enable.at(pos);
+    int currCs = 0;
+    bool csChanged = false;
+    bool csOff = false;
+
+
+    int prevSck = s.sck.at(pos);
+    int currSck = 0;
+    bool sckChanged = false;
+    int sckChangeNum = 0;
+
+    int mosi = 0;
+    int miso = 0;
+    int mosiValue = 0;
+    int misoValue = 0;
+    int dataBitCnt = config.dataBits;
+
+    int startIdx = -1;
+
+    // CPHA = 0 -> capture data on first clock transition (otherwise second)
+    bool captureOnFirst = (config.mode == Types::SpiMode_0
+                           || config.mode == Types::SpiMode_2);
+
+    while (true) {
+
+        // reached end of data
+        if (pos >= s.sck.size()) break;
+
+        currCs  = s.enable.at(pos);
+        csChanged = (prevCs != currCs);
+
+        currSck = s.sck.at(pos);
+        sckChanged = (prevSck != currSck);
+        if (sckChanged) {
+            sckChangeNum++;
+        }
+
+        mosi = s.mosi.at(pos);
+        miso = s.miso.at(pos);
+
+
+        do {
+
+            /*
+             * Look for Enable on
+             */
+
+            if (findCsOn) {
+
+                if (csChanged &&
+                        ( ((currCs == 0 && config.enableMode == Types::SpiEnableLow) ||
+                          (currCs == 1 && config.enableMode == Types::SpiEnableHigh))))
+                {
+                    findCsOn = false;
+                }
+
+                else {
+                    // we've not found enable yet -> get next sample
+                    break;
+                }
+            }
+
+            /*
+             * Check if Enable is set to off
+             */
+
+            csOff = (csChanged && ((currCs == 1 && config.enableMode == Types::SpiEnableLow)
+                                   || (currCs == 0 && config.enableMode == Types::SpiEnableHigh)));
+
+            if (csOff) {
+                findCsOn = true;
+
+                // enable signal has been set to off, but we haven't received a complete value
+                if (dataBitCnt > 0 && dataBitCnt < config.dataBits) {
+                    addItem(items, SpiItem::TYPE_FRAME_ERROR, 0, 0, startIdx, -1);
+                }
+
+                startIdx = -1;
+                mosiValue = 0;
+                misoValue = 0;
+                dataBitCnt = config.dataBits;
+            }
+
+            // capture data when SCK changes
+            if (sckChanged && ((captureOnFirst && (sckChangeNum % 2) != 0)
+                    || (!captureOnFirst && (sckChangeNum % 2) == 0))) {
+
+                if (startIdx == -1) {
+                    startIdx = pos;
+                }
+
+                mosiValue |= (mosi << (--dataBitCnt));
+                misoValue |= (miso << (dataBitCnt));
+
+                // captured a complete value
+                if (dataBitCnt == 0) {
+                    addItem(items, SpiItem::TYPE_DATA, mosiValue, misoValue,
+                            startIdx, pos);
+
+                    startIdx = -1;
+                    mosiValue = 0;
+                    misoValue = 0;
+                    dataBitCnt = config.dataBits;
+                }
+            }
+
+        } while (false);
+
+        pos++;
+        prevCs = currCs;
+        prevSck = currSck;
+    }
+
+    qStableSort(items);
+}
+
+static void decodeCurrent(const Signals &s, const Config &config,
+                          int sampleRate, DecodedFrameStore &frames)
+{
+    SpiDecoder decoder;
+    decoder.setSignals(s.sckTrans, s.mosiTrans, s.misoTrans, s.enableTrans);
+    decoder.setSampleRate(sampleRate);
+    decoder.setMode(config.mode);
+    decoder.setEnableMode(config.enableMode);
+    decoder.setDataBits(config.dataBits);
+    decoder.decode();
+
+    frames = decoder.frames();
+}
+
+/*
+    Compares the frames decoded by the SpiDecoder with the reference items.
+    Returns the index of the first difference or -1 if they are equal.
+*/
+static int compare(const DecodedFrameStore &frames, const QVector<Item> &items)
+{
+    int n = qMin(frames.size(), items.size());
+
+    for (int i = 0; i < n; i++) {
+        const Item &item = items.at(i);
+
+        if (frames.type(i) != item.type
+                || frames.value(i) != item.mosiValue
+                || frames.secondValue(i) != item.misoValue
+                || frames.startIdx(i) != item.startIdx
+                || frames.stopIdx(i) != item.stopIdx
+                || frames.isError(i) != (item.type == SpiItem::TYPE_FRAME_ERROR)) {
+            return i;
+        }
+    }
+
+    if (frames.size() != items.size()) return n;
+
+    return -1;
+}
+
+/*
+    Decodes the signals with one configuration by both decoders and adds
+    the best times in nanoseconds to \a referenceNs and \a currentNs.
+    Returns false if the decoded items differ.
+*/
+static bool runCase(const Signals &s, const Config &config, int sampleRate,
+                    qint64 &referenceNs, qint64 &currentNs, int &numItems)
+{
+    QVector<Item> items;
+    DecodedFrameStore frames;
+
+    qint64 bestReference = -1;
+    qint64 bestCurrent = -1;
+
+    for (int r = 0; r < Repetitions; r++) {
+        QElapsedTimer timer;
+
+        items.clear();
+        timer.start();
+        decodeReference(s, config, items);
+        qint64 elapsed = timer.nsecsElapsed();
+        if (bestReference < 0 || elapsed < bestReference) {
+            bestReference = elapsed;
+        }
+
+        timer.start();
+        decodeCurrent(s, config, sampleRate, frames);
+        elapsed = timer.nsecsElapsed();
+        if (bestCurrent < 0 || elapsed < bestCurrent) {
+            bestCurrent = elapsed;
+        }
+    }
+
+    referenceNs += bestReference;
+    currentNs += bestCurrent;
+    numItems += items.size();
+
+    int diff = compare(frames, items);
+    if (diff != -1) {
+        printf("FAILED: mode %d, enable %s, %d data bits, sample rate %d Hz: "
+               "item %d differs (%d items, reference %d items)\n",
+               (int)config.mode,
+               (config.enableMode == Types::SpiEnableLow ? "low" : "high"),
+               config.dataBits, sampleRate, diff, frames.size(), items.size());
+        return false;
+    }
+
+    return true;
+}
+
+static void appendSamples(Signals &s, int sck, int mosi, int miso,
+                          int enable, int count)
+{
+    s.sck.append(sck, count);
+    s.mosi.append(mosi, count);
+    s.miso.append(miso, count);
+    s.enable.append(enable, count);
+}
+
+/*
+    Appends the \a numBits most significant bits of a value in SPI mode 0
+    with an active low enable signal. Returns the sample index of the first
+    and the last rising SCK edge, i.e. where the bits are captured.
+*/
+static void appendValue(Signals &s, int mosiValue, int misoValue, int numBits,
+                        int &firstEdge, int &lastEdge)
+{
+    for (int bit = numBits-1; bit >= 0; bit--) {
+        int mosi = (mosiValue >> bit) & 1;
+        int miso = (misoValue >> bit) & 1;
+
+        appendSamples(s, 0, mosi, miso, 0, 3);
+
+        lastEdge = s.sck.size();
+        if (bit == numBits-1) {
+            firstEdge = lastEdge;
+        }
+
+        appendSamples(s, 1, mosi, miso, 0, 3);
+    }
+    appendSamples(s, 0, 0, 0, 0, 3);
+}
+
+/*
+    Decodes two transfers with 12 data bits. The enable signal is set to
+    off after 3 bits of the first transfer. This must give a frame error
+    and the bits must not be part of the value in the second transfer.
+    Returns false if the SpiDecoder gives another result.
+*/
+static bool checkIncompleteValue()
+{
+    const int dataBits = 12;
+    const int mosiValue = 0xA5C;
+    const int misoValue = 0x3C1;
+
+    Signals s;
+    int errorStart = 0;
+    int dataStart = 0;
+    int dataStop = 0;
+    int unused = 0;
+
+    appendSamples(s, 0, 0, 0, 1, 10);
+    appendSamples(s, 0, 0, 0, 0, 5);
+    appendValue(s, 0x7, 0x7, 3, errorStart, unused);
+    appendSamples(s, 0, 0, 0, 1, 10);
+    appendSamples(s, 0, 0, 0, 0, 5);
+    appendValue(s, mosiValue, misoValue, dataBits, dataStart, dataStop);
+    appendSamples(s, 0, 0, 0, 1, 10);
+
+    s.sckTrans = DigitalTransitions::fromSamples(s.sck);
+    s.mosiTrans = DigitalTransitions::fromSamples(s.mosi);
+    s.misoTrans = DigitalTransitions::fromSamples(s.miso);
+    s.enableTrans = DigitalTransitions::fromSamples(s.enable);
+
+    Config config;
+    config.mode = Types::SpiMode_0;
+    config.enableMode = Types::SpiEnableLow;
+    config.dataBits = dataBits;
+
+    DecodedFrameStore frames;
+    decodeCurrent(s, config, 1000000, frames);
+
+    bool ok = (frames.size() == 2
+               && frames.type(0) == SpiItem::TYPE_FRAME_ERROR
+               && frames.isError(0)
+               && frames.startIdx(0) == errorStart
+               && frames.type(1) == SpiItem::TYPE_DATA
+               && !frames.isError(1)
+               && frames.value(1) == mosiValue
+               && frames.secondValue(1) == misoValue
+               && frames.startIdx(1) == dataStart
+               && frames.stopIdx(1) == dataStop);
+
+    printf("incomplete value with %d data bits: %s\n", dataBits,
+           (ok ? "ok" : "MISMATCH"));
+
+    return ok;
+}
+
+int main()
+{
+    const int numSampleRates = sizeof(sampleRates)/sizeof(sampleRates[0]);
+    const Types::SpiEnable enableModes[] = {
+        Types::SpiEnableLow, Types::SpiEnableHigh
+    };
+
+    int totalItems = 0;
+
+    for (int r = 0; r < numSampleRates; r++) {
+
+        qint64 referenceNs = 0;
+        qint64 currentNs = 0;
+        int numItems = 0;
+        int numCases = 0;
+
+        for (int m = 0; m < Types::SpiMode_Num; m++) {
+            for (int e = 0; e < 2; e++) {
+                for (int bits = MinDataBits; bits <= MaxDataBits; bits++) {
+
+                    Config config;
+                    config.mode = (Types::SpiMode)m;
+                    config.enableMode = enableModes[e];
+                    config.dataBits = bits;
+
+                    Signals s;
+                    if (!SimulatorSignals::generateSpi(config.mode,
+                                                       config.enableMode,
+                                                       SpiRate, bits,
+                                                       sampleRates[r],
+                                                       NumSamples, s.sck,
+                                                       s.mosi, s.miso,
+                                                       s.enable)) {
+                        printf("FAILED: no SPI signals generated\n");
+                        return 1;
+                    }
+
+                    s.sckTrans = DigitalTransitions::fromSamples(s.sck);
+                    s.mosiTrans = DigitalTransitions::fromSamples(s.mosi);
+                    s.misoTrans = DigitalTransitions::fromSamples(s.miso);
+                    s.enableTrans = DigitalTransitions::fromSamples(s.enable);
+
+                    if (!runCase(s, config, sampleRates[r], referenceNs,
+                                 currentNs, numItems)) {
+                        return 1;
+                    }
+
+                    numCases++;
+                }
+            }
+        }
+
+        referenceNs = qMax(referenceNs, (qint64)1);
+        currentNs = qMax(currentNs, (qint64)1);
+
+        printf("%9d Hz: %3d cases %6d items: before %8.2f ms, "
+               "after %8.2f ms, %7.1fx ok\n",
+               sampleRates[r], numCases, numItems, referenceNs/1000000.0,
+               currentNs/1000000.0, (double)referenceNs/currentNs);
+
+        totalItems += numItems;
+    }
+
+    if (totalItems == 0) {
+        printf("FAILED: no items decoded\n");
+        return 1;
+    }
+
+    if (!checkIncompleteValue()) {
+        printf("FAILED: incomplete value not handled\n");
+        return 1;
+    }
+
+    return 0;
+}
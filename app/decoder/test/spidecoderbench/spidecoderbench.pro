@@ -0,0 +1,12 @@
+# Benchmark of the SpiDecoder. The SPI signals of the simulator are decoded
+# at every supported sample rate, in every SPI mode and with every number of
+# data bits by the SpiDecoder and by the original sample by sample decoding
+# loop. The program fails if the decoded items differ. An incomplete value
+# is handled the way the SpiDecoder does it, not like the original loop.
+
+TARGET = spidecoderbench
+
+include(../decodertest.pri)
+
+SOURCES += \
+    main.cpp
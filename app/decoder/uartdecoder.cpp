@@ -0,0 +1,257 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uartdecoder.h"
+
+/*!
+    \class UartDecoder
+    \brief Decodes UART protocol data.
+
+    \ingroup Analyzer
+
+    Once the falling edge of a start bit has been found the position of
+    every bit in the frame is given by the number of samples per bit. The
+    decoder therefore jumps directly to the center of each bit and then to
+    the next falling edge instead of visiting every sample.
+*/
+
+/*!
+    Constructs the decoder without any signal data. The default settings
+    are 8 data bits, 1 stop bit and no parity. The baud rate must be set
+    with setBaudRate() before decoding.
+*/
+UartDecoder::UartDecoder()
+{
+    mBaudRate = 0;
+    mDataBits = 8;
+    mStopBits = 1;
+    mParity = Types::ParityNone;
+}
+
+/*!
+    \fn void UartDecoder::setSignal(const DigitalTransitions &data)
+
+    Set the signal data to decode to the transitions \a data. The data is
+    implicitly shared so the copy is cheap.
+*/
+
+/*!
+    \fn void UartDecoder::setBaudRate(int baudRate)
+
+    Set the baud rate to \a baudRate.
+*/
+
+/*!
+    \fn void UartDecoder::setDataBits(int bits)
+
+    Set the number of data bits to \a bits.
+*/
+
+/*!
+    \fn void UartDecoder::setStopBits(int bits)
+
+    Set the number of stop bits to \a bits.
+*/
+
+/*!
+    \fn void UartDecoder::setParity(Types::UartParity parity)
+
+    Set the \a parity.
+*/
+
+/*!
+    \fn DecodedFrameStore UartDecoder::frames() const
+
+    Returns the decoded UART frames. The type of each frame is one of the
+    UartItem::ItemType values.
+*/
+
+/*!
+    Returns the length of one bit in samples given the sample rate and
+    baud rate. 0 is returned if any of the rates hasn't been set.
+*/
+double UartDecoder::numSamplesPerBit() const
+{
+    if (sampleRate() <= 0 || mBaudRate <= 0) return 0;
+
+    return (double)sampleRate() / mBaudRate;
+}
+
+/*!
+    Decodes the signal data.
+*/
+void UartDecoder::decode()
+{
+    mFrames.clear();
+
+    const double samplesPerBit = numSamplesPerBit();
+    if (samplesPerBit <= 0) return;
+
+    const qint64 end = mData.numSamples();
+    const int numBits = 1 + mDataBits
+            + (mParity != Types::ParityNone ? 1 : 0) + mStopBits;
+
+    qint64 from = startPosition();
+    int numFrames = 0;
+
+    while (true) {
+
+        // stop as soon as possible if a newer capture has arrived
+        if ((++numFrames % CancelCheckInterval) == 0 && isCancelled()) break;
+
+        int edge = findStartEdge(from);
+        if (edge < 0) break;
+
+        qint64 startIdx = mData.at(edge);
+
+        // the frame must fit within the captured data
+        qint64 stopIdx = startIdx + (qint64)(numBits*samplesPerBit);
+        if (stopIdx >= end) break;
+
+        // the transition before the start edge has already been passed
+        int transIdx = edge;
+        int bit = 0;
+
+        // start bit must still be low at its center, otherwise it was
+        // just a glitch on the line
+        qint64 center = startIdx + (qint64)(0.5*samplesPerBit);
+        if (levelAt(center, transIdx) != 0) {
+            from = center;
+            continue;
+        }
+
+        int value = 0;
+        int onesInValue = 0;
+
+        // TODO: also support MSB first
+        for (int i = 0; i < mDataBits; i++) {
+            center = startIdx + (qint64)((++bit + 0.5)*samplesPerBit);
+            int level = levelAt(center, transIdx);
+
+            value |= (level << i);
+            onesInValue += level;
+        }
+
+        bool parityErr = false;
+        if (mParity != Types::ParityNone) {
+            center = startIdx + (qint64)((++bit + 0.5)*samplesPerBit);
+            parityErr = parityError(onesInValue,
+                                    levelAt(center, transIdx));
+        }
+
+        bool frameErr = false;
+        for (int i = 0; i < mStopBits; i++) {
+            center = startIdx + (qint64)((++bit + 0.5)*samplesPerBit);
+            if (levelAt(center, transIdx) != 1) {
+                frameErr = true;
+                break;
+            }
+        }
+
+        if (frameErr) {
+            mFrames.append(UartItem::TYPE_FRAME_ERROR, (int)startIdx,
+                           (int)stopIdx, 0, 0, DecodedFrameStore::FlagError);
+        }
+        else if (parityErr) {
+            mFrames.append(UartItem::TYPE_PARITY_ERROR, (int)startIdx,
+                           (int)stopIdx, 0, 0, DecodedFrameStore::FlagError);
+        }
+        else {
+            mFrames.append(UartItem::TYPE_DATA, (int)startIdx, (int)stopIdx,
+                           value);
+        }
+
+        // the next start bit can begin after the center of the last
+        // sampled bit. For a frame error this means that the decoder
+        // resynchronizes on the next falling edge after the line has
+        // returned to idle.
+        from = center;
+    }
+
+    mFrames.finish();
+
+    // the frames may be kept for a long time by the analyzer
+    mFrames.squeeze();
+}
+
+/*!
+    Returns the position of the first transition from high to low after
+    sample index \a from. -1 is returned if there is no such transition.
+*/
+int UartDecoder::findStartEdge(qint64 from) const
+{
+    int idx = mData.upperBound(from);
+
+    // every second transition is a falling edge
+    if (idx < mData.size() && mData.levelAfter(idx) != 0) {
+        idx++;
+    }
+
+    if (idx >= mData.size()) {
+        idx = -1;
+    }
+
+    return idx;
+}
+
+/*!
+    Returns the level of the sample at \a sampleIdx. \a transIdx is the
+    position of a transition at or before \a sampleIdx and is moved forward
+    to the first transition after \a sampleIdx. Since the bit centers are
+    visited in increasing order only a few transitions are passed for each
+    call.
+*/
+int UartDecoder::levelAt(qint64 sampleIdx, int &transIdx) const
+{
+    const qint64* trans = mData.constData();
+    const int numTrans = mData.size();
+
+    while (transIdx < numTrans && trans[transIdx] <= sampleIdx) {
+        transIdx++;
+    }
+
+    return mData.initialLevel() ^ (transIdx & 1);
+}
+
+/*!
+    Returns true if \a parityBit doesn't match the configured parity for a
+    value with \a onesInValue bits set.
+*/
+bool UartDecoder::parityError(int onesInValue, int parityBit) const
+{
+    bool error = false;
+
+    switch(mParity) {
+    case Types::ParityNone:
+        break;
+    case Types::ParityOdd:
+        // total number of ones including the parity bit must be odd
+        error = (((onesInValue + parityBit) % 2) == 0);
+        break;
+    case Types::ParityEven:
+        error = (((onesInValue + parityBit) % 2) != 0);
+        break;
+    case Types::ParityMark:
+        error = (parityBit == 0);
+        break;
+    case Types::ParitySpace:
+        error = (parityBit == 1);
+        break;
+    default:
+        break;
+    }
+
+    return error;
+}
@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UARTDECODER_H
+#define UARTDECODER_H
+
+#include "decoder/decodedframestore.h"
+#include "decoder/protocoldecoder.h"
+#include "common/types.h"
+#include "device/digitaltransitions.h"
+
+/*!
+    \class UartItem
+    \brief Frame types decoded by the UartDecoder.
+
+    \ingroup Analyzer
+
+    \internal
+
+    The type of every frame in the DecodedFrameStore of a UartDecoder is one of
+    the ItemType values.
+*/
+class UartItem {
+public:
+
+    /*!
+        UART item type
+    */
+    enum ItemType {
+        TYPE_DATA,
+        TYPE_FRAME_ERROR,
+        TYPE_PARITY_ERROR
+    };
+};
+
+class UartDecoder : public ProtocolDecoder
+{
+public:
+    UartDecoder();
+
+    void setSignal(const DigitalTransitions &data) {mData = data;}
+
+    void setBaudRate(int baudRate) {mBaudRate = baudRate;}
+    void setDataBits(int bits) {mDataBits = bits;}
+    void setStopBits(int bits) {mStopBits = bits;}
+    void setParity(Types::UartParity parity) {mParity = parity;}
+
+    double numSamplesPerBit() const;
+
+    void decode();
+
+    DecodedFrameStore frames() const {return mFrames;}
+
+private:
+
+    DigitalTransitions mData;
+
+    int mBaudRate;
+    int mDataBits;
+    int mStopBits;
+    Types::UartParity mParity;
+
+    DecodedFrameStore mFrames;
+
+    int findStartEdge(qint64 from) const;
+    int levelAt(qint64 sampleIdx, int &transIdx) const;
+    bool parityError(int onesInValue, int parityBit) const;
+
+};
+
+#endif // UARTDECODER_H
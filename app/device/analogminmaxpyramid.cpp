@@ -0,0 +1,200 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "analogminmaxpyramid.h"
+
+/*!
+    \class AnalogMinMaxPyramid
+    \brief AnalogMinMaxPyramid holds precalculated minimum and maximum
+        values for blocks of analog samples.
+
+    \ingroup Device
+
+    Level 0 contains the minimum and maximum value for each block of
+    BaseBlockSize samples. Each following level combines LevelFactor blocks
+    from the level below. Only complete blocks are stored. Level 0 doesn't
+    start at single samples since the pyramid would then need more memory
+    than the packed samples themselves.
+
+    The pyramid is built once when the signal data is available and makes it
+    possible to find the minimum and maximum value in any range of samples
+    in logarithmic time. When painting a signal the cost will therefore
+    depend on the width of the plot area and not on the number of samples.
+
+    The signal data is implicitly shared with the AnalogSampleStore given
+    to the constructor.
+*/
+
+/*!
+    Constructs an empty pyramid.
+*/
+AnalogMinMaxPyramid::AnalogMinMaxPyramid()
+{
+}
+
+/*!
+    Constructs a pyramid for the analog signal \a data.
+*/
+AnalogMinMaxPyramid::AnalogMinMaxPyramid(const AnalogSampleStore &data)
+{
+    mData = data;
+
+    // level 0 is calculated from the samples
+    int numBlocks = mData.size() / BaseBlockSize;
+
+    while (numBlocks > 0) {
+        QVector<double> minLevel(numBlocks);
+        QVector<double> maxLevel(numBlocks);
+        double* minDst = minLevel.data();
+        double* maxDst = maxLevel.data();
+
+        if (mMin.isEmpty()) {
+            // the samples are converted to volts a buffer at a time
+            double buf[AnalogSampleStore::BlockSize];
+            const int blocksPerBuf = AnalogSampleStore::BlockSize/BaseBlockSize;
+
+            for (int first = 0; first < numBlocks; first += blocksPerBuf) {
+                int n = qMin(blocksPerBuf, numBlocks - first);
+                mData.values(first*BaseBlockSize, n*BaseBlockSize, buf);
+
+                for (int b = 0; b < n; b++) {
+                    const double* s = &buf[b*BaseBlockSize];
+                    double minVal = s[0];
+                    double maxVal = s[0];
+                    for (int i = 1; i < BaseBlockSize; i++) {
+                        if (s[i] < minVal) minVal = s[i];
+                        if (s[i] > maxVal) maxVal = s[i];
+                    }
+                    minDst[first+b] = minVal;
+                    maxDst[first+b] = maxVal;
+                }
+            }
+        }
+        else {
+            // the remaining levels are calculated from the level below
+            const double* minSrc = mMin.last().constData();
+            const double* maxSrc = mMax.last().constData();
+            for (int b = 0; b < numBlocks; b++) {
+                int first = b*LevelFactor;
+                double minVal = minSrc[first];
+                double maxVal = maxSrc[first];
+                for (int i = 1; i < LevelFactor; i++) {
+                    if (minSrc[first+i] < minVal) minVal = minSrc[first+i];
+                    if (maxSrc[first+i] > maxVal) maxVal = maxSrc[first+i];
+                }
+                minDst[b] = minVal;
+                maxDst[b] = maxVal;
+            }
+        }
+
+        mMin.append(minLevel);
+        mMax.append(maxLevel);
+
+        numBlocks /= LevelFactor;
+    }
+}
+
+/*!
+    \fn int AnalogMinMaxPyramid::size() const
+
+    Returns the number of samples.
+*/
+
+/*!
+    \fn int AnalogMinMaxPyramid::numLevels() const
+
+    Returns the number of levels in the pyramid.
+*/
+
+/*!
+    Returns the number of samples covered by each block at \a level.
+*/
+int AnalogMinMaxPyramid::blockSize(int level) const
+{
+    int size = BaseBlockSize;
+    for (int i = 0; i < level; i++) {
+        size *= LevelFactor;
+    }
+
+    return size;
+}
+
+/*!
+    \fn double AnalogMinMaxPyramid::minAt(int level, int block) const
+
+    Returns the minimum value of \a block at \a level.
+*/
+
+/*!
+    \fn double AnalogMinMaxPyramid::maxAt(int level, int block) const
+
+    Returns the maximum value of \a block at \a level.
+*/
+
+/*!
+    Finds the minimum and maximum value for the samples from index \a from
+    up to and including index \a to. The result is stored in \a minVal and
+    \a maxVal.
+
+    The range is covered by the largest blocks that fit. Only the samples
+    at the edges of the range that don't fill a complete level 0 block are
+    visited.
+*/
+void AnalogMinMaxPyramid::minMax(int from, int to, double &minVal,
+                                 double &maxVal) const
+{
+    minVal = 0;
+    maxVal = 0;
+
+    if (from < 0) from = 0;
+    if (to >= mData.size()) to = mData.size()-1;
+    if (from > to) return;
+
+    minVal = mData.at(from);
+    maxVal = minVal;
+
+    // end is exclusive
+    int end = to + 1;
+
+    while (from < end) {
+
+        // find the largest block starting at 'from' which fits in the range
+        int level = -1;
+        int size = 1;
+        while (level+1 < mMin.size()) {
+            int next = (level == -1 ? (int)BaseBlockSize : size*LevelFactor);
+            if ((from % next) != 0 || from + next > end) break;
+
+            level++;
+            size = next;
+        }
+
+        double lo;
+        double hi;
+        if (level == -1) {
+            lo = mData.at(from);
+            hi = lo;
+        }
+        else {
+            lo = mMin.at(level).at(from / size);
+            hi = mMax.at(level).at(from / size);
+        }
+
+        if (lo < minVal) minVal = lo;
+        if (hi > maxVal) maxVal = hi;
+
+        from += size;
+    }
+}
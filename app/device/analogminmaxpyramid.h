@@ -0,0 +1,53 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALOGMINMAXPYRAMID_H
+#define ANALOGMINMAXPYRAMID_H
+
+#include <QtGlobal>
+#include <QVector>
+
+#include "analogsamplestore.h"
+
+class AnalogMinMaxPyramid
+{
+public:
+
+    enum Constants {
+        BaseBlockSize = 16,
+        LevelFactor = 4
+    };
+
+    AnalogMinMaxPyramid();
+    explicit AnalogMinMaxPyramid(const AnalogSampleStore &data);
+
+    int size() const {return mData.size();}
+    int numLevels() const {return mMin.size();}
+    int blockSize(int level) const;
+
+    double minAt(int level, int block) const {return mMin.at(level).at(block);}
+    double maxAt(int level, int block) const {return mMax.at(level).at(block);}
+
+    void minMax(int from, int to, double &minVal, double &maxVal) const;
+
+private:
+
+    AnalogSampleStore mData;
+    QVector<QVector<double> > mMin;
+    QVector<QVector<double> > mMax;
+
+};
+
+#endif // ANALOGMINMAXPYRAMID_H
@@ -0,0 +1,280 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "analogsamplestore.h"
+
+#include <string.h>
+
+/*!
+    \class AnalogSampleStore
+    \brief AnalogSampleStore is a compact container for the samples of one
+        analog signal.
+
+    \ingroup Device
+
+    Samples captured by the LabTool Hardware are 12-bit codes which are
+    converted to volts with the calibration factors \c a and \c b as
+    \c {a + b*code}. Instead of storing the converted values the codes are
+    kept packed, two codes in three bytes, together with the factors. The
+    conversion to volts is done on demand, either one sample at a time with
+    at() or for a block of samples with values().
+
+    Signal data that doesn't originate from 12-bit codes, e.g., simulated
+    data or data loaded from a project file, is stored as converted values.
+
+    The container is implicitly shared through QVector which means that it
+    is cheap to copy.
+*/
+
+/*!
+    Constructs an empty sample store.
+*/
+AnalogSampleStore::AnalogSampleStore()
+{
+    mSize = 0;
+    mHasCodes = false;
+    mA = 0;
+    mB = 1;
+}
+
+/*!
+    Constructs a sample store for the \a size 12-bit \a codes. The value in
+    volts of a sample is calculated as \a a + \a b * code.
+
+    The codes can be any part of a larger buffer which means that samples
+    at the start or end of a capture are dropped by just adjusting
+    \a codes and \a size.
+*/
+AnalogSampleStore::AnalogSampleStore(const quint16 *codes, int size,
+                                     double a, double b)
+{
+    mSize = (size > 0 ? size : 0);
+    mHasCodes = true;
+    mA = a;
+    mB = b;
+
+    mCodes.resize(packedSize(mSize));
+
+    const quint16* src = codes;
+    quint8* dst = mCodes.data();
+    int i = 0;
+
+    for (; i+1 < mSize; i += 2) {
+        quint16 c0 = src[i] & CodeMask;
+        quint16 c1 = src[i+1] & CodeMask;
+
+        *dst++ = (quint8)c0;
+        *dst++ = (quint8)((c0 >> 8) | (c1 << 4));
+        *dst++ = (quint8)(c1 >> 4);
+    }
+
+    // odd number of samples -> the last code is alone in its byte triplet
+    if (i < mSize) {
+        quint16 c0 = src[i] & CodeMask;
+
+        *dst++ = (quint8)c0;
+        *dst++ = (quint8)(c0 >> 8);
+        *dst++ = 0;
+    }
+}
+
+/*!
+    Constructs a sample store for the already converted \a values.
+*/
+AnalogSampleStore::AnalogSampleStore(const QVector<double> &values)
+{
+    mSize = values.size();
+    mHasCodes = false;
+    mA = 0;
+    mB = 1;
+    mValues = values;
+}
+
+/*!
+    \fn int AnalogSampleStore::size() const
+
+    Returns the number of samples in the store.
+*/
+
+/*!
+    \fn bool AnalogSampleStore::isEmpty() const
+
+    Returns true if the store doesn't contain any samples.
+*/
+
+/*!
+    Removes all samples from the store.
+*/
+void AnalogSampleStore::clear()
+{
+    mSize = 0;
+    mHasCodes = false;
+    mA = 0;
+    mB = 1;
+    mCodes.clear();
+    mValues.clear();
+}
+
+/*!
+    \fn bool AnalogSampleStore::hasCodes() const
+
+    Returns true if the samples are stored as 12-bit codes.
+*/
+
+/*!
+    \fn double AnalogSampleStore::factorA() const
+
+    Returns the calibration offset used when converting codes to volts.
+*/
+
+/*!
+    \fn double AnalogSampleStore::factorB() const
+
+    Returns the calibration gain used when converting codes to volts.
+*/
+
+/*!
+    Returns the 12-bit code of sample \a i. Must only be called if
+    hasCodes() returns true.
+*/
+int AnalogSampleStore::codeAt(int i) const
+{
+    const quint8* p = &mCodes.constData()[(i/2)*3];
+
+    if ((i & 1) == 0) {
+        return p[0] | ((p[1] & 0x0f) << 8);
+    }
+
+    return (p[1] >> 4) | (p[2] << 4);
+}
+
+/*!
+    \fn double AnalogSampleStore::at(int i) const
+
+    Returns the value in volts of sample \a i.
+*/
+
+/*!
+    Converts \a count samples starting at index \a from to volts and stores
+    them in \a dest.
+
+    The codes are unpacked a byte triplet at a time in a tight loop that
+    the compiler can vectorize. Iterating over a range of samples this way
+    is considerably faster than calling at() for each sample.
+*/
+void AnalogSampleStore::values(int from, int count, double *dest) const
+{
+    if (from < 0 || count <= 0 || from + count > mSize) return;
+
+    if (!mHasCodes) {
+        const double* src = &mValues.constData()[from];
+        for (int i = 0; i < count; i++) {
+            dest[i] = src[i];
+        }
+        return;
+    }
+
+    const double a = mA;
+    const double b = mB;
+    int i = from;
+    int end = from + count;
+
+    // leading odd sample
+    if ((i & 1) != 0 && i < end) {
+        *dest++ = a + b*codeAt(i);
+        i++;
+    }
+
+    const quint8* p = &mCodes.constData()[(i/2)*3];
+    for (; i+1 < end; i += 2) {
+        int c0 = p[0] | ((p[1] & 0x0f) << 8);
+        int c1 = (p[1] >> 4) | (p[2] << 4);
+        p += 3;
+
+        dest[0] = a + b*c0;
+        dest[1] = a + b*c1;
+        dest += 2;
+    }
+
+    // trailing even sample
+    if (i < end) {
+        *dest = a + b*codeAt(i);
+    }
+}
+
+/*!
+    Returns all samples converted to volts.
+*/
+QVector<double> AnalogSampleStore::toVector() const
+{
+    if (!mHasCodes) {
+        return mValues;
+    }
+
+    QVector<double> v(mSize);
+    values(0, mSize, v.data());
+
+    return v;
+}
+
+/*!
+    \fn const quint8* AnalogSampleStore::constPackedCodes() const
+
+    Returns a pointer to the packed 12-bit codes. Two codes are stored in
+    three bytes with the first code in the lower 12 bits. Must only be
+    called if hasCodes() returns true.
+
+    \sa packedSize()
+*/
+
+/*!
+    \fn int AnalogSampleStore::packedSize(int numCodes)
+
+    Returns the number of bytes needed to store \a numCodes packed codes.
+*/
+
+/*!
+    Constructs a sample store for the \a size codes that have already been
+    packed into \a packed, e.g., by reading back a file written from
+    constPackedCodes(). The value in volts of a sample is calculated as
+    \a a + \a b * code.
+*/
+AnalogSampleStore AnalogSampleStore::fromPackedCodes(const quint8 *packed,
+                                                     int size,
+                                                     double a, double b)
+{
+    AnalogSampleStore s;
+    if (size <= 0) return s;
+
+    s.mSize = size;
+    s.mHasCodes = true;
+    s.mA = a;
+    s.mB = b;
+
+    int bytes = packedSize(size);
+    s.mCodes.resize(bytes);
+    memcpy(s.mCodes.data(), packed, bytes);
+
+    return s;
+}
+
+/*!
+    Returns the number of bytes used to store the samples.
+*/
+qint64 AnalogSampleStore::memoryUsage() const
+{
+    return (qint64)mCodes.capacity()
+            + (qint64)mValues.capacity() * sizeof(double);
+}
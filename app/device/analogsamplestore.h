@@ -0,0 +1,70 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALOGSAMPLESTORE_H
+#define ANALOGSAMPLESTORE_H
+
+#include <QtGlobal>
+#include <QVector>
+
+class AnalogSampleStore
+{
+public:
+
+    enum Constants {
+        CodeMask = 0xfff,
+        BlockSize = 256
+    };
+
+    AnalogSampleStore();
+    AnalogSampleStore(const quint16* codes, int size, double a, double b);
+    explicit AnalogSampleStore(const QVector<double> &values);
+
+    int size() const {return mSize;}
+    bool isEmpty() const {return mSize == 0;}
+    void clear();
+
+    bool hasCodes() const {return mHasCodes;}
+    double factorA() const {return mA;}
+    double factorB() const {return mB;}
+
+    int codeAt(int i) const;
+    double at(int i) const
+        {return (mHasCodes ? mA + mB*codeAt(i) : mValues.at(i));}
+
+    void values(int from, int count, double* dest) const;
+    QVector<double> toVector() const;
+
+    const quint8* constPackedCodes() const {return mCodes.constData();}
+    static int packedSize(int numCodes) {return ((numCodes+1)/2)*3;}
+    static AnalogSampleStore fromPackedCodes(const quint8* packed, int size,
+                                             double a, double b);
+
+    qint64 memoryUsage() const;
+
+private:
+
+    int mSize;
+    bool mHasCodes;
+    double mA;
+    double mB;
+
+    // two 12-bit codes are packed in three bytes
+    QVector<quint8> mCodes;
+    QVector<double> mValues;
+
+};
+
+#endif // ANALOGSAMPLESTORE_H
@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "captureconditiontask.h"
+
+/*!
+    \class CaptureConditionTask
+    \brief Evaluates a stop condition on one capture segment in a
+        thread pool.
+
+    \ingroup Device
+
+    The task is created by the CaptureTriggerEngine on the GUI thread with
+    its own copy of the condition and of the segment. The signal data in the
+    segment is implicitly shared so the copy is cheap and the task is not
+    affected by the capture history evicting the segment.
+*/
+
+/*!
+    Constructs a task that evaluates \a condition on \a segment. The
+    \a generation is the generation of the engine when the task was created
+    and is used to ignore results that arrive after the engine has been
+    reset.
+
+    Deallocation:
+      The task takes ownership of the condition. The task itself is
+      deleted with deleteLater() once finished() has been delivered, see
+      CaptureTriggerEngine::evaluate().
+*/
+CaptureConditionTask::CaptureConditionTask(CaptureSegmentCondition *condition,
+                                           const CaptureSegment &segment,
+                                           int generation,
+                                           QObject *parent) :
+    QObject(parent)
+{
+    mCondition = condition;
+    mSegment = segment;
+    mGeneration = generation;
+    mMatched = false;
+
+    setAutoDelete(false);
+}
+
+/*!
+    Deletes the condition.
+*/
+CaptureConditionTask::~CaptureConditionTask()
+{
+    delete mCondition;
+}
+
+/*!
+    Evaluates the condition. Called by the thread pool.
+*/
+void CaptureConditionTask::run()
+{
+    mMatched = mCondition->matches(mSegment);
+
+    emit finished();
+}
+
+/*!
+    \fn const CaptureSegment& CaptureConditionTask::segment() const
+
+    Returns the evaluated segment.
+*/
+
+/*!
+    \fn int CaptureConditionTask::sequenceNumber() const
+
+    Returns the sequence number of the evaluated segment.
+*/
+
+/*!
+    \fn int CaptureConditionTask::generation() const
+
+    Returns the generation of the engine when the task was created.
+*/
+
+/*!
+    \fn bool CaptureConditionTask::isMatched() const
+
+    Returns true if the segment matched the condition. Only valid once
+    finished() has been emitted.
+*/
+
+/*!
+    \fn void CaptureConditionTask::finished()
+
+    This signal is emitted from the thread pool when the condition has
+    been evaluated.
+*/
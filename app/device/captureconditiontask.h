@@ -0,0 +1,53 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef CAPTURECONDITIONTASK_H
+#define CAPTURECONDITIONTASK_H
+
+#include <QObject>
+#include <QRunnable>
+
+#include "capturesegment.h"
+#include "capturesegmentcondition.h"
+
+class CaptureConditionTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    CaptureConditionTask(CaptureSegmentCondition* condition,
+                         const CaptureSegment &segment,
+                         int generation,
+                         QObject *parent = 0);
+    ~CaptureConditionTask();
+
+    void run();
+
+    const CaptureSegment& segment() const {return mSegment;}
+    int sequenceNumber() const {return mSegment.sequenceNumber();}
+    int generation() const {return mGeneration;}
+    bool isMatched() const {return mMatched;}
+
+signals:
+    void finished();
+
+private:
+    CaptureSegmentCondition* mCondition;
+    CaptureSegment mSegment;
+    int mGeneration;
+    bool mMatched;
+
+};
+
+#endif // CAPTURECONDITIONTASK_H
@@ -14,6 +14,7 @@
  *  limitations under the License.
  */
 #include "capturedevice.h"
+#include "capturefilewriter.h"
 
 #include <QDebug>
 #include <QVector>
@@ -38,6 +39,10 @@ CaptureDevice::CaptureDevice(QObject *parent) :
     QObject(parent)
 {
     mUsedSampleRate = 1;
+    mFileWriter = NULL;
+
+    connect(&mTriggerEngine, SIGNAL(stopConditionMatched(CaptureSegment)),
+            this, SLOT(handleStopConditionMatched(CaptureSegment)));
 }
 
 /*!
@@ -102,6 +107,14 @@ QList<double> CaptureDevice::supportedVPerDiv()
     after a capture has finished.
 */
 
+/*!
+    \fn virtual bool CaptureDevice::restartsContinuousCapture()
+
+    Returns true if the capture device starts the next capture by itself
+    in continuous mode. No new start request must then be issued after a
+    capture has finished.
+*/
+
 /*!
     \fn virtual void CaptureDevice::configureBeforeStart(QWidget* parent)
 
@@ -313,15 +326,15 @@ QString CaptureDevice::digitalSignalName(int id)
 */
 
 /*!
-    \fn virtual QVector<int>* CaptureDevice::digitalData(int signalId) = 0
+    \fn virtual DigitalSampleStore* CaptureDevice::digitalData(int signalId) = 0
 
-    Returns a vector with the latest captured digital signal data for the
-    given \a signalId. NULL is returned if there isn't any data for the given
-    ID.
+    Returns the bit-packed samples of the latest captured digital signal data
+    for the given \a signalId. NULL is returned if there isn't any data for
+    the given ID.
 */
 
 /*!
-    \fn virtual void CaptureDevice::setDigitalData(int signalId, QVector<int> data) = 0
+    \fn virtual void CaptureDevice::setDigitalData(int signalId, const DigitalSampleStore &data) = 0
 
     Set digital signal data \a data for the digital signal with ID \a signalID.
 */
@@ -425,17 +438,29 @@ QList<int> CaptureDevice::unusedAnalogIds()
 */
 
 /*!
-    \fn virtual QVector<double>* CaptureDevice::analogData(int signalId) = 0
+    \fn virtual AnalogSampleStore* CaptureDevice::analogData(int signalId) = 0
 
-    Returns a vector with the latest captured analog signal data for the
-    given \a signalId. NULL is returned if there isn't any data for the given
+    Returns the latest captured analog signal data for the given
+    \a signalId. NULL is returned if there isn't any data for the given
     ID.
 */
 
 /*!
-    \fn virtual void CaptureDevice::setAnalogData(int signalId, QVector<double> data) = 0
+    \fn virtual void CaptureDevice::setAnalogData(int signalId, const AnalogSampleStore &data) = 0
 
     Set analog signal data \a data for the analog signal with ID \a signalID.
+    The data is implicitly shared so packed 12-bit codes aren't expanded.
+*/
+
+/*!
+    \fn virtual AnalogMinMaxPyramid* CaptureDevice::analogMinMax(int signalId) = 0
+
+    Returns the minimum/maximum pyramid for the latest captured analog signal
+    data for the given \a signalId. NULL is returned if there isn't any data
+    for the given ID.
+
+    The pyramid is owned by the device and is valid until new signal data
+    is captured or set.
 */
 
 /*!
@@ -457,44 +482,211 @@ QList<int> CaptureDevice::unusedAnalogIds()
 */
 
 /*!
-    Get a list with digital transitions for the digital signal with ID
-    \a signalId. The first position in the list \a list will contain the
-    logical level of the signal at sample index 0. The remaining positions
-    (except the last) in the list will contain the sample indexes where
-    a transition (high-to-low or low-to-high) occured.
+    \fn virtual DigitalTransitions* CaptureDevice::digitalTransitions(int signalId) = 0
+
+    Returns the transitions of the latest captured digital signal data for
+    the given \a signalId. NULL is returned if there isn't any data for the
+    given ID.
 
-    The last position contains the last sample index of the data even if there
-    wasn't a transition at that index.
+    The transitions are owned by the device and are valid until new signal
+    data is captured or set.
 */
-void CaptureDevice::digitalTransitions(int signalId, QList<int> &list)
+
+/*!
+    Returns the sample index of the transition closest to time \a t for the
+    digital signal with ID \a signalId. -1 is returned if the signal doesn't
+    have any transitions.
+*/
+qint64 CaptureDevice::nearestDigitalTransition(int signalId, double t)
 {
+    DigitalTransitions* trans = digitalTransitions(signalId);
+    if (trans == NULL || usedSampleRate() <= 0) return -1;
 
-    QVector<int>* data = digitalData(signalId);
-    if (data != NULL && data->size() > 0) {
+    int pos = trans->nearest(timeToSampleIndex(t));
+    if (pos == -1) return -1;
 
-        int val = data->at(0);
+    return trans->at(pos);
+}
 
-        //
-        //  Index 0 always contains the logic level of the data at first
-        //  position. The remaining position contains transition index
-        //
-        list.append(val);
+/*!
+    Returns the sample index of the last transition at or before time \a t
+    for the digital signal with ID \a signalId. -1 is returned if there is
+    no such transition.
+*/
+qint64 CaptureDevice::previousDigitalTransition(int signalId, double t)
+{
+    DigitalTransitions* trans = digitalTransitions(signalId);
+    if (trans == NULL || usedSampleRate() <= 0) return -1;
 
+    int pos = trans->previous(timeToSampleIndex(t));
+    if (pos == -1) return -1;
 
-        for (int i = 1; i < data->size(); i++) {
-            if (data->at(i) != val) {
-                list.append(i);
-                val = data->at(i);
-            }
+    return trans->at(pos);
+}
+
+/*!
+    Returns the sample index of the first transition after time \a t for
+    the digital signal with ID \a signalId. -1 is returned if there is no
+    such transition.
+*/
+qint64 CaptureDevice::nextDigitalTransition(int signalId, double t)
+{
+    DigitalTransitions* trans = digitalTransitions(signalId);
+    if (trans == NULL || usedSampleRate() <= 0) return -1;
+
+    int pos = trans->next(timeToSampleIndex(t));
+    if (pos == -1) return -1;
+
+    return trans->at(pos);
+}
+
+/*!
+    Returns the number of transitions between time \a from and \a to
+    (inclusive) for the digital signal with ID \a signalId. The position
+    of the first of these transitions is stored in \a first and the
+    transitions are accessed through digitalTransitions() which means that
+    no data is copied.
+*/
+int CaptureDevice::digitalTransitionsInRange(int signalId, double from,
+                                             double to, int &first)
+{
+    first = 0;
+
+    DigitalTransitions* trans = digitalTransitions(signalId);
+    if (trans == NULL || usedSampleRate() <= 0 || to < from) return 0;
+
+    first = trans->lowerBound(timeToSampleIndex(from));
+    int last = trans->upperBound(timeToSampleIndex(to));
+
+    return last - first;
+}
+
+/*!
+    \fn CaptureHistory& CaptureDevice::captureHistory()
+
+    Returns the history of captures made in continuous mode.
+*/
+
+/*!
+    \fn CaptureTriggerEngine& CaptureDevice::triggerEngine()
+
+    Returns the engine that evaluates the stop condition on the captures
+    made in continuous mode.
+*/
+
+/*!
+    Replaces the current signal data with the data of the segment at
+    position \a index in the capture history. The segment can then be
+    analyzed and exported in the same way as the latest capture.
+
+    Returns false if there isn't any such segment.
+*/
+bool CaptureDevice::showCaptureSegment(int index)
+{
+    if (index < 0 || index >= mHistory.size()) return false;
+
+    showCaptureSegment(mHistory.at(index));
+
+    return true;
+}
+
+/*!
+    Replaces the current signal data with the data in \a segment, e.g., a
+    capture read back from a recording with CaptureFile.
+*/
+void CaptureDevice::showCaptureSegment(const CaptureSegment &segment)
+{
+    clearSignalData();
+    setUsedSampleRate(segment.sampleRate());
+
+    foreach(int id, segment.digitalIds()) {
+        setDigitalData(id, segment.digitalData(id));
+    }
+    foreach(int id, segment.analogIds()) {
+        setAnalogData(id, segment.analogData(id));
+    }
+
+    setDigitalTriggerIndex(segment.triggerIndex());
+}
+
+/*!
+    \fn CaptureFileWriter* CaptureDevice::captureFileWriter() const
+
+    Returns the writer that captures in continuous mode are recorded to or
+    NULL if they aren't recorded.
+*/
+
+/*!
+    \fn void CaptureDevice::setCaptureFileWriter(CaptureFileWriter* writer)
+
+    Records all following captures in continuous mode to \a writer. Set to
+    NULL to stop recording.
+
+    Deallocation:
+      The device doesn't take ownership of the writer.
+*/
+
+/*!
+    Stores the latest captured signal data as a new segment in the capture
+    history, queues it for the capture recording, if any, and for the
+    evaluation of the stop condition. This function is called by the
+    subclasses after each capture in continuous mode.
+
+    Returns false if the segment wasn't stored, i.e., if the history is
+    disabled or the segment didn't fit in its memory budget.
+*/
+bool CaptureDevice::recordCaptureSegment()
+{
+    CaptureSegment segment;
+    segment.setSampleRate(usedSampleRate());
+    segment.setTriggerIndex(digitalTriggerIndex());
+    segment.setNumSamples(lastSampleIndex()+1);
+
+    foreach(DigitalSignal* s, mDigitalSignalList) {
+        DigitalTransitions* t = digitalTransitions(s->id());
+        if (t != NULL) {
+            segment.setDigitalTransitions(s->id(), *t);
+        }
+    }
+    foreach(AnalogSignal* s, mAnalogSignalList) {
+        AnalogSampleStore* data = analogData(s->id());
+        if (data != NULL) {
+            segment.setAnalogData(s->id(), *data);
         }
+    }
 
-        //
-        //  The last index of the transition list always contains the "size",
-        //  i.e., the last sample time of the data list
-        //
-        list.append(data->size()-1);
+    // the history assigns the sequence number used in the recording
+    bool stored = mHistory.append(segment);
 
+    if (mFileWriter != NULL) {
+        mFileWriter->append(segment);
     }
+
+    // also evaluated if the history rejected it, the engine keeps its
+    // own copy of the segment
+    mTriggerEngine.evaluate(segment);
+
+    return stored;
+}
+
+/*!
+    Called when \a segment has matched the stop condition of the
+    triggerEngine(). The segment is the copy that was evaluated and may
+    no longer be in the captureHistory(). Subclasses that support
+    continuous capture stop the capture here. Does nothing by default.
+*/
+void CaptureDevice::handleStopConditionMatched(const CaptureSegment &segment)
+{
+    (void)segment;
+}
+
+/*!
+    Returns the sample index for time \a t using the sample rate of the
+    latest capture.
+*/
+qint64 CaptureDevice::timeToSampleIndex(double t)
+{
+    return (qint64)(t*usedSampleRate());
 }
 
 /*!
@@ -22,8 +22,16 @@
 #include <QMessageBox>
 
 #include "digitalsignal.h"
+#include "digitalsamplestore.h"
+#include "digitaltransitions.h"
 #include "analogsignal.h"
+#include "analogsamplestore.h"
+#include "analogminmaxpyramid.h"
 #include "reconfigurelistener.h"
+#include "capturehistory.h"
+#include "capturetriggerengine.h"
+
+class CaptureFileWriter;
 
 class CaptureDevice : public QObject, public ReconfigureListener
 {
@@ -38,6 +46,7 @@ public:
     virtual int maxNumAnalogSignals() = 0;
     virtual QList<double> supportedVPerDiv();
     virtual bool supportsContinuousCapture() {return false;}
+    virtual bool restartsContinuousCapture() {return false;}
 
     virtual void configureBeforeStart(QWidget* parent) {(void)parent;/* do nothing by default */}
     virtual void configureTrigger(QWidget* parent)
@@ -57,6 +66,9 @@ public:
 
     virtual void start(int sampleRate) = 0;
     virtual void stop() = 0;
+    virtual void setContinuousCapture(bool enable) {(void)enable;/* do nothing by default */}
+    virtual double capturesPerSecond() {return 0;}
+    virtual quint64 droppedFrames() {return 0;}
 
     virtual int usedSampleRate() {return mUsedSampleRate;}
     virtual void setUsedSampleRate(int sampleRate) {mUsedSampleRate = sampleRate;}
@@ -68,23 +80,37 @@ public:
     QString digitalSignalName(int id);
     QList<DigitalSignal*> digitalSignals() {return mDigitalSignalList;}
 
-    virtual QVector<int>* digitalData(int signalId) = 0;
-    virtual void setDigitalData(int signalId, QVector<int> data) = 0;
+    virtual DigitalSampleStore* digitalData(int signalId) = 0;
+    virtual void setDigitalData(int signalId, const DigitalSampleStore &data) = 0;
 
     AnalogSignal* addAnalogSignal(int id);
     void removeAnalogSignal(AnalogSignal* s);
     QList<int> unusedAnalogIds();
     QList<AnalogSignal*> analogSignals() {return mAnalogSignalList;}
 
-    virtual QVector<double>* analogData(int signalId) = 0;
-    virtual void setAnalogData(int signalId, QVector<double> data) = 0;
+    virtual AnalogSampleStore* analogData(int signalId) = 0;
+    virtual void setAnalogData(int signalId, const AnalogSampleStore &data) = 0;
+    virtual AnalogMinMaxPyramid* analogMinMax(int signalId) = 0;
 
     virtual void clearSignalData() = 0;
 
     virtual int digitalTriggerIndex() = 0;
     virtual void setDigitalTriggerIndex(int idx) = 0;
 
-    virtual void digitalTransitions(int signalId, QList<int> &list);
+    virtual DigitalTransitions* digitalTransitions(int signalId) = 0;
+    qint64 nearestDigitalTransition(int signalId, double t);
+    qint64 previousDigitalTransition(int signalId, double t);
+    qint64 nextDigitalTransition(int signalId, double t);
+    int digitalTransitionsInRange(int signalId, double from, double to,
+                                  int &first);
+
+    CaptureHistory& captureHistory() {return mHistory;}
+    CaptureTriggerEngine& triggerEngine() {return mTriggerEngine;}
+    bool showCaptureSegment(int index);
+    void showCaptureSegment(const CaptureSegment &segment);
+
+    CaptureFileWriter* captureFileWriter() const {return mFileWriter;}
+    void setCaptureFileWriter(CaptureFileWriter* writer) {mFileWriter = writer;}
 
 
 signals:
@@ -93,11 +119,23 @@ signals:
 public slots:
 
 
+protected slots:
+    virtual void handleStopConditionMatched(const CaptureSegment &segment);
+
 protected:
     int mUsedSampleRate;
     QList<DigitalSignal*> mDigitalSignalList;
     QList<AnalogSignal*> mAnalogSignalList;
 
+    bool recordCaptureSegment();
+
+private:
+    qint64 timeToSampleIndex(double t);
+
+    CaptureHistory mHistory;
+    CaptureTriggerEngine mTriggerEngine;
+    CaptureFileWriter* mFileWriter;
+
 
     
 };
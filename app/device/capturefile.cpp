@@ -0,0 +1,564 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "capturefile.h"
+
+#include <QtEndian>
+#include <string.h>
+
+/*!
+    \class CaptureFile
+    \brief CaptureFile gives access to the captures stored in a capture
+        recording.
+
+    \ingroup Device
+
+    A capture recording is written by the CaptureFileWriter while a
+    continuous capture is running. The file is append-only and consists of
+    a file header followed by one chunk per capture. The chunk index is
+    written at the end of the file when the recording is closed.
+
+    All numbers are stored in little endian byte order.
+
+    <table>
+      <tr><th>Part</th><th>Content</th></tr>
+      <tr><td>File header (32 bytes)</td>
+          <td>magic, version, header size, reserved, creation time in ms
+              since the epoch, reserved</td></tr>
+      <tr><td>Chunk header (40 bytes)</td>
+          <td>magic, number of blocks, chunk size including the header,
+              sequence number, sample rate, timestamp, trigger index,
+              number of samples</td></tr>
+      <tr><td>Block header (32 bytes)</td>
+          <td>block type, signal id, number of samples, data size,
+              calibration factors a and b (analog codes only)</td></tr>
+      <tr><td>Block data</td>
+          <td>digital: the samples packed 32 to a word as in
+              DigitalSampleStore. Analog codes: two 12-bit codes packed in
+              three bytes as in AnalogSampleStore. Analog values: doubles.
+              Padded to a multiple of 8 bytes.</td></tr>
+      <tr><td>Index</td>
+          <td>magic, number of entries and for each chunk its offset, size,
+              sequence number, trigger index, timestamp, number of samples
+              and sample rate</td></tr>
+      <tr><td>Trailer (16 bytes)</td>
+          <td>offset of the index, number of entries, magic</td></tr>
+    </table>
+
+    Opening a file only reads the index, the signal data is accessed
+    through memory mapping one chunk at a time. A multi gigabyte recording
+    therefore opens instantly and only the pages needed for the requested
+    samples are read from disk. If the index is missing, e.g., because the
+    application was terminated while recording, the chunk headers are
+    scanned instead.
+*/
+
+/*!
+    \enum CaptureFile::Constants
+
+    This enum describes the magic numbers and sizes of the file format.
+*/
+
+/*!
+    \enum CaptureFile::BlockType
+
+    This enum describes the types of signal data blocks.
+
+    \var CaptureFile::BlockType CaptureFile::BlockDigital
+    Digital samples packed into 32-bit words
+
+    \var CaptureFile::BlockType CaptureFile::BlockAnalogCodes
+    Analog samples as packed 12-bit codes with calibration factors
+
+    \var CaptureFile::BlockType CaptureFile::BlockAnalogValues
+    Analog samples as doubles, used for signals that don't have codes
+*/
+
+/*!
+    \struct CaptureFile::ChunkInfo
+    \brief Describes one chunk, i.e., one capture, in a capture recording.
+*/
+
+static quint32 readU32(const uchar* p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+static qint32 readI32(const uchar* p)
+{
+    return qFromLittleEndian<qint32>(p);
+}
+
+static qint64 readI64(const uchar* p)
+{
+    return qFromLittleEndian<qint64>(p);
+}
+
+static double readDouble(const uchar* p)
+{
+    quint64 bits = qFromLittleEndian<quint64>(p);
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+/*!
+    Constructs a capture file object without any file opened.
+*/
+CaptureFile::CaptureFile()
+{
+    mHasIndex = false;
+    mMappedChunk = -1;
+    mMapped = NULL;
+}
+
+/*!
+    Closes the file.
+*/
+CaptureFile::~CaptureFile()
+{
+    close();
+}
+
+/*!
+    Opens the recording \a fileName and reads the chunk index. Returns
+    false if the file couldn't be opened or isn't a capture recording, see
+    errorString().
+*/
+bool CaptureFile::open(const QString &fileName)
+{
+    close();
+
+    mFile.setFileName(fileName);
+    if (!mFile.open(QIODevice::ReadOnly)) {
+        mErrorString = mFile.errorString();
+        return false;
+    }
+
+    QByteArray header = mFile.read(FileHeaderSize);
+    const uchar* p = (const uchar*)header.constData();
+    if (header.size() != FileHeaderSize || readU32(p) != FileMagic) {
+        mErrorString = QObject::tr("Not a capture recording");
+        close();
+        return false;
+    }
+    if (readU32(p+4) > Version) {
+        mErrorString = QObject::tr("Unsupported capture recording version");
+        close();
+        return false;
+    }
+
+    mHasIndex = readIndex();
+    if (!mHasIndex && !scanChunks()) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+    Closes the file and forgets the chunk index.
+*/
+void CaptureFile::close()
+{
+    if (mMapped != NULL) {
+        mFile.unmap(mMapped);
+        mMapped = NULL;
+    }
+    mMappedChunk = -1;
+    mChunks.clear();
+    mHasIndex = false;
+    mFile.close();
+}
+
+/*!
+    \fn bool CaptureFile::isOpen() const
+
+    Returns true if a recording has been opened.
+*/
+
+/*!
+    \fn QString CaptureFile::errorString() const
+
+    Returns a description of the last error.
+*/
+
+/*!
+    \fn bool CaptureFile::hasIndex() const
+
+    Returns true if the chunk index was read from the file. If false is
+    returned the recording wasn't closed properly and the chunks were
+    located by scanning the file.
+*/
+
+/*!
+    \fn int CaptureFile::numChunks() const
+
+    Returns the number of chunks (captures) in the recording.
+*/
+
+/*!
+    \fn const ChunkInfo& CaptureFile::chunkInfo(int chunk) const
+
+    Returns the information about \a chunk from the index. Can be used to
+    show the timestamps and trigger positions without reading any signal
+    data.
+*/
+
+/*!
+    Returns the position of the chunk with \a sequenceNumber or -1 if
+    there isn't any.
+*/
+int CaptureFile::findChunk(int sequenceNumber) const
+{
+    for (int i = 0; i < mChunks.size(); i++) {
+        if (mChunks.at(i).sequenceNumber == sequenceNumber) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+    Reads all signal data in \a chunk into \a segment. Returns false if the
+    chunk couldn't be read.
+*/
+bool CaptureFile::readSegment(int chunk, CaptureSegment &segment)
+{
+    const uchar* p = mapChunk(chunk);
+    if (p == NULL) return false;
+
+    const ChunkInfo &info = mChunks.at(chunk);
+    const uchar* end = p + info.size;
+
+    segment = CaptureSegment();
+    segment.setSequenceNumber(info.sequenceNumber);
+    segment.setTimestamp(info.timestamp);
+    segment.setSampleRate(info.sampleRate);
+    segment.setTriggerIndex(info.triggerIndex);
+    segment.setNumSamples(info.numSamples);
+
+    int numBlocks = (int)readU32(p+4);
+    const uchar* b = p + ChunkHeaderSize;
+
+    for (int i = 0; i < numBlocks; i++) {
+        if (end - b < BlockHeaderSize) return false;
+
+        int type = (int)readU32(b);
+        int id = readI32(b+4);
+        int n = readI32(b+8);
+        qint64 dataSize = readU32(b+12);
+        const uchar* data = b + BlockHeaderSize;
+
+        if (n < 0 || end - data < dataSize) return false;
+
+        if (type == BlockDigital) {
+            int numWords = (n + DigitalSampleStore::BitsPerWord - 1)
+                    / DigitalSampleStore::BitsPerWord;
+            if (dataSize < (qint64)numWords*4) return false;
+
+            DigitalSampleStore samples;
+            samples.reserve(numWords*DigitalSampleStore::BitsPerWord);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+            // blocks are 8 byte aligned within the chunk
+            samples.appendWords((const quint32*)data, numWords);
+#else
+            for (int w = 0; w < numWords; w++) {
+                samples.appendWord(readU32(data + w*4));
+            }
+#endif
+            samples.resize(n);
+            segment.setDigitalTransitions(
+                        id, DigitalTransitions::fromSamples(samples));
+        }
+        else if (type == BlockAnalogCodes) {
+            if (dataSize < AnalogSampleStore::packedSize(n)) return false;
+
+            segment.setAnalogData(id, AnalogSampleStore::fromPackedCodes(
+                                      data, n, readDouble(b+16),
+                                      readDouble(b+24)));
+        }
+        else if (type == BlockAnalogValues) {
+            if (dataSize < (qint64)n*8) return false;
+
+            QVector<double> values(n);
+            for (int s = 0; s < n; s++) {
+                values[s] = readDouble(data + s*8);
+            }
+            segment.setAnalogData(id, AnalogSampleStore(values));
+        }
+
+        // unknown block types are skipped
+        b = data + alignedSize((int)dataSize);
+    }
+
+    return true;
+}
+
+/*!
+    Converts \a count samples starting at index \a from of the analog
+    signal with id \a signalId in \a chunk to volts and stores them in
+    \a dest. Only the pages of the file containing the requested samples
+    are read. Returns the number of values stored in \a dest.
+*/
+int CaptureFile::analogValues(int chunk, int signalId, int from, int count,
+                              double *dest)
+{
+    const uchar* p = mapChunk(chunk);
+    if (p == NULL) return 0;
+
+    const uchar* b = findBlock(p, chunk, signalId, false);
+    if (b == NULL) return 0;
+
+    int type = (int)readU32(b);
+    int n = readI32(b+8);
+    const uchar* data = b + BlockHeaderSize;
+
+    if (from < 0) from = 0;
+    if (count > n - from) count = n - from;
+    if (count <= 0) return 0;
+
+    if (type == BlockAnalogValues) {
+        for (int i = 0; i < count; i++) {
+            dest[i] = readDouble(data + (qint64)(from+i)*8);
+        }
+        return count;
+    }
+
+    const double a = readDouble(b+16);
+    const double bFactor = readDouble(b+24);
+    for (int i = from; i < from + count; i++) {
+        const uchar* c = data + (qint64)(i/2)*3;
+        int code = ((i & 1) == 0 ? c[0] | ((c[1] & 0x0f) << 8)
+                                 : (c[1] >> 4) | (c[2] << 4));
+        *dest++ = a + bFactor*code;
+    }
+
+    return count;
+}
+
+/*!
+    Returns the transitions of the \a count samples starting at index
+    \a from of the digital signal with id \a signalId in \a chunk. The
+    first sample in the range gets index 0. Only the pages of the file
+    containing the requested samples are read.
+*/
+DigitalTransitions CaptureFile::digitalTransitions(int chunk, int signalId,
+                                                   int from, int count)
+{
+    const uchar* p = mapChunk(chunk);
+    if (p == NULL) return DigitalTransitions();
+
+    const uchar* b = findBlock(p, chunk, signalId, true);
+    if (b == NULL) return DigitalTransitions();
+
+    int n = readI32(b+8);
+    const uchar* data = b + BlockHeaderSize;
+
+    if (from < 0) from = 0;
+    if (count > n - from) count = n - from;
+    if (count <= 0) return DigitalTransitions();
+
+    int firstWord = from / DigitalSampleStore::BitsPerWord;
+    int lastWord = (from + count - 1) / DigitalSampleStore::BitsPerWord;
+
+    DigitalSampleStore samples;
+    samples.reserve((lastWord-firstWord+1)*DigitalSampleStore::BitsPerWord);
+    for (int w = firstWord; w <= lastWord; w++) {
+        samples.appendWord(readU32(data + (qint64)w*4));
+    }
+
+    return DigitalTransitions::fromSamples(
+                samples, from % DigitalSampleStore::BitsPerWord, count);
+}
+
+/*!
+    \fn int CaptureFile::alignedSize(int size)
+
+    Returns \a size rounded up to a multiple of BlockAlignment.
+*/
+
+/*!
+    Reads the index from the end of the file. Returns false if the file
+    doesn't have a valid index.
+*/
+bool CaptureFile::readIndex()
+{
+    qint64 fileSize = mFile.size();
+    if (fileSize < FileHeaderSize + TrailerSize) return false;
+
+    if (!mFile.seek(fileSize - TrailerSize)) return false;
+    QByteArray trailer = mFile.read(TrailerSize);
+    if (trailer.size() != TrailerSize) return false;
+
+    const uchar* t = (const uchar*)trailer.constData();
+    qint64 indexOffset = readI64(t);
+    int count = (int)readU32(t+8);
+    if (readU32(t+12) != TrailerMagic) return false;
+
+    qint64 indexSize = 8 + (qint64)count*IndexEntrySize;
+    if (count < 0 || indexOffset < FileHeaderSize
+            || indexOffset + indexSize + TrailerSize != fileSize) {
+        return false;
+    }
+
+    if (!mFile.seek(indexOffset)) return false;
+    QByteArray index = mFile.read(indexSize);
+    if (index.size() != indexSize) return false;
+
+    const uchar* p = (const uchar*)index.constData();
+    if (readU32(p) != IndexMagic || (int)readU32(p+4) != count) return false;
+    p += 8;
+
+    QVector<ChunkInfo> chunks;
+    chunks.reserve(count);
+    for (int i = 0; i < count; i++, p += IndexEntrySize) {
+        ChunkInfo info;
+        info.offset = readI64(p);
+        info.size = readI64(p+8);
+        info.sequenceNumber = readI32(p+16);
+        info.triggerIndex = readI32(p+20);
+        info.timestamp = readI64(p+24);
+        info.numSamples = readI32(p+32);
+        info.sampleRate = readI32(p+36);
+
+        if (info.offset < FileHeaderSize || info.size < ChunkHeaderSize
+                || info.offset + info.size > indexOffset) {
+            return false;
+        }
+        chunks.append(info);
+    }
+
+    mChunks = chunks;
+    return true;
+}
+
+/*!
+    Locates the chunks by reading the chunk headers one by one. Used when
+    the file doesn't have an index. A chunk that was only partially
+    written ends the scan.
+*/
+bool CaptureFile::scanChunks()
+{
+    qint64 fileSize = mFile.size();
+    qint64 pos = FileHeaderSize;
+
+    mChunks.clear();
+
+    while (pos + ChunkHeaderSize <= fileSize) {
+        if (!mFile.seek(pos)) break;
+
+        QByteArray header = mFile.read(ChunkHeaderSize);
+        if (header.size() != ChunkHeaderSize) break;
+
+        const uchar* p = (const uchar*)header.constData();
+        if (readU32(p) != ChunkMagic) break;
+
+        ChunkInfo info;
+        info.offset = pos;
+        info.size = readI64(p+8);
+        info.sequenceNumber = readI32(p+16);
+        info.sampleRate = readI32(p+20);
+        info.timestamp = readI64(p+24);
+        info.triggerIndex = readI32(p+32);
+        info.numSamples = readI32(p+36);
+
+        if (info.size < ChunkHeaderSize || pos + info.size > fileSize) break;
+
+        mChunks.append(info);
+        pos += info.size;
+    }
+
+    return true;
+}
+
+/*!
+    Maps \a chunk into memory and returns a pointer to its header. Only one
+    chunk is mapped at a time. NULL is returned if the chunk couldn't
+    be mapped.
+*/
+const uchar* CaptureFile::mapChunk(int chunk)
+{
+    if (chunk < 0 || chunk >= mChunks.size()) return NULL;
+
+    if (chunk == mMappedChunk) return mMapped;
+
+    if (mMapped != NULL) {
+        mFile.unmap(mMapped);
+        mMapped = NULL;
+        mMappedChunk = -1;
+    }
+
+    const ChunkInfo &info = mChunks.at(chunk);
+    mMapped = mFile.map(info.offset, info.size);
+    if (mMapped == NULL) {
+        mErrorString = mFile.errorString();
+        return NULL;
+    }
+
+    if (readU32(mMapped) != ChunkMagic) {
+        mErrorString = QObject::tr("Corrupt chunk in capture recording");
+        mFile.unmap(mMapped);
+        mMapped = NULL;
+        return NULL;
+    }
+
+    mMappedChunk = chunk;
+    return mMapped;
+}
+
+/*!
+    Returns a pointer to the header of the digital (\a digital is true) or
+    analog block for the signal with id \a signalId in the mapped
+    \a chunkData of \a chunk. Only the block headers are visited. NULL is
+    returned if there isn't any such block.
+*/
+const uchar* CaptureFile::findBlock(const uchar *chunkData, int chunk,
+                                    int signalId, bool digital)
+{
+    const uchar* end = chunkData + mChunks.at(chunk).size;
+    int numBlocks = (int)readU32(chunkData+4);
+    const uchar* b = chunkData + ChunkHeaderSize;
+
+    for (int i = 0; i < numBlocks; i++) {
+        if (end - b < BlockHeaderSize) break;
+
+        int type = (int)readU32(b);
+        int n = readI32(b+8);
+        qint64 dataSize = readU32(b+12);
+        if (n < 0 || end - b - BlockHeaderSize < dataSize) break;
+
+        bool isDigital = (type == BlockDigital);
+        bool isAnalog = (type == BlockAnalogCodes
+                         || type == BlockAnalogValues);
+
+        if (readI32(b+4) == signalId && (digital ? isDigital : isAnalog)) {
+            // make sure the data fits for the number of samples
+            qint64 needed = (digital ? ((qint64)n + 31)/32*4
+                                     : (type == BlockAnalogCodes
+                                        ? (qint64)AnalogSampleStore::packedSize(n)
+                                        : (qint64)n*8));
+            if (dataSize < needed) break;
+
+            return b;
+        }
+
+        b += BlockHeaderSize + alignedSize((int)dataSize);
+    }
+
+    return NULL;
+}
@@ -0,0 +1,105 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QtGlobal>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "capturesegment.h"
+
+class CaptureFile
+{
+public:
+
+    enum Constants {
+        FileMagic       = 0x4643544C, // "LTCF"
+        ChunkMagic      = 0x4B4E4843, // "CHNK"
+        IndexMagic      = 0x58444E49, // "INDX"
+        TrailerMagic    = 0x45435446, // "FTCE"
+        Version         = 1,
+
+        FileHeaderSize  = 32,
+        ChunkHeaderSize = 40,
+        BlockHeaderSize = 32,
+        IndexEntrySize  = 40,
+        TrailerSize     = 16,
+
+        BlockAlignment  = 8
+    };
+
+    enum BlockType {
+        BlockDigital       = 1,
+        BlockAnalogCodes   = 2,
+        BlockAnalogValues  = 3
+    };
+
+    struct ChunkInfo {
+        qint64 offset;
+        qint64 size;
+        int sequenceNumber;
+        int triggerIndex;
+        qint64 timestamp;
+        int numSamples;
+        int sampleRate;
+    };
+
+    CaptureFile();
+    ~CaptureFile();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const {return mFile.isOpen();}
+    QString errorString() const {return mErrorString;}
+    bool hasIndex() const {return mHasIndex;}
+
+    int numChunks() const {return mChunks.size();}
+    const ChunkInfo& chunkInfo(int chunk) const {return mChunks.at(chunk);}
+    int findChunk(int sequenceNumber) const;
+
+    bool readSegment(int chunk, CaptureSegment &segment);
+    int analogValues(int chunk, int signalId, int from, int count,
+                     double* dest);
+    DigitalTransitions digitalTransitions(int chunk, int signalId,
+                                          int from, int count);
+
+    static int alignedSize(int size)
+        {return (size + BlockAlignment - 1) & ~(BlockAlignment - 1);}
+
+private:
+    // hide copy constructor
+    CaptureFile(const CaptureFile&);
+    // hide assign operator
+    CaptureFile& operator=(const CaptureFile &);
+
+    bool readIndex();
+    bool scanChunks();
+    const uchar* mapChunk(int chunk);
+    const uchar* findBlock(const uchar* chunkData, int chunk, int signalId,
+                           bool digital);
+
+    QFile mFile;
+    QString mErrorString;
+    bool mHasIndex;
+    QVector<ChunkInfo> mChunks;
+
+    int mMappedChunk;
+    uchar* mMapped;
+};
+
+#endif // CAPTUREFILE_H
@@ -0,0 +1,443 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "capturefilewriter.h"
+
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QtEndian>
+#include <string.h>
+
+/*!
+    \class CaptureFileWriter
+    \brief CaptureFileWriter streams captures to a capture recording on a
+        separate thread.
+
+    \ingroup Device
+
+    The captures are appended with append() which only puts the segment in
+    a queue. Encoding and writing is done by the writer thread so that a
+    slow disk never delays the capture or the painting. The segments are
+    implicitly shared with the capture history which means that queuing
+    doesn't copy any samples.
+
+    If the disk can't keep up and the queue is full the segment is dropped
+    and counted, see numDropped(). The chunk index is written when the
+    recording is closed. The file format is described in CaptureFile.
+*/
+
+/*!
+    \enum CaptureFileWriter::Constants
+
+    This enum describes integer constants used by the writer.
+
+    \var CaptureFileWriter::Constants CaptureFileWriter::MaxQueuedSegments
+    The maximum number of segments waiting to be written
+*/
+
+static void writeU32(uchar* p, quint32 v)
+{
+    qToLittleEndian<quint32>(v, p);
+}
+
+static void writeI32(uchar* p, qint32 v)
+{
+    qToLittleEndian<qint32>(v, p);
+}
+
+static void writeI64(uchar* p, qint64 v)
+{
+    qToLittleEndian<qint64>(v, p);
+}
+
+static void writeDouble(uchar* p, double d)
+{
+    quint64 bits;
+    memcpy(&bits, &d, sizeof(bits));
+    qToLittleEndian<quint64>(bits, p);
+}
+
+/*!
+    Constructs a writer with the given \a parent.
+*/
+CaptureFileWriter::CaptureFileWriter(QObject *parent) :
+    QThread(parent)
+{
+    mStopRequested = false;
+    mOpen = false;
+    mNumWritten = 0;
+    mNumDropped = 0;
+    mBytesWritten = 0;
+}
+
+/*!
+    Closes the recording.
+*/
+CaptureFileWriter::~CaptureFileWriter()
+{
+    close();
+}
+
+/*!
+    Creates the recording \a fileName, writes the file header and starts
+    the writer thread. An existing file is overwritten. Returns false if
+    the file couldn't be created, see errorString().
+*/
+bool CaptureFileWriter::open(const QString &fileName)
+{
+    close();
+
+    mFile.setFileName(fileName);
+    if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        mErrorString = mFile.errorString();
+        return false;
+    }
+
+    uchar header[CaptureFile::FileHeaderSize];
+    memset(header, 0, sizeof(header));
+    writeU32(header, CaptureFile::FileMagic);
+    writeU32(header+4, CaptureFile::Version);
+    writeU32(header+8, CaptureFile::FileHeaderSize);
+    writeI64(header+16, QDateTime::currentMSecsSinceEpoch());
+
+    if (mFile.write((const char*)header, sizeof(header)) != sizeof(header)) {
+        mErrorString = mFile.errorString();
+        mFile.close();
+        return false;
+    }
+
+    mIndex.clear();
+    mQueue.clear();
+    mErrorString.clear();
+    mStopRequested = false;
+    mNumWritten = 0;
+    mNumDropped = 0;
+    mBytesWritten = CaptureFile::FileHeaderSize;
+    mOpen = true;
+
+    start(QThread::LowPriority);
+
+    return true;
+}
+
+/*!
+    Writes the queued segments and the chunk index and then closes
+    the recording. Blocks until the writer thread has finished.
+*/
+void CaptureFileWriter::close()
+{
+    {
+        QMutexLocker locker(&mMutex);
+        if (!mOpen) return;
+
+        mStopRequested = true;
+        mQueueNotEmpty.wakeOne();
+    }
+
+    wait();
+
+    if (errorString().isEmpty() && !writeIndex()) {
+        setError(mFile.errorString());
+    }
+    mFile.close();
+
+    QMutexLocker locker(&mMutex);
+    mOpen = false;
+}
+
+/*!
+    Returns true if a recording is open.
+*/
+bool CaptureFileWriter::isOpen() const
+{
+    QMutexLocker locker(&mMutex);
+    return mOpen;
+}
+
+/*!
+    \fn QString CaptureFileWriter::fileName() const
+
+    Returns the name of the recording.
+*/
+
+/*!
+    Returns a description of the last error or an empty string if there
+    hasn't been any error.
+*/
+QString CaptureFileWriter::errorString() const
+{
+    QMutexLocker locker(&mMutex);
+    return mErrorString;
+}
+
+/*!
+    Queues \a segment to be written to the recording. Returns false if the
+    segment was dropped because the queue is full or the recording isn't
+    open or has failed.
+*/
+bool CaptureFileWriter::append(const CaptureSegment &segment)
+{
+    QMutexLocker locker(&mMutex);
+
+    if (!mOpen || mStopRequested || !mErrorString.isEmpty()) return false;
+
+    if (mQueue.size() >= MaxQueuedSegments) {
+        mNumDropped++;
+        return false;
+    }
+
+    mQueue.enqueue(segment);
+    mQueueNotEmpty.wakeOne();
+
+    return true;
+}
+
+/*!
+    Returns the number of captures written to the recording.
+*/
+quint64 CaptureFileWriter::numWritten() const
+{
+    QMutexLocker locker(&mMutex);
+    return mNumWritten;
+}
+
+/*!
+    Returns the number of captures that were dropped because the queue
+    was full.
+*/
+quint64 CaptureFileWriter::numDropped() const
+{
+    QMutexLocker locker(&mMutex);
+    return mNumDropped;
+}
+
+/*!
+    Returns the size of the recording in bytes.
+*/
+qint64 CaptureFileWriter::bytesWritten() const
+{
+    QMutexLocker locker(&mMutex);
+    return mBytesWritten;
+}
+
+/*!
+    \fn void CaptureFileWriter::writeFailed(QString msg)
+
+    This signal is emitted from the writer thread when writing to the
+    recording fails. The reason is given by \a msg. No more captures are
+    written after a failure.
+*/
+
+/*!
+    Writes queued segments until close() is called.
+*/
+void CaptureFileWriter::run()
+{
+    forever {
+        CaptureSegment segment;
+
+        {
+            QMutexLocker locker(&mMutex);
+            while (mQueue.isEmpty() && !mStopRequested) {
+                mQueueNotEmpty.wait(&mMutex);
+            }
+            if (mQueue.isEmpty()) break;
+
+            segment = mQueue.dequeue();
+        }
+
+        if (!writeChunk(segment)) {
+            setError(mFile.errorString());
+            emit writeFailed(mFile.errorString());
+
+            QMutexLocker locker(&mMutex);
+            mQueue.clear();
+            break;
+        }
+    }
+}
+
+/*!
+    Encodes and appends \a segment as a new chunk. Returns false if the
+    chunk couldn't be written.
+*/
+bool CaptureFileWriter::writeChunk(const CaptureSegment &segment)
+{
+    QByteArray chunk = encodeChunk(segment);
+    qint64 offset = mFile.pos();
+
+    if (mFile.write(chunk) != chunk.size()) return false;
+
+    CaptureFile::ChunkInfo info;
+    info.offset = offset;
+    info.size = chunk.size();
+    info.sequenceNumber = segment.sequenceNumber();
+    info.triggerIndex = segment.triggerIndex();
+    info.timestamp = segment.timestamp();
+    info.numSamples = segment.numSamples();
+    info.sampleRate = segment.sampleRate();
+    mIndex.append(info);
+
+    QMutexLocker locker(&mMutex);
+    mNumWritten++;
+    mBytesWritten += chunk.size();
+
+    return true;
+}
+
+/*!
+    Appends the chunk index and the trailer. Returns false if they couldn't
+    be written.
+*/
+bool CaptureFileWriter::writeIndex()
+{
+    qint64 indexOffset = mFile.pos();
+    int count = mIndex.size();
+
+    QByteArray index(8 + count*CaptureFile::IndexEntrySize
+                     + CaptureFile::TrailerSize, 0);
+    uchar* p = (uchar*)index.data();
+
+    writeU32(p, CaptureFile::IndexMagic);
+    writeU32(p+4, count);
+    p += 8;
+
+    for (int i = 0; i < count; i++, p += CaptureFile::IndexEntrySize) {
+        const CaptureFile::ChunkInfo &info = mIndex.at(i);
+        writeI64(p, info.offset);
+        writeI64(p+8, info.size);
+        writeI32(p+16, info.sequenceNumber);
+        writeI32(p+20, info.triggerIndex);
+        writeI64(p+24, info.timestamp);
+        writeI32(p+32, info.numSamples);
+        writeI32(p+36, info.sampleRate);
+    }
+
+    writeI64(p, indexOffset);
+    writeU32(p+8, count);
+    writeU32(p+12, CaptureFile::TrailerMagic);
+
+    if (mFile.write(index) != index.size()) return false;
+
+    QMutexLocker locker(&mMutex);
+    mBytesWritten += index.size();
+
+    return mFile.flush();
+}
+
+/*!
+    Remembers \a msg as the reason for a failed recording.
+*/
+void CaptureFileWriter::setError(const QString &msg)
+{
+    QMutexLocker locker(&mMutex);
+    mErrorString = (msg.isEmpty() ? tr("Failed to write recording") : msg);
+}
+
+/*!
+    Encodes \a segment as a chunk. The size of the chunk is a multiple of
+    CaptureFile::BlockAlignment so that all blocks are aligned when the
+    file is mapped into memory.
+*/
+QByteArray CaptureFileWriter::encodeChunk(const CaptureSegment &segment)
+{
+    QList<int> digitalIds = segment.digitalIds();
+    QList<int> analogIds = segment.analogIds();
+
+    // the digital samples are recreated from the transitions once and
+    // kept until the chunk has been encoded
+    QVector<DigitalSampleStore> digital;
+    qint64 size = CaptureFile::ChunkHeaderSize;
+
+    foreach(int id, digitalIds) {
+        digital.append(segment.digitalData(id));
+        size += CaptureFile::BlockHeaderSize
+                + CaptureFile::alignedSize(digital.last().numWords()*4);
+    }
+    foreach(int id, analogIds) {
+        AnalogSampleStore s = segment.analogData(id);
+        int dataSize = (s.hasCodes() ? AnalogSampleStore::packedSize(s.size())
+                                     : s.size()*8);
+        size += CaptureFile::BlockHeaderSize
+                + CaptureFile::alignedSize(dataSize);
+    }
+
+    QByteArray chunk((int)size, 0);
+    uchar* p = (uchar*)chunk.data();
+
+    writeU32(p, CaptureFile::ChunkMagic);
+    writeU32(p+4, digitalIds.size() + analogIds.size());
+    writeI64(p+8, size);
+    writeI32(p+16, segment.sequenceNumber());
+    writeI32(p+20, segment.sampleRate());
+    writeI64(p+24, segment.timestamp());
+    writeI32(p+32, segment.triggerIndex());
+    writeI32(p+36, segment.numSamples());
+    p += CaptureFile::ChunkHeaderSize;
+
+    for (int i = 0; i < digitalIds.size(); i++) {
+        const DigitalSampleStore &s = digital.at(i);
+        int dataSize = s.numWords()*4;
+
+        writeU32(p, CaptureFile::BlockDigital);
+        writeI32(p+4, digitalIds.at(i));
+        writeI32(p+8, s.size());
+        writeU32(p+12, dataSize);
+        p += CaptureFile::BlockHeaderSize;
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        memcpy(p, s.constWords(), dataSize);
+#else
+        for (int w = 0; w < s.numWords(); w++) {
+            writeU32(p + w*4, s.word(w));
+        }
+#endif
+        p += CaptureFile::alignedSize(dataSize);
+    }
+
+    foreach(int id, analogIds) {
+        AnalogSampleStore s = segment.analogData(id);
+
+        writeI32(p+4, id);
+        writeI32(p+8, s.size());
+
+        if (s.hasCodes()) {
+            int dataSize = AnalogSampleStore::packedSize(s.size());
+
+            writeU32(p, CaptureFile::BlockAnalogCodes);
+            writeU32(p+12, dataSize);
+            writeDouble(p+16, s.factorA());
+            writeDouble(p+24, s.factorB());
+            p += CaptureFile::BlockHeaderSize;
+
+            memcpy(p, s.constPackedCodes(), dataSize);
+            p += CaptureFile::alignedSize(dataSize);
+        }
+        else {
+            int dataSize = s.size()*8;
+
+            writeU32(p, CaptureFile::BlockAnalogValues);
+            writeU32(p+12, dataSize);
+            p += CaptureFile::BlockHeaderSize;
+
+            for (int i = 0; i < s.size(); i++) {
+                writeDouble(p + i*8, s.at(i));
+            }
+            p += CaptureFile::alignedSize(dataSize);
+        }
+    }
+
+    return chunk;
+}
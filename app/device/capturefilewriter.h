@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef CAPTUREFILEWRITER_H
+#define CAPTUREFILEWRITER_H
+
+#include <QThread>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QVector>
+#include <QByteArray>
+
+#include "capturefile.h"
+#include "capturesegment.h"
+
+class CaptureFileWriter : public QThread
+{
+    Q_OBJECT
+public:
+
+    enum Constants {
+        MaxQueuedSegments = 8
+    };
+
+    explicit CaptureFileWriter(QObject *parent = 0);
+    ~CaptureFileWriter();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+    QString fileName() const {return mFile.fileName();}
+    QString errorString() const;
+
+    bool append(const CaptureSegment &segment);
+
+    quint64 numWritten() const;
+    quint64 numDropped() const;
+    qint64 bytesWritten() const;
+
+signals:
+    void writeFailed(QString msg);
+
+protected:
+    void run();
+
+private:
+    bool writeChunk(const CaptureSegment &segment);
+    bool writeIndex();
+    void setError(const QString &msg);
+
+    static QByteArray encodeChunk(const CaptureSegment &segment);
+
+    QFile mFile;
+
+    mutable QMutex mMutex;
+    QWaitCondition mQueueNotEmpty;
+    QQueue<CaptureSegment> mQueue;
+    bool mStopRequested;
+    bool mOpen;
+    QString mErrorString;
+    quint64 mNumWritten;
+    quint64 mNumDropped;
+    qint64 mBytesWritten;
+
+    // only accessed by the writer thread until it has finished
+    QVector<CaptureFile::ChunkInfo> mIndex;
+};
+
+#endif // CAPTUREFILEWRITER_H
@@ -0,0 +1,259 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "capturehistory.h"
+
+#include <QDateTime>
+
+/*!
+    \class CaptureHistory
+    \brief CaptureHistory is a ring of the latest captures made in
+        continuous mode.
+
+    \ingroup Device
+
+    In continuous mode each capture replaces the previous one on screen.
+    The history keeps the most recent captures as CaptureSegment instances
+    so that an earlier capture can be brought back, analyzed and exported.
+
+    Since the history can use its whole memory budget during a long
+    continuous capture, segments are only stored after a call to
+    setEnabled(). Sequence numbers are assigned also when disabled.
+
+    The history is bounded by a memory budget and optionally by a maximum
+    number of segments. The memory used by each segment is calculated when
+    it is appended and the oldest segments are evicted until the new one
+    fits. A segment that is larger than the whole budget is rejected.
+
+    Stop conditions are not evaluated by the history, see
+    CaptureTriggerEngine.
+*/
+
+/*!
+    \enum CaptureHistory::Constants
+
+    This enum describes integer constants used by the history.
+
+    \var CaptureHistory::Constants CaptureHistory::DefaultMemoryBudgetMB
+    The memory budget in megabytes used until setMemoryBudget() is called
+*/
+
+/*!
+    Constructs an empty and disabled history with the default memory
+    budget and no limit on the number of segments.
+*/
+CaptureHistory::CaptureHistory()
+{
+    mEnabled = false;
+    mMemoryBudget = (qint64)DefaultMemoryBudgetMB*1024*1024;
+    mMaxSegments = 0;
+    mMemoryUsage = 0;
+    mNextSequenceNumber = 1;
+    mNumEvicted = 0;
+    mNumRejected = 0;
+}
+
+/*!
+    Deletes the history.
+*/
+CaptureHistory::~CaptureHistory()
+{
+}
+
+/*!
+    \fn bool CaptureHistory::isEnabled() const
+
+    Returns true if appended segments are stored.
+*/
+
+/*!
+    Stores appended segments if \a enable is true. All stored segments are
+    removed when the history is disabled.
+*/
+void CaptureHistory::setEnabled(bool enable)
+{
+    mEnabled = enable;
+    if (!enable) {
+        clear();
+    }
+}
+
+/*!
+    \fn qint64 CaptureHistory::memoryBudget() const
+
+    Returns the maximum number of bytes used by the stored segments.
+*/
+
+/*!
+    Sets the maximum number of bytes used by the stored segments to
+    \a bytes. Segments are evicted if the new budget is lower than the
+    memory currently in use.
+*/
+void CaptureHistory::setMemoryBudget(qint64 bytes)
+{
+    mMemoryBudget = qMax(bytes, (qint64)0);
+    evict(0);
+}
+
+/*!
+    \fn int CaptureHistory::maxSegments() const
+
+    Returns the maximum number of stored segments. 0 means that only
+    the memory budget limits the number of segments.
+*/
+
+/*!
+    Sets the maximum number of stored segments to \a maxSegments. A value
+    of 0 removes the limit.
+*/
+void CaptureHistory::setMaxSegments(int maxSegments)
+{
+    mMaxSegments = qMax(maxSegments, 0);
+    evict(0);
+}
+
+/*!
+    Assigns the next sequence number and the current time as timestamp to
+    \a segment and appends a copy of it to the history. The oldest segments
+    are evicted to make room for it.
+
+    Returns false if the history is disabled or if the segment is larger
+    than the memory budget, in which case only the sequence number and
+    timestamp are assigned.
+*/
+bool CaptureHistory::append(CaptureSegment &segment)
+{
+    segment.setSequenceNumber(mNextSequenceNumber++);
+    segment.setTimestamp(QDateTime::currentMSecsSinceEpoch());
+
+    if (!mEnabled) return false;
+
+    qint64 usage = segment.memoryUsage();
+    if (usage > mMemoryBudget) {
+        mNumRejected++;
+        return false;
+    }
+
+    evict(usage);
+
+    mSegments.append(segment);
+    mSegmentUsage.append(usage);
+    mMemoryUsage += usage;
+
+    return true;
+}
+
+/*!
+    Removes all segments. The counters are kept.
+*/
+void CaptureHistory::clear()
+{
+    mSegments.clear();
+    mSegmentUsage.clear();
+    mMemoryUsage = 0;
+}
+
+/*!
+    \fn int CaptureHistory::size() const
+
+    Returns the number of stored segments.
+*/
+
+/*!
+    \fn bool CaptureHistory::isEmpty() const
+
+    Returns true if there aren't any stored segments.
+*/
+
+/*!
+    \fn const CaptureSegment& CaptureHistory::at(int i) const
+
+    Returns segment \a i where 0 is the oldest stored segment.
+*/
+
+/*!
+    \fn const CaptureSegment& CaptureHistory::last() const
+
+    Returns the most recently stored segment. The history must not
+    be empty.
+*/
+
+/*!
+    Returns the position of the segment with \a sequenceNumber or -1
+    if it isn't stored (anymore).
+*/
+int CaptureHistory::indexOf(int sequenceNumber) const
+{
+    // sequence numbers are increasing but rejected segments leave gaps
+    int low = 0;
+    int high = mSegments.size();
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (mSegments.at(mid).sequenceNumber() < sequenceNumber) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    if (low < mSegments.size()
+            && mSegments.at(low).sequenceNumber() == sequenceNumber) {
+        return low;
+    }
+
+    return -1;
+}
+
+/*!
+    \fn qint64 CaptureHistory::memoryUsage() const
+
+    Returns the number of bytes used by the stored segments.
+*/
+
+/*!
+    \fn quint64 CaptureHistory::numEvicted() const
+
+    Returns the number of segments that have been removed to make room
+    for newer ones.
+*/
+
+/*!
+    \fn quint64 CaptureHistory::numRejected() const
+
+    Returns the number of segments that were too large to be stored.
+*/
+
+/*!
+    Removes the oldest segments until \a neededBytes more bytes fit in the
+    memory budget and one more segment fits within the segment limit.
+    With \a neededBytes set to 0 only the current limits are enforced.
+*/
+void CaptureHistory::evict(qint64 neededBytes)
+{
+    int maxSegments = mMaxSegments;
+    if (maxSegments > 0 && neededBytes > 0) {
+        maxSegments--;
+    }
+
+    while (!mSegments.isEmpty()
+           && (mMemoryUsage + neededBytes > mMemoryBudget
+               || (mMaxSegments > 0 && mSegments.size() > maxSegments))) {
+        mMemoryUsage -= mSegmentUsage.takeFirst();
+        mSegments.removeFirst();
+        mNumEvicted++;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef CAPTUREHISTORY_H
+#define CAPTUREHISTORY_H
+
+#include <QtGlobal>
+#include <QList>
+
+#include "capturesegment.h"
+
+class CaptureHistory
+{
+public:
+
+    enum Constants {
+        DefaultMemoryBudgetMB = 256
+    };
+
+    CaptureHistory();
+    ~CaptureHistory();
+
+    bool isEnabled() const {return mEnabled;}
+    void setEnabled(bool enable);
+
+    qint64 memoryBudget() const {return mMemoryBudget;}
+    void setMemoryBudget(qint64 bytes);
+    int maxSegments() const {return mMaxSegments;}
+    void setMaxSegments(int maxSegments);
+
+    bool append(CaptureSegment &segment);
+    void clear();
+
+    int size() const {return mSegments.size();}
+    bool isEmpty() const {return mSegments.isEmpty();}
+    const CaptureSegment& at(int i) const {return mSegments.at(i);}
+    const CaptureSegment& last() const {return mSegments.last();}
+    int indexOf(int sequenceNumber) const;
+
+    qint64 memoryUsage() const {return mMemoryUsage;}
+    quint64 numEvicted() const {return mNumEvicted;}
+    quint64 numRejected() const {return mNumRejected;}
+
+private:
+    // hide copy constructor
+    CaptureHistory(const CaptureHistory&);
+    // hide assign operator
+    CaptureHistory& operator=(const CaptureHistory &);
+
+    void evict(qint64 neededBytes);
+
+    QList<CaptureSegment> mSegments;
+    QList<qint64> mSegmentUsage;
+    bool mEnabled;
+    qint64 mMemoryBudget;
+    int mMaxSegments;
+    qint64 mMemoryUsage;
+    int mNextSequenceNumber;
+    quint64 mNumEvicted;
+    quint64 mNumRejected;
+};
+
+#endif // CAPTUREHISTORY_H
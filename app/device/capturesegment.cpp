@@ -0,0 +1,193 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "capturesegment.h"
+
+/*!
+    \class CaptureSegment
+    \brief CaptureSegment holds the signal data of one capture in the
+        CaptureHistory.
+
+    \ingroup Device
+
+    The digital signals are kept as DigitalTransitions and the analog
+    signals as AnalogSampleStore with packed 12-bit codes, which is the
+    most compact form the capture devices have. Both are implicitly shared
+    so storing a segment of the current capture doesn't copy any samples.
+*/
+
+/*!
+    Constructs an empty segment.
+*/
+CaptureSegment::CaptureSegment()
+{
+    mSequenceNumber = 0;
+    mTimestamp = 0;
+    mSampleRate = 0;
+    mTriggerIndex = 0;
+    mNumSamples = 0;
+}
+
+/*!
+    \fn int CaptureSegment::sequenceNumber() const
+
+    Returns the sequence number of the segment. The number is assigned by
+    the CaptureHistory and increases with every stored capture.
+*/
+
+/*!
+    \fn void CaptureSegment::setSequenceNumber(int number)
+
+    Sets the sequence number to \a number.
+*/
+
+/*!
+    \fn qint64 CaptureSegment::timestamp() const
+
+    Returns the time when the capture was stored in milliseconds since
+    1970-01-01T00:00:00 UTC.
+*/
+
+/*!
+    \fn void CaptureSegment::setTimestamp(qint64 msecsSinceEpoch)
+
+    Sets the timestamp to \a msecsSinceEpoch.
+*/
+
+/*!
+    \fn int CaptureSegment::sampleRate() const
+
+    Returns the sample rate used for the capture.
+*/
+
+/*!
+    \fn void CaptureSegment::setSampleRate(int sampleRate)
+
+    Sets the sample rate to \a sampleRate.
+*/
+
+/*!
+    \fn int CaptureSegment::triggerIndex() const
+
+    Returns the sample index of the trigger.
+*/
+
+/*!
+    \fn void CaptureSegment::setTriggerIndex(int idx)
+
+    Sets the sample index of the trigger to \a idx.
+*/
+
+/*!
+    \fn int CaptureSegment::numSamples() const
+
+    Returns the number of samples in each signal.
+*/
+
+/*!
+    \fn void CaptureSegment::setNumSamples(int numSamples)
+
+    Sets the number of samples in each signal to \a numSamples.
+*/
+
+/*!
+    \fn QList<int> CaptureSegment::digitalIds() const
+
+    Returns the ids of the digital signals in this segment.
+*/
+
+/*!
+    \fn bool CaptureSegment::hasDigitalSignal(int signalId) const
+
+    Returns true if this segment has data for the digital signal with
+    id \a signalId.
+*/
+
+/*!
+    \fn DigitalTransitions CaptureSegment::digitalTransitions(int signalId) const
+
+    Returns the transitions of the digital signal with id \a signalId. An
+    empty transition list is returned if there isn't any such signal.
+*/
+
+/*!
+    Sets the transitions \a t for the digital signal with id \a signalId.
+*/
+void CaptureSegment::setDigitalTransitions(int signalId, const DigitalTransitions &t)
+{
+    mDigital.insert(signalId, t);
+}
+
+/*!
+    Recreates the samples of the digital signal with id \a signalId. Used
+    when exporting or showing a segment.
+*/
+DigitalSampleStore CaptureSegment::digitalData(int signalId) const
+{
+    if (!mDigital.contains(signalId)) {
+        return DigitalSampleStore();
+    }
+
+    return mDigital.value(signalId).toSamples();
+}
+
+/*!
+    \fn QList<int> CaptureSegment::analogIds() const
+
+    Returns the ids of the analog signals in this segment.
+*/
+
+/*!
+    \fn bool CaptureSegment::hasAnalogSignal(int signalId) const
+
+    Returns true if this segment has data for the analog signal with
+    id \a signalId.
+*/
+
+/*!
+    \fn AnalogSampleStore CaptureSegment::analogData(int signalId) const
+
+    Returns the samples of the analog signal with id \a signalId. An empty
+    store is returned if there isn't any such signal.
+*/
+
+/*!
+    Sets the samples \a data for the analog signal with id \a signalId.
+*/
+void CaptureSegment::setAnalogData(int signalId, const AnalogSampleStore &data)
+{
+    mAnalog.insert(signalId, data);
+}
+
+/*!
+    Returns the number of bytes used by the signal data in this segment.
+    Data shared with the current capture is included.
+*/
+qint64 CaptureSegment::memoryUsage() const
+{
+    qint64 usage = sizeof(CaptureSegment);
+
+    QMap<int, DigitalTransitions>::const_iterator d = mDigital.constBegin();
+    for (; d != mDigital.constEnd(); ++d) {
+        usage += d.value().memoryUsage();
+    }
+
+    QMap<int, AnalogSampleStore>::const_iterator a = mAnalog.constBegin();
+    for (; a != mAnalog.constEnd(); ++a) {
+        usage += a.value().memoryUsage();
+    }
+
+    return usage;
+}
@@ -0,0 +1,77 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef CAPTURESEGMENT_H
+#define CAPTURESEGMENT_H
+
+#include <QtGlobal>
+#include <QList>
+#include <QMap>
+
+#include "digitalsamplestore.h"
+#include "digitaltransitions.h"
+#include "analogsamplestore.h"
+
+class CaptureSegment
+{
+public:
+    CaptureSegment();
+
+    int sequenceNumber() const {return mSequenceNumber;}
+    void setSequenceNumber(int number) {mSequenceNumber = number;}
+
+    qint64 timestamp() const {return mTimestamp;}
+    void setTimestamp(qint64 msecsSinceEpoch) {mTimestamp = msecsSinceEpoch;}
+
+    int sampleRate() const {return mSampleRate;}
+    void setSampleRate(int sampleRate) {mSampleRate = sampleRate;}
+
+    int triggerIndex() const {return mTriggerIndex;}
+    void setTriggerIndex(int idx) {mTriggerIndex = idx;}
+
+    int numSamples() const {return mNumSamples;}
+    void setNumSamples(int numSamples) {mNumSamples = numSamples;}
+
+    QList<int> digitalIds() const {return mDigital.keys();}
+    bool hasDigitalSignal(int signalId) const
+        {return mDigital.contains(signalId);}
+    DigitalTransitions digitalTransitions(int signalId) const
+        {return mDigital.value(signalId);}
+    void setDigitalTransitions(int signalId, const DigitalTransitions &t);
+    DigitalSampleStore digitalData(int signalId) const;
+
+    QList<int> analogIds() const {return mAnalog.keys();}
+    bool hasAnalogSignal(int signalId) const
+        {return mAnalog.contains(signalId);}
+    AnalogSampleStore analogData(int signalId) const
+        {return mAnalog.value(signalId);}
+    void setAnalogData(int signalId, const AnalogSampleStore &data);
+
+    qint64 memoryUsage() const;
+
+private:
+
+    int mSequenceNumber;
+    qint64 mTimestamp;
+    int mSampleRate;
+    int mTriggerIndex;
+    int mNumSamples;
+
+    QMap<int, DigitalTransitions> mDigital;
+    QMap<int, AnalogSampleStore> mAnalog;
+
+};
+
+#endif // CAPTURESEGMENT_H
@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "capturesegmentcondition.h"
+
+/*!
+    \class CaptureSegmentCondition
+    \brief CaptureSegmentCondition is the base class of the conditions that
+        can stop a continuous capture.
+
+    \ingroup Device
+
+    Each capture in continuous mode is recorded as a CaptureSegment, see
+    CaptureHistory. If a stop condition has been set on the
+    CaptureTriggerEngine it is evaluated on every recorded segment and the
+    capture is stopped when a segment matches, which leaves the matching
+    capture on screen.
+
+    The engine evaluates the segments in a thread pool, each with its own
+    copy of the condition made with clone(). A condition therefore doesn't
+    need to be thread safe but must not depend on anything outside of
+    itself and the segment.
+*/
+
+/*!
+    \fn virtual bool CaptureSegmentCondition::matches(const CaptureSegment &segment) const = 0
+
+    Returns true if the \a segment fulfills the condition.
+*/
+
+/*!
+    \fn virtual CaptureSegmentCondition* CaptureSegmentCondition::clone() const = 0
+
+    Returns a copy of the condition.
+
+    Deallocation:
+      The caller takes ownership of the copy.
+*/
+
+
+/*!
+    \class PulseWidthCondition
+    \brief Matches a segment with a pulse of a given width on a digital
+        signal.
+
+    \ingroup Device
+
+    A pulse is the time between two consecutive transitions, i.e., both
+    high and low pulses are considered. Pulses that are cut off by the
+    start or end of the capture are ignored as their width is unknown.
+*/
+
+/*!
+    Constructs a condition that matches a pulse on the digital signal with
+    id \a signalId that is at least \a minWidth and at most \a maxWidth
+    seconds wide.
+*/
+PulseWidthCondition::PulseWidthCondition(int signalId, double minWidth,
+                                         double maxWidth)
+{
+    mSignalId = signalId;
+    mMinWidth = minWidth;
+    mMaxWidth = maxWidth;
+}
+
+/*!
+    \fn int PulseWidthCondition::signalId() const
+
+    Returns the id of the digital signal the condition is evaluated on.
+*/
+
+/*!
+    \fn double PulseWidthCondition::minWidth() const
+
+    Returns the minimum pulse width in seconds.
+*/
+
+/*!
+    \fn double PulseWidthCondition::maxWidth() const
+
+    Returns the maximum pulse width in seconds.
+*/
+
+/*!
+    Returns true if the \a segment has a pulse within the width limits on
+    the digital signal this condition is evaluated on.
+*/
+bool PulseWidthCondition::matches(const CaptureSegment &segment) const
+{
+    if (!segment.hasDigitalSignal(mSignalId) || segment.sampleRate() <= 0) {
+        return false;
+    }
+
+    // compare in samples to avoid a division for each pulse
+    const double minSamples = mMinWidth * segment.sampleRate();
+    const double maxSamples = mMaxWidth * segment.sampleRate();
+
+    DigitalTransitions t = segment.digitalTransitions(mSignalId);
+    const qint64* idx = t.constData();
+    for (int i = 1; i < t.size(); i++) {
+        double width = (double)(idx[i] - idx[i-1]);
+        if (width >= minSamples && width <= maxSamples) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    Returns a copy of the condition.
+*/
+CaptureSegmentCondition* PulseWidthCondition::clone() const
+{
+    return new PulseWidthCondition(mSignalId, mMinWidth, mMaxWidth);
+}
@@ -0,0 +1,51 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef CAPTURESEGMENTCONDITION_H
+#define CAPTURESEGMENTCONDITION_H
+
+#include <QtGlobal>
+
+#include "capturesegment.h"
+
+class CaptureSegmentCondition
+{
+public:
+    CaptureSegmentCondition() {}
+    virtual ~CaptureSegmentCondition() {}
+
+    virtual bool matches(const CaptureSegment &segment) const = 0;
+    virtual CaptureSegmentCondition* clone() const = 0;
+};
+
+class PulseWidthCondition : public CaptureSegmentCondition
+{
+public:
+    PulseWidthCondition(int signalId, double minWidth, double maxWidth);
+
+    int signalId() const {return mSignalId;}
+    double minWidth() const {return mMinWidth;}
+    double maxWidth() const {return mMaxWidth;}
+
+    bool matches(const CaptureSegment &segment) const;
+    CaptureSegmentCondition* clone() const;
+
+private:
+    int mSignalId;
+    double mMinWidth;
+    double mMaxWidth;
+};
+
+#endif // CAPTURESEGMENTCONDITION_H
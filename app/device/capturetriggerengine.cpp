@@ -0,0 +1,350 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "capturetriggerengine.h"
+
+#include <QThread>
+
+#include "captureconditiontask.h"
+
+/*!
+    \class CaptureTriggerEngine
+    \brief A host side trigger that evaluates a stop condition on each
+        capture made in continuous mode.
+
+    \ingroup Device
+
+    The hardware trigger only knows about edges and levels. The engine
+    makes it possible to capture continuously until a protocol event
+    happens, e.g. an I2C NACK from a given address or a UART framing error
+    (see I2CCondition, UartCondition and SpiCondition), and then freeze the
+    capture that contains it.
+
+    Decoding a capture takes much longer than converting it so the
+    condition is never evaluated on the GUI thread. For each capture
+    given to evaluate() a CaptureConditionTask with a clone() of the
+    condition and a copy of the segment is started in a thread pool owned
+    by the engine. The global QThreadPool used for the conversion of the
+    captures and by the analyzers is therefore never filled with slow
+    evaluations. The copy is also what is reported when the segment
+    matches, so it doesn't matter if the capture history has rejected or
+    evicted the segment by then. Captures arrive in order but the tasks may finish in any
+    order. A match is therefore only reported when all captures before it
+    have been evaluated, which makes sure that stopConditionMatched() is
+    emitted once with the first matching capture.
+
+    The number of tasks is limited to half the number of cores. If the
+    captures arrive faster than they can be evaluated the segments wait
+    in a queue and are evaluated as soon as a task has finished. Only if
+    the queue is full is a segment skipped. This is counted by
+    numSkipped() and reported with the segmentSkipped() signal, as the
+    event that should stop the capture may be in the skipped segment. The
+    number of captures evaluated per second is available from
+    evaluationsPerSecond() and can be compared with the capture rate to
+    see if the engine keeps up.
+*/
+
+/*!
+    Constructs an engine without a stop condition.
+*/
+CaptureTriggerEngine::CaptureTriggerEngine(QObject *parent) :
+    QObject(parent)
+{
+    mStopCondition = NULL;
+    mMatchedSequenceNumber = -1;
+    mCandidateSequenceNumber = -1;
+    mGeneration = 0;
+    mMaxPending = qMax(QThread::idealThreadCount()/2, 1);
+    mNumPending = 0;
+    mThreadPool.setMaxThreadCount(mMaxPending);
+
+    mNumEvaluated = 0;
+    mNumSkipped = 0;
+    mNumInPeriod = 0;
+    mEvaluationsPerSecond = 0;
+}
+
+/*!
+    Deletes the stop condition. Tasks that are still running own a copy
+    of the condition, the thread pool waits for them when it is deleted.
+*/
+CaptureTriggerEngine::~CaptureTriggerEngine()
+{
+    delete mStopCondition;
+}
+
+/*!
+    \fn CaptureSegmentCondition* CaptureTriggerEngine::stopCondition() const
+
+    Returns the stop condition or NULL if none has been set.
+*/
+
+/*!
+    Sets the stop condition to \a condition. Any previous condition is
+    deleted and the engine is reset. Use NULL to remove the condition.
+
+    Deallocation:
+      The engine takes ownership of the condition.
+*/
+void CaptureTriggerEngine::setStopCondition(CaptureSegmentCondition *condition)
+{
+    if (condition == mStopCondition) return;
+
+    delete mStopCondition;
+    mStopCondition = condition;
+    reset();
+}
+
+/*!
+    \fn bool CaptureTriggerEngine::hasStopCondition() const
+
+    Returns true if a stop condition has been set.
+*/
+
+/*!
+    Starts an evaluation of the stop condition on \a segment in the thread
+    pool. Nothing is done if there isn't any condition or if an earlier
+    segment has already matched the condition. If the maximum number of
+    evaluations are already pending the segment waits until an evaluation
+    has finished. The segment is only skipped, and segmentSkipped()
+    emitted, if too many segments are already waiting.
+*/
+void CaptureTriggerEngine::evaluate(const CaptureSegment &segment)
+{
+    if (mStopCondition == NULL || mCandidateSequenceNumber != -1) return;
+
+    if (!mRateTimer.isValid()) {
+        mRateTimer.start();
+    }
+
+    if (mNumPending >= mMaxPending) {
+        if (mWaitingSegments.size() >= MaxWaitingSegments) {
+            mNumSkipped++;
+            emit segmentSkipped(segment.sequenceNumber());
+            return;
+        }
+
+        // an earlier segment must be evaluated before a match is reported
+        mPendingSequenceNumbers.append(segment.sequenceNumber());
+        mWaitingSegments.enqueue(segment);
+        return;
+    }
+
+    mPendingSequenceNumbers.append(segment.sequenceNumber());
+    startEvaluation(segment);
+}
+
+/*!
+    Starts a CaptureConditionTask for \a segment. The sequence number of
+    the segment must already be in the list of pending sequence numbers.
+*/
+void CaptureTriggerEngine::startEvaluation(const CaptureSegment &segment)
+{
+    CaptureConditionTask* task = new CaptureConditionTask(
+                mStopCondition->clone(), segment, mGeneration);
+
+    // Deallocation: deleteLater is queued after handleTaskFinished as
+    // both are connected to the same signal
+    connect(task, SIGNAL(finished()), this, SLOT(handleTaskFinished()));
+    connect(task, SIGNAL(finished()), task, SLOT(deleteLater()));
+
+    mNumPending++;
+    mThreadPool.start(task);
+}
+
+/*!
+    Starts evaluations of waiting segments until the maximum number of
+    evaluations are pending. Waiting segments after a segment that has
+    matched the condition don't need to be evaluated and are removed.
+*/
+void CaptureTriggerEngine::startWaitingEvaluations()
+{
+    while (!mWaitingSegments.isEmpty() && mNumPending < mMaxPending) {
+        CaptureSegment segment = mWaitingSegments.dequeue();
+
+        if (mCandidateSequenceNumber != -1
+                && segment.sequenceNumber() > mCandidateSequenceNumber) {
+            mPendingSequenceNumbers.removeOne(segment.sequenceNumber());
+            continue;
+        }
+
+        startEvaluation(segment);
+    }
+}
+
+/*!
+    Forgets the matching segment and the statistics so that the condition
+    can match again. Results from evaluations that are still running are
+    ignored. Should be called when a new continuous capture is started.
+*/
+void CaptureTriggerEngine::reset()
+{
+    mGeneration++;
+    mMatchedSequenceNumber = -1;
+    mCandidateSequenceNumber = -1;
+    mCandidateSegment = CaptureSegment();
+    mPendingSequenceNumbers.clear();
+    mWaitingSegments.clear();
+
+    mNumEvaluated = 0;
+    mNumSkipped = 0;
+    mNumInPeriod = 0;
+    mEvaluationsPerSecond = 0;
+    mRateTimer.invalidate();
+}
+
+/*!
+    \fn bool CaptureTriggerEngine::isStopConditionMatched() const
+
+    Returns true if a segment has matched the stop condition since the
+    last call to reset().
+*/
+
+/*!
+    \fn int CaptureTriggerEngine::matchedSequenceNumber() const
+
+    Returns the sequence number of the segment that matched the stop
+    condition or -1 if there isn't any.
+*/
+
+/*!
+    \fn int CaptureTriggerEngine::maxPendingEvaluations() const
+
+    Returns the maximum number of evaluations running at the same time.
+*/
+
+/*!
+    Sets the maximum number of evaluations running at the same time to
+    \a maxPending. The default is half of QThread::idealThreadCount().
+*/
+void CaptureTriggerEngine::setMaxPendingEvaluations(int maxPending)
+{
+    mMaxPending = qMax(maxPending, 1);
+    mThreadPool.setMaxThreadCount(mMaxPending);
+}
+
+/*!
+    \fn int CaptureTriggerEngine::numPendingEvaluations() const
+
+    Returns the number of evaluations that haven't finished yet.
+*/
+
+/*!
+    \fn int CaptureTriggerEngine::numWaitingSegments() const
+
+    Returns the number of segments waiting for an evaluation to finish
+    before they can be evaluated.
+*/
+
+/*!
+    \fn quint64 CaptureTriggerEngine::numEvaluated() const
+
+    Returns the number of segments evaluated since the last reset().
+*/
+
+/*!
+    \fn quint64 CaptureTriggerEngine::numSkipped() const
+
+    Returns the number of segments that were not evaluated since the last
+    reset() because too many segments were waiting to be evaluated.
+*/
+
+/*!
+    \fn double CaptureTriggerEngine::evaluationsPerSecond() const
+
+    Returns the number of segments evaluated per second. The rate is
+    calculated over periods of at least one second.
+*/
+
+/*!
+    \fn void CaptureTriggerEngine::stopConditionMatched(const CaptureSegment &segment)
+
+    This signal is emitted when \a segment has matched the stop
+    condition and all segments before it have been
+    evaluated without matching. It is only emitted once until the engine
+    is reset.
+*/
+
+/*!
+    \fn void CaptureTriggerEngine::segmentSkipped(int sequenceNumber)
+
+    This signal is emitted when the segment with \a sequenceNumber is
+    not evaluated because too many segments are already waiting. An event
+    in this segment will not stop the capture.
+*/
+
+/*!
+    Called when an evaluation in the thread pool has finished.
+*/
+void CaptureTriggerEngine::handleTaskFinished()
+{
+    CaptureConditionTask* task = qobject_cast<CaptureConditionTask*>(sender());
+    if (task == NULL) return;
+
+    mNumPending--;
+
+    // the task was started before the last reset
+    if (task->generation() != mGeneration) {
+        startWaitingEvaluations();
+        return;
+    }
+
+    int seq = task->sequenceNumber();
+    mPendingSequenceNumbers.removeOne(seq);
+
+    mNumEvaluated++;
+    updateEvaluationRate();
+
+    // already reported
+    if (mMatchedSequenceNumber != -1) return;
+
+    if (task->isMatched()) {
+        if (mCandidateSequenceNumber == -1 || seq < mCandidateSequenceNumber) {
+            mCandidateSequenceNumber = seq;
+            mCandidateSegment = task->segment();
+        }
+    }
+
+    startWaitingEvaluations();
+
+    if (mCandidateSequenceNumber == -1) return;
+
+    // an earlier segment that is still being evaluated may also match
+    foreach(int pending, mPendingSequenceNumbers) {
+        if (pending < mCandidateSequenceNumber) return;
+    }
+
+    mMatchedSequenceNumber = mCandidateSequenceNumber;
+    emit stopConditionMatched(mCandidateSegment);
+
+    // the segment is kept by the receivers if needed
+    mCandidateSegment = CaptureSegment();
+}
+
+/*!
+    Updates the number of evaluations per second. The rate is calculated
+    over periods of at least one second.
+*/
+void CaptureTriggerEngine::updateEvaluationRate()
+{
+    mNumInPeriod++;
+
+    qint64 elapsed = mRateTimer.elapsed();
+    if (elapsed >= 1000) {
+        mEvaluationsPerSecond = mNumInPeriod*1000.0/elapsed;
+        mNumInPeriod = 0;
+        mRateTimer.restart();
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef CAPTURETRIGGERENGINE_H
+#define CAPTURETRIGGERENGINE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QQueue>
+#include <QThreadPool>
+
+#include "capturesegment.h"
+#include "capturesegmentcondition.h"
+
+class CaptureTriggerEngine : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CaptureTriggerEngine(QObject *parent = 0);
+    ~CaptureTriggerEngine();
+
+    CaptureSegmentCondition* stopCondition() const {return mStopCondition;}
+    void setStopCondition(CaptureSegmentCondition* condition);
+    bool hasStopCondition() const {return mStopCondition != NULL;}
+
+    void evaluate(const CaptureSegment &segment);
+    void reset();
+
+    bool isStopConditionMatched() const {return mMatchedSequenceNumber != -1;}
+    int matchedSequenceNumber() const {return mMatchedSequenceNumber;}
+
+    int maxPendingEvaluations() const {return mMaxPending;}
+    void setMaxPendingEvaluations(int maxPending);
+    int numPendingEvaluations() const {return mNumPending;}
+    int numWaitingSegments() const {return mWaitingSegments.size();}
+
+    quint64 numEvaluated() const {return mNumEvaluated;}
+    quint64 numSkipped() const {return mNumSkipped;}
+    double evaluationsPerSecond() const {return mEvaluationsPerSecond;}
+
+signals:
+    void stopConditionMatched(const CaptureSegment &segment);
+    void segmentSkipped(int sequenceNumber);
+
+private slots:
+    void handleTaskFinished();
+
+private:
+    // hide copy constructor
+    CaptureTriggerEngine(const CaptureTriggerEngine&);
+    // hide assign operator
+    CaptureTriggerEngine& operator=(const CaptureTriggerEngine &);
+
+    enum Constants {
+        // segments waiting for an evaluation to finish
+        MaxWaitingSegments = 16
+    };
+
+    void startEvaluation(const CaptureSegment &segment);
+    void startWaitingEvaluations();
+    void updateEvaluationRate();
+
+    CaptureSegmentCondition* mStopCondition;
+    int mMatchedSequenceNumber;
+    int mCandidateSequenceNumber;
+    CaptureSegment mCandidateSegment;
+    QList<int> mPendingSequenceNumbers;
+    int mGeneration;
+    int mMaxPending;
+    int mNumPending;
+    QQueue<CaptureSegment> mWaitingSegments;
+    QThreadPool mThreadPool;
+
+    quint64 mNumEvaluated;
+    quint64 mNumSkipped;
+    int mNumInPeriod;
+    double mEvaluationsPerSecond;
+    QElapsedTimer mRateTimer;
+};
+
+#endif // CAPTURETRIGGERENGINE_H
@@ -0,0 +1,530 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "digitalsamplestore.h"
+
+#include <string.h>
+
+/*!
+    \class DigitalSampleStore
+    \brief DigitalSampleStore is a bit-packed container for the samples of
+        one digital signal.
+
+    \ingroup Device
+
+    Each sample is stored as one bit in a vector of 32-bit words. Sample
+    \c i is found in word \c i/32 at bit position \c i%32, that is, the
+    first sample of a word is in the least significant bit. This is the same
+    layout as the 32-bit slice words delivered by the LabTool Hardware which
+    means that captured data can be appended a word at a time.
+
+    Bits in the last word that are beyond size() are always zero. This makes
+    it possible to compare, count and scan the data a word at a time.
+
+    The container is implicitly shared through QVector which means that it
+    is cheap to copy.
+*/
+
+/*!
+    \class DigitalSampleStore::ConstIterator
+    \brief Iterator used to visit the samples of a DigitalSampleStore in
+        order.
+
+    \ingroup Device
+*/
+
+/*!
+    Constructs an empty sample store.
+*/
+DigitalSampleStore::DigitalSampleStore()
+{
+    mSize = 0;
+}
+
+/*!
+    Constructs a sample store with \a size samples, all set to \a level.
+*/
+DigitalSampleStore::DigitalSampleStore(int size, int level)
+{
+    mSize = 0;
+    append(level, size);
+}
+
+/*!
+    \fn int DigitalSampleStore::size() const
+
+    Returns the number of samples in the store.
+*/
+
+/*!
+    \fn bool DigitalSampleStore::isEmpty() const
+
+    Returns true if the store doesn't contain any samples.
+*/
+
+/*!
+    Removes all samples from the store.
+*/
+void DigitalSampleStore::clear()
+{
+    mWords.clear();
+    mSize = 0;
+}
+
+/*!
+    Allocates memory for at least \a size samples.
+*/
+void DigitalSampleStore::reserve(int size)
+{
+    mWords.reserve((size + BitsPerWord - 1) / BitsPerWord);
+}
+
+/*!
+    Sets the number of samples to \a size. New samples are set to 0.
+*/
+void DigitalSampleStore::resize(int size)
+{
+    if (size < 0) size = 0;
+
+    mWords.resize((size + BitsPerWord - 1) / BitsPerWord);
+    mSize = size;
+    clearUnusedBits();
+}
+
+/*!
+    \fn int DigitalSampleStore::at(int i) const
+
+    Returns the logic level (0 or 1) of the sample at index \a i.
+*/
+
+/*!
+    Sets the sample at index \a i to \a level.
+*/
+void DigitalSampleStore::setLevel(int i, int level)
+{
+    quint32 mask = (quint32)1 << (i % BitsPerWord);
+
+    if (level) {
+        mWords[i / BitsPerWord] |= mask;
+    }
+    else {
+        mWords[i / BitsPerWord] &= ~mask;
+    }
+}
+
+/*!
+    \fn int DigitalSampleStore::first() const
+
+    Returns the level of the first sample. The store must not be empty.
+*/
+
+/*!
+    \fn int DigitalSampleStore::last() const
+
+    Returns the level of the last sample. The store must not be empty.
+*/
+
+/*!
+    Appends one sample with the given \a level.
+*/
+void DigitalSampleStore::append(int level)
+{
+    if ((mSize % BitsPerWord) == 0) {
+        mWords.append(0);
+    }
+
+    mSize++;
+    if (level) {
+        setLevel(mSize-1, 1);
+    }
+}
+
+/*!
+    Appends \a count samples, all with the given \a level.
+*/
+void DigitalSampleStore::append(int level, int count)
+{
+    if (count <= 0) return;
+
+    // complete the last partial word one sample at a time
+    while (count > 0 && (mSize % BitsPerWord) != 0) {
+        append(level);
+        count--;
+    }
+
+    // whole words
+    quint32 fill = (level ? 0xffffffff : 0);
+    while (count >= BitsPerWord) {
+        mWords.append(fill);
+        mSize += BitsPerWord;
+        count -= BitsPerWord;
+    }
+
+    // remaining samples
+    while (count > 0) {
+        append(level);
+        count--;
+    }
+}
+
+/*!
+    Appends 32 samples given by \a word. The first sample is in the least
+    significant bit.
+*/
+void DigitalSampleStore::appendWord(quint32 word)
+{
+    int shift = mSize % BitsPerWord;
+
+    if (shift == 0) {
+        mWords.append(word);
+    }
+    else {
+        mWords[mWords.size()-1] |= (word << shift);
+        mWords.append(word >> (BitsPerWord - shift));
+    }
+
+    mSize += BitsPerWord;
+}
+
+/*!
+    Appends \a numWords words of samples from \a words.
+
+    \sa appendWord()
+*/
+void DigitalSampleStore::appendWords(const quint32* words, int numWords)
+{
+    if (numWords <= 0) return;
+
+    if ((mSize % BitsPerWord) == 0) {
+        // word aligned -> copy the data as is
+        int pos = mWords.size();
+        mWords.resize(pos + numWords);
+        memcpy(mWords.data() + pos, words, numWords * sizeof(quint32));
+        mSize += numWords * BitsPerWord;
+    }
+    else {
+        for (int i = 0; i < numWords; i++) {
+            appendWord(words[i]);
+        }
+    }
+}
+
+/*!
+    Removes \a count samples starting at index \a from. Samples after the
+    removed range are moved towards the start of the store.
+*/
+void DigitalSampleStore::remove(int from, int count)
+{
+    if (from < 0 || from >= mSize || count <= 0) return;
+    if (from + count > mSize) {
+        count = mSize - from;
+    }
+
+    int newSize = mSize - count;
+    int dst = from;
+    int src = from + count;
+
+    // move samples one at a time until the destination is word aligned
+    while (dst < newSize && (dst % BitsPerWord) != 0) {
+        setLevel(dst++, at(src++));
+    }
+
+    // move whole words. The source is always at or after the destination
+    // and the source words are read before the destination word is written.
+    while (dst < newSize) {
+        mWords[dst / BitsPerWord] = bitsAt(src);
+        dst += BitsPerWord;
+        src += BitsPerWord;
+    }
+
+    resize(newSize);
+}
+
+/*!
+    \fn int DigitalSampleStore::numWords() const
+
+    Returns the number of 32-bit words used to store the samples.
+*/
+
+/*!
+    \fn quint32 DigitalSampleStore::word(int wordIdx) const
+
+    Returns the word at index \a wordIdx. Word \c n holds the samples
+    \c n*32 to \c n*32+31.
+*/
+
+/*!
+    \fn const quint32* DigitalSampleStore::constWords() const
+
+    Returns a pointer to the packed sample words.
+*/
+
+/*!
+    \fn quint32* DigitalSampleStore::words()
+
+    Returns a pointer to the packed sample words. Bits beyond size() in the
+    last word must be left as zero.
+*/
+
+/*!
+    Returns the index of the first sample at or after \a from that has the
+    given \a level. -1 is returned if there is no such sample.
+
+    The search is done a word at a time.
+*/
+int DigitalSampleStore::findLevel(int from, int level) const
+{
+    if (from < 0) from = 0;
+    if (from >= mSize) return -1;
+
+    int numWords = mWords.size();
+    int w = from / BitsPerWord;
+
+    // ignore samples before 'from' in the first word
+    quint32 mask = 0xffffffff << (from % BitsPerWord);
+
+    for (; w < numWords; w++) {
+        quint32 bits = mWords.at(w);
+        if (!level) {
+            bits = ~bits;
+        }
+        bits &= mask;
+        mask = 0xffffffff;
+
+        if (bits != 0) {
+            int idx = w*BitsPerWord + countTrailingZeros(bits);
+
+            // when looking for zeros the unused bits of the
+            // last word will match
+            if (idx >= mSize) break;
+
+            return idx;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+    Returns the index of the last sample at or before \a from that has the
+    given \a level. -1 is returned if there is no such sample.
+
+    The search is done a word at a time.
+*/
+int DigitalSampleStore::findPreviousLevel(int from, int level) const
+{
+    if (from >= mSize) from = mSize-1;
+    if (from < 0) return -1;
+
+    int w = from / BitsPerWord;
+
+    // ignore samples after 'from' in the first word
+    quint32 mask = 0xffffffff >> (BitsPerWord - 1 - (from % BitsPerWord));
+
+    for (; w >= 0; w--) {
+        quint32 bits = mWords.at(w);
+        if (!level) {
+            bits = ~bits;
+        }
+        bits &= mask;
+        mask = 0xffffffff;
+
+        if (bits != 0) {
+            return w*BitsPerWord + (BitsPerWord - 1 - countLeadingZeros(bits));
+        }
+    }
+
+    return -1;
+}
+
+/*!
+    Returns the index of the first sample after \a from that has a different
+    level than the sample at \a from. -1 is returned if the level doesn't
+    change after \a from.
+*/
+int DigitalSampleStore::nextTransition(int from) const
+{
+    if (from < 0 || from >= mSize-1) return -1;
+
+    return findLevel(from+1, at(from) ? 0 : 1);
+}
+
+/*!
+    Returns the number of samples in the range \a from (inclusive) to \a to
+    (exclusive) that have the given \a level.
+*/
+int DigitalSampleStore::countLevel(int from, int to, int level) const
+{
+    if (from < 0) from = 0;
+    if (to > mSize) to = mSize;
+    if (from >= to) return 0;
+
+    int ones = 0;
+    int firstWord = from / BitsPerWord;
+    int lastWord = (to - 1) / BitsPerWord;
+
+    for (int w = firstWord; w <= lastWord; w++) {
+        quint32 bits = mWords.at(w);
+
+        if (w == firstWord) {
+            bits &= 0xffffffff << (from % BitsPerWord);
+        }
+        if (w == lastWord) {
+            bits &= 0xffffffff >> (BitsPerWord - 1 - ((to - 1) % BitsPerWord));
+        }
+
+        ones += countOnes(bits);
+    }
+
+    return (level ? ones : (to - from) - ones);
+}
+
+/*!
+    \fn ConstIterator DigitalSampleStore::begin() const
+
+    Returns an iterator pointing to the first sample.
+*/
+
+/*!
+    \fn ConstIterator DigitalSampleStore::end() const
+
+    Returns an iterator pointing to the position after the last sample.
+*/
+
+/*!
+    \fn ConstIterator DigitalSampleStore::begin(int from) const
+
+    Returns an iterator pointing to the sample at index \a from.
+*/
+
+/*!
+    Returns the samples as a vector with one integer (0 or 1) per sample.
+*/
+QVector<int> DigitalSampleStore::toVector() const
+{
+    QVector<int> v(mSize);
+
+    for (int i = 0; i < mSize; i++) {
+        v[i] = at(i);
+    }
+
+    return v;
+}
+
+/*!
+    Creates a sample store from \a data which contains one integer per
+    sample. Any non-zero value is considered to be a logic high level.
+*/
+DigitalSampleStore DigitalSampleStore::fromVector(const QVector<int> &data)
+{
+    DigitalSampleStore s;
+    s.reserve(data.size());
+
+    for (int i = 0; i < data.size(); i++) {
+        s.append(data.at(i) != 0 ? 1 : 0);
+    }
+
+    return s;
+}
+
+/*!
+    Returns true if this store contains the same samples as \a other.
+*/
+bool DigitalSampleStore::operator==(const DigitalSampleStore &other) const
+{
+    return (mSize == other.mSize && mWords == other.mWords);
+}
+
+/*!
+    Returns 32 samples starting at index \a pos. Samples beyond the last
+    word are read as 0.
+*/
+quint32 DigitalSampleStore::bitsAt(int pos) const
+{
+    int w = pos / BitsPerWord;
+    int shift = pos % BitsPerWord;
+    quint32 bits = 0;
+
+    if (w < mWords.size()) {
+        bits = mWords.at(w) >> shift;
+    }
+    if (shift != 0 && w+1 < mWords.size()) {
+        bits |= mWords.at(w+1) << (BitsPerWord - shift);
+    }
+
+    return bits;
+}
+
+/*!
+    Clears the bits in the last word that are beyond size().
+*/
+void DigitalSampleStore::clearUnusedBits()
+{
+    int used = mSize % BitsPerWord;
+    if (used != 0) {
+        mWords[mWords.size()-1] &= (0xffffffff >> (BitsPerWord - used));
+    }
+}
+
+/*!
+    Returns the number of trailing zero bits in \a word which must not be 0.
+*/
+int DigitalSampleStore::countTrailingZeros(quint32 word)
+{
+#if defined(Q_CC_GNU)
+    return __builtin_ctz(word);
+#else
+    int n = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/*!
+    Returns the number of leading zero bits in \a word which must not be 0.
+*/
+int DigitalSampleStore::countLeadingZeros(quint32 word)
+{
+#if defined(Q_CC_GNU)
+    return __builtin_clz(word);
+#else
+    int n = 0;
+    while ((word & 0x80000000) == 0) {
+        word <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/*!
+    Returns the number of bits set in \a word.
+*/
+int DigitalSampleStore::countOnes(quint32 word)
+{
+#if defined(Q_CC_GNU)
+    return __builtin_popcount(word);
+#else
+    int n = 0;
+    while (word != 0) {
+        word &= word - 1;
+        n++;
+    }
+    return n;
+#endif
+}
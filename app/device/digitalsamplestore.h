@@ -0,0 +1,105 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DIGITALSAMPLESTORE_H
+#define DIGITALSAMPLESTORE_H
+
+#include <QtGlobal>
+#include <QVector>
+
+class DigitalSampleStore
+{
+public:
+
+    enum Constants {
+        BitsPerWord = 32
+    };
+
+    class ConstIterator
+    {
+    public:
+        ConstIterator(const DigitalSampleStore* store, int idx)
+            : mStore(store), mIdx(idx) {}
+
+        int operator*() const {return mStore->at(mIdx);}
+        int index() const {return mIdx;}
+        ConstIterator& operator++() {mIdx++; return *this;}
+        bool operator==(const ConstIterator &other) const
+            {return mIdx == other.mIdx;}
+        bool operator!=(const ConstIterator &other) const
+            {return mIdx != other.mIdx;}
+
+    private:
+        const DigitalSampleStore* mStore;
+        int mIdx;
+    };
+
+    DigitalSampleStore();
+    explicit DigitalSampleStore(int size, int level = 0);
+
+    int size() const {return mSize;}
+    bool isEmpty() const {return mSize == 0;}
+    void clear();
+    void reserve(int size);
+    void resize(int size);
+
+    int at(int i) const
+        {return (mWords.at(i / BitsPerWord) >> (i % BitsPerWord)) & 1;}
+    void setLevel(int i, int level);
+    int first() const {return at(0);}
+    int last() const {return at(mSize-1);}
+
+    void append(int level);
+    void append(int level, int count);
+    void appendWord(quint32 word);
+    void appendWords(const quint32* words, int numWords);
+    void remove(int from, int count);
+
+    int numWords() const {return mWords.size();}
+    quint32 word(int wordIdx) const {return mWords.at(wordIdx);}
+    const quint32* constWords() const {return mWords.constData();}
+    quint32* words() {return mWords.data();}
+
+    int findLevel(int from, int level) const;
+    int findPreviousLevel(int from, int level) const;
+    int nextTransition(int from) const;
+    int countLevel(int from, int to, int level) const;
+
+    ConstIterator begin() const {return ConstIterator(this, 0);}
+    ConstIterator end() const {return ConstIterator(this, mSize);}
+    ConstIterator begin(int from) const {return ConstIterator(this, from);}
+
+    QVector<int> toVector() const;
+    static DigitalSampleStore fromVector(const QVector<int> &data);
+
+    bool operator==(const DigitalSampleStore &other) const;
+    bool operator!=(const DigitalSampleStore &other) const
+        {return !(*this == other);}
+
+    static int countTrailingZeros(quint32 word);
+    static int countLeadingZeros(quint32 word);
+    static int countOnes(quint32 word);
+
+private:
+
+    QVector<quint32> mWords;
+    int mSize;
+
+    quint32 bitsAt(int pos) const;
+    void clearUnusedBits();
+
+};
+
+#endif // DIGITALSAMPLESTORE_H
@@ -0,0 +1,448 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "digitalsearch.h"
+
+/*!
+    \class DigitalSearch
+    \brief DigitalSearch finds the positions in a capture where the digital
+        signals match a pattern or have a pulse of a given width.
+
+    \ingroup Device
+
+    Two types of searches are supported:
+
+    \list
+    \li A pattern search where each signal has a Condition, e.g. D0 high,
+        D3 low and a rising edge on D5. A match is a run of consecutive
+        samples where all conditions are fulfilled. A pattern with an edge
+        condition only matches single samples.
+    \li A pulse width search where the time between two transitions on one
+        signal, while it has a given level, is within a range. A high pulse
+        shorter than 50 ns or a gap (low level) longer than 10 us are
+        typical examples.
+    \endlist
+
+    The search is done once, when the index is built, and all matches are
+    stored in sample order. Navigating to the next or previous match is then
+    a binary search which makes it possible to step through the matches of
+    a long capture interactively.
+
+    The pattern index is built from the packed samples in
+    DigitalSampleStore. All conditions are evaluated on 32 samples at a
+    time with bit operations, the edges of a word are found by comparing
+    the word with itself shifted one sample. The pulse index only visits the
+    transitions in DigitalTransitions and the time needed is therefore
+    independent of the length of the capture.
+*/
+
+/*!
+    \enum DigitalSearch::SearchType
+
+    This enum describes the type of search.
+
+    \var DigitalSearch::SearchType DigitalSearch::PatternSearch
+    The levels and edges of several signals are matched against a pattern
+
+    \var DigitalSearch::SearchType DigitalSearch::PulseWidthSearch
+    The widths of the pulses of one signal are compared with a range
+*/
+
+/*!
+    \enum DigitalSearch::Condition
+
+    This enum describes the condition a signal must fulfill in a pattern.
+
+    \var DigitalSearch::Condition DigitalSearch::DontCare
+    The signal is ignored
+
+    \var DigitalSearch::Condition DigitalSearch::Low
+    The signal must be low
+
+    \var DigitalSearch::Condition DigitalSearch::High
+    The signal must be high
+
+    \var DigitalSearch::Condition DigitalSearch::Rising
+    The signal must go from low to high at the sample
+
+    \var DigitalSearch::Condition DigitalSearch::Falling
+    The signal must go from high to low at the sample
+
+    \var DigitalSearch::Condition DigitalSearch::AnyEdge
+    The signal must change level at the sample
+*/
+
+/*!
+    Constructs an empty pattern search.
+*/
+DigitalSearch::DigitalSearch()
+{
+    mType = PatternSearch;
+    mPulseSignalId = -1;
+    mPulseLevel = 1;
+    mMinWidth = -1;
+    mMaxWidth = -1;
+    mIndexed = false;
+}
+
+/*!
+    \fn SearchType DigitalSearch::type() const
+
+    Returns the type of search.
+*/
+
+/*!
+    Makes this a pattern search where the signal with id \a key in
+    \a pattern must fulfill the condition it maps to. The index is cleared.
+*/
+void DigitalSearch::setPattern(const QMap<int, Condition> &pattern)
+{
+    mType = PatternSearch;
+    mPattern.clear();
+
+    QMap<int, Condition>::const_iterator it;
+    for (it = pattern.constBegin(); it != pattern.constEnd(); ++it) {
+        if (it.value() != DontCare) {
+            mPattern.insert(it.key(), it.value());
+        }
+    }
+
+    clearIndex();
+}
+
+/*!
+    \fn QMap<int, Condition> DigitalSearch::pattern() const
+
+    Returns the conditions of a pattern search. Signals that are ignored
+    aren't included.
+*/
+
+/*!
+    Makes this a pulse width search on the signal with id \a signalId.
+    A pulse where the signal has \a level and lasts at least \a minWidth
+    and at most \a maxWidth samples matches. Use -1 for a limit that
+    shouldn't be checked. The index is cleared.
+*/
+void DigitalSearch::setPulseWidth(int signalId, int level, qint64 minWidth,
+                                  qint64 maxWidth)
+{
+    mType = PulseWidthSearch;
+    mPulseSignalId = signalId;
+    mPulseLevel = (level ? 1 : 0);
+    mMinWidth = minWidth;
+    mMaxWidth = maxWidth;
+
+    clearIndex();
+}
+
+/*!
+    \fn int DigitalSearch::pulseSignalId() const
+
+    Returns the id of the signal in a pulse width search.
+*/
+
+/*!
+    \fn int DigitalSearch::pulseLevel() const
+
+    Returns the level of the pulses in a pulse width search.
+*/
+
+/*!
+    \fn qint64 DigitalSearch::minPulseWidth() const
+
+    Returns the minimum width in samples of a matching pulse or -1 if
+    there isn't any minimum.
+*/
+
+/*!
+    \fn qint64 DigitalSearch::maxPulseWidth() const
+
+    Returns the maximum width in samples of a matching pulse or -1 if
+    there isn't any maximum.
+*/
+
+/*!
+    Returns the ids of the signals needed to build the index.
+*/
+QList<int> DigitalSearch::signalIds() const
+{
+    QList<int> ids;
+
+    if (mType == PatternSearch) {
+        ids = mPattern.keys();
+    }
+    else if (mPulseSignalId >= 0) {
+        ids.append(mPulseSignalId);
+    }
+
+    return ids;
+}
+
+/*!
+    \fn bool DigitalSearch::isEmpty() const
+
+    Returns true if the search doesn't have any conditions.
+*/
+
+/*!
+    Searches the signals in \a samples, which maps signal id to the samples
+    of the signal, for the pattern and stores the matches. A signal in the
+    pattern that is missing in \a samples never matches.
+*/
+void DigitalSearch::buildPatternIndex(const QMap<int, DigitalSampleStore> &samples)
+{
+    clearIndex();
+    mIndexed = true;
+
+    if (mType != PatternSearch || mPattern.isEmpty()) return;
+
+    const int numSignals = mPattern.size();
+    QVector<DigitalSampleStore> stores(numSignals);
+    QVector<const quint32*> words(numSignals);
+    QVector<int> conditions(numSignals);
+
+    int numSamples = -1;
+    int s = 0;
+    QMap<int, Condition>::const_iterator it;
+    for (it = mPattern.constBegin(); it != mPattern.constEnd(); ++it, s++) {
+        if (!samples.contains(it.key())) return;
+
+        stores[s] = samples.value(it.key());
+        if (numSamples == -1 || stores.at(s).size() < numSamples) {
+            numSamples = stores.at(s).size();
+        }
+        words[s] = stores.at(s).constWords();
+        conditions[s] = it.value();
+    }
+
+    if (numSamples <= 0) return;
+
+    const int bitsPerWord = DigitalSampleStore::BitsPerWord;
+    const int numWords = (numSamples + bitsPerWord - 1) / bitsPerWord;
+    const int unusedBits = numWords*bitsPerWord - numSamples;
+
+    // bit 31 of the match mask of the previous word
+    quint32 prevMatch = 0;
+
+    for (int w = 0; w < numWords; w++) {
+        quint32 match = 0xffffffff;
+        if (w == numWords-1) {
+            match >>= unusedBits;
+        }
+
+        for (s = 0; s < numSignals && match != 0; s++) {
+            quint32 word = words[s][w];
+
+            // the first sample can't be an edge
+            quint32 prevBit = (w == 0 ? word & 1 : words[s][w-1] >> (bitsPerWord-1));
+
+            // bit i in diff is set if sample i differs from sample i-1
+            quint32 diff = word ^ ((word << 1) | prevBit);
+
+            switch (conditions[s]) {
+            case Low:
+                match &= ~word;
+                break;
+            case High:
+                match &= word;
+                break;
+            case Rising:
+                match &= diff & word;
+                break;
+            case Falling:
+                match &= diff & ~word;
+                break;
+            case AnyEdge:
+                match &= diff;
+                break;
+            default:
+                break;
+            }
+        }
+
+        // a run of matching samples starts where the mask goes from 0 to 1
+        // and ends where it goes from 1 to 0
+        quint32 shifted = (match << 1) | prevMatch;
+        quint32 starts = match & ~shifted;
+        quint32 ends = ~match & shifted;
+        prevMatch = match >> (bitsPerWord-1);
+
+        quint32 bits = starts | ends;
+        while (bits != 0) {
+            int b = DigitalSampleStore::countTrailingZeros(bits);
+            qint64 idx = (qint64)w*bitsPerWord + b;
+
+            if ((starts >> b) & 1) {
+                mMatchStart.append(idx);
+                mMatchEnd.append(numSamples-1);
+            }
+            else {
+                mMatchEnd.last() = idx-1;
+            }
+
+            bits &= bits - 1;
+        }
+    }
+
+    mMatchStart.squeeze();
+    mMatchEnd.squeeze();
+}
+
+/*!
+    Searches \a transitions, which must be the transitions of the signal
+    given to setPulseWidth(), for pulses of the given level and width and
+    stores the matches. The first and last level of the signal aren't
+    pulses since their width is unknown.
+*/
+void DigitalSearch::buildPulseIndex(const DigitalTransitions &transitions)
+{
+    clearIndex();
+    mIndexed = true;
+
+    if (mType != PulseWidthSearch || transitions.size() < 2) return;
+
+    const qint64* t = transitions.constData();
+    const int size = transitions.size();
+    const qint64 minWidth = mMinWidth;
+    const qint64 maxWidth = (mMaxWidth < 0 ? transitions.numSamples() : mMaxWidth);
+
+    // the pulses alternate between high and low
+    int i = (transitions.levelAfter(0) == mPulseLevel ? 0 : 1);
+    for (; i < size-1; i += 2) {
+        qint64 width = t[i+1] - t[i];
+        if (width >= minWidth && width <= maxWidth) {
+            mMatchStart.append(t[i]);
+            mMatchEnd.append(t[i+1]-1);
+        }
+    }
+
+    mMatchStart.squeeze();
+    mMatchEnd.squeeze();
+}
+
+/*!
+    Removes all matches. Should be called when the signal data changes.
+*/
+void DigitalSearch::clearIndex()
+{
+    mIndexed = false;
+    mMatchStart.clear();
+    mMatchEnd.clear();
+}
+
+/*!
+    \fn bool DigitalSearch::isIndexed() const
+
+    Returns true if the index has been built since the search or the
+    signal data changed.
+*/
+
+/*!
+    \fn int DigitalSearch::numMatches() const
+
+    Returns the number of matches in the index.
+*/
+
+/*!
+    \fn qint64 DigitalSearch::matchStart(int i) const
+
+    Returns the index of the first sample of match \a i.
+*/
+
+/*!
+    \fn qint64 DigitalSearch::matchEnd(int i) const
+
+    Returns the index of the last sample of match \a i.
+*/
+
+/*!
+    Returns the position of the first match that starts after
+    \a sampleIdx. -1 is returned if there is no such match.
+*/
+int DigitalSearch::next(qint64 sampleIdx) const
+{
+    const qint64* data = mMatchStart.constData();
+    int low = 0;
+    int high = mMatchStart.size();
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (data[mid] <= sampleIdx) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return (low < mMatchStart.size() ? low : -1);
+}
+
+/*!
+    Returns the position of the last match that starts before
+    \a sampleIdx. -1 is returned if there is no such match.
+*/
+int DigitalSearch::previous(qint64 sampleIdx) const
+{
+    const qint64* data = mMatchStart.constData();
+    int low = 0;
+    int high = mMatchStart.size();
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (data[mid] < sampleIdx) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low - 1;
+}
+
+/*!
+    Returns the number of bytes used to store the matches.
+*/
+qint64 DigitalSearch::memoryUsage() const
+{
+    return (qint64)(mMatchStart.capacity() + mMatchEnd.capacity())
+            * sizeof(qint64);
+}
+
+/*!
+    Returns a string representation of \a condition.
+*/
+QString DigitalSearch::conditionToString(Condition condition)
+{
+    switch (condition) {
+    case DontCare:
+        return QString("X");
+    case Low:
+        return QString("Low");
+    case High:
+        return QString("High");
+    case Rising:
+        return QString("Rising");
+    case Falling:
+        return QString("Falling");
+    case AnyEdge:
+        return QString("Any edge");
+    default:
+        break;
+    }
+
+    return QString();
+}
@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DIGITALSEARCH_H
+#define DIGITALSEARCH_H
+
+#include <QtGlobal>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "digitalsamplestore.h"
+#include "digitaltransitions.h"
+
+class DigitalSearch
+{
+public:
+
+    enum SearchType {
+        PatternSearch,
+        PulseWidthSearch
+    };
+
+    enum Condition {
+        DontCare,
+        Low,
+        High,
+        Rising,
+        Falling,
+        AnyEdge,
+        NumConditions // must be last
+    };
+
+    DigitalSearch();
+
+    SearchType type() const {return mType;}
+
+    void setPattern(const QMap<int, Condition> &pattern);
+    QMap<int, Condition> pattern() const {return mPattern;}
+
+    void setPulseWidth(int signalId, int level, qint64 minWidth,
+                       qint64 maxWidth);
+    int pulseSignalId() const {return mPulseSignalId;}
+    int pulseLevel() const {return mPulseLevel;}
+    qint64 minPulseWidth() const {return mMinWidth;}
+    qint64 maxPulseWidth() const {return mMaxWidth;}
+
+    QList<int> signalIds() const;
+    bool isEmpty() const {return signalIds().isEmpty();}
+
+    void buildPatternIndex(const QMap<int, DigitalSampleStore> &samples);
+    void buildPulseIndex(const DigitalTransitions &transitions);
+    void clearIndex();
+    bool isIndexed() const {return mIndexed;}
+
+    int numMatches() const {return mMatchStart.size();}
+    qint64 matchStart(int i) const {return mMatchStart.at(i);}
+    qint64 matchEnd(int i) const {return mMatchEnd.at(i);}
+
+    int next(qint64 sampleIdx) const;
+    int previous(qint64 sampleIdx) const;
+
+    qint64 memoryUsage() const;
+
+    static QString conditionToString(Condition condition);
+
+private:
+
+    SearchType mType;
+    QMap<int, Condition> mPattern;
+    int mPulseSignalId;
+    int mPulseLevel;
+    qint64 mMinWidth;
+    qint64 mMaxWidth;
+
+    bool mIndexed;
+    QVector<qint64> mMatchStart;
+    QVector<qint64> mMatchEnd;
+
+};
+
+#endif // DIGITALSEARCH_H
@@ -0,0 +1,345 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "digitaltransitions.h"
+
+/*!
+    \class DigitalTransitions
+    \brief DigitalTransitions is a run-length representation of the samples
+        of one digital signal.
+
+    \ingroup Device
+
+    Instead of storing every sample the signal is described by its level at
+    the first sample, the total number of samples and the sample index of
+    every transition. A transition at index \c t means that the sample at
+    \c t has a different level than the sample at \c t-1.
+
+    The transition indexes are 64-bit and stored in increasing order which
+    makes it possible to locate the transitions around any point in time
+    with a binary search. For a mostly idle signal the memory needed is
+    proportional to the number of transitions and not to the length of
+    the capture.
+*/
+
+/*!
+    Constructs an empty transition list.
+*/
+DigitalTransitions::DigitalTransitions()
+{
+    mInitialLevel = 0;
+    mNumSamples = 0;
+}
+
+/*!
+    Removes all transitions and sets the number of samples to 0.
+*/
+void DigitalTransitions::clear()
+{
+    mInitialLevel = 0;
+    mNumSamples = 0;
+    mIndexes.clear();
+}
+
+/*!
+    Reserves space for \a numTransitions transitions.
+*/
+void DigitalTransitions::reserve(int numTransitions)
+{
+    mIndexes.reserve(numTransitions);
+}
+
+/*!
+    Releases any memory not needed to store the transitions.
+*/
+void DigitalTransitions::squeeze()
+{
+    mIndexes.squeeze();
+}
+
+/*!
+    \fn int DigitalTransitions::initialLevel() const
+
+    Returns the level of the first sample.
+*/
+
+/*!
+    \fn void DigitalTransitions::setInitialLevel(int level)
+
+    Sets the level of the first sample to \a level.
+*/
+
+/*!
+    \fn qint64 DigitalTransitions::numSamples() const
+
+    Returns the number of samples described by this transition list.
+*/
+
+/*!
+    \fn void DigitalTransitions::setNumSamples(qint64 numSamples)
+
+    Sets the number of samples described by this transition list to
+    \a numSamples.
+*/
+
+/*!
+    \fn qint64 DigitalTransitions::lastIndex() const
+
+    Returns the index of the last sample.
+*/
+
+/*!
+    \fn int DigitalTransitions::size() const
+
+    Returns the number of transitions.
+*/
+
+/*!
+    \fn bool DigitalTransitions::isEmpty() const
+
+    Returns true if there are no transitions, i.e., the signal has the
+    same level for all samples.
+*/
+
+/*!
+    \fn qint64 DigitalTransitions::at(int i) const
+
+    Returns the sample index of transition \a i.
+*/
+
+/*!
+    \fn const qint64* DigitalTransitions::constData() const
+
+    Returns a pointer to the sample indexes of all transitions.
+*/
+
+/*!
+    \fn void DigitalTransitions::append(qint64 sampleIdx)
+
+    Appends a transition at \a sampleIdx which must be larger than the
+    index of the last transition.
+*/
+
+/*!
+    \fn int DigitalTransitions::levelAfter(int i) const
+
+    Returns the level of the signal from transition \a i up until the
+    next transition.
+*/
+
+/*!
+    Returns the level of the sample at \a sampleIdx.
+*/
+int DigitalTransitions::levelAt(qint64 sampleIdx) const
+{
+    int numBefore = upperBound(sampleIdx);
+
+    return mInitialLevel ^ (numBefore & 1);
+}
+
+/*!
+    Returns the position of the first transition at or after \a sampleIdx.
+    size() is returned if there is no such transition.
+*/
+int DigitalTransitions::lowerBound(qint64 sampleIdx) const
+{
+    const qint64* data = mIndexes.constData();
+    int low = 0;
+    int high = mIndexes.size();
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (data[mid] < sampleIdx) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/*!
+    Returns the position of the first transition after \a sampleIdx.
+    size() is returned if there is no such transition.
+*/
+int DigitalTransitions::upperBound(qint64 sampleIdx) const
+{
+    const qint64* data = mIndexes.constData();
+    int low = 0;
+    int high = mIndexes.size();
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (data[mid] <= sampleIdx) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/*!
+    Returns the position of the last transition at or before \a sampleIdx.
+    -1 is returned if there is no such transition.
+*/
+int DigitalTransitions::previous(qint64 sampleIdx) const
+{
+    return upperBound(sampleIdx) - 1;
+}
+
+/*!
+    Returns the position of the first transition after \a sampleIdx.
+    -1 is returned if there is no such transition.
+*/
+int DigitalTransitions::next(qint64 sampleIdx) const
+{
+    int pos = upperBound(sampleIdx);
+    if (pos == mIndexes.size()) {
+        pos = -1;
+    }
+
+    return pos;
+}
+
+/*!
+    Returns the position of the transition closest to \a sampleIdx. If two
+    transitions are at the same distance the one before \a sampleIdx is
+    returned. -1 is returned if there aren't any transitions.
+*/
+int DigitalTransitions::nearest(qint64 sampleIdx) const
+{
+    int after = upperBound(sampleIdx);
+    int before = after - 1;
+
+    if (after == mIndexes.size()) {
+        return before;
+    }
+    if (before < 0) {
+        return after;
+    }
+
+    if (sampleIdx - mIndexes.at(before) <= mIndexes.at(after) - sampleIdx) {
+        return before;
+    }
+
+    return after;
+}
+
+/*!
+    Returns the number of bytes used to store the transitions.
+*/
+qint64 DigitalTransitions::memoryUsage() const
+{
+    return (qint64)mIndexes.capacity() * sizeof(qint64);
+}
+
+/*!
+    Creates a transition list from the digital \a samples.
+
+    The samples are compared a word at a time so the time needed depends
+    on the number of words and transitions and not on the number of samples.
+*/
+DigitalTransitions DigitalTransitions::fromSamples(
+        const DigitalSampleStore &samples)
+{
+    return fromSamples(samples, 0, samples.size());
+}
+
+/*!
+    Creates a transition list from the \a count digital \a samples starting
+    at index \a from. The first sample in the range gets index 0 in the
+    transition list.
+
+    Only the words covering the range are visited, which makes it possible
+    to drop samples at the start or end of a capture without moving the
+    remaining samples.
+*/
+DigitalTransitions DigitalTransitions::fromSamples(
+        const DigitalSampleStore &samples, int from, int count)
+{
+    DigitalTransitions t;
+
+    if (from < 0) from = 0;
+    if (count > samples.size() - from) count = samples.size() - from;
+    if (count <= 0) {
+        return t;
+    }
+
+    t.setInitialLevel(samples.at(from));
+    t.setNumSamples(count);
+
+    const quint32* words = samples.constWords();
+    const int firstWord = from / DigitalSampleStore::BitsPerWord;
+    const int lastWord = (from + count - 1) / DigitalSampleStore::BitsPerWord;
+    const qint64 end = (qint64)from + count;
+
+    quint32 prevBit = 0;
+
+    // ignore samples up to and including 'from' in the first word since
+    // the first sample of the range can't be a transition
+    quint32 mask = (0xffffffff << (from % DigitalSampleStore::BitsPerWord)) << 1;
+
+    for (int w = firstWord; w <= lastWord; w++) {
+        quint32 word = words[w];
+
+        // bit i in diff is set if sample i differs from sample i-1
+        quint32 diff = (word ^ ((word << 1) | prevBit)) & mask;
+        prevBit = word >> (DigitalSampleStore::BitsPerWord - 1);
+        mask = 0xffffffff;
+
+        while (diff != 0) {
+            qint64 idx = (qint64)w*DigitalSampleStore::BitsPerWord
+                    + DigitalSampleStore::countTrailingZeros(diff);
+
+            // samples after the range, including the unused bits in the
+            // last word, must not give a transition
+            if (idx >= end) break;
+
+            t.append(idx - from);
+            diff &= diff - 1;
+        }
+    }
+
+    // the list may be kept for a long time in the capture history
+    t.squeeze();
+
+    return t;
+}
+
+/*!
+    Recreates all samples from the transition list.
+*/
+DigitalSampleStore DigitalTransitions::toSamples() const
+{
+    DigitalSampleStore samples;
+    samples.reserve((int)mNumSamples);
+
+    int level = mInitialLevel;
+    qint64 from = 0;
+    for (int i = 0; i < mIndexes.size(); i++) {
+        qint64 to = mIndexes.at(i);
+        samples.append(level, (int)(to - from));
+        level ^= 1;
+        from = to;
+    }
+    samples.append(level, (int)(mNumSamples - from));
+
+    return samples;
+}
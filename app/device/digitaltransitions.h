@@ -0,0 +1,71 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DIGITALTRANSITIONS_H
+#define DIGITALTRANSITIONS_H
+
+#include <QtGlobal>
+#include <QVector>
+
+#include "digitalsamplestore.h"
+
+class DigitalTransitions
+{
+public:
+    DigitalTransitions();
+
+    void clear();
+    void reserve(int numTransitions);
+    void squeeze();
+
+    int initialLevel() const {return mInitialLevel;}
+    void setInitialLevel(int level) {mInitialLevel = (level ? 1 : 0);}
+
+    qint64 numSamples() const {return mNumSamples;}
+    void setNumSamples(qint64 numSamples) {mNumSamples = numSamples;}
+    qint64 lastIndex() const {return mNumSamples-1;}
+
+    int size() const {return mIndexes.size();}
+    bool isEmpty() const {return mIndexes.isEmpty();}
+    qint64 at(int i) const {return mIndexes.at(i);}
+    const qint64* constData() const {return mIndexes.constData();}
+    void append(qint64 sampleIdx) {mIndexes.append(sampleIdx);}
+
+    int levelAfter(int i) const {return mInitialLevel ^ ((i+1) & 1);}
+    int levelAt(qint64 sampleIdx) const;
+
+    int lowerBound(qint64 sampleIdx) const;
+    int upperBound(qint64 sampleIdx) const;
+
+    int previous(qint64 sampleIdx) const;
+    int next(qint64 sampleIdx) const;
+    int nearest(qint64 sampleIdx) const;
+
+    qint64 memoryUsage() const;
+
+    static DigitalTransitions fromSamples(const DigitalSampleStore &samples);
+    static DigitalTransitions fromSamples(const DigitalSampleStore &samples,
+                                          int from, int count);
+    DigitalSampleStore toSamples() const;
+
+private:
+
+    int mInitialLevel;
+    qint64 mNumSamples;
+    QVector<qint64> mIndexes;
+
+};
+
+#endif // DIGITALTRANSITIONS_H
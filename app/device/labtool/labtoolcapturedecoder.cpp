@@ -0,0 +1,1042 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "labtoolcapturedecoder.h"
+
+#include <QDebug>
+
+#include "labtooldevicetransfer.h"
+#include "labtoolsampleunpacker.h"
+
+/*!
+    \class LabToolCaptureDecoder
+    \brief Converts the sample data received from the LabTool Hardware into
+        signal data in a thread pool.
+
+    \ingroup Device
+
+    A decoder is created by the LabToolCaptureDevice on the GUI thread when
+    a transfer with sample data has been received. Everything needed for
+    the conversion, such as the enabled signals, the sample rate and the
+    calibration data, is copied into the decoder so that the conversion
+    isn't affected by changes made in the UI while it is running.
+
+    The conversion is done by run() in a thread from the global QThreadPool.
+    The finished() signal is emitted when the conversion is done, also for
+    a cancelled decoder. The capture device then takes over the converted
+    signal data with the take functions. Data that hasn't been taken is
+    deallocated together with the decoder.
+
+    This makes it possible for the capture device to receive the next
+    capture while the previous one is converted and the one before that is
+    painted.
+*/
+
+/*!
+    Constructs a decoder for the sample data in \a transfer. The decoder
+    takes over the ownership of \a transfer. The remaining parameters are
+    the ones from the header of the sample data, see
+    LabToolCaptureDevice::handleReceivedSamples().
+*/
+LabToolCaptureDecoder::LabToolCaptureDecoder(LabToolDeviceTransfer *transfer,
+                                             unsigned int size,
+                                             unsigned int trigger,
+                                             unsigned int digitalTrigSample,
+                                             unsigned int analogTrigSample,
+                                             unsigned int digitalChannelInfo,
+                                             unsigned int analogChannelInfo,
+                                             int signalTrim,
+                                             QObject *parent) :
+    QObject(parent)
+{
+    // Deallocation: the decoder is deleted with deleteLater() once
+    // finished() has been delivered, see LabToolCaptureDevice
+    setAutoDelete(false);
+
+    mTransfer = transfer;
+    mSize = size;
+    mTrigger = trigger;
+    mDigitalTrigSample = digitalTrigSample;
+    mAnalogTrigSample = analogTrigSample;
+    mDigitalChannelInfo = digitalChannelInfo;
+    mAnalogChannelInfo = analogChannelInfo;
+    mSignalTrim = signalTrim;
+
+    mCalibration = NULL;
+    mNoiseFilterEnabled = false;
+    mNoiseFilter12BitLevel = 0;
+
+    mUsedSampleRate = 0;
+    mEndSampleIdx = 0;
+    mTriggerIndex = 0;
+
+    for (int i = 0; i < MaxDigitalSignals; i++) {
+        mDigitalSignals[i] = NULL;
+        mDigitalSignalTransitions[i] = NULL;
+    }
+
+    for (int i = 0; i < MaxAnalogSignals; i++) {
+        mAnalogSignals[i] = NULL;
+        mAnalogSignalData[i] = NULL;
+        mAnalogMinMax[i] = NULL;
+    }
+}
+
+/*!
+    Deletes the transfer, the copied settings and all converted signal data
+    that hasn't been taken.
+*/
+LabToolCaptureDecoder::~LabToolCaptureDecoder()
+{
+    // Deallocation: deleting the transfer returns its buffer to the pool
+    delete mTransfer;
+    mTransfer = NULL;
+
+    qDeleteAll(mDigitalSignalList);
+    qDeleteAll(mAnalogSignalList);
+    delete mCalibration;
+
+    deleteSignals();
+}
+
+/*!
+    Copies the \a digitalSignals and \a analogSignals that were enabled
+    when the capture was made.
+*/
+void LabToolCaptureDecoder::setSignals(const QList<DigitalSignal *> &digitalSignals, const QList<AnalogSignal *> &analogSignals)
+{
+    // Deallocation: the copies are deleted by the destructor
+    foreach(DigitalSignal* signal, digitalSignals) {
+        mDigitalSignalList.append(new DigitalSignal(*signal));
+    }
+    foreach(AnalogSignal* signal, analogSignals) {
+        mAnalogSignalList.append(new AnalogSignal(*signal));
+    }
+}
+
+/*!
+    \fn void LabToolCaptureDecoder::setSampleRate(int sampleRate)
+
+    Sets the sample rate that the capture was made with to \a sampleRate.
+*/
+
+/*!
+    Copies the calibration data \a calib that is used to convert the analog
+    samples into volts. The \a supportedVPerDiv list is used to find the
+    calibration factors for an analog signal's V/div setting.
+*/
+void LabToolCaptureDecoder::setCalibration(const LabToolCalibrationData *calib, const QList<double> &supportedVPerDiv)
+{
+    delete mCalibration;
+    mCalibration = NULL;
+
+    if (calib != NULL) {
+        // Deallocation: the copy is deleted by the destructor
+        mCalibration = new LabToolCalibrationData(*calib);
+    }
+    mSupportedVPerDiv = supportedVPerDiv;
+}
+
+/*!
+    Sets the noise filter settings used when locating an analog trigger.
+    The filter is \a enabled with the given \a level12Bit level.
+*/
+void LabToolCaptureDecoder::setNoiseFilter(bool enabled, int level12Bit)
+{
+    mNoiseFilterEnabled = enabled;
+    mNoiseFilter12BitLevel = level12Bit;
+}
+
+/*!
+    Converts the sample data. Called by the thread pool.
+*/
+void LabToolCaptureDecoder::run()
+{
+    if (!isCancelled()) {
+        decode();
+    }
+
+    // The samples have been converted so the receive buffer can be used
+    // for the next capture
+    mTransfer->releaseBuffer();
+
+    emit finished();
+}
+
+/*!
+    Request the decoder to stop. The result of a cancelled decoder must
+    not be used. Can be called from any thread.
+*/
+void LabToolCaptureDecoder::cancel()
+{
+    mCancelled.storeRelease(1);
+}
+
+/*!
+    Returns true if the decoder has been cancelled.
+*/
+bool LabToolCaptureDecoder::isCancelled() const
+{
+    return mCancelled.loadAcquire() != 0;
+}
+
+/*!
+    \fn int LabToolCaptureDecoder::sampleRate() const
+
+    Returns the sample rate that the capture was made with.
+*/
+
+/*!
+    \fn int LabToolCaptureDecoder::endSampleIndex() const
+
+    Returns the index of the last converted sample.
+*/
+
+/*!
+    \fn int LabToolCaptureDecoder::triggerIndex() const
+
+    Returns the sample index of the trigger.
+*/
+
+/*!
+    Returns the digital samples for the signal with id \a signalId or NULL
+    if there aren't any. The caller takes over the ownership.
+*/
+DigitalSampleStore* LabToolCaptureDecoder::takeDigitalData(int signalId)
+{
+    if (signalId < 0 || signalId >= MaxDigitalSignals) return NULL;
+
+    DigitalSampleStore* s = mDigitalSignals[signalId];
+    mDigitalSignals[signalId] = NULL;
+    return s;
+}
+
+/*!
+    Returns the transitions for the digital signal with id \a signalId or
+    NULL if there aren't any. The caller takes over the ownership.
+*/
+DigitalTransitions* LabToolCaptureDecoder::takeDigitalTransitions(int signalId)
+{
+    if (signalId < 0 || signalId >= MaxDigitalSignals) return NULL;
+
+    DigitalTransitions* t = mDigitalSignalTransitions[signalId];
+    mDigitalSignalTransitions[signalId] = NULL;
+    return t;
+}
+
+/*!
+    Returns the analog samples for the signal with id \a signalId or NULL
+    if there aren't any. The caller takes over the ownership.
+*/
+AnalogSampleStore* LabToolCaptureDecoder::takeAnalogData(int signalId)
+{
+    if (signalId < 0 || signalId >= MaxAnalogSignals) return NULL;
+
+    AnalogSampleStore* s = mAnalogSignals[signalId];
+    mAnalogSignals[signalId] = NULL;
+    return s;
+}
+
+/*!
+    Returns the min/max pyramid for the analog signal with id \a signalId
+    or NULL if there isn't any. The caller takes over the ownership.
+*/
+AnalogMinMaxPyramid* LabToolCaptureDecoder::takeAnalogMinMax(int signalId)
+{
+    if (signalId < 0 || signalId >= MaxAnalogSignals) return NULL;
+
+    AnalogMinMaxPyramid* p = mAnalogMinMax[signalId];
+    mAnalogMinMax[signalId] = NULL;
+    return p;
+}
+
+/*!
+    \fn void LabToolCaptureDecoder::finished()
+
+    This signal is emitted from the thread pool when the decoder has finished.
+*/
+
+/*!
+    Converts the digital and analog parts of the sample data.
+*/
+void LabToolCaptureDecoder::decode()
+{
+    int analogOffset = mTransfer->analogDataOffset();
+    int analogSize = mTransfer->analogDataSize();
+
+    convertDigitalInput(mTransfer->data(), mSize-analogSize, mDigitalChannelInfo, mTrigger, mDigitalTrigSample, mSignalTrim);
+
+    convertAnalogInput(mTransfer->data()+analogOffset, analogSize, mAnalogChannelInfo, mTrigger, mAnalogTrigSample, mSignalTrim);
+    qDebug() << "Got " << mSize << "bytes with samples";
+    //qDebug() << "Digital trigger at " << mDigitalTrigSample << ", analog at " << mAnalogTrigSample;
+}
+
+/*!
+    Deletes all analog and digital signal data that hasn't been taken.
+*/
+void LabToolCaptureDecoder::deleteSignals()
+{
+    for (int i = 0; i < MaxDigitalSignals; i++) {
+        delete mDigitalSignals[i];
+        mDigitalSignals[i] = NULL;
+
+        delete mDigitalSignalTransitions[i];
+        mDigitalSignalTransitions[i] = NULL;
+    }
+
+    for (int i = 0; i < MaxAnalogSignals; i++) {
+        delete mAnalogSignals[i];
+        mAnalogSignals[i] = NULL;
+
+        delete mAnalogSignalData[i];
+        mAnalogSignalData[i] = NULL;
+
+        delete mAnalogMinMax[i];
+        mAnalogMinMax[i] = NULL;
+    }
+}
+
+/*!
+    Returns the number of samples to skip to compensate for the delay in the
+    analog hardware so that the analog and digital signals line up. The
+    samples are skipped at the start of the digital signals and at the end
+    of the analog signals. This compensation is only needed when both analog
+    and digital signals are sampled.
+
+    The samples are never removed from the signal buffers. Instead the
+    convert functions adjust the range of samples they use, see
+    convertDigitalInput() and convertAnalogInput().
+*/
+int LabToolCaptureDecoder::analogHardwareDelay() const
+{
+    int numToRemove = 0;
+
+    if (!mAnalogSignalList.isEmpty() && !mDigitalSignalList.isEmpty()) {
+
+        // The delay is roughly 200ns but was adjusted in detail using an
+        // external oscilloscope. As there is a limit on maximum sample
+        // rate when sampling both analog and digital signals of 20MHz
+        // there is no point in correcting higher sample rates. For sample
+        // rates below 5MHz the resolution is already below 200ns so
+        // correcting even one sample is too much.
+        switch (mUsedSampleRate) {
+        case  5000000: numToRemove = 3; break;
+        case 10000000: numToRemove = 4; break;
+        case 20000000: numToRemove = 5; break;
+        }
+    }
+
+    return numToRemove;
+}
+
+/*!
+    Scans the list of digital samples and locates the first entry with the correct
+    level and returns it's index. The parameter \a s is the list of digital
+    samples of which only the \a count samples starting at \a first are used.
+    Parameter \a level is either one or zero. The \a offset parameter
+    specifies where in the list to start looking. Both \a offset and the
+    returned index are relative to \a first.
+*/
+int LabToolCaptureDecoder::locateFirstLevel(DigitalSampleStore *s, int first, int count, int level, int offset)
+{
+    int start = offset;
+    if (offset < 0) {
+        start = 0;
+    }
+    if (start >= count) return -1;
+
+    int pos = s->findLevel(first + start, level);
+    if (pos == -1 || pos >= first + count) return -1;
+
+    return pos - first;
+}
+
+/*!
+    Scans the list of digital samples backwards and locates the first entry with the
+    correct level and returns it's index. The parameter \a s is the list of digital
+    samples of which only the \a count samples starting at \a first are used.
+    Parameter \a level is either one or zero. The \a offset parameter
+    specifies where in the list to start looking. Both \a offset and the
+    returned index are relative to \a first.
+*/
+int LabToolCaptureDecoder::locatePreviousLevel(DigitalSampleStore *s, int first, int count, int level, int offset)
+{
+    int start = offset;
+    if (offset >= count) {
+        start = count-1;
+    }
+    if (start < 0) return -1;
+
+    int pos = s->findPreviousLevel(first + start, level);
+    if (pos == -1 || pos < first) return -1;
+
+    return pos - first;
+}
+
+
+/*!
+    Scans the list of calibrated (double format) analog samples specified
+    by the \a s parameter starting at \a offset, looking
+    for the position where the value goes from above \a highLevel to below
+    \a lowLevel.
+
+    In cases where the sample rate is much higher than the frequency of
+    the sampled signal a lot of samples will have about the same value
+    and the returned index is calculated as the middle point between the
+    last value above \a highLevel and the first value below \a lowLevel.
+*/
+int LabToolCaptureDecoder::locateAnalogHighLowTransition(const AnalogSampleStore *s, double lowLevel, double highLevel, int offset)
+{
+    int numSamples = s->size();
+
+    if (highLevel != lowLevel) {
+
+//        qDebug("dlocateAnalogHighLowTransition(lowLevel %f, highLevel %f, offset %d", lowLevel, highLevel, offset);
+//        qDebug("lowLevel %f, highLevel %f, looking for High->Low", lowLevel, highLevel);
+
+        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
+            if (s->at(i) > highLevel) {
+LocateAnalogHighLowTransition_restart_comp:
+//                qDebug("s[%d]: %f above %f, restart", i, s->at(i), highLevel);
+                int lastAbove = i;
+                while ((lastAbove < numSamples) && (s->at(lastAbove) > highLevel)) {
+//                    qDebug("s[%d]: %f still above %f", lastAbove, s->at(lastAbove), highLevel);
+                    lastAbove++;
+                }
+                if (lastAbove < numSamples) {
+//                    qDebug("s[%d]: %f broke while with > %f", lastAbove, s->at(lastAbove), highLevel);
+                } else {
+//                    qDebug("s[%d]: broke while as \"out of bounds\"", lastAbove);
+                    break;
+                }
+
+                // found first value above level, now find equal to or below level
+                for (i = lastAbove; i < numSamples; i++) {
+                    if (s->at(i) <= lowLevel) {
+//                        qDebug("s[%d]: %f <= %f, done returning %d", i, s->at(i), lowLevel, (i+lastAbove)/2);
+                        // found transition
+                        return (i+lastAbove)/2;
+                    }
+                    if (s->at(i) > highLevel) {
+                        goto LocateAnalogHighLowTransition_restart_comp;
+                    }
+//                    qDebug("s[%d]: %f between %f and %f", i, s->at(i), lowLevel, highLevel);
+                }
+                break;
+            }
+            else {
+//                qDebug("s[%d]: %f  not above %f", i, s->at(i), highLevel);
+            }
+        }
+    } else {
+        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
+            if (s->at(i) > highLevel) {
+                // found first value above level, now find equal to or below level
+                for (i = i+1; i < numSamples; i++) {
+                    if (s->at(i) <= lowLevel) {
+                        // found transition
+                        return i;
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    return -1;
+}
+
+/*!
+    Scans the list of calibrated (double format) analog samples specified
+    by the \a s parameter starting at \a offset, looking
+    for the position where the value goes from below \a lowLevel to above
+    \a highLevel.
+
+    In cases where the sample rate is much higher than the frequency of
+    the sampled signal a lot of samples will have about the same value
+    and the returned index is calculated as the middle point between the
+    last value below \a lowLevel and the first value above \a highLevel.
+*/
+int LabToolCaptureDecoder::locateAnalogLowHighTransition(const AnalogSampleStore *s, double lowLevel, double highLevel, int offset)
+{
+    int numSamples = s->size();
+
+    if (highLevel != lowLevel) {
+
+//        qDebug("dlocateAnalogLowHighTransition(trigLevel %f, offset %d", trigLevel, offset);
+//        qDebug("lowLevel %f, highLevel %f, looking for High->Low", lowLevel, highLevel);
+
+        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
+            if (s->at(i) < lowLevel) {
+LocateAnalogLowHighTransition_restart_comp:
+//                qDebug("s[%d]: %f below %f, restart", i, s->at(i), lowLevel);
+                int lastBelow = i;
+                while ((lastBelow < numSamples) && (s->at(lastBelow) < lowLevel)) {
+//                    qDebug("s[%d]: %f still below %f", lastBelow, s->at(lastBelow), lowLevel);
+                    lastBelow++;
+                }
+                if (lastBelow < numSamples) {
+//                    qDebug("s[%d]: %f broke while with < %f", lastBelow, s->at(lastBelow), lowLevel);
+                } else {
+//                    qDebug("s[%d]: broke while as \"out of bounds\"", lastBelow);
+                    break;
+                }
+
+                // found first value below level, now find equal to or above level
+                for (i = lastBelow; i < numSamples; i++) {
+                    if (s->at(i) >= highLevel) {
+//                        qDebug("s[%d]: %f <= %f, done returning %d", i, s->at(i), highLevel, (i+lastBelow)/2);
+                        // found transition
+                        return (i+lastBelow)/2;
+                    }
+                    if (s->at(i) < lowLevel) {
+                        goto LocateAnalogLowHighTransition_restart_comp;
+                    }
+//                    qDebug("s[%d]: %f between %f and %f", i, s->at(i), lowLevel, highLevel);
+                }
+                break;
+            }
+            else {
+//                qDebug("s[%d]: %f  not below %f", i, s->at(i), lowLevel);
+            }
+        }
+    } else {
+        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
+            if (s->at(i) < lowLevel) {
+                // found first value below level, now find equal to or above level
+                for (i = i+1; i < numSamples; i++) {
+                    if (s->at(i) >= highLevel) {
+                        // found transition
+                        return i;
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    return -1;
+}
+
+/*!
+    Scans the list of calibrated (double format) analog samples specified
+    by the \a s parameter from start to end looking for the specified
+    transition. The index of the transition closest to \a estimatedIdx
+    is returned.
+
+    The search starts with the \a lowLevel and \a highLevel trigger levels
+    to find a transition but filtering out noise. If no such transition
+    can be found then a search is done with just the \a trigLevel instead.
+    If still no transition can be found then a -1 is returned.
+*/
+int LabToolCaptureDecoder::locateTransition(const AnalogSampleStore *s, AnalogSignal::AnalogTriggerState trigState, double lowLevel, double trigLevel, double highLevel, int estimatedIdx)
+{
+    int bestIdx = -1;
+    if (trigState == AnalogSignal::AnalogTriggerHighLow ||
+        trigState == AnalogSignal::AnalogTriggerLowHigh) {
+
+        int newDiff;
+        int bestDiff = estimatedIdx;
+        int pos = 0;
+        do {
+            newDiff = abs(estimatedIdx - pos);
+            if (newDiff < bestDiff) {
+                //qDebug("locateTransition: found filtered %d, %d from estimated %d", pos, newDiff, estimatedIdx);
+                bestDiff = newDiff;
+                bestIdx = pos;
+            }
+            if (trigState == AnalogSignal::AnalogTriggerHighLow) {
+                pos = locateAnalogHighLowTransition(s, lowLevel, highLevel, pos+1);
+            } else {
+                pos = locateAnalogLowHighTransition(s, lowLevel, highLevel, pos+1);
+            }
+        } while ((pos != -1) && (newDiff <= bestDiff));
+
+        // Search without filter?
+        if (bestIdx == -1) {
+            pos = 0;
+            bestIdx = 0;
+            bestDiff = estimatedIdx;
+            do {
+                newDiff = abs(estimatedIdx - pos);
+                if (newDiff < bestDiff) {
+                    //qDebug("locateTransition: found unfiltered %d, %d from estimated %d", pos, newDiff, estimatedIdx);
+                    bestDiff = abs(estimatedIdx - pos);
+                    bestIdx = pos;
+                }
+                if (trigState == AnalogSignal::AnalogTriggerHighLow) {
+                    pos = locateAnalogHighLowTransition(s, trigLevel, trigLevel, pos+1);
+                } else {
+                    pos = locateAnalogLowHighTransition(s, trigLevel, trigLevel, pos+1);
+                }
+            } while ((pos != -1) && (newDiff <= bestDiff));
+        }
+    }
+    return bestIdx;
+}
+
+/*!
+    Converts the signal data received for digital signals from the LabTool Hardware
+    into the format used by this application.
+
+    Input format:
+
+    \dot
+     digraph structs {
+         node [shape=record];
+         start [label="DIO0 | DIO1 | ... | DIOn | DIO0 | ..."];
+     }
+     \enddot
+
+    Each box is a 32-bit value containing 32 digital samples for that channel.
+    the \a n value is the highest enabled channel number. If only DIO4 is
+    enabled then the positions for DIO0, DIO1, DIO2 and DIO3 will still be
+    present but with invalid data.
+
+    The \a pData parameter is a pointer to the data, \a size is the number of
+    bytes of data.
+
+    The \a activeChannels parameter has two parts: The 16 MSB holds
+    the number of channels with values in the data, the 16 LSB holds a bitmask
+    where each channel with valid data has a bit set. In the previous example
+    with only DIO4 enabled \a activeChannels would have the value \a 0x00050020.
+
+    The \a trig parameter holds the id of the channel that caused the trigger.
+
+    The \a digitalTrigSample parameter holds the current sample index at the
+    time of triggering. The \a signalTrim parameter is used to discard a number
+    of samples from the start (signalTrim < 0) or end of the data to compensate
+    for the fact that the analog and digital samplings are stopped at slightly
+    different times.
+
+    All enabled channels are extracted in one pass over the data, see
+    LabToolSampleUnpacker::deinterleaveSliceWords().
+*/
+void LabToolCaptureDecoder::convertDigitalInput(const quint8 *pData, quint32 size, quint32 activeChannels, quint32 trig, int digitalTrigSample, int signalTrim)
+{
+    const quint32* samples = (const quint32*)pData;
+    int signalsInInput = activeChannels >> 16;
+
+    if (signalsInInput <= 0) return;
+
+    int sampleGroups = (size/(signalsInInput*4));
+    quint32* sliceDst[MaxDigitalSignals];
+    for (int i = 0; i < MaxDigitalSignals; i++) {
+        sliceDst[i] = NULL;
+    }
+
+    foreach(DigitalSignal* signal, mDigitalSignalList) {
+        int id = signal->id();
+
+        if (id >= MaxDigitalSignals) continue;
+        int slice = id;//GetSliceForId(id, activeChannels);
+        if ((activeChannels & (1<<slice)) == 0) continue; // got no data for this channel from target
+        if (slice >= signalsInInput) continue;
+
+        if (mDigitalSignals[id] != NULL) {
+            delete mDigitalSignals[id];
+        }
+        if (mDigitalSignalTransitions[id] != NULL) {
+            delete mDigitalSignalTransitions[id];
+            mDigitalSignalTransitions[id] = NULL;
+        }
+
+        // Deallocation:
+        //   DigitalSampleStore will be deallocated either by this function or
+        //   the destructor as a part of deallocating mDigitalSignals
+        DigitalSampleStore *s = new DigitalSampleStore();
+
+        // each 32-bit slice word holds 32 samples with the first sample in
+        // the LSB which is the same layout as used by DigitalSampleStore
+        s->resize(sampleGroups*32);
+        mDigitalSignals[id] = s;
+
+        sliceDst[slice] = s->words();
+    }
+
+    // LabToolSampleUnpacker wants the slices sorted which isn't the case
+    // for the signal list
+    int slices[MaxDigitalSignals];
+    quint32* dst[MaxDigitalSignals];
+    int numSlices = 0;
+    for (int slice = 0; slice < MaxDigitalSignals; slice++) {
+        if (sliceDst[slice] == NULL) continue;
+
+        slices[numSlices] = slice;
+        dst[numSlices] = sliceDst[slice];
+        numSlices++;
+    }
+
+    LabToolSampleUnpacker::deinterleaveSliceWords(samples, sampleGroups, signalsInInput, slices, dst, numSlices);
+
+    // Samples to skip at the start and end of each signal. The first samples
+    // compensate for the delay in the analog hardware so that the analog and
+    // digital signals line up. Nothing is moved: the trigger search and the
+    // transitions only use the samples in the range.
+    int trimStart = analogHardwareDelay();
+    int trimEnd = 0;
+    if (signalTrim < 0) {
+        // skip abs(signalTrim) samples at the start of the data
+        trimStart += -signalTrim;
+    } else if (signalTrim > 0){
+        // skip abs(signalTrim) samples at the end of the data
+        trimEnd = signalTrim;
+    }
+
+    foreach(DigitalSignal* signal, mDigitalSignalList) {
+        int id = signal->id();
+
+        if (id >= MaxDigitalSignals) continue;
+        if ((activeChannels & (1<<id)) == 0 || id >= signalsInInput) continue;
+
+        DigitalSampleStore *s = mDigitalSignals[id];
+        int first = qMin(trimStart, s->size());
+        int count = qMax(0, s->size() - first - trimEnd);
+
+
+        if (((int)trig) == id)
+        {
+            // this signal was the trigger
+            DigitalSignal::DigitalTriggerState trigger = signal->triggerState();
+
+            int pos = 0;
+            switch (trigger) {
+            // Falling edge
+            case DigitalSignal::DigitalTriggerHighLow:
+                pos = locateFirstLevel(s, first, count, 1, digitalTrigSample-20);
+                if (pos != -1) {
+                    pos = locateFirstLevel(s, first, count, 0, pos);
+                    if (pos != -1) {
+                        // found first possible trigger past the digitalTrigSample location
+                        mTriggerIndex = pos;
+                        //qDebug("Found High->Low at %d, (+%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
+                    }
+                }
+                pos = locatePreviousLevel(s, first, count, 0, digitalTrigSample+20);
+                if (pos != -1) {
+                    pos = locatePreviousLevel(s, first, count, 1, pos);
+                    if (pos != -1) {
+                        pos++;
+                        //qDebug("Found High->Low at %d, (%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
+
+                        // found last trigger before the digitalTrigSample location
+                        if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
+                            // this trigger is the closest one to the digitalTrigSample location
+                            mTriggerIndex = pos;
+                        }
+                    }
+                }
+                break;
+
+                // Rising edge
+            case DigitalSignal::DigitalTriggerLowHigh:
+                pos = locateFirstLevel(s, first, count, 0, digitalTrigSample-20);
+                if (pos != -1) {
+                    pos = locateFirstLevel(s, first, count, 1, pos);
+                    if (pos != -1) {
+                        // found first possible trigger past the digitalTrigSample location
+                        mTriggerIndex = pos;
+                        //qDebug("Found Low->High at %d, (+%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
+                    }
+                }
+                pos = locatePreviousLevel(s, first, count, 1, digitalTrigSample+20);
+                if (pos != -1) {
+                    pos = locatePreviousLevel(s, first, count, 0, pos);
+                    if (pos != -1) {
+                        pos++;
+                        //qDebug("Found Low->High at %d, (%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
+
+                        // found last trigger before the digitalTrigSample location
+                        if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
+                            // this trigger is the closest one to the digitalTrigSample location
+                            mTriggerIndex = pos;
+                        }
+                    }
+                }
+                break;
+
+                // High level
+#if 0 // disabling high level and low level as trigger levels
+            case DigitalSignal::DigitalTriggerHigh:
+                pos = locateFirstLevel(s, first, count, 1, digitalTrigSample-20);
+                if (pos != -1) {
+                    // found first possible trigger past the digitalTrigSample location
+                    mTriggerIndex = pos;
+                }
+                pos = locatePreviousLevel(s, first, count, 1, digitalTrigSample+20);
+                if (pos != -1) {
+                    // found last trigger before the digitalTrigSample location
+                    if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
+                        // this trigger is the closest one to the digitalTrigSample location
+                        mTriggerIndex = pos;
+                    }
+                }
+                break;
+
+                // Low level
+            case DigitalSignal::DigitalTriggerLow:
+                pos = locateFirstLevel(s, first, count, 0, digitalTrigSample-20);
+                if (pos != -1) {
+                    // found first possible trigger past the digitalTrigSample location
+                    mTriggerIndex = pos;
+                }
+                pos = locatePreviousLevel(s, first, count, 0, digitalTrigSample+20);
+                if (pos != -1) {
+                    // found last trigger before the digitalTrigSample location
+                    if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
+                        // this trigger is the closest one to the digitalTrigSample location
+                        mTriggerIndex = pos;
+                    }
+                }
+                break;
+#endif
+                // Not a trigger
+            default:
+                break;
+            }
+
+        }
+
+        mEndSampleIdx = count-1;
+        //qDebug("D%d: %d samples", id, count);
+
+        // Deallocation:
+        //   DigitalTransitions will be deallocated either by deleteSignals()
+        //   or the destructor as a part of deallocating
+        //   mDigitalSignalTransitions
+        DigitalTransitions* t = new DigitalTransitions(
+                    DigitalTransitions::fromSamples(*s, first, count));
+        mDigitalSignalTransitions[id] = t;
+
+        // A mostly idle signal is cheaper to keep as a list of transitions.
+        // The samples are also dropped if the first samples were skipped
+        // since they would otherwise have to be moved. In both cases the
+        // samples are recreated by digitalData() if they are requested.
+        if (first > 0
+                || t->memoryUsage() < (qint64)s->numWords()*sizeof(quint32)) {
+            delete s;
+            mDigitalSignals[id] = NULL;
+        }
+        else {
+            // dropping samples at the end doesn't move anything
+            s->resize(count);
+        }
+    }
+}
+
+/*!
+    Converts the signal data received for analog signals from the LabTool Hardware
+    into two lists of integer values, one for each channel.
+
+    Input format:
+
+    \dot
+     digraph structs {
+         node [shape=record];
+         start [label="A0 | A1 | A0 | ..."];
+     }
+     \enddot
+
+    Each box is a 16-bit value containing one analog samples for that channel.
+    If only one channel is enabled then only that channel's data will be present.
+    Each 16-bit value is also marked with information about which channel
+    the data is for.
+
+    The \a pData parameter is a pointer to the data, \a size is the number of
+    bytes of data.
+
+    The \a activeChannels parameter has two parts: The 16 MSB holds
+    the number of channels with values in the data, the 16 LSB holds a bitmask
+    where each channel with valid data has a bit set.
+
+    \todo Remove the \a activeChannels part of the protocol for analog signals?
+
+    At high sample rates the analog signal data can get corrupted. This is only
+    visible in the data when both analog channels are enabled and it will look
+    like this:
+
+    \dot
+     digraph structs {
+         node [shape=record];
+         start [label="A0 | A1 | A0 | A0 | A1 | ..."];
+     }
+     \enddot
+
+     This function detects the double values and inserts a value for the
+     missing channel. In the example above channel A1 would get an extra value
+     inserted. The reason for inserting extra value(s) is to at least keep the
+     signals identical in length.
+
+     One problem is that the double A0 could hide either one missing A1 value
+     or one A1 and any number of A0+A1 samples. It is impossible to know.
+
+     The work is done by LabToolSampleUnpacker::unpackAnalogSamples().
+*/
+void LabToolCaptureDecoder::unpackAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels)
+{
+    for (int i = 0; i < MaxAnalogSignals; i++) {
+        if (mAnalogSignalData[i] != NULL) {
+            delete mAnalogSignalData[i];
+        }
+        mAnalogSignalData[i] = NULL;
+    }
+
+    (void)activeChannels; // To avoid warning
+
+    // Deallocation:
+    //   QVector will be deallocated either by deleteSignals,
+    //   unpackAnalogInput or the destructor as a part of deallocating mAnalogSignalData
+    QVector<quint16> *s0 = new QVector<quint16>();
+    // Deallocation:
+    //   QVector will be deallocated either by deleteSignals,
+    //   unpackAnalogInput or the destructor as a part of deallocating mAnalogSignalData
+    QVector<quint16> *s1 = new QVector<quint16>();
+
+    LabToolSampleUnpacker::unpackAnalogSamples((const quint16*)pData, size/2,//PACKED
+                                               mAnalogSignalList.size(), mUsedSampleRate,
+                                               *s0, *s1);
+
+    mAnalogSignalData[0] = s0;
+    mAnalogSignalData[1] = s1;
+}
+
+/*!
+    Converts the signal data received for analog signals from the LabTool Hardware
+    into the format used by this application. The return value reflects the validity
+    of the data. If the data was captured with a falling edge trigger and the received
+    data contains no falling edge then false is returned.
+
+    The conversion is done in three steps:
+    -# Use \ref unpackAnalogInput to creates one list of integer values per channel.
+    -# Pack the integer values, except the ones skipped because of \a signalTrim
+       and the analog hardware delay, into an AnalogSampleStore
+    -# Attach the calibration factors for each channel's Volts/div setting so
+       that the values can be converted to volts on demand
+
+    The \a pData parameter is a pointer to the data, \a size is the number of
+    bytes of data.
+
+    The \a activeChannels parameter has two parts: The 16 MSB holds
+    the number of channels with values in the data, the 16 LSB holds a bitmask
+    where each channel with valid data has a bit set. In the previous example
+    with only DIO4 enabled \a activeChannels would have the value \a 0x00050020.
+
+    The \a trig parameter holds the id of the channel that caused the trigger.
+
+    The \a analogTrigSample parameter holds the current sample index at the
+    time of triggering. The \a signalTrim parameter is used to discard a number
+    of samples from the start (signalTrim < 0) or end of the data to compensate
+    for the fact that the analog and digital samplings are stopped at slightly
+    different times.
+*/
+void LabToolCaptureDecoder::convertAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels, quint32 trig, int analogTrigSample, int signalTrim)
+{
+    (void)trig; // To avoid warning
+    if (mAnalogSignalList.isEmpty()) {
+        // nothing to do
+        return;
+    }
+    unpackAnalogInput(pData, size, activeChannels);
+
+    LabToolCalibrationData* calib = mCalibration;
+    if (calib == NULL) {
+        qWarning("No calibration data, cannot convert analog samples");
+        return;
+    }
+
+    // Samples to skip at the start and end of each signal. The last samples
+    // compensate for the delay in the analog hardware so that the analog and
+    // digital signals line up. Only the samples in the range are packed.
+    int trimStart = 0;
+    int trimEnd = analogHardwareDelay();
+    if (signalTrim < 0) {
+        // skip abs(signalTrim) samples at the start of the data
+        trimStart = -signalTrim;
+    } else if (signalTrim > 0){
+        // skip abs(signalTrim) samples at the end of the data
+        trimEnd += signalTrim;
+    }
+
+    foreach(AnalogSignal* signal, mAnalogSignalList) {
+        int id = signal->id();
+        int voltsPerDivIndex = mSupportedVPerDiv.indexOf(signal->vPerDiv());
+        double a = calib->analogFactorA(id, voltsPerDivIndex);
+        double b = calib->analogFactorB(id, voltsPerDivIndex);
+
+        if (mAnalogSignalData[id] == NULL) continue;
+
+        QVector<quint16>* codes = mAnalogSignalData[id];
+        int first = qMin(trimStart, codes->size());
+        int count = qMax(0, codes->size() - first - trimEnd);
+
+        // The 12-bit codes are kept packed together with the calibration
+        // factors and converted to volts when the samples are read. The
+        // unpacked codes aren't needed anymore.
+        // Deallocation:
+        //   AnalogSampleStore will be deallocated either by this function or
+        //   the destructor as a part of deallocating mAnalogSignals
+        AnalogSampleStore *s = new AnalogSampleStore(codes->constData() + first,
+                                                     count, a, b);
+
+        delete mAnalogSignalData[id];
+        mAnalogSignalData[id] = NULL;
+
+        if (signal->triggerState() != AnalogSignal::AnalogTriggerNone)
+        {
+            double trigLevel = signal->triggerLevel();
+            double lowLevel = trigLevel;
+            double highLevel = trigLevel;
+            bool forceNoiseFilter = true; // have to apply some filtering
+
+            if (forceNoiseFilter) {
+                lowLevel = trigLevel - qAbs(b * (1<<5));
+                highLevel = trigLevel + qAbs(b * (1<<5));
+            } else if (mNoiseFilterEnabled) {
+                lowLevel = trigLevel - qAbs(b * mNoiseFilter12BitLevel);
+                highLevel = trigLevel + qAbs(b * mNoiseFilter12BitLevel);
+            }
+
+            if (signalTrim < 0) {
+                // Have removed abs(signalTrim) samples from the start of the data so the
+                // trigger point must be moved as well
+
+                qDebug("analogTrigSample = %u, moved to %u", analogTrigSample, analogTrigSample-abs(signalTrim));
+                analogTrigSample -= abs(signalTrim);
+            }
+
+            int pos = locateTransition(s, signal->triggerState(), lowLevel, trigLevel, highLevel, analogTrigSample);
+            if (pos != -1) {
+                mTriggerIndex = pos;
+            }
+        }
+
+        if (mAnalogSignals[id] != NULL) {
+            delete mAnalogSignals[id];
+        }
+
+        mAnalogSignals[id] = s;
+        mEndSampleIdx = s->size()-1;
+        //qDebug("A%d: %d samples", id, s->size());
+
+        if (mAnalogMinMax[id] != NULL) {
+            delete mAnalogMinMax[id];
+        }
+
+        // Deallocation:
+        //   AnalogMinMaxPyramid will be deallocated either by deleteSignals()
+        //   or the destructor as a part of deallocating mAnalogMinMax
+        mAnalogMinMax[id] = new AnalogMinMaxPyramid(*s);
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef LABTOOLCAPTUREDECODER_H
+#define LABTOOLCAPTUREDECODER_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QList>
+#include <QVector>
+
+#include "device/digitalsignal.h"
+#include "device/digitalsamplestore.h"
+#include "device/digitaltransitions.h"
+#include "device/analogsignal.h"
+#include "device/analogsamplestore.h"
+#include "device/analogminmaxpyramid.h"
+#include "labtoolcalibrationdata.h"
+
+class LabToolDeviceTransfer;
+
+class LabToolCaptureDecoder : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+
+    enum Constants {
+        MaxDigitalSignals = 11,
+        MaxAnalogSignals = 2
+    };
+
+    LabToolCaptureDecoder(LabToolDeviceTransfer* transfer,
+                          unsigned int size,
+                          unsigned int trigger,
+                          unsigned int digitalTrigSample,
+                          unsigned int analogTrigSample,
+                          unsigned int digitalChannelInfo,
+                          unsigned int analogChannelInfo,
+                          int signalTrim,
+                          QObject *parent = 0);
+    ~LabToolCaptureDecoder();
+
+    void setSignals(const QList<DigitalSignal*> &digitalSignals,
+                    const QList<AnalogSignal*> &analogSignals);
+    void setSampleRate(int sampleRate) {mUsedSampleRate = sampleRate;}
+    void setCalibration(const LabToolCalibrationData* calib,
+                        const QList<double> &supportedVPerDiv);
+    void setNoiseFilter(bool enabled, int level12Bit);
+
+    void run();
+    void cancel();
+    bool isCancelled() const;
+
+    int sampleRate() const {return mUsedSampleRate;}
+    int endSampleIndex() const {return mEndSampleIdx;}
+    int triggerIndex() const {return mTriggerIndex;}
+
+    DigitalSampleStore* takeDigitalData(int signalId);
+    DigitalTransitions* takeDigitalTransitions(int signalId);
+    AnalogSampleStore* takeAnalogData(int signalId);
+    AnalogMinMaxPyramid* takeAnalogMinMax(int signalId);
+
+signals:
+    void finished();
+
+private:
+
+    LabToolDeviceTransfer* mTransfer;
+    unsigned int mSize;
+    unsigned int mTrigger;
+    unsigned int mDigitalTrigSample;
+    unsigned int mAnalogTrigSample;
+    unsigned int mDigitalChannelInfo;
+    unsigned int mAnalogChannelInfo;
+    int mSignalTrim;
+
+    QList<DigitalSignal*> mDigitalSignalList;
+    QList<AnalogSignal*> mAnalogSignalList;
+    LabToolCalibrationData* mCalibration;
+    QList<double> mSupportedVPerDiv;
+    bool mNoiseFilterEnabled;
+    int mNoiseFilter12BitLevel;
+    QAtomicInt mCancelled;
+
+    int mUsedSampleRate;
+    int mEndSampleIdx;
+    int mTriggerIndex;
+
+    DigitalSampleStore* mDigitalSignals[MaxDigitalSignals];
+    AnalogSampleStore* mAnalogSignals[MaxAnalogSignals];
+    QVector<quint16>* mAnalogSignalData[MaxAnalogSignals];
+    AnalogMinMaxPyramid* mAnalogMinMax[MaxAnalogSignals];
+    DigitalTransitions* mDigitalSignalTransitions[MaxDigitalSignals];
+
+    void decode();
+    void deleteSignals();
+
+    int analogHardwareDelay() const;
+
+    int locateFirstLevel(DigitalSampleStore *s, int first, int count, int level, int offset);
+    int locatePreviousLevel(DigitalSampleStore *s, int first, int count, int level, int offset);
+
+    int locateAnalogHighLowTransition(const AnalogSampleStore *s, double lowLevel, double highLevel, int offset);
+    int locateAnalogLowHighTransition(const AnalogSampleStore *s, double lowLevel, double highLevel, int offset);
+    int locateTransition(const AnalogSampleStore *s, AnalogSignal::AnalogTriggerState trigState, double lowLevel, double trigLevel, double highLevel, int estimatedIdx);
+
+    void convertDigitalInput(const quint8* pData, quint32 size, quint32 activeChannels, quint32 trig, int digitalTrigSample, int signalTrim);
+    void unpackAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels);
+    void convertAnalogInput(const quint8* pData, quint32 size, quint32 activeChannels, quint32 trig, int analogTrigSample, int signalTrim);
+
+};
+
+#endif // LABTOOLCAPTUREDECODER_H
@@ -18,6 +18,9 @@
 #include <QDebug>
 #include <QFile>
 #include <QTimer>
+#include <QThreadPool>
+
+#include <string.h>
 
 #include "labtoolcalibrationwizard.h"
 
@@ -235,6 +238,11 @@ LabToolCaptureDevice::LabToolCaptureDevice(QObject *parent) :
     mRunningCapture = false;
     mReconfigurationRequested = false;
     mWarnUncalibrated = true;
+    mContinuous = false;
+    mDecoder = NULL;
+    mDroppedFrames = 0;
+    mCapturesPerSecond = 0;
+    mCapturesSinceRateUpdate = 0;
     mRequestedSampleRate = -1;
     mLastUsedSampleRate = -2;
 
@@ -245,7 +253,7 @@ LabToolCaptureDevice::LabToolCaptureDevice(QObject *parent) :
 
     for (int i = 0; i < MaxAnalogSignals; i++) {
         mAnalogSignals[i] = NULL;
-        mAnalogSignalData[i] = NULL;
+        mAnalogMinMax[i] = NULL;
     }
 }
 
@@ -262,12 +270,18 @@ LabToolCaptureDevice::~LabToolCaptureDevice()
         delete mReconfigTimer;
     }
 
+    // the decoder deletes itself when it has finished
+    if (mDecoder != NULL) {
+        mDecoder->cancel();
+        mDecoder = NULL;
+    }
+
     for (int i = 0; i < MaxAnalogSignals; i++) {
         if (mAnalogSignals[i] != NULL) {
             delete mAnalogSignals[i];
         }
-        if (mAnalogSignalData[i] != NULL) {
-            delete mAnalogSignalData[i];
+        if (mAnalogMinMax[i] != NULL) {
+            delete mAnalogMinMax[i];
         }
     }
 
@@ -389,773 +403,6 @@ void LabToolCaptureDevice::calibrate(QWidget *parent)
     }
 }
 
-/*!
-    Removes \a numToRemove elements from the \a s list of signal samples.
-    The parameter \a removeFromStart dictates if the samples should be
-    removed from the start or end of the list. If the list contains
-    fewer than \a numToRemove elements all will be removed.
-*/
-template <typename T>
-void LabToolCaptureDevice::trimSignalData(QVector<T> *s, int numToRemove, bool removeFromStart) const
-{
-    if ((s != NULL) && (numToRemove > 0)) {
-
-        if (s->size() <= numToRemove) {
-            s->clear();
-        } else if (removeFromStart) {
-            s->remove(0, numToRemove);
-        } else {
-            s->remove(s->size() - numToRemove, numToRemove);
-        }
-    }
-}
-
-/*!
-    Compensates for the delay in the analog hardware so that the analog and
-    digital signals line up. A few samples are removed from the start of the
-    signal (if digital) or end of the signal (if analog). This compensation
-    is only needed when both analog and digital signals are sampled.
-    The parameter \a s is the list of samples, parameter \a isAnalogSignal
-    is used to determine if the samples should be removed from the start
-    or end of the list.
-*/
-template <typename T>
-void LabToolCaptureDevice::compensateForAnalogHardware(QVector<T> *s, bool isAnalogSignal) const
-{
-    if (!mAnalogSignalList.isEmpty() && !mDigitalSignalList.isEmpty()) {
-        int numToRemove = 0;
-
-        // The delay is roughly 200ns but was adjusted in detail using an
-        // external oscilloscope. As there is a limit on maximum sample
-        // rate when sampling both analog and digital signals of 20MHz
-        // there is no point in correcting higher sample rates. For sample
-        // rates below 5MHz the resolution is already below 200ns so
-        // correcting even one sample is too much.
-        switch (mUsedSampleRate) {
-        case  5000000: numToRemove = 3; break;
-        case 10000000: numToRemove = 4; break;
-        case 20000000: numToRemove = 5; break;
-        }
-
-        trimSignalData(s, numToRemove, !isAnalogSignal);
-    }
-}
-
-/*!
-    Scans the list of digital samples and locates the first entry with the correct
-    level and returns it's index. The parameter \a s is the list of digital
-    samples, parameter \a level is either one or zero. The \a offset parameter
-    specifies where in the list to start looking.
-*/
-int LabToolCaptureDevice::locateFirstLevel(QVector<int> *s, int level, int offset)
-{
-    int start = offset;
-    if (offset < 0) {
-        start = 0;
-    }
-    for (int i = start; i < s->size(); i++) {
-        if (s->at(i) == level) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-/*!
-    Scans the list of digital samples backwards and locates the first entry with the
-    correct level and returns it's index. The parameter \a s is the list of digital
-    samples, parameter \a level is either one or zero. The \a offset parameter
-    specifies where in the list to start looking.
-*/
-int LabToolCaptureDevice::locatePreviousLevel(QVector<int> *s, int level, int offset)
-{
-    int start = offset;
-    if (offset > s->size()) {
-        start = s->size()-1;
-    }
-    for (int i = start; i >= 0; i--) {
-        if (s->at(i) == level) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-
-/*!
-    Scans the list of calibrated (double format) analog samples specified
-    by the \a s parameter starting at \a offset, looking
-    for the position where the value goes from above \a highLevel to below
-    \a lowLevel.
-
-    In cases where the sample rate is much higher than the frequency of
-    the sampled signal a lot of samples will have about the same value
-    and the returned index is calculated as the middle point between the
-    last value above \a highLevel and the first value below \a lowLevel.
-*/
-int LabToolCaptureDevice::locateAnalogHighLowTransition(QVector<double> *s, double lowLevel, double highLevel, int offset)
-{
-    int numSamples = s->size();
-
-    if (highLevel != lowLevel) {
-
-//        qDebug("dlocateAnalogHighLowTransition(lowLevel %f, highLevel %f, offset %d", lowLevel, highLevel, offset);
-//        qDebug("lowLevel %f, highLevel %f, looking for High->Low", lowLevel, highLevel);
-
-        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
-            if (s->at(i) > highLevel) {
-LocateAnalogHighLowTransition_restart_comp:
-//                qDebug("s[%d]: %f above %f, restart", i, s->at(i), highLevel);
-                int lastAbove = i;
-                while ((lastAbove < numSamples) && (s->at(lastAbove) > highLevel)) {
-//                    qDebug("s[%d]: %f still above %f", lastAbove, s->at(lastAbove), highLevel);
-                    lastAbove++;
-                }
-                if (lastAbove < numSamples) {
-//                    qDebug("s[%d]: %f broke while with > %f", lastAbove, s->at(lastAbove), highLevel);
-                } else {
-//                    qDebug("s[%d]: broke while as \"out of bounds\"", lastAbove);
-                    break;
-                }
-
-                // found first value above level, now find equal to or below level
-                for (i = lastAbove; i < numSamples; i++) {
-                    if (s->at(i) <= lowLevel) {
-//                        qDebug("s[%d]: %f <= %f, done returning %d", i, s->at(i), lowLevel, (i+lastAbove)/2);
-                        // found transition
-                        return (i+lastAbove)/2;
-                    }
-                    if (s->at(i) > highLevel) {
-                        goto LocateAnalogHighLowTransition_restart_comp;
-                    }
-//                    qDebug("s[%d]: %f between %f and %f", i, s->at(i), lowLevel, highLevel);
-                }
-                break;
-            }
-            else {
-//                qDebug("s[%d]: %f  not above %f", i, s->at(i), highLevel);
-            }
-        }
-    } else {
-        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
-            if (s->at(i) > highLevel) {
-                // found first value above level, now find equal to or below level
-                for (i = i+1; i < numSamples; i++) {
-                    if (s->at(i) <= lowLevel) {
-                        // found transition
-                        return i;
-                    }
-                }
-                break;
-            }
-        }
-    }
-
-    return -1;
-}
-
-/*!
-    Scans the list of calibrated (double format) analog samples specified
-    by the \a s parameter starting at \a offset, looking
-    for the position where the value goes from below \a lowLevel to above
-    \a highLevel.
-
-    In cases where the sample rate is much higher than the frequency of
-    the sampled signal a lot of samples will have about the same value
-    and the returned index is calculated as the middle point between the
-    last value below \a lowLevel and the first value above \a highLevel.
-*/
-int LabToolCaptureDevice::locateAnalogLowHighTransition(QVector<double> *s, double lowLevel, double highLevel, int offset)
-{
-    int numSamples = s->size();
-
-    if (highLevel != lowLevel) {
-
-//        qDebug("dlocateAnalogLowHighTransition(trigLevel %f, offset %d", trigLevel, offset);
-//        qDebug("lowLevel %f, highLevel %f, looking for High->Low", lowLevel, highLevel);
-
-        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
-            if (s->at(i) < lowLevel) {
-LocateAnalogLowHighTransition_restart_comp:
-//                qDebug("s[%d]: %f below %f, restart", i, s->at(i), lowLevel);
-                int lastBelow = i;
-                while ((lastBelow < numSamples) && (s->at(lastBelow) < lowLevel)) {
-//                    qDebug("s[%d]: %f still below %f", lastBelow, s->at(lastBelow), lowLevel);
-                    lastBelow++;
-                }
-                if (lastBelow < numSamples) {
-//                    qDebug("s[%d]: %f broke while with < %f", lastBelow, s->at(lastBelow), lowLevel);
-                } else {
-//                    qDebug("s[%d]: broke while as \"out of bounds\"", lastBelow);
-                    break;
-                }
-
-                // found first value below level, now find equal to or above level
-                for (i = lastBelow; i < numSamples; i++) {
-                    if (s->at(i) >= highLevel) {
-//                        qDebug("s[%d]: %f <= %f, done returning %d", i, s->at(i), highLevel, (i+lastBelow)/2);
-                        // found transition
-                        return (i+lastBelow)/2;
-                    }
-                    if (s->at(i) < lowLevel) {
-                        goto LocateAnalogLowHighTransition_restart_comp;
-                    }
-//                    qDebug("s[%d]: %f between %f and %f", i, s->at(i), lowLevel, highLevel);
-                }
-                break;
-            }
-            else {
-//                qDebug("s[%d]: %f  not below %f", i, s->at(i), lowLevel);
-            }
-        }
-    } else {
-        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
-            if (s->at(i) < lowLevel) {
-                // found first value below level, now find equal to or above level
-                for (i = i+1; i < numSamples; i++) {
-                    if (s->at(i) >= highLevel) {
-                        // found transition
-                        return i;
-                    }
-                }
-                break;
-            }
-        }
-    }
-
-    return -1;
-}
-
-/*!
-    Scans the list of calibrated (double format) analog samples specified
-    by the \a s parameter from start to end looking for the specified
-    transition. The index of the transition closest to \a estimatedIdx
-    is returned.
-
-    The search starts with the \a lowLevel and \a highLevel trigger levels
-    to find a transition but filtering out noise. If no such transition
-    can be found then a search is done with just the \a trigLevel instead.
-    If still no transition can be found then a -1 is returned.
-*/
-int LabToolCaptureDevice::locateTransition(QVector<double> *s, AnalogSignal::AnalogTriggerState trigState, double lowLevel, double trigLevel, double highLevel, int estimatedIdx)
-{
-    int bestIdx = -1;
-    if (trigState == AnalogSignal::AnalogTriggerHighLow ||
-        trigState == AnalogSignal::AnalogTriggerLowHigh) {
-
-        int newDiff;
-        int bestDiff = estimatedIdx;
-        int pos = 0;
-        do {
-            newDiff = abs(estimatedIdx - pos);
-            if (newDiff < bestDiff) {
-                //qDebug("locateTransition: found filtered %d, %d from estimated %d", pos, newDiff, estimatedIdx);
-                bestDiff = newDiff;
-                bestIdx = pos;
-            }
-            if (trigState == AnalogSignal::AnalogTriggerHighLow) {
-                pos = locateAnalogHighLowTransition(s, lowLevel, highLevel, pos+1);
-            } else {
-                pos = locateAnalogLowHighTransition(s, lowLevel, highLevel, pos+1);
-            }
-        } while ((pos != -1) && (newDiff <= bestDiff));
-
-        // Search without filter?
-        if (bestIdx == -1) {
-            pos = 0;
-            bestIdx = 0;
-            bestDiff = estimatedIdx;
-            do {
-                newDiff = abs(estimatedIdx - pos);
-                if (newDiff < bestDiff) {
-                    //qDebug("locateTransition: found unfiltered %d, %d from estimated %d", pos, newDiff, estimatedIdx);
-                    bestDiff = abs(estimatedIdx - pos);
-                    bestIdx = pos;
-                }
-                if (trigState == AnalogSignal::AnalogTriggerHighLow) {
-                    pos = locateAnalogHighLowTransition(s, trigLevel, trigLevel, pos+1);
-                } else {
-                    pos = locateAnalogLowHighTransition(s, trigLevel, trigLevel, pos+1);
-                }
-            } while ((pos != -1) && (newDiff <= bestDiff));
-        }
-    }
-    return bestIdx;
-}
-
-/*!
-    Converts the signal data received for digital signals from the LabTool Hardware
-    into the format used by this application.
-
-    Input format:
-
-    \dot
-     digraph structs {
-         node [shape=record];
-         start [label="DIO0 | DIO1 | ... | DIOn | DIO0 | ..."];
-     }
-     \enddot
-
-    Each box is a 32-bit value containing 32 digital samples for that channel.
-    the \a n value is the highest enabled channel number. If only DIO4 is
-    enabled then the positions for DIO0, DIO1, DIO2 and DIO3 will still be
-    present but with invalid data.
-
-    The \a pData parameter is a pointer to the data, \a size is the number of
-    bytes of data.
-
-    The \a activeChannels parameter has two parts: The 16 MSB holds
-    the number of channels with values in the data, the 16 LSB holds a bitmask
-    where each channel with valid data has a bit set. In the previous example
-    with only DIO4 enabled \a activeChannels would have the value \a 0x00050020.
-
-    The \a trig parameter holds the id of the channel that caused the trigger.
-
-    The \a digitalTrigSample parameter holds the current sample index at the
-    time of triggering. The \a signalTrim parameter is used to discard a number
-    of samples from the start (signalTrim < 0) or end of the data to compensate
-    for the fact that the analog and digital samplings are stopped at slightly
-    different times.
-*/
-void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size, quint32 activeChannels, quint32 trig, int digitalTrigSample, int signalTrim)
-{
-    quint32* samples = (quint32*)pData;
-    int signalsInInput = activeChannels >> 16;
-
-    foreach(DigitalSignal* signal, mDigitalSignalList) {
-        int id = signal->id();
-
-        if (id >= MaxDigitalSignals) continue;
-        int slice = id;//GetSliceForId(id, activeChannels);
-        if ((activeChannels & (1<<slice)) == 0) continue; // got no data for this channel from target
-
-        int sampleGroups = (size/(signalsInInput*4));
-
-        // Deallocation:
-        //   QVector will be deallocated either by this function or the destructor
-        //   as a part of deallocating mDigitalSignals
-        QVector<int> *s = new QVector<int>();
-
-        for(int j = 0; j < sampleGroups; ++j) {
-            quint32 val = samples[j*signalsInInput + slice];
-            for (int k = 0; k < 32; k++) {
-                s->append(val & 1);
-                val = val >> 1;
-            }
-        }
-
-        // Compensate for the delay in the analog hardware so that the analog and digital signals line up.
-        compensateForAnalogHardware(s, false);
-
-        if (signalTrim < 0) {
-            // remove abs(signalTrim) samples from the start of the data
-            trimSignalData(s, -signalTrim, true);
-        } else if (signalTrim > 0){
-            // remove abs(signalTrim) samples from the end of the data
-            trimSignalData(s, signalTrim, false);
-        }
-
-
-        if (((int)trig) == id)
-        {
-            // this signal was the trigger
-            DigitalSignal::DigitalTriggerState trigger = signal->triggerState();
-
-            int pos = 0;
-            switch (trigger) {
-            // Falling edge
-            case DigitalSignal::DigitalTriggerHighLow:
-                pos = locateFirstLevel(s, 1, digitalTrigSample-20);
-                if (pos != -1) {
-                    pos = locateFirstLevel(s, 0, pos);
-                    if (pos != -1) {
-                        // found first possible trigger past the digitalTrigSample location
-                        mTriggerIndex = pos;
-                        //qDebug("Found High->Low at %d, (+%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
-                    }
-                }
-                pos = locatePreviousLevel(s, 0, digitalTrigSample+20);
-                if (pos != -1) {
-                    pos = locatePreviousLevel(s, 1, pos);
-                    if (pos != -1) {
-                        pos++;
-                        //qDebug("Found High->Low at %d, (%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
-
-                        // found last trigger before the digitalTrigSample location
-                        if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
-                            // this trigger is the closest one to the digitalTrigSample location
-                            mTriggerIndex = pos;
-                        }
-                    }
-                }
-                break;
-
-                // Rising edge
-            case DigitalSignal::DigitalTriggerLowHigh:
-                pos = locateFirstLevel(s, 0, digitalTrigSample-20);
-                if (pos != -1) {
-                    pos = locateFirstLevel(s, 1, pos);
-                    if (pos != -1) {
-                        // found first possible trigger past the digitalTrigSample location
-                        mTriggerIndex = pos;
-                        //qDebug("Found Low->High at %d, (+%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
-                    }
-                }
-                pos = locatePreviousLevel(s, 1, digitalTrigSample+20);
-                if (pos != -1) {
-                    pos = locatePreviousLevel(s, 0, pos);
-                    if (pos != -1) {
-                        pos++;
-                        //qDebug("Found Low->High at %d, (%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
-
-                        // found last trigger before the digitalTrigSample location
-                        if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
-                            // this trigger is the closest one to the digitalTrigSample location
-                            mTriggerIndex = pos;
-                        }
-                    }
-                }
-                break;
-
-                // High level
-#if 0 // disabling high level and low level as trigger levels
-            case DigitalSignal::DigitalTriggerHigh:
-                pos = locateFirstLevel(s, 1, digitalTrigSample-20);
-                if (pos != -1) {
-                    // found first possible trigger past the digitalTrigSample location
-                    mTriggerIndex = pos;
-                }
-                pos = locatePreviousLevel(s, 1, digitalTrigSample+20);
-                if (pos != -1) {
-                    // found last trigger before the digitalTrigSample location
-                    if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
-                        // this trigger is the closest one to the digitalTrigSample location
-                        mTriggerIndex = pos;
-                    }
-                }
-                break;
-
-                // Low level
-            case DigitalSignal::DigitalTriggerLow:
-                pos = locateFirstLevel(s, 0, digitalTrigSample-20);
-                if (pos != -1) {
-                    // found first possible trigger past the digitalTrigSample location
-                    mTriggerIndex = pos;
-                }
-                pos = locatePreviousLevel(s, 0, digitalTrigSample+20);
-                if (pos != -1) {
-                    // found last trigger before the digitalTrigSample location
-                    if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
-                        // this trigger is the closest one to the digitalTrigSample location
-                        mTriggerIndex = pos;
-                    }
-                }
-                break;
-#endif
-                // Not a trigger
-            default:
-                break;
-            }
-
-        }
-
-        if (mDigitalSignals[id] != NULL) {
-            delete mDigitalSignals[id];
-        }
-
-        mDigitalSignals[id] = s;
-        mEndSampleIdx = s->size()-1;
-        //qDebug("D%d: %d samples", id, s->size());
-    }
-}
-
-/*!
-    Converts the signal data received for analog signals from the LabTool Hardware
-    into two lists of integer values, one for each channel.
-
-    Input format:
-
-    \dot
-     digraph structs {
-         node [shape=record];
-         start [label="A0 | A1 | A0 | ..."];
-     }
-     \enddot
-
-    Each box is a 16-bit value containing one analog samples for that channel.
-    If only one channel is enabled then only that channel's data will be present.
-    Each 16-bit value is also marked with information about which channel
-    the data is for.
-
-    The \a pData parameter is a pointer to the data, \a size is the number of
-    bytes of data.
-
-    The \a activeChannels parameter has two parts: The 16 MSB holds
-    the number of channels with values in the data, the 16 LSB holds a bitmask
-    where each channel with valid data has a bit set.
-
-    \todo Remove the \a activeChannels part of the protocol for analog signals?
-
-    At high sample rates the analog signal data can get corrupted. This is only
-    visible in the data when both analog channels are enabled and it will look
-    like this:
-
-    \dot
-     digraph structs {
-         node [shape=record];
-         start [label="A0 | A1 | A0 | A0 | A1 | ..."];
-     }
-     \enddot
-
-     This function detects the double values and inserts a value for the
-     missing channel. In the example above channel A1 would get an extra value
-     inserted. The reason for inserting extra value(s) is to at least keep the
-     signals identical in length.
-
-     One problem is that the double A0 could hide either one missing A1 value
-     or one A1 and any number of A0+A1 samples. It is impossible to know.
-*/
-void LabToolCaptureDevice::unpackAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels)
-{
-    quint16* samples = (quint16*)pData;//PACKED
-
-    for (int i = 0; i < MaxAnalogSignals; i++) {
-        if (mAnalogSignalData[i] != NULL) {
-            delete mAnalogSignalData[i];
-        }
-        mAnalogSignalData[i] = NULL;
-    }
-
-#define A0_CH_ID  (0)  // Mapping of A0 to the VADC channel number in fw
-#define A1_CH_ID  (1)  // Mapping of A1 to the VADC channel number in fw
-
-    // This is adjusted unpacking of the data. If an EMPTY marker is found, it is not treated
-    // as data and is instead discarded. If two channels are sampled and two consecutive
-    // samples for the same channel is found then an additional sample is inserted in the other
-    // channel to make up for the missing one. The id bits of each sample is also read to make
-    // sure that the samples end up on the correct signal's vector (prevents signal swapping).
-
-    // Deallocation:
-    //   QVector will be deallocated either by this function or by deleteSignals,
-    //   unpackAnalogInput or the destructor as a part of deallocating mAnalogSignalData
-    QVector<quint16> *s0 = new QVector<quint16>();
-    // Deallocation:
-    //   QVector will be deallocated either by this function or by deleteSignals,
-    //   unpackAnalogInput or the destructor as a part of deallocating mAnalogSignalData
-    QVector<quint16> *s1 = new QVector<quint16>();
-    int numChannels = mAnalogSignalList.size();
-    int lastId = -1;
-    int numSamples = size/2;
-    (void)activeChannels; // To avoid warning
-
-    // Sometimes the absolute first sample is invalid (channel id 0). If that is the
-    // case then discard that sample
-//    if (((*samples & 0x7000)>>12) == 0) {
-//        numSamples--;
-//        samples++;
-//    }
-
-    for (int i = 0; i < numSamples; i++)
-    {
-        int id = (*samples & 0x7000)>>12;
-        int empty = (*samples & 0x8000)>>15;
-        if (empty)
-        {
-            qDebug("Empty marker for i=%d", i);
-        }
-        else
-        {
-            if (id == lastId && numChannels>1)
-            {
-                // found a skip i.e. two consecutive samples for the same channel, add an extra sample for the other channel
-                if (id == A1_CH_ID)
-                {
-                    s0->append(s0->isEmpty() ? 0 : s0->last());
-                }
-                else
-                {
-                    s1->append(s1->isEmpty() ? 0 : s1->last());
-                }
-                qDebug("Skip at i=%d", i);
-            }
-
-            if (id == A1_CH_ID)
-            {
-                quint16 val = *samples;//PACKED
-                val = val & 0xfff;
-                s1->append(val);
-            }
-            else
-            {
-                quint16 val = *samples;//PACKED
-                val = val & 0xfff;
-                s0->append(val);
-            }
-            lastId = id;
-        }
-        samples++;
-    }
-
-    // Make sure that the same amount of samples have been received for both channels.
-    // This difference can only happen when two channels have been sampled and the
-    // difference in size can only be one element.
-    if (numChannels > 1)
-    {
-        if (s0->size() > s1->size())
-        {
-            s0->pop_back();
-        }
-        else if (s1->size() > s0->size())
-        {
-            s1->pop_back();
-        }
-    }
-
-    // Compensate for crosstalk between channels. The compensation is needed at sample
-    // rates >=30MHz and only when sampling both channels.
-    if (numChannels > 1 && (mUsedSampleRate == 30000000 || mUsedSampleRate == 40000000))
-    {
-        // Deallocation:
-        //   QVector will be deallocated by deleteSignals, unpackAnalogInput or
-        //   the destructor as a part of deallocating mAnalogSignalData
-        QVector<quint16> *s0prim = new QVector<quint16>();
-        // Deallocation:
-        //   QVector will be deallocated by deleteSignals, unpackAnalogInput or
-        //   the destructor as a part of deallocating mAnalogSignalData
-        QVector<quint16> *s1prim = new QVector<quint16>();
-
-        // 40MHz needs 8%, 30MHz needs 5%
-        int percent = 8;
-        if (mUsedSampleRate == 30000000)
-        {
-            percent = 5;
-        }
-
-        s0prim->append(s0->at(0));
-        s1prim->append(s1->at(0) - (percent*(s0->at(0) - 2048))/100);
-        for (int i = 1; i < s1->size(); i++)
-        {
-            s0prim->append(s0->at(i) - (percent*(s1->at(i-1) - 2048))/100);
-            s1prim->append(s1->at(i) - (percent*(s0->at(i) - 2048))/100);
-        }
-
-        delete s0;
-        delete s1;
-        s0 = s0prim;
-        s1 = s1prim;
-    }
-
-    mAnalogSignalData[0] = s0;
-    mAnalogSignalData[1] = s1;
-}
-
-/*!
-    Converts the signal data received for analog signals from the LabTool Hardware
-    into the format used by this application. The return value reflects the validity
-    of the data. If the data was captured with a falling edge trigger and the received
-    data contains no falling edge then false is returned.
-
-    The conversion is done in three steps:
-    -# Use \ref unpackAnalogInput to creates one list of integer values per channel.
-    -# Convert the integer values in to double values used by this application
-    -# Scale the values according to each channel's Volts/div setting
-
-    The \a pData parameter is a pointer to the data, \a size is the number of
-    bytes of data.
-
-    The \a activeChannels parameter has two parts: The 16 MSB holds
-    the number of channels with values in the data, the 16 LSB holds a bitmask
-    where each channel with valid data has a bit set. In the previous example
-    with only DIO4 enabled \a activeChannels would have the value \a 0x00050020.
-
-    The \a trig parameter holds the id of the channel that caused the trigger.
-
-    The \a analogTrigSample parameter holds the current sample index at the
-    time of triggering. The \a signalTrim parameter is used to discard a number
-    of samples from the start (signalTrim < 0) or end of the data to compensate
-    for the fact that the analog and digital samplings are stopped at slightly
-    different times.
-*/
-void LabToolCaptureDevice::convertAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels, quint32 trig, int analogTrigSample, int signalTrim)
-{
-    (void)trig; // To avoid warning
-    if (mAnalogSignalList.isEmpty()) {
-        // nothing to do
-        return;
-    }
-    unpackAnalogInput(pData, size, activeChannels);
-
-    LabToolCalibrationData* calib = mDeviceComm->storedCalibrationData();
-
-    foreach(AnalogSignal* signal, mAnalogSignalList) {
-        int id = signal->id();
-        int voltsPerDivIndex = supportedVPerDiv().indexOf(signal->vPerDiv());
-        double a = calib->analogFactorA(id, voltsPerDivIndex);
-        double b = calib->analogFactorB(id, voltsPerDivIndex);
-
-        if (mAnalogSignalData[id] == NULL) continue;
-
-        // Compensate for the delay in the analog hardware so that the analog and digital signals line up.
-        compensateForAnalogHardware(mAnalogSignalData[id], true);
-
-        if (signalTrim < 0) {
-            // remove abs(signalTrim) samples from the start of the data
-            trimSignalData(mAnalogSignalData[id], -signalTrim, true);
-        } else if (signalTrim > 0){
-            // remove abs(signalTrim) samples from the end of the data
-            trimSignalData(mAnalogSignalData[id], signalTrim, false);
-        }
-
-        // Deallocation:
-        //   QVector will be deallocated either by this function or the destructor
-        //   as a part of deallocating mAnalogSignals
-        QVector<double> *s = new QVector<double>();
-
-        for (int j = 0; j < mAnalogSignalData[id]->size(); j++)
-        {
-            double dval = a + b * mAnalogSignalData[id]->at(j);
-            s->append(dval);
-        }
-
-        if (signal->triggerState() != AnalogSignal::AnalogTriggerNone)
-        {
-            double trigLevel = signal->triggerLevel();
-            double lowLevel = trigLevel;
-            double highLevel = trigLevel;
-            bool forceNoiseFilter = true; // have to apply some filtering
-
-            if (forceNoiseFilter) {
-                lowLevel = trigLevel - qAbs(b * (1<<5));
-                highLevel = trigLevel + qAbs(b * (1<<5));
-            } else if (mTriggerConfig->isNoiseFilterEnabled()) {
-                lowLevel = trigLevel - qAbs(b * mTriggerConfig->noiseFilter12BitLevel());
-                highLevel = trigLevel + qAbs(b * mTriggerConfig->noiseFilter12BitLevel());
-            }
-
-            if (signalTrim < 0) {
-                // Have removed abs(signalTrim) samples from the start of the data so the
-                // trigger point must be moved as well
-
-                qDebug("analogTrigSample = %u, moved to %u", analogTrigSample, analogTrigSample-abs(signalTrim));
-                analogTrigSample -= abs(signalTrim);
-            }
-
-            int pos = locateTransition(s, signal->triggerState(), lowLevel, trigLevel, highLevel, analogTrigSample);
-            if (pos != -1) {
-                mTriggerIndex = pos;
-            }
-        }
-
-        if (mAnalogSignals[id] != NULL) {
-            delete mAnalogSignals[id];
-        }
-
-        mAnalogSignals[id] = s;
-        mEndSampleIdx = s->size()-1;
-        //qDebug("A%d: %d samples", id, s->size());
-    }
-}
-
 void LabToolCaptureDevice::start(int sampleRate)
 {
     if (mWarnUncalibrated) {
@@ -1180,6 +427,10 @@ void LabToolCaptureDevice::start(int sampleRate)
 
     qDebug() << "LabToolCaptureDevice::start";
 
+    // In continuous mode the next capture is started by LabToolDeviceComm
+    // as soon as the samples have been received, see handleReceivedSamples
+    mDeviceComm->setContinuousCapture(mContinuous);
+
     mRunningCapture = true;
     if (hasConfigChanged()) {
         qDebug("Configuration has changed and will be pushed to target");
@@ -1196,26 +447,89 @@ void LabToolCaptureDevice::stop()
     qDebug() << "LabToolCaptureDevice::stop";
     mReconfigurationRequested = false;
     mRunningCapture = false;
+    mContinuous = false;
     mDeviceComm->stopCapture();
 }
 
+/*!
+    Enables (\a enable is true) or disables continuous capture. Must be
+    called before start().
+
+    In continuous mode the hardware is started again as soon as the samples
+    of the previous capture have been received. Receiving, converting and
+    painting the captures then overlap: while a capture is received the
+    previous one is converted in a thread pool and the one before that is
+    painted. A capture that arrives while the previous one is still being
+    converted is dropped instead of stalling the hardware, see
+    droppedFrames().
+
+    Each converted capture is stored in the captureHistory(), if enabled,
+    and given to the triggerEngine(). The capture stops by itself when a
+    segment matches the stop condition, see handleStopConditionMatched().
+*/
+void LabToolCaptureDevice::setContinuousCapture(bool enable)
+{
+    if (enable && !mContinuous) {
+        mDroppedFrames = 0;
+        mCapturesPerSecond = 0;
+        mCapturesSinceRateUpdate = 0;
+        mCaptureRateTimer.start();
+        triggerEngine().reset();
+    }
+    mContinuous = enable;
+}
+
+/*!
+    \fn bool LabToolCaptureDevice::restartsContinuousCapture()
+
+    Returns true as the hardware is started again by LabToolDeviceComm in
+    continuous mode, see setContinuousCapture().
+*/
+
+/*!
+    \fn double LabToolCaptureDevice::capturesPerSecond()
+
+    Returns the number of captures per second that have been converted
+    and handed over to the UI during continuous capture.
+*/
+
+/*!
+    \fn quint64 LabToolCaptureDevice::droppedFrames()
+
+    Returns the number of captures that have been dropped since continuous
+    capture was enabled because the previous capture was still being
+    converted.
+*/
+
 int LabToolCaptureDevice::lastSampleIndex()
 {
     return mEndSampleIdx;
 }
 
-QVector<int>* LabToolCaptureDevice::digitalData(int signalId)
+DigitalSampleStore* LabToolCaptureDevice::digitalData(int signalId)
 {
-    QVector<int>* data = NULL;
+    DigitalSampleStore* data = NULL;
 
     if (signalId < MaxDigitalSignals) {
+
+        // Only the transitions are kept for signals with few transitions.
+        // Recreate the samples
+        if (mDigitalSignals[signalId] == NULL
+                && mDigitalSignalTransitions[signalId] != NULL) {
+            // Deallocation:
+            //   DigitalSampleStore will be deallocated by the destructor
+            //   as a part of deallocating mDigitalSignals
+            mDigitalSignals[signalId] = new DigitalSampleStore(
+                        mDigitalSignalTransitions[signalId]->toSamples());
+        }
+
         data = mDigitalSignals[signalId];
     }
 
     return data;
 }
 
-void LabToolCaptureDevice::setDigitalData(int signalId, QVector<int> data)
+void LabToolCaptureDevice::setDigitalData(int signalId, const DigitalSampleStore &data)
 {
     if (signalId < MaxDigitalSignals) {
 
@@ -1224,21 +538,27 @@ void LabToolCaptureDevice::setDigitalData(int signalId, QVector<int> data)
             mDigitalSignals[signalId] = NULL;
         }
 
+        // the cached transitions belong to the old data
+        if (mDigitalSignalTransitions[signalId] != NULL) {
+            delete mDigitalSignalTransitions[signalId];
+            mDigitalSignalTransitions[signalId] = NULL;
+        }
+
         if (data.size() > 0) {
             mEndSampleIdx = data.size()-1;
 
             // Deallocation:
-            //   QVector will be deallocated either by this function or the destructor
-            //   as a part of deallocating mDigitalSignals
-            mDigitalSignals[signalId] = new QVector<int>(data);
+            //   DigitalSampleStore will be deallocated either by this function or
+            //   the destructor as a part of deallocating mDigitalSignals
+            mDigitalSignals[signalId] = new DigitalSampleStore(data);
         }
 
     }
 }
 
-QVector<double>* LabToolCaptureDevice::analogData(int signalId)
+AnalogSampleStore* LabToolCaptureDevice::analogData(int signalId)
 {
-    QVector<double>* data = NULL;
+    AnalogSampleStore* data = NULL;
 
     if (signalId < MaxAnalogSignals) {
         data = mAnalogSignals[signalId];
@@ -1247,7 +567,7 @@ QVector<double>* LabToolCaptureDevice::analogData(int signalId)
     return data;
 }
 
-void LabToolCaptureDevice::setAnalogData(int signalId, QVector<double> data)
+void LabToolCaptureDevice::setAnalogData(int signalId, const AnalogSampleStore &data)
 {
     if (signalId < MaxAnalogSignals) {
 
@@ -1256,17 +576,39 @@ void LabToolCaptureDevice::setAnalogData(int signalId, QVector<double> data)
             mAnalogSignals[signalId] = NULL;
         }
 
+        // the pyramid belongs to the old data
+        if (mAnalogMinMax[signalId] != NULL) {
+            delete mAnalogMinMax[signalId];
+            mAnalogMinMax[signalId] = NULL;
+        }
+
         if (data.size() > 0) {
             mEndSampleIdx = data.size()-1;
 
             // Deallocation:
-            //   QVector will be deallocated either by this function or the destructor
-            //   as a part of deallocating mAnalogSignalData
-            mAnalogSignals[signalId] = new QVector<double>(data);
+            //   AnalogSampleStore will be deallocated either by this function or
+            //   the destructor as a part of deallocating mAnalogSignals
+            mAnalogSignals[signalId] = new AnalogSampleStore(data);
         }
     }
 }
 
+AnalogMinMaxPyramid* LabToolCaptureDevice::analogMinMax(int signalId)
+{
+    if (signalId >= MaxAnalogSignals) return NULL;
+
+    // Not in cache. Create the pyramid
+    if (mAnalogMinMax[signalId] == NULL && mAnalogSignals[signalId] != NULL) {
+        // Deallocation:
+        //   AnalogMinMaxPyramid will be deallocated by the destructor
+        //   as a part of deallocating mAnalogMinMax
+        mAnalogMinMax[signalId] = new AnalogMinMaxPyramid(
+                    *mAnalogSignals[signalId]);
+    }
+
+    return mAnalogMinMax[signalId];
+}
+
 void LabToolCaptureDevice::clearSignalData()
 {
     deleteSignals();
@@ -1282,22 +624,21 @@ void LabToolCaptureDevice::setDigitalTriggerIndex(int idx)
     mTriggerIndex = idx;
 }
 
-void LabToolCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
+DigitalTransitions* LabToolCaptureDevice::digitalTransitions(int signalId)
 {
-    if (signalId >= MaxDigitalSignals) return;
-    if (mDigitalSignals[signalId] == NULL) return;
+    if (signalId >= MaxDigitalSignals) return NULL;
 
     // Not in cache. Create the list
-    if (mDigitalSignalTransitions[signalId] == NULL) {
+    if (mDigitalSignalTransitions[signalId] == NULL
+            && mDigitalSignals[signalId] != NULL) {
         // Deallocation:
-        //   QList will be deallocated by the destructor
+        //   DigitalTransitions will be deallocated by the destructor
         //   as a part of deallocating mDigitalSignalTransitions
-        QList<int>* l = new QList<int>();
-        CaptureDevice::digitalTransitions(signalId, *l);
-        mDigitalSignalTransitions[signalId] = l;
+        mDigitalSignalTransitions[signalId] = new DigitalTransitions(
+                    DigitalTransitions::fromSamples(*mDigitalSignals[signalId]));
     }
 
-    list = *mDigitalSignalTransitions[signalId];
+    return mDigitalSignalTransitions[signalId];
 }
 
 void LabToolCaptureDevice::reconfigure(int sampleRate)
@@ -1368,9 +709,9 @@ void LabToolCaptureDevice::deleteSignals()
             mAnalogSignals[i] = NULL;
         }
 
-        if (mAnalogSignalData[i] != NULL) {
-            delete mAnalogSignalData[i];
-            mAnalogSignalData[i] = NULL;
+        if (mAnalogMinMax[i] != NULL) {
+            delete mAnalogMinMax[i];
+            mAnalogMinMax[i] = NULL;
         }
     }
 }
@@ -1429,32 +770,160 @@ void LabToolCaptureDevice::handleConfigurationFailure(const char *msg)
 /*!
     A report that the LabTool Hardware has successfully captured the requested
     signal data.
-    The previously collected signals will be discarded and the new data will
-    be unpacked. Finally a \ref captureFinished signal will be sent to
-    indicate the successful end of the capturing.
+    The conversion of the sample data in \a transfer is started in the global
+    thread pool by a LabToolCaptureDecoder. The previously collected signals
+    are kept until the conversion is done, see handleDecoderFinished().
+
+    In continuous mode the hardware has already been started again by
+    LabToolDeviceComm. If the previous capture is still being converted
+    this one is dropped so that the hardware never has to wait for the
+    host.
 */
 void LabToolCaptureDevice::handleReceivedSamples(LabToolDeviceTransfer* transfer, unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int digitalChannelInfo, unsigned int analogChannelInfo, int signalTrim)
 {
+    if (!mRunningCapture) {
+        // the capture has been stopped, e.g. by the stop condition, while
+        // these samples were on their way
+        delete transfer;
+        return;
+    }
+
     if (mReconfigurationRequested && hasConfigChanged()) {
         // will restart capture with the new data so discard this set
         qDebug("Discarding captured data as reconfiguration is in the pipe");
-    } else {
-        int analogOffset = transfer->analogDataOffset();
-        int analogSize = transfer->analogDataSize();
-        deleteSignals();
+        delete transfer;
+        return;
+    }
 
-        mUsedSampleRate = mRequestedSampleRate;
-        mTriggerIndex = 0;
+    if (mDecoder != NULL) {
+        if (mContinuous) {
+            // converting the previous capture, drop this one
+            mDroppedFrames++;
+            delete transfer;
+            return;
+        }
 
-        convertDigitalInput(transfer->data(), size-analogSize, digitalChannelInfo, trigger, digitalTrigSample, signalTrim);
-        convertAnalogInput(transfer->data()+analogOffset, analogSize, analogChannelInfo, trigger, analogTrigSample, signalTrim);
-        qDebug() << "Got " << size << "bytes with samples";
-        //qDebug() << "Digital trigger at " << digitalTrigSample << ", analog at " << analogTrigSample;
+        // only the latest capture is of interest
+        mDecoder->cancel();
+        mDecoder = NULL;
+    }
+
+    // Deallocation: the decoder takes over the transfer and deletes itself
+    //   with deleteLater() once finished() has been delivered
+    LabToolCaptureDecoder* decoder = new LabToolCaptureDecoder(
+                transfer, size, trigger, digitalTrigSample, analogTrigSample,
+                digitalChannelInfo, analogChannelInfo, signalTrim);
+
+    // The UI can change the signals while the conversion is running so the
+    // decoder gets copies of everything it needs
+    decoder->setSignals(mDigitalSignalList, mAnalogSignalList);
+    decoder->setSampleRate(mRequestedSampleRate);
+    decoder->setNoiseFilter(mTriggerConfig->isNoiseFilterEnabled(),
+                            mTriggerConfig->noiseFilter12BitLevel());
+    if (!mAnalogSignalList.isEmpty()) {
+        decoder->setCalibration(mDeviceComm->storedCalibrationData(),
+                                supportedVPerDiv());
+    }
+
+    // the connections are queued since the signal is emitted from the
+    // thread pool
+    connect(decoder, SIGNAL(finished()), this, SLOT(handleDecoderFinished()));
+    connect(decoder, SIGNAL(finished()), decoder, SLOT(deleteLater()));
+
+    mDecoder = decoder;
+    QThreadPool::globalInstance()->start(decoder);
+}
+
+/*!
+    Called when the LabToolCaptureDecoder has converted the sample data.
+    The previously collected signals are discarded and replaced by the
+    converted ones. In continuous mode the capture is also recorded, see
+    recordCaptureSegment(). Finally a \ref captureFinished signal will be sent to
+    indicate the successful end of the capturing.
+*/
+void LabToolCaptureDevice::handleDecoderFinished()
+{
+    LabToolCaptureDecoder* decoder = qobject_cast<LabToolCaptureDecoder*>(sender());
 
+    // the result from a replaced decoder is outdated
+    if (decoder == NULL || decoder != mDecoder) return;
+
+    mDecoder = NULL;
+
+    if (decoder->isCancelled()) return;
+
+    deleteSignals();
+
+    mUsedSampleRate = decoder->sampleRate();
+    mTriggerIndex = decoder->triggerIndex();
+    mEndSampleIdx = decoder->endSampleIndex();
+
+    for (int i = 0; i < MaxDigitalSignals; i++) {
+        mDigitalSignals[i] = decoder->takeDigitalData(i);
+        mDigitalSignalTransitions[i] = decoder->takeDigitalTransitions(i);
+    }
+
+    for (int i = 0; i < MaxAnalogSignals; i++) {
+        mAnalogSignals[i] = decoder->takeAnalogData(i);
+        mAnalogMinMax[i] = decoder->takeAnalogMinMax(i);
+    }
+
+    if (mContinuous) {
+        updateCaptureRate();
+        recordCaptureSegment();
+    }
+    else {
         mRunningCapture = false;
-        emit captureFinished(true, "");
     }
-    delete transfer;
+    emit captureFinished(true, "");
+}
+
+/*!
+    Called when \a segment has matched the stop condition. The evaluation
+    runs in a thread pool so a few more captures may have been made since
+    the matching one. The continuous capture is stopped and the matching
+    segment is shown again, also if the capture history has evicted it.
+    The \ref captureFinished signal sent by handleStopped() lets the UI
+    show it.
+
+    Nothing is done if the continuous capture has already been stopped.
+*/
+void LabToolCaptureDevice::handleStopConditionMatched(const CaptureSegment &segment)
+{
+    if (!mContinuous) return;
+
+    // a pending reconfiguration is pushed by the next start() instead of
+    // restarting the capture from handleStopped()
+    mReconfigurationRequested = false;
+    mContinuous = false;
+    mRunningCapture = false;
+
+    // a capture converted after the matching one must not replace it
+    if (mDecoder != NULL) {
+        mDecoder->cancel();
+        mDecoder = NULL;
+    }
+
+    // leave the matching capture on screen
+    showCaptureSegment(segment);
+
+    mDeviceComm->stopCapture();
+}
+
+/*!
+    Updates the number of captures per second. The rate is calculated over
+    periods of at least one second.
+*/
+void LabToolCaptureDevice::updateCaptureRate()
+{
+    mCapturesSinceRateUpdate++;
+
+    qint64 elapsed = mCaptureRateTimer.elapsed();
+    if (elapsed >= 1000) {
+        mCapturesPerSecond = mCapturesSinceRateUpdate*1000.0/elapsed;
+        mCapturesSinceRateUpdate = 0;
+        mCaptureRateTimer.restart();
+    }
 }
 
 /*!
@@ -1465,6 +934,7 @@ void LabToolCaptureDevice::handleReceivedSamples(LabToolDeviceTransfer* transfer
 void LabToolCaptureDevice::handleFailedCapture(const char *msg)
 {
     mRunningCapture = false;
+    mContinuous = false;
     emit captureFinished(false, msg);
 }
 
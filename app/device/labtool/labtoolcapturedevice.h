@@ -18,9 +18,11 @@
 
 #include <QObject>
 #include <QList>
+#include <QElapsedTimer>
 
 #include "device/capturedevice.h"
 #include "labtooldevicecomm.h"
+#include "labtoolcapturedecoder.h"
 #include "uilabtooltriggerconfig.h"
 
 class LabToolCaptureDevice : public CaptureDevice
@@ -35,23 +37,28 @@ public:
     int maxNumAnalogSignals();
     QList<double> supportedVPerDiv();
     bool supportsContinuousCapture() {return true;}
+    bool restartsContinuousCapture() {return true;}
 
     void configureTrigger(QWidget* parent);
     void calibrate(QWidget* parent);
     void start(int sampleRate);
     void stop();
+    void setContinuousCapture(bool enable);
+    double capturesPerSecond() {return mCapturesPerSecond;}
+    quint64 droppedFrames() {return mDroppedFrames;}
 
     int lastSampleIndex();
-    QVector<int>* digitalData(int signalId);
-    void setDigitalData(int signalId, QVector<int> data);
-    QVector<double>* analogData(int signalId);
-    void setAnalogData(int signalId, QVector<double> data);
+    DigitalSampleStore* digitalData(int signalId);
+    void setDigitalData(int signalId, const DigitalSampleStore &data);
+    AnalogSampleStore* analogData(int signalId);
+    void setAnalogData(int signalId, const AnalogSampleStore &data);
+    AnalogMinMaxPyramid* analogMinMax(int signalId);
 
     void clearSignalData();
 
     int digitalTriggerIndex();
     void setDigitalTriggerIndex(int idx);
-    void digitalTransitions(int signalId, QList<int> &list);
+    DigitalTransitions* digitalTransitions(int signalId);
 
     void reconfigure(int sampleRate = -1);
 
@@ -64,14 +71,18 @@ private slots:
     void handleConfigurationDone();
     void handleConfigurationFailure(const char* msg);
     void handleReceivedSamples(LabToolDeviceTransfer* transfer, unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int digitalChannelInfo, unsigned int analogChannelInfo, int signalTrim);
+    void handleDecoderFinished();
     void handleFailedCapture(const char* msg);
     void handleReconfigurationTimer();
 
+protected slots:
+    void handleStopConditionMatched(const CaptureSegment &segment);
+
 private:
 
     enum Constants {
-        MaxDigitalSignals = 11,
-        MaxAnalogSignals = 2
+        MaxDigitalSignals = LabToolCaptureDecoder::MaxDigitalSignals,
+        MaxAnalogSignals = LabToolCaptureDecoder::MaxAnalogSignals
     };
 
     UiLabToolTriggerConfig* mTriggerConfig;
@@ -84,40 +95,31 @@ private:
     bool mRunningCapture;
     bool mReconfigurationRequested;
     bool mWarnUncalibrated;
+    bool mContinuous;
+    LabToolCaptureDecoder* mDecoder;
+    quint64 mDroppedFrames;
+    double mCapturesPerSecond;
+    int mCapturesSinceRateUpdate;
+    QElapsedTimer mCaptureRateTimer;
     quint8* mData;
     QList<DigitalSignal> mLastUsedDigtalSignals;
     QList<AnalogSignal> mLastUsedAnalogSignals;
     int mLastUsedSampleRate;
 
-    QVector<int>* mDigitalSignals[MaxDigitalSignals];
-    QVector<double>* mAnalogSignals[MaxAnalogSignals];
-    QVector<quint16>* mAnalogSignalData[MaxAnalogSignals];
-    QList<int>* mDigitalSignalTransitions[MaxDigitalSignals];
+    DigitalSampleStore* mDigitalSignals[MaxDigitalSignals];
+    AnalogSampleStore* mAnalogSignals[MaxAnalogSignals];
+    AnalogMinMaxPyramid* mAnalogMinMax[MaxAnalogSignals];
+    DigitalTransitions* mDigitalSignalTransitions[MaxDigitalSignals];
 
     QList<double> mSupportedVPerDiv;
 
     QTimer* mReconfigTimer;
 
-    template <typename T>
-    void trimSignalData(QVector<T> *s, int numToRemove, bool removeFromStart) const;
-
-    template <typename T>
-    void compensateForAnalogHardware(QVector<T> *s, bool isAnalogSignal) const;
-
-    int locateFirstLevel(QVector<int> *s, int level, int offset);
-    int locatePreviousLevel(QVector<int> *s, int level, int offset);
-
-    int locateAnalogHighLowTransition(QVector<double> *s, double lowLevel, double highLevel, int offset);
-    int locateAnalogLowHighTransition(QVector<double> *s, double lowLevel, double highLevel, int offset);
-    int locateTransition(QVector<double> *s, AnalogSignal::AnalogTriggerState trigState, double lowLevel, double trigLevel, double highLevel, int estimatedIdx);
-
     bool detectAnalogSignalFrequency(int id, quint16 trigLevel, bool fallingEdge);
-    void convertDigitalInput(const quint8* pData, quint32 size, quint32 activeChannels, quint32 trig, int digitalTrigSample, int signalTrim);
-    void unpackAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels);
     void convertHiddenAnalogInput(const quint8 *pData, quint32 size);
-    void convertAnalogInput(const quint8* pData, quint32 size, quint32 activeChannels, quint32 trig, int analogTrigSample, int signalTrim);
     void saveData(const quint8* pData, quint32 size);
     void deleteSignals();
+    void updateCaptureRate();
 
     qint16 analog12BitTriggerLevel(const AnalogSignal *signal);
 
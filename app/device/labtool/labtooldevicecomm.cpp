@@ -15,6 +15,8 @@
  */
 #include "labtooldevicecomm.h"
 
+#include <QMutexLocker>
+
 
 /*!
     The Vendor Identifier (VID) of the LabTool Hardware
@@ -203,13 +205,15 @@ void LIBUSB_CALL CallbackForSend(struct libusb_transfer* transfer)
     Constructs a communication instance with the given \a parent.
 */
 LabToolDeviceComm::LabToolDeviceComm(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    mCaptureMutex(QMutex::Recursive)
 {
     this->mContext = NULL;
     this->mDeviceHandle = NULL;
     this->mRunningTransfer = NULL;
     this->mConnected = false;
     this->mActiveCalibrationData = NULL;
+    this->mContinuousCapture = 0;
 }
 
 /*!
@@ -302,7 +306,9 @@ void LabToolDeviceComm::disconnectFromDevice()
         libusb_close(mDeviceHandle);
         mDeviceHandle = NULL;
     }
+    mCaptureMutex.lock();
     this->mRunningTransfer = NULL;
+    mCaptureMutex.unlock();
     if (this->mActiveCalibrationData != NULL) {
         delete this->mActiveCalibrationData;
         this->mActiveCalibrationData = NULL;
@@ -908,10 +914,18 @@ void LabToolDeviceComm::probe()
 */
 int LabToolDeviceComm::stopCapture()
 {
+    // Continuous capture must be disabled and the transfers invalidated
+    // while holding the lock. The USB thread checks the flag and starts
+    // the next capture while holding the same lock, so after this no new
+    // capture can be started.
+    mCaptureMutex.lock();
+    mContinuousCapture.storeRelease(0);
     LabToolDeviceTransfer::invalidateOldTransfers();
+    mCaptureMutex.unlock();
 
     if (!mConnected)
     {
+        QMutexLocker locker(&mCaptureMutex);
         mRunningTransfer = NULL;
         return -1;
     }
@@ -923,6 +937,9 @@ int LabToolDeviceComm::stopCapture()
 //        return -1;//emit connectionStatus(false);
 //    }
 
+    // the lock must not be held during the synchronous request above as
+    // the USB thread may need it to complete the ongoing callback
+    mCaptureMutex.lock();
     if (mRunningTransfer != NULL)
     {
         if (libusb_cancel_transfer(mRunningTransfer->transfer()) != LIBUSB_SUCCESS)
@@ -931,6 +948,7 @@ int LabToolDeviceComm::stopCapture()
             mRunningTransfer = NULL;
         }
     }
+    mCaptureMutex.unlock();
 
 
 //    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
@@ -1003,6 +1021,10 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
         memcpy(&sampleHeader, transfer->data(), sizeof(logic_samples_header));
 //        qDebug("Got samples. Headers: %#x, %#x, %#x, %#x", sampleHeader.cmd, sampleHeader.bufferSize, sampleHeader.triggerInfo, sampleHeader.channelInfo);
         transfer->setupForIncomingData(mEndpointIn, mDeviceHandle, CallbackForData, 2000, sampleHeader.digitalBufferSize, sampleHeader.analogBufferSize);
+        if (transfer->data() == NULL) {
+            emit captureFailed("Failed to allocate memory for the captured samples");
+            break;
+        }
         ret = libusb_submit_transfer(transfer->transfer());
         if (ret == LIBUSB_SUCCESS) {
             // must return to avoid the deletion of this transfer
@@ -1015,9 +1037,20 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
         // actual sample data
         // give sampleHeader and transfer) to LabToolDevice to forward to UI
         emit captureReceivedSamples(transfer, sampleHeader.digitalBufferSize + sampleHeader.analogBufferSize, sampleHeader.triggerInfo, sampleHeader.digitalTrigSample, sampleHeader.analogTrigSample, sampleHeader.digitalChannelInfo, sampleHeader.analogChannelInfo, sampleHeader.signalTrim);
-        if (mRunningTransfer == transfer)
         {
-            mRunningTransfer = NULL;
+            // the flag is checked while holding the lock so that a
+            // concurrent stopCapture() either cancels the new capture or
+            // prevents it from being started
+            QMutexLocker locker(&mCaptureMutex);
+            if (mRunningTransfer == transfer)
+            {
+                mRunningTransfer = NULL;
+            }
+            if (mContinuousCapture.loadAcquire() != 0) {
+                // start the next capture immediately so that the hardware
+                // captures while the host is converting these samples
+                runCapture();
+            }
         }
         // must return to avoid the deletion of this transfer
         return;
@@ -1056,10 +1089,12 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
         break;
     }
 
+    mCaptureMutex.lock();
     if (mRunningTransfer == transfer)
     {
         mRunningTransfer = NULL;
     }
+    mCaptureMutex.unlock();
     delete transfer;
 }
 
@@ -1116,10 +1151,12 @@ void LabToolDeviceComm::transferSuccessErrorResponse(LabToolDeviceTransfer *tran
         break;
     }
 
+    mCaptureMutex.lock();
     if (mRunningTransfer == transfer)
     {
         mRunningTransfer = NULL;
     }
+    mCaptureMutex.unlock();
     delete transfer;
 }
 
@@ -1141,10 +1178,12 @@ void LabToolDeviceComm::transferFailed(LabToolDeviceTransfer *transfer, int libu
 {
     if (!transfer->validSequenceNumber()) {
         //qDebug("Discarding out-of-order transfer");
+        mCaptureMutex.lock();
         if (mRunningTransfer == transfer)
         {
             mRunningTransfer = NULL;
         }
+        mCaptureMutex.unlock();
         delete transfer;
         return;
     }
@@ -1225,10 +1264,12 @@ void LabToolDeviceComm::transferFailed(LabToolDeviceTransfer *transfer, int libu
         }
     }
 
+    mCaptureMutex.lock();
     if (mRunningTransfer == transfer)
     {
         mRunningTransfer = NULL;
     }
+    mCaptureMutex.unlock();
 
     // Don't reconnect on cancelled transfers (which occur when pressing STOP during a capture)
     if (transfer->transfer()->status != LIBUSB_TRANSFER_CANCELLED) {
@@ -1272,6 +1313,10 @@ int LabToolDeviceComm::configureCapture(int cfgSize, quint8 * cfgData)
         return -1;
     }
 
+    // The size of the sample transfers depends on the configuration so the
+    // pooled buffers must be sized again
+    LabToolTransferBufferPool::instance().clear();
+
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
     ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAP_CONFIGURE,
                          mEndpointOut,
@@ -1325,6 +1370,10 @@ int LabToolDeviceComm::runCapture()
         return -1;
     }
 
+    // also held by the caller when the next continuous capture is started
+    // from the USB thread, see transferSuccess()
+    QMutexLocker locker(&mCaptureMutex);
+
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
     ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAP_RUN, mEndpointOut, mDeviceHandle, CallbackForSend, 2000);
     mRunningTransfer = ddt;
@@ -1337,6 +1386,23 @@ int LabToolDeviceComm::runCapture()
     return ret;
 }
 
+/*!
+    Enables (\a enable is true) or disables continuous capture. When enabled
+    a new capture is started, see \ref runCapture, as soon as the samples from
+    the previous capture have been received and before they are handed over
+    with the \ref captureReceivedSamples signal. This way the hardware can
+    capture the next set of samples while the current one is being processed.
+
+    Continuous capture is disabled by \ref stopCapture. Can be called from
+    any thread. The flag is checked by the USB thread and cleared by
+    \ref stopCapture while holding the capture lock, so no capture is started
+    after \ref stopCapture has returned.
+*/
+void LabToolDeviceComm::setContinuousCapture(bool enable)
+{
+    mContinuousCapture.storeRelease(enable ? 1 : 0);
+}
+
 /*!
     Sends a request to the LabTool Hardware to stop/abort the ongoing signal generation.
 
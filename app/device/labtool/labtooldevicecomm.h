@@ -17,6 +17,8 @@
 #define LABTOOLDEVICECOMM_H
 
 #include <QObject>
+#include <QAtomicInt>
+#include <QMutex>
 #include "labtooldevicecommthread.h"
 #include "labtooldevicetransfer.h"
 #include "labtoolcalibrationdata.h"
@@ -36,6 +38,11 @@ private:
     quint8                   mEndpointIn;
     quint8                   mEndpointOut;
     LabToolCalibrationData* mActiveCalibrationData;
+    QAtomicInt               mContinuousCapture;
+
+    // protects mRunningTransfer and the start of a new capture which can
+    // be done from both the USB thread and the thread owning this object
+    QMutex                   mCaptureMutex;
 
 public:
     explicit LabToolDeviceComm(QObject *parent = 0);
@@ -46,6 +53,7 @@ public:
     int stopCapture();
     int configureCapture(int cfgSize, quint8 * cfgData);
     int runCapture();
+    void setContinuousCapture(bool enable);
 
     int stopGenerator();
     int configureGenerator(int cfgSize, quint8* cfgData);
@@ -15,6 +15,8 @@
  */
 #include "labtooldevicetransfer.h"
 
+#include <string.h>
+
 /*!
      When using debugger or Valgrind it is useful to increase the timeouts of
      all USB transfers. Default value is 1.
@@ -53,6 +55,8 @@ LabToolDeviceTransfer::LabToolDeviceTransfer(LabToolDeviceComm *comm)
     mTransfer = libusb_alloc_transfer(0);
     mDeviceComm = comm;
     mHasPayload = false;
+    mBuffer = NULL;
+    mBufferDataSize = 0;
     mAnalogDataOffset = 0;
     mAnalogDataSize = 0;
     mSequenceNumber = sequenceCounter++;
@@ -68,6 +72,7 @@ LabToolDeviceTransfer::~LabToolDeviceTransfer()
 //    qDebug("[Trace] Delete transfer for comm %#x, mTransfer=%#x, this=%#x", (uint32_t)mDeviceComm, (uint32_t)mTransfer, (uint32_t)this);
     libusb_free_transfer(mTransfer);
     mTransfer = NULL;
+    releaseBuffer();
 }
 
 /*!
@@ -292,6 +297,7 @@ void LabToolDeviceTransfer::setupForResponse(unsigned char endpoint, libusb_tran
 void LabToolDeviceTransfer::setupForIncomingCommand(Commands cmd, unsigned char endpoint, libusb_device_handle *deviceHandle, libusb_transfer_cb_fn callback, unsigned int timeout, int payloadSize)
 {
 //    qDebug("[Trace] Setup for incomming cmd %d: comm %#x, mTransfer=%#x, this=%#x", cmd, (uint32_t)mDeviceComm, (uint32_t)mTransfer, (uint32_t)this);
+    releaseBuffer();
     mData.clear();
     mData.resize(payloadSize);
 
@@ -322,6 +328,10 @@ void LabToolDeviceTransfer::setupForIncomingCommand(Commands cmd, unsigned char
     The \a digitalPayloadSize parameter specifies how many bytes of digital samples to receive.
     The \a analogPayloadSize parameter specifies how many bytes of analog samples to receive.
 
+    The data is received into a buffer from the LabToolTransferBufferPool
+    instead of a newly allocated array. The buffer is given back to the pool
+    with \ref releaseBuffer() or when this transfer is deleted.
+
     The received data will be \a digitalPayloadSize + \a analogPayloadSize bytes formatted like this:
 
    \dot
@@ -334,8 +344,15 @@ void LabToolDeviceTransfer::setupForIncomingCommand(Commands cmd, unsigned char
 void LabToolDeviceTransfer::setupForIncomingData(unsigned char endpoint, libusb_device_handle *deviceHandle, libusb_transfer_cb_fn callback, unsigned int timeout, int digitalPayloadSize, int analogPayloadSize)
 {
 //    qDebug("[Trace] Setup for incoming data: comm %#x, mTransfer=%#x, this=%#x", (uint32_t)mDeviceComm, (uint32_t)mTransfer, (uint32_t)this);
+    int size = digitalPayloadSize + analogPayloadSize;
+
+    // the small buffer with the header is not needed anymore
     mData.clear();
-    mData.resize(digitalPayloadSize + analogPayloadSize);
+
+    releaseBuffer();
+    mBuffer = LabToolTransferBufferPool::instance().acquire(size);
+    mBufferDataSize = (mBuffer != NULL ? size : 0);
+
     mAnalogDataOffset = digitalPayloadSize;
     mAnalogDataSize = analogPayloadSize;
 
@@ -344,13 +361,43 @@ void LabToolDeviceTransfer::setupForIncomingData(unsigned char endpoint, libusb_
     libusb_fill_bulk_transfer(mTransfer,
                               deviceHandle,
                               endpoint,
-                              mData.data(),
-                              mData.size(),
+                              (mBuffer != NULL ? mBuffer->data() : NULL),
+                              mBufferDataSize,
                               callback,
                               this,
                               timeout * TIMEOUT_MULTIPLIER);
 }
 
+/*!
+    Creates a copy of the received data. The data will remain even after this
+    object is deallocated and the recipient is responsible for deallocation.
+*/
+QVector<quint8> LabToolDeviceTransfer::copyData()
+{
+    if (mBuffer == NULL) {
+        return QVector<quint8>(mData);
+    }
+
+    QVector<quint8> copy(mBufferDataSize);
+    memcpy(copy.data(), mBuffer->data(), mBufferDataSize);
+    return copy;
+}
+
+/*!
+    Gives the buffer with the received sample data back to the
+    LabToolTransferBufferPool. The pointer returned by \ref data() is not
+    valid after this call. Calling this function for a transfer without a
+    buffer from the pool does nothing.
+*/
+void LabToolDeviceTransfer::releaseBuffer()
+{
+    if (mBuffer != NULL) {
+        LabToolTransferBufferPool::instance().release(mBuffer);
+        mBuffer = NULL;
+        mBufferDataSize = 0;
+    }
+}
+
 /*!
     Verifies that the first received byte is 0xEA and that the Command byte corresponds
     to the Command that this transfer is configured for.
@@ -362,6 +409,10 @@ bool LabToolDeviceTransfer::isValidResponse()
         //qDebug("isValidResponse: Found out-of-order transfer");
         return false;
     }
+    if (mData.size() < 4) {
+        // the header isn't kept for transfers with sample data
+        return false;
+    }
     return (mData[3] == 0xea) && (mData[2] == mCmd);
 }
 
@@ -496,12 +547,6 @@ const char *LabToolDeviceTransfer::commandString()
     transfer this is. The data is only valid as long as this object is not
     deallocated.
 */
-/*!
-    \fn QVector<quint8> LabToolDeviceTransfer::copyData()
-
-    Creates a copy of the received data. The data will remain even after this
-    object is deallocated and the recipient is responsible for deallocation.
-*/
 /*!
     \fn int LabToolDeviceTransfer::payloadSize()
 
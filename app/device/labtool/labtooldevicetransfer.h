@@ -18,6 +18,7 @@
 
 #include "QVector"
 #include "labtooldevicecomm.h"
+#include "labtooltransferbufferpool.h"
 
 #include "libusbx/include/libusbx-1.0/libusb.h"
 
@@ -82,8 +83,9 @@ public:
     const char* statusErrorString();
     const char* commandString();
 
-    const quint8* data()  { return mData.constData(); }
-    QVector<quint8> copyData() { return QVector<quint8>(mData); }
+    const quint8* data()  { return (mBuffer != NULL ? mBuffer->data() : mData.constData()); }
+    QVector<quint8> copyData();
+    void releaseBuffer();
     int payloadSize() { return mData.size() - 4; }
     bool hasPayload() { return mHasPayload; }
     int analogDataOffset() { return mAnalogDataOffset; }
@@ -100,6 +102,8 @@ public:
 
 private:
     QVector<quint8> mData;
+    LabToolTransferBuffer* mBuffer;
+    int mBufferDataSize;
     int mAnalogDataOffset;
     int mAnalogDataSize;
     bool mHasPayload;
@@ -0,0 +1,389 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "labtoolsampleunpacker.h"
+
+#include <QDebug>
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LABTOOL_USE_SSE2
+#endif
+
+/*!
+    \class LabToolSampleUnpacker
+    \brief Unpacks the raw sample data received from the LabTool Hardware.
+
+    \ingroup Device
+
+    The functions only work on plain arrays and only need QtCore so that
+    they can be benchmarked and tested without the rest of the application.
+    They are used by the LabToolCaptureDecoder.
+*/
+
+/*!
+    De-interleaves the 32-bit slice words in \a samples into one array of
+    words per channel. The data consists of \a sampleGroups groups with
+    \a signalsInInput words each (see
+    LabToolCaptureDecoder::convertDigitalInput()).
+
+    The \a slices array holds the \a numSlices slices (positions in a group,
+    at most \ref MaxSlices) to extract in increasing order. The words for \c slices[i] are written
+    to \c dst[i] which must have room for \a sampleGroups words.
+
+    The input is only read once independent of the number of channels. When
+    SSE2 is available four groups are handled at a time by transposing 4x4
+    blocks of words. The remaining groups, and inputs with fewer than four
+    slices per group, are handled by the plain loop.
+*/
+void LabToolSampleUnpacker::deinterleaveSliceWords(const quint32 *samples, int sampleGroups, int signalsInInput, const int *slices, quint32 **dst, int numSlices)
+{
+    if (numSlices == 0 || sampleGroups <= 0) return;
+
+    int j = 0;
+
+    if (signalsInInput == 1) {
+        memcpy(dst[0], samples, sampleGroups*sizeof(quint32));
+        return;
+    }
+
+#ifdef LABTOOL_USE_SSE2
+    if (signalsInInput >= 4) {
+
+        // The 4x4 block that contains each slice. The last block is moved
+        // back so that it never reads past the end of a group.
+        int block[MaxSlices];
+        for (int c = 0; c < numSlices; c++) {
+            block[c] = qMin((slices[c]/4)*4, signalsInInput-4);
+        }
+
+        for (; j + 4 <= sampleGroups; j += 4) {
+            const quint32* g = samples + j*signalsInInput;
+            int lastBlock = -1;
+            __m128i col[4];
+
+            for (int c = 0; c < numSlices; c++) {
+                int b = block[c];
+
+                // slices are sorted so all slices in a block are handled
+                // after each other and each block is only transposed once
+                if (b != lastBlock) {
+                    __m128i r0 = _mm_loadu_si128((const __m128i*)(g + b));
+                    __m128i r1 = _mm_loadu_si128((const __m128i*)(g + signalsInInput + b));
+                    __m128i r2 = _mm_loadu_si128((const __m128i*)(g + 2*signalsInInput + b));
+                    __m128i r3 = _mm_loadu_si128((const __m128i*)(g + 3*signalsInInput + b));
+
+                    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+                    __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+                    __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+                    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+                    col[0] = _mm_unpacklo_epi64(t0, t1);
+                    col[1] = _mm_unpackhi_epi64(t0, t1);
+                    col[2] = _mm_unpacklo_epi64(t2, t3);
+                    col[3] = _mm_unpackhi_epi64(t2, t3);
+
+                    lastBlock = b;
+                }
+
+                _mm_storeu_si128((__m128i*)(dst[c] + j), col[slices[c] - b]);
+            }
+        }
+    }
+#endif
+
+    for (; j < sampleGroups; j++) {
+        const quint32* g = samples + j*signalsInInput;
+        for (int c = 0; c < numSlices; c++) {
+            dst[c][j] = g[slices[c]];
+        }
+    }
+}
+
+/*!
+    Unpacks the VADC words for the analog channels in \a samples (with
+    \a numSamples words) into \a s0 for A0 and \a s1 for A1, see
+    LabToolCaptureDecoder::unpackAnalogInput() for the format. The
+    \a numChannels is the number of channels that were sampled at
+    \a sampleRate.
+
+    EMPTY markers are discarded and a value is inserted for a channel with
+    a missing sample. At 30 and 40 MHz with two channels the crosstalk
+    between the channels is compensated for. The resulting values are
+    clamped to the 12-bit range.
+*/
+void LabToolSampleUnpacker::unpackAnalogSamples(const quint16 *samples, int numSamples, int numChannels, int sampleRate, QVector<quint16> &s0, QVector<quint16> &s1)
+{
+#define A0_CH_ID  (0)  // Mapping of A0 to the VADC channel number in fw
+#define A1_CH_ID  (1)  // Mapping of A1 to the VADC channel number in fw
+
+    // This is adjusted unpacking of the data. If an EMPTY marker is found, it is not treated
+    // as data and is instead discarded. If two channels are sampled and two consecutive
+    // samples for the same channel is found then an additional sample is inserted in the other
+    // channel to make up for the missing one. The id bits of each sample is also read to make
+    // sure that the samples end up on the correct signal's vector (prevents signal swapping).
+    //
+    // Everything, including the crosstalk compensation below, is done in one pass over the
+    // data. Runs of samples that follow the expected channel order without EMPTY markers are
+    // handled a block at a time. All other samples are handled one at a time.
+
+    int lastId = -1;
+
+    // A channel gets at most one value (sample or inserted value) per input sample
+    s0.resize(numSamples);
+    s1.resize(numSamples);
+    quint16* d[2] = {s0.data(), s1.data()};
+    int n[2] = {0, 0};
+
+    // last value received for each channel, used when inserting a value for a
+    // missing sample
+    quint16 last[2] = {0, 0};
+
+    // Compensate for crosstalk between channels. The compensation is needed at sample
+    // rates >=30MHz and only when sampling both channels. 40MHz needs 8%, 30MHz needs 5%
+    bool compensate = (numChannels > 1 && (sampleRate == 30000000 || sampleRate == 40000000));
+    int percent = (sampleRate == 30000000 ? 5 : 8);
+    int numCompensated = 0;
+    int prevA1 = 2048;
+
+    // the correction only depends on the 12-bit value of the other channel
+    qint16 correction[4096];
+    if (compensate) {
+        for (int v = 0; v < 4096; v++) {
+            correction[v] = (qint16)((percent*(v - 2048))/100);
+        }
+    }
+
+    // Sometimes the absolute first sample is invalid (channel id 0). If that is the
+    // case then discard that sample
+//    if (((*samples & 0x7000)>>12) == 0) {
+//        numSamples--;
+//        samples++;
+//    }
+
+    int i = 0;
+    while (i < numSamples)
+    {
+        // Channel that the next sample is expected to belong to. The ids of
+        // the two channels alternate when both are sampled.
+        int nextId = lastId;
+        if (numChannels > 1) {
+            nextId = (lastId == A1_CH_ID ? A0_CH_ID : A1_CH_ID);
+        }
+
+        // ---- block of samples in the expected order ----
+        if (lastId == A0_CH_ID || lastId == A1_CH_ID) {
+            int numHandled = unpackAnalogBlock(samples + i, numSamples - i, nextId, lastId,
+                                               d[nextId] + n[nextId], d[lastId] + n[lastId]);
+            if (numHandled > 0) {
+                if (nextId != lastId) {
+                    n[nextId] += numHandled/2;
+                    last[nextId] = d[nextId][n[nextId]-1];
+                    n[lastId] += numHandled/2;
+                }
+                else {
+                    n[lastId] += numHandled;
+                }
+                last[lastId] = d[lastId][n[lastId]-1];
+                i += numHandled;
+
+                // 'last' holds the values before compensation
+
+                if (compensate) {
+                    numCompensated = compensateAnalogCrosstalk(d[A0_CH_ID], d[A1_CH_ID], numCompensated,
+                                                               qMin(n[A0_CH_ID], n[A1_CH_ID]), correction, prevA1);
+                }
+                continue;
+            }
+        }
+
+        // ---- one sample at a time ----
+        quint16 sample = samples[i];
+        int id = (sample & 0x7000)>>12;
+        int empty = (sample & 0x8000)>>15;
+        if (empty)
+        {
+            qDebug("Empty marker for i=%d", i);
+        }
+        else
+        {
+            int ch = (id == A1_CH_ID ? A1_CH_ID : A0_CH_ID);
+
+            if (id == lastId && numChannels>1)
+            {
+                // found a skip i.e. two consecutive samples for the same channel, add an extra sample for the other channel
+                int other = (ch == A1_CH_ID ? A0_CH_ID : A1_CH_ID);
+                d[other][n[other]++] = last[other];
+                qDebug("Skip at i=%d", i);
+            }
+
+            last[ch] = sample & 0xfff;
+            d[ch][n[ch]++] = last[ch];
+            lastId = id;
+
+            if (compensate) {
+                numCompensated = compensateAnalogCrosstalk(d[A0_CH_ID], d[A1_CH_ID], numCompensated,
+                                                           qMin(n[A0_CH_ID], n[A1_CH_ID]), correction, prevA1);
+            }
+        }
+        i++;
+    }
+
+    // Make sure that the same amount of samples have been received for both channels.
+    // This difference can only happen when two channels have been sampled and the
+    // difference in size can only be one element.
+    if (numChannels > 1)
+    {
+        if (n[A0_CH_ID] > n[A1_CH_ID])
+        {
+            n[A0_CH_ID]--;
+        }
+        else if (n[A1_CH_ID] > n[A0_CH_ID])
+        {
+            n[A1_CH_ID]--;
+        }
+    }
+
+    s0.resize(n[A0_CH_ID]);
+    s1.resize(n[A1_CH_ID]);
+}
+
+/*!
+    Unpacks a block of VADC words from \a samples (with \a numSamples words
+    available) that follow the expected channel order: the first word is for
+    channel \a firstId, the second for \a secondId and so on. The 12-bit
+    codes are written to \a firstDst and \a secondDst. If \a firstId and
+    \a secondId are the same all codes are written to \a firstDst.
+
+    Returns the number of words that were unpacked which is 0 if the next
+    block contains an EMPTY marker or a word for an unexpected channel. The
+    caller handles such words one at a time.
+
+    With SSE2 the channel ids of eight words are checked with one compare
+    and the words are separated per channel with shifts and packs.
+    Otherwise four words are checked at a time without branching per word.
+*/
+int LabToolSampleUnpacker::unpackAnalogBlock(const quint16 *samples, int numSamples, int firstId, int secondId, quint16 *firstDst, quint16 *secondDst)
+{
+    int i = 0;
+    int j = 0;
+    const bool twoChannels = (firstId != secondId);
+
+#ifdef LABTOOL_USE_SSE2
+    // the expected id and a cleared EMPTY marker in the 4 MSB of each word
+    const __m128i headerMask = _mm_set1_epi16((short)0xf000);
+    const __m128i codeMask = _mm_set1_epi16(0x0fff);
+    const __m128i expected = _mm_set_epi16(
+                (short)(secondId << 12), (short)(firstId << 12), (short)(secondId << 12), (short)(firstId << 12),
+                (short)(secondId << 12), (short)(firstId << 12), (short)(secondId << 12), (short)(firstId << 12));
+
+    for (; i + 16 <= numSamples; i += 16) {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)(samples + i));
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(samples + i + 8));
+
+        __m128i ok = _mm_and_si128(
+                    _mm_cmpeq_epi16(_mm_and_si128(v0, headerMask), expected),
+                    _mm_cmpeq_epi16(_mm_and_si128(v1, headerMask), expected));
+        if (_mm_movemask_epi8(ok) != 0xffff) break;
+
+        v0 = _mm_and_si128(v0, codeMask);
+        v1 = _mm_and_si128(v1, codeMask);
+
+        if (twoChannels) {
+            // even words belong to the first channel and odd words to the
+            // second. The codes are 12-bit so the signed pack can't saturate.
+            __m128i even = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(v0, 16), 16),
+                                           _mm_srai_epi32(_mm_slli_epi32(v1, 16), 16));
+            __m128i odd = _mm_packs_epi32(_mm_srli_epi32(v0, 16),
+                                          _mm_srli_epi32(v1, 16));
+            _mm_storeu_si128((__m128i*)(firstDst + j), even);
+            _mm_storeu_si128((__m128i*)(secondDst + j), odd);
+            j += 8;
+        }
+        else {
+            _mm_storeu_si128((__m128i*)(firstDst + j), v0);
+            _mm_storeu_si128((__m128i*)(firstDst + j + 8), v1);
+            j += 16;
+        }
+    }
+#endif
+
+    const quint16 h0 = (quint16)(firstId << 12);
+    const quint16 h1 = (quint16)(secondId << 12);
+
+    for (; i + 4 <= numSamples; i += 4) {
+        const quint16* s = samples + i;
+
+        // a single test for all four words
+        if ((((s[0] & 0xf000) ^ h0) | ((s[1] & 0xf000) ^ h1)
+             | ((s[2] & 0xf000) ^ h0) | ((s[3] & 0xf000) ^ h1)) != 0) break;
+
+        if (twoChannels) {
+            firstDst[j] = s[0] & 0x0fff;
+            secondDst[j] = s[1] & 0x0fff;
+            firstDst[j+1] = s[2] & 0x0fff;
+            secondDst[j+1] = s[3] & 0x0fff;
+            j += 2;
+        }
+        else {
+            firstDst[j] = s[0] & 0x0fff;
+            firstDst[j+1] = s[1] & 0x0fff;
+            firstDst[j+2] = s[2] & 0x0fff;
+            firstDst[j+3] = s[3] & 0x0fff;
+            j += 4;
+        }
+    }
+
+    return i;
+}
+
+/*!
+    Applies the crosstalk compensation to the sample pairs from index \a from
+    up to (but not including) index \a to in \a s0 and \a s1. Each value is
+    corrected by a percentage of the other channel's deviation from the
+    middle of the range: \c s0[i] with \c s1[i-1] and \c s1[i] with
+    \c s0[i]. The \a correction table holds the correction for each 12-bit
+    value.
+
+    The values are corrected in place. \a prevA1 holds the uncorrected
+    \c s1[from-1] and is updated for the next call. Corrected values are
+    clamped to the 12-bit range.
+
+    Returns \a to, the number of compensated pairs.
+*/
+int LabToolSampleUnpacker::compensateAnalogCrosstalk(quint16 *s0, quint16 *s1, int from, int to, const qint16 *correction, int &prevA1)
+{
+    if (from >= to) return from;
+
+    // the first A0 sample has no preceding A1 sample
+    int prevCorrection = (from == 0 ? 0 : correction[prevA1]);
+
+    for (int i = from; i < to; i++) {
+        int a0 = s0[i];
+        int a1 = s1[i];
+
+        int c0 = a0 - prevCorrection;
+        int c1 = a1 - correction[a0];
+        prevCorrection = correction[a1];
+        prevA1 = a1;
+
+        s0[i] = (quint16)qBound(0, c0, 0xfff);
+        s1[i] = (quint16)qBound(0, c1, 0xfff);
+    }
+
+    return to;
+}
@@ -0,0 +1,41 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef LABTOOLSAMPLEUNPACKER_H
+#define LABTOOLSAMPLEUNPACKER_H
+
+#include <QtGlobal>
+#include <QVector>
+
+class LabToolSampleUnpacker
+{
+public:
+
+    enum Constants {
+        MaxSlices = 16
+    };
+
+    static void deinterleaveSliceWords(const quint32* samples, int sampleGroups, int signalsInInput, const int* slices, quint32** dst, int numSlices);
+    static void unpackAnalogSamples(const quint16* samples, int numSamples, int numChannels, int sampleRate, QVector<quint16> &s0, QVector<quint16> &s1);
+
+private:
+    // only static functions
+    LabToolSampleUnpacker();
+
+    static int unpackAnalogBlock(const quint16* samples, int numSamples, int firstId, int secondId, quint16* firstDst, quint16* secondDst);
+    static int compensateAnalogCrosstalk(quint16* s0, quint16* s1, int from, int to, const qint16* correction, int &prevA1);
+};
+
+#endif // LABTOOLSAMPLEUNPACKER_H
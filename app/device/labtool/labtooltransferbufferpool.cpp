@@ -0,0 +1,252 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "labtooltransferbufferpool.h"
+
+#include <QMutexLocker>
+
+/*!
+    \class LabToolTransferBuffer
+    \brief A page aligned buffer that the sample data from the LabTool
+        Hardware is received into.
+
+    \ingroup Device
+
+    Buffers are only created and destroyed by the LabToolTransferBufferPool.
+*/
+
+/*!
+    Allocates a buffer of \a capacity bytes.
+*/
+LabToolTransferBuffer::LabToolTransferBuffer(int capacity)
+{
+    mData = (quint8*)qMallocAligned(capacity, LabToolTransferBufferPool::Alignment);
+    mCapacity = (mData != NULL ? capacity : 0);
+}
+
+/*!
+    Frees the buffer.
+*/
+LabToolTransferBuffer::~LabToolTransferBuffer()
+{
+    qFreeAligned(mData);
+    mData = NULL;
+}
+
+/*!
+    \fn quint8* LabToolTransferBuffer::data() const
+
+    Returns a pointer to the first byte of the buffer.
+*/
+
+/*!
+    \fn int LabToolTransferBuffer::capacity() const
+
+    Returns the size of the buffer in bytes.
+*/
+
+
+/*!
+    \class LabToolTransferBufferPool
+    \brief Recycles the buffers used to receive sample data from the
+        LabTool Hardware.
+
+    \ingroup Device
+
+    A capture results in one large transfer with the samples for all
+    signals. Instead of allocating (and zero filling) a new buffer for each
+    capture the buffer is returned to this pool when the samples have been
+    converted and is then reused for the next capture.
+
+    All buffers have the same size which is decided by the first capture
+    after \ref clear() has been called, i.e. after a new configuration has
+    been sent to the hardware. A request that doesn't fit in the idle
+    buffers is counted as a miss and results in a new allocation, a request
+    that could reuse an idle buffer is counted as a hit.
+
+    The pool is a singleton as the buffers are passed from the USB thread
+    to the capture device and may outlive the LabToolDeviceComm instance
+    that requested them. All functions are thread safe.
+*/
+
+/*!
+    \enum LabToolTransferBufferPool::Constants
+
+    This enum describes integer constants used by the pool.
+
+    \var LabToolTransferBufferPool::Constants LabToolTransferBufferPool::Alignment
+    The alignment of each buffer in bytes
+
+    \var LabToolTransferBufferPool::Constants LabToolTransferBufferPool::SizeGranularity
+    The buffer sizes are rounded up to a multiple of this number of bytes
+    so that small variations in the transfer size can reuse a buffer
+
+    \var LabToolTransferBufferPool::Constants LabToolTransferBufferPool::MaxIdleBuffers
+    The maximum number of buffers kept in the pool while not in use
+*/
+
+/*!
+    \fn LabToolTransferBufferPool& LabToolTransferBufferPool::instance()
+
+    This function returns an instance of the LabToolTransferBufferPool which
+    is a singleton class.
+*/
+
+/*!
+    Constructs an empty pool.
+*/
+LabToolTransferBufferPool::LabToolTransferBufferPool()
+{
+    mBufferSize = 0;
+    mHits = 0;
+    mMisses = 0;
+}
+
+/*!
+    Frees all idle buffers.
+*/
+LabToolTransferBufferPool::~LabToolTransferBufferPool()
+{
+    clear();
+}
+
+/*!
+    Returns a buffer with room for at least \a size bytes. The content of
+    the buffer is undefined.
+
+    Deallocation:
+      The buffer must be given back with \ref release().
+*/
+LabToolTransferBuffer* LabToolTransferBufferPool::acquire(int size)
+{
+    QMutexLocker locker(&mMutex);
+
+    for (int i = mIdle.size()-1; i >= 0; i--) {
+        LabToolTransferBuffer* buffer = mIdle.at(i);
+        if (buffer->capacity() >= size) {
+            mIdle.remove(i);
+            mHits++;
+            return buffer;
+        }
+    }
+
+    mMisses++;
+
+    // The buffers are sized once, by the first capture after a
+    // configuration change. Only grow if a larger transfer is requested.
+    if (size > mBufferSize || mBufferSize == 0) {
+        mBufferSize = roundedSize(qMax(size, 1));
+
+        // the idle buffers are too small to be of any use now
+        deleteIdleBuffers();
+    }
+
+    LabToolTransferBuffer* buffer = new LabToolTransferBuffer(mBufferSize);
+    if (buffer->data() == NULL) {
+        qWarning("Failed to allocate %d bytes for transfer buffer", mBufferSize);
+        delete buffer;
+        buffer = NULL;
+    }
+    return buffer;
+}
+
+/*!
+    Returns the \a buffer to the pool so that it can be reused by the next
+    call to \ref acquire(). The buffer is freed if it has the wrong size or
+    if the pool already has enough idle buffers.
+*/
+void LabToolTransferBufferPool::release(LabToolTransferBuffer *buffer)
+{
+    if (buffer == NULL) return;
+
+    QMutexLocker locker(&mMutex);
+
+    if (buffer->capacity() != mBufferSize || mIdle.size() >= MaxIdleBuffers) {
+        delete buffer;
+    }
+    else {
+        mIdle.append(buffer);
+    }
+}
+
+/*!
+    Returns the size in bytes of the buffers that are currently handed out.
+*/
+int LabToolTransferBufferPool::bufferSize() const
+{
+    QMutexLocker locker(&mMutex);
+    return mBufferSize;
+}
+
+/*!
+    Frees all idle buffers and forgets the buffer size. This should be called
+    when the capture configuration changes as the size of the transfers
+    will most likely change as well. Buffers that are in use when this
+    function is called are freed when they are released.
+*/
+void LabToolTransferBufferPool::clear()
+{
+    QMutexLocker locker(&mMutex);
+
+    deleteIdleBuffers();
+    mBufferSize = 0;
+}
+
+/*!
+    Returns the number of calls to \ref acquire() that reused a buffer.
+*/
+quint64 LabToolTransferBufferPool::hits() const
+{
+    QMutexLocker locker(&mMutex);
+    return mHits;
+}
+
+/*!
+    Returns the number of calls to \ref acquire() that had to allocate
+    a new buffer.
+*/
+quint64 LabToolTransferBufferPool::misses() const
+{
+    QMutexLocker locker(&mMutex);
+    return mMisses;
+}
+
+/*!
+    Returns the number of buffers in the pool that are not in use.
+*/
+int LabToolTransferBufferPool::numIdleBuffers() const
+{
+    QMutexLocker locker(&mMutex);
+    return mIdle.size();
+}
+
+/*!
+    Frees all buffers that are not in use. The caller must hold the lock.
+*/
+void LabToolTransferBufferPool::deleteIdleBuffers()
+{
+    for (int i = 0; i < mIdle.size(); i++) {
+        delete mIdle.at(i);
+    }
+    mIdle.clear();
+}
+
+/*!
+    Rounds \a size up to a multiple of SizeGranularity.
+*/
+int LabToolTransferBufferPool::roundedSize(int size)
+{
+    return ((size + SizeGranularity - 1) / SizeGranularity) * SizeGranularity;
+}
@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef LABTOOLTRANSFERBUFFERPOOL_H
+#define LABTOOLTRANSFERBUFFERPOOL_H
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QVector>
+
+class LabToolTransferBuffer
+{
+public:
+    quint8* data() const {return mData;}
+    int capacity() const {return mCapacity;}
+
+private:
+    friend class LabToolTransferBufferPool;
+
+    LabToolTransferBuffer(int capacity);
+    ~LabToolTransferBuffer();
+
+    quint8* mData;
+    int mCapacity;
+};
+
+class LabToolTransferBufferPool
+{
+public:
+
+    enum Constants {
+        Alignment = 4096,
+        SizeGranularity = 64*1024,
+        MaxIdleBuffers = 3
+    };
+
+    static LabToolTransferBufferPool& instance()
+    {
+        static LabToolTransferBufferPool singleton;
+        return singleton;
+    }
+
+    LabToolTransferBuffer* acquire(int size);
+    void release(LabToolTransferBuffer* buffer);
+
+    int bufferSize() const;
+    void clear();
+
+    quint64 hits() const;
+    quint64 misses() const;
+    int numIdleBuffers() const;
+
+private:
+    LabToolTransferBufferPool();
+    ~LabToolTransferBufferPool();
+    // hide copy constructor
+    LabToolTransferBufferPool(const LabToolTransferBufferPool&);
+    // hide assign operator
+    LabToolTransferBufferPool& operator=(const LabToolTransferBufferPool &);
+
+    void deleteIdleBuffers();
+    static int roundedSize(int size);
+
+    mutable QMutex mMutex;
+    QVector<LabToolTransferBuffer*> mIdle;
+    int mBufferSize;
+    quint64 mHits;
+    quint64 mMisses;
+};
+
+#endif // LABTOOLTRANSFERBUFFERPOOL_H
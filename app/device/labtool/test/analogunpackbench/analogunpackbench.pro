@@ -0,0 +1,24 @@
+# Benchmark of the unpacking of the analog sample data received from the
+# LabTool Hardware. LabToolSampleUnpacker::unpackAnalogSamples() is
+# compared with the earlier implementation that unpacked, trimmed and
+# compensated for crosstalk in three passes. The payloads in fixtures/ are
+# used, see main.cpp. The program fails if the results differ. Only QtCore
+# is needed.
+
+TEMPLATE = app
+TARGET = analogunpackbench
+CONFIG += console
+CONFIG -= app_bundle
+
+QT -= gui
+
+DEFINES += FIXTURE_DIR=\\\"$$PWD/fixtures\\\"
+
+INCLUDEPATH += $$PWD/../../../..
+
+SOURCES += \
+    main.cpp \
+    $$PWD/../../labtoolsampleunpacker.cpp
+
+HEADERS += \
+    $$PWD/../../labtoolsampleunpacker.h
@@ -0,0 +1,282 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+#include <QtEndian>
+
+#include <stdio.h>
+
+#include "device/labtool/labtoolsampleunpacker.h"
+
+/*
+    Unpacks the VADC payloads in the fixture directory (FIXTURE_DIR or the
+    first argument) with the earlier three pass implementation and with
+    LabToolSampleUnpacker, checks that the results are the same and
+    reports the number of words unpacked per second for both.
+
+    A fixture holds the analog part of a transfer from the LabTool Hardware
+    as little endian 16-bit words. The name tells how it was captured:
+    <channels>ch_<sample rate>[_<description>].vadc, e.g.
+    2ch_40000000_skips.vadc. More payloads can be added by saving the
+    analog part of a transfer with such a name.
+*/
+
+enum Constants {
+    BenchmarkWords = 1024*1024,
+    Repetitions = 5
+};
+
+#define A0_CH_ID  (0)
+#define A1_CH_ID  (1)
+
+/*
+    The earlier implementation: unpack into one vector per channel, make
+    the channels the same length and then compensate for the crosstalk
+    into new vectors. The compensated values weren't clamped and could
+    wrap around.
+*/
+static void unpackThreePass(const quint16* samples, int numSamples,
+                            int numChannels, int sampleRate,
+                            QVector<quint16> &out0, QVector<quint16> &out1)
+{
+    QVector<quint16> s0;
+    QVector<quint16> s1;
+    int lastId = -1;
+
+    for (int i = 0; i < numSamples; i++) {
+        int id = (samples[i] & 0x7000)>>12;
+        int empty = (samples[i] & 0x8000)>>15;
+        if (empty) continue;
+
+        if (id == lastId && numChannels > 1) {
+            // two consecutive samples for the same channel
+            if (id == A1_CH_ID) {
+                s0.append(s0.isEmpty() ? 0 : s0.last());
+            }
+            else {
+                s1.append(s1.isEmpty() ? 0 : s1.last());
+            }
+        }
+
+        if (id == A1_CH_ID) {
+            s1.append(samples[i] & 0xfff);
+        }
+        else {
+            s0.append(samples[i] & 0xfff);
+        }
+        lastId = id;
+    }
+
+    if (numChannels > 1) {
+        if (s0.size() > s1.size()) {
+            s0.pop_back();
+        }
+        else if (s1.size() > s0.size()) {
+            s1.pop_back();
+        }
+    }
+
+    if (numChannels > 1 && !s0.isEmpty()
+            && (sampleRate == 30000000 || sampleRate == 40000000)) {
+        int percent = (sampleRate == 30000000 ? 5 : 8);
+
+        QVector<quint16> s0prim;
+        QVector<quint16> s1prim;
+
+        s0prim.append(s0.at(0));
+        s1prim.append(s1.at(0) - (percent*(s0.at(0) - 2048))/100);
+        for (int i = 1; i < s1.size(); i++) {
+            s0prim.append(s0.at(i) - (percent*(s1.at(i-1) - 2048))/100);
+            s1prim.append(s1.at(i) - (percent*(s0.at(i) - 2048))/100);
+        }
+
+        s0 = s0prim;
+        s1 = s1prim;
+    }
+
+    out0 = s0;
+    out1 = s1;
+}
+
+/*
+    Returns the value of the earlier implementation clamped to the 12-bit
+    range. The correction is at most 8% of 2048 so a value that went below
+    zero has wrapped around to the top of the 16-bit range.
+*/
+static int clamped(quint16 value)
+{
+    if (value >= 0x8000) return 0;
+    return qMin((int)value, 0xfff);
+}
+
+/*
+    Compares the two implementations on the first \a numSamples words.
+    Returns false if they differ. The number of values changed by the
+    clamp is added to \a numClamped.
+*/
+static bool compare(const QVector<quint16> &payload, int numSamples,
+                    int numChannels, int sampleRate, int &numClamped)
+{
+    QVector<quint16> before[2];
+    QVector<quint16> after[2];
+
+    unpackThreePass(payload.constData(), numSamples, numChannels,
+                    sampleRate, before[0], before[1]);
+    LabToolSampleUnpacker::unpackAnalogSamples(payload.constData(),
+                                               numSamples, numChannels,
+                                               sampleRate, after[0],
+                                               after[1]);
+
+    for (int c = 0; c < 2; c++) {
+        if (before[c].size() != after[c].size()) {
+            printf("  A%d: %d values before, %d after (%d words)\n", c,
+                   before[c].size(), after[c].size(), numSamples);
+            return false;
+        }
+
+        for (int i = 0; i < before[c].size(); i++) {
+            int expected = clamped(before[c].at(i));
+            if (expected != before[c].at(i)) {
+                numClamped++;
+            }
+            if (after[c].at(i) != expected) {
+                printf("  A%d[%d]: %d before (%d clamped), %d after "
+                       "(%d words)\n", c, i, before[c].at(i), expected,
+                       after[c].at(i), numSamples);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+typedef void (*UnpackFunction)(const quint16*, int, int, int,
+                               QVector<quint16>&, QVector<quint16>&);
+
+/*
+    Returns the best time in nanoseconds of a number of runs.
+*/
+static qint64 measure(UnpackFunction unpack, const QVector<quint16> &payload,
+                      int numChannels, int sampleRate)
+{
+    qint64 best = -1;
+    for (int r = 0; r < Repetitions; r++) {
+        QVector<quint16> s0;
+        QVector<quint16> s1;
+
+        QElapsedTimer timer;
+        timer.start();
+        unpack(payload.constData(), payload.size(), numChannels, sampleRate,
+               s0, s1);
+        qint64 elapsed = timer.nsecsElapsed();
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    return qMax(best, (qint64)1);
+}
+
+/*
+    Checks and benchmarks the payload in \a fileName. Returns false if the
+    implementations differ or the file can't be used.
+*/
+static bool runFixture(const QString &dir, const QString &fileName)
+{
+    QString name = fileName.section('.', 0, 0);
+    bool ok = true;
+    int numChannels = name.section('_', 0, 0).remove("ch").toInt(&ok);
+    int sampleRate = (ok ? name.section('_', 1, 1).toInt(&ok) : 0);
+    if (!ok || numChannels < 1 || numChannels > 2) {
+        printf("%s: unknown name format\n", qPrintable(fileName));
+        return false;
+    }
+
+    QFile file(dir + "/" + fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        printf("%s: %s\n", qPrintable(fileName),
+               qPrintable(file.errorString()));
+        return false;
+    }
+    QByteArray data = file.readAll();
+
+    QVector<quint16> payload(data.size()/2);
+    for (int i = 0; i < payload.size(); i++) {
+        payload[i] = qFromLittleEndian<quint16>(
+                    (const uchar*)data.constData() + 2*i);
+    }
+
+    // the complete payload and lengths that end in the middle of the
+    // blocks handled by the unpacker
+    int numClamped = 0;
+    bool same = compare(payload, payload.size(), numChannels, sampleRate,
+                        numClamped);
+    for (int n = 0; n < 40 && same; n++) {
+        int dummy = 0;
+        same = compare(payload, qMin(n, payload.size()), numChannels,
+                       sampleRate, dummy)
+                && compare(payload, qMax(payload.size() - n, 0),
+                           numChannels, sampleRate, dummy);
+    }
+
+    // repeat the payload to get a transfer of a realistic size
+    QVector<quint16> big;
+    big.reserve(BenchmarkWords);
+    while (big.size() + payload.size() <= BenchmarkWords
+           && !payload.isEmpty()) {
+        big += payload;
+    }
+
+    qint64 beforeNs = measure(unpackThreePass, big, numChannels, sampleRate);
+    qint64 afterNs = measure(LabToolSampleUnpacker::unpackAnalogSamples,
+                             big, numChannels, sampleRate);
+
+    printf("%-28s %6d words, %4d clamped: before %7.1f Mwords/s, "
+           "after %7.1f Mwords/s, %5.2fx %s\n",
+           qPrintable(fileName), payload.size(), numClamped,
+           big.size()*1000.0/beforeNs, big.size()*1000.0/afterNs,
+           (double)beforeNs/afterNs, (same ? "ok" : "MISMATCH"));
+
+    return same;
+}
+
+int main(int argc, char *argv[])
+{
+    QString dir = (argc > 1 ? QString(argv[1]) : QString(FIXTURE_DIR));
+
+    QStringList files = QDir(dir).entryList(QStringList("*.vadc"),
+                                            QDir::Files, QDir::Name);
+    if (files.isEmpty()) {
+        printf("No payloads found in %s\n", qPrintable(dir));
+        return 1;
+    }
+
+    bool ok = true;
+    foreach(QString fileName, files) {
+        ok &= runFixture(dir, fileName);
+    }
+
+    if (!ok) {
+        printf("FAILED: the implementations differ\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+# Benchmark of the conversion of the digital sample data received from the
+# LabTool Hardware. LabToolSampleUnpacker::deinterleaveSliceWords() is
+# compared with the earlier conversion that walked the data once per
+# channel. The program fails if the results differ. Only QtCore is needed.
+
+TEMPLATE = app
+TARGET = digitalunpackbench
+CONFIG += console
+CONFIG -= app_bundle
+
+QT -= gui
+
+INCLUDEPATH += $$PWD/../../../..
+
+SOURCES += \
+    main.cpp \
+    $$PWD/../../labtoolsampleunpacker.cpp \
+    $$PWD/../../../digitalsamplestore.cpp
+
+HEADERS += \
+    $$PWD/../../labtoolsampleunpacker.h \
+    $$PWD/../../../digitalsamplestore.h
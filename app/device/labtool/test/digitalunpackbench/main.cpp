@@ -0,0 +1,175 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <stdio.h>
+
+#include "device/digitalsamplestore.h"
+#include "device/labtool/labtoolsampleunpacker.h"
+
+/*
+    Converts random sample data with the earlier implementation and with
+    LabToolSampleUnpacker and reports the number of samples per second
+    (all channels) for both. The data has the same layout as the data from
+    the LabTool Hardware: groups of one 32-bit word per channel in the
+    input where each word holds 32 samples.
+*/
+
+enum Constants {
+    SampleGroups = 256*1024,
+    Repetitions = 5
+};
+
+static quint32 randomState = 0x12345678;
+
+static quint32 nextRandom()
+{
+    // xorshift32, the same data on every run
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+/*
+    The conversion before all channels were handled in one pass. Each
+    channel walks the complete input.
+*/
+static void convertPerChannel(const quint32* samples, int sampleGroups,
+                              int signalsInInput, const int* slices,
+                              int numSlices, DigitalSampleStore* stores)
+{
+    for (int c = 0; c < numSlices; c++) {
+        DigitalSampleStore* s = &stores[c];
+        s->clear();
+        s->reserve(sampleGroups*32);
+
+        for (int j = 0; j < sampleGroups; ++j) {
+            s->appendWord(samples[j*signalsInInput + slices[c]]);
+        }
+    }
+}
+
+/*
+    The current conversion as done by LabToolCaptureDecoder.
+*/
+static void convertOnePass(const quint32* samples, int sampleGroups,
+                           int signalsInInput, const int* slices,
+                           int numSlices, DigitalSampleStore* stores)
+{
+    quint32* dst[LabToolSampleUnpacker::MaxSlices];
+    for (int c = 0; c < numSlices; c++) {
+        stores[c].resize(sampleGroups*32);
+        dst[c] = stores[c].words();
+    }
+
+    LabToolSampleUnpacker::deinterleaveSliceWords(samples, sampleGroups,
+                                                  signalsInInput, slices,
+                                                  dst, numSlices);
+}
+
+typedef void (*ConvertFunction)(const quint32*, int, int, const int*, int,
+                                DigitalSampleStore*);
+
+/*
+    Returns the best time in nanoseconds of a number of conversions.
+*/
+static qint64 measure(ConvertFunction convert, const QVector<quint32> &input,
+                      int signalsInInput, const int* slices, int numSlices,
+                      DigitalSampleStore* stores)
+{
+    qint64 best = -1;
+    for (int r = 0; r < Repetitions; r++) {
+        QElapsedTimer timer;
+        timer.start();
+        convert(input.constData(), SampleGroups, signalsInInput, slices,
+                numSlices, stores);
+        qint64 elapsed = timer.nsecsElapsed();
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    return qMax(best, (qint64)1);
+}
+
+/*
+    Runs one configuration. Returns false if the results differ.
+*/
+static bool runCase(int signalsInInput, const int* slices, int numSlices)
+{
+    QVector<quint32> input(SampleGroups*signalsInInput);
+    for (int i = 0; i < input.size(); i++) {
+        input[i] = nextRandom();
+    }
+
+    DigitalSampleStore before[LabToolSampleUnpacker::MaxSlices];
+    DigitalSampleStore after[LabToolSampleUnpacker::MaxSlices];
+
+    qint64 beforeNs = measure(convertPerChannel, input, signalsInInput,
+                              slices, numSlices, before);
+    qint64 afterNs = measure(convertOnePass, input, signalsInInput,
+                             slices, numSlices, after);
+
+    bool same = true;
+    for (int c = 0; c < numSlices; c++) {
+        if (!(before[c] == after[c])) {
+            same = false;
+        }
+    }
+
+    double samples = (double)SampleGroups*32*numSlices;
+    printf("%2d words/group %2d channels: before %8.1f Msamples/s, "
+           "after %8.1f Msamples/s, %5.2fx %s\n",
+           signalsInInput, numSlices,
+           samples*1000.0/beforeNs, samples*1000.0/afterNs,
+           (double)beforeNs/afterNs, (same ? "ok" : "MISMATCH"));
+
+    return same;
+}
+
+int main()
+{
+    bool ok = true;
+
+    // all channels in the input enabled
+    for (int n = 1; n <= 11; n++) {
+        int slices[LabToolSampleUnpacker::MaxSlices];
+        for (int c = 0; c < n; c++) {
+            slices[c] = c;
+        }
+        ok &= runCase(n, slices, n);
+    }
+
+    // only some of the channels in the input enabled, including the last
+    // slice which is handled by a 4x4 block that overlaps the one before
+    const int sparse[] = {0, 3, 5, 10};
+    ok &= runCase(11, sparse, 4);
+
+    const int last[] = {9, 10};
+    ok &= runCase(11, last, 2);
+
+    const int single[] = {6};
+    ok &= runCase(7, single, 1);
+
+    if (!ok) {
+        printf("FAILED: the conversions differ\n");
+        return 1;
+    }
+
+    return 0;
+}
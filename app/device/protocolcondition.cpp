@@ -0,0 +1,463 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "protocolcondition.h"
+
+/*!
+    \class I2CCondition
+    \brief Matches a segment with a given I2C event.
+
+    \ingroup Device
+
+    The SCL and SDA signals of the segment are decoded with an I2CDecoder
+    and the segment matches if a frame of the given type is found. The
+    match can be limited to frames with a given value and to frames within
+    a transfer to a given address, e.g. a NACK from the device with
+    address 0x50.
+*/
+
+/*!
+    Constructs a condition that matches a frame of \a type when the
+    digital signals with id \a sclSignalId and \a sdaSignalId are decoded.
+*/
+I2CCondition::I2CCondition(int sclSignalId, int sdaSignalId,
+                           I2CItem::I2CType type)
+{
+    mSclSignalId = sclSignalId;
+    mSdaSignalId = sdaSignalId;
+    mType = type;
+    mAddress = -1;
+    mValue = -1;
+}
+
+/*!
+    \fn int I2CCondition::sclSignalId() const
+
+    Returns the id of the SCL signal.
+*/
+
+/*!
+    \fn int I2CCondition::sdaSignalId() const
+
+    Returns the id of the SDA signal.
+*/
+
+/*!
+    \fn I2CItem::I2CType I2CCondition::type() const
+
+    Returns the type of the frame to match.
+*/
+
+/*!
+    \fn void I2CCondition::setAddress(int address)
+
+    Only match frames in a transfer to \a address. -1 matches any address.
+*/
+
+/*!
+    \fn int I2CCondition::address() const
+
+    Returns the address that the transfer must be sent to or -1 for any
+    address.
+*/
+
+/*!
+    \fn void I2CCondition::setValue(int value)
+
+    Only match frames with \a value. -1 matches any value.
+*/
+
+/*!
+    \fn int I2CCondition::value() const
+
+    Returns the value that the frame must have or -1 for any value.
+*/
+
+/*!
+    Returns true if the decoded \a segment contains a frame of the
+    configured type, value and address.
+*/
+bool I2CCondition::matches(const CaptureSegment &segment) const
+{
+    if (!segment.hasDigitalSignal(mSclSignalId)
+            || !segment.hasDigitalSignal(mSdaSignalId)) {
+        return false;
+    }
+
+    I2CDecoder decoder;
+    decoder.setSignals(segment.digitalTransitions(mSclSignalId),
+                       segment.digitalTransitions(mSdaSignalId));
+    decoder.decode();
+
+    DecodedFrameStore frames = decoder.frames();
+    const quint8* types = frames.constTypeData();
+    const int* values = frames.constValueData();
+
+    // the address of the transfer the current frame belongs to
+    int address = -1;
+
+    for (int i = 0; i < frames.size(); i++) {
+
+        switch (types[i]) {
+        case I2CItem::I2C_START:
+        case I2CItem::I2C_STOP:
+            address = -1;
+            break;
+        case I2CItem::I2C_7_ADDRESS_WRITE:
+        case I2CItem::I2C_7_ADDRESS_READ:
+        case I2CItem::I2C_10_ADDRESS_WRITE:
+        case I2CItem::I2C_10_ADDRESS_READ:
+            address = values[i];
+            break;
+        default:
+            break;
+        }
+
+        if (types[i] != mType) continue;
+        if (mAddress != -1 && address != mAddress) continue;
+        if (mValue != -1 && values[i] != mValue) continue;
+
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+    Returns a copy of the condition.
+*/
+CaptureSegmentCondition* I2CCondition::clone() const
+{
+    I2CCondition* c = new I2CCondition(mSclSignalId, mSdaSignalId, mType);
+    c->setAddress(mAddress);
+    c->setValue(mValue);
+
+    return c;
+}
+
+
+/*!
+    \class UartCondition
+    \brief Matches a segment with a given UART event.
+
+    \ingroup Device
+
+    The signal is decoded with a UartDecoder and the segment matches if a
+    frame of the given type is found, e.g. a framing error. Data frames
+    can also be limited to a given value.
+*/
+
+/*!
+    Constructs a condition that matches a frame of \a type when the digital
+    signal with id \a signalId is decoded with \a baudRate. The frame
+    format is 8 data bits, 1 stop bit and no parity until changed.
+*/
+UartCondition::UartCondition(int signalId, int baudRate,
+                             UartItem::ItemType type)
+{
+    mSignalId = signalId;
+    mBaudRate = baudRate;
+    mType = type;
+    mDataBits = 8;
+    mStopBits = 1;
+    mParity = Types::ParityNone;
+    mValue = -1;
+}
+
+/*!
+    \fn int UartCondition::signalId() const
+
+    Returns the id of the UART signal.
+*/
+
+/*!
+    \fn int UartCondition::baudRate() const
+
+    Returns the baud rate.
+*/
+
+/*!
+    \fn UartItem::ItemType UartCondition::type() const
+
+    Returns the type of the frame to match.
+*/
+
+/*!
+    \fn void UartCondition::setDataBits(int bits)
+
+    Set the number of data bits to \a bits.
+*/
+
+/*!
+    \fn int UartCondition::dataBits() const
+
+    Returns the number of data bits.
+*/
+
+/*!
+    \fn void UartCondition::setStopBits(int bits)
+
+    Set the number of stop bits to \a bits.
+*/
+
+/*!
+    \fn int UartCondition::stopBits() const
+
+    Returns the number of stop bits.
+*/
+
+/*!
+    \fn void UartCondition::setParity(Types::UartParity parity)
+
+    Set the \a parity.
+*/
+
+/*!
+    \fn Types::UartParity UartCondition::parity() const
+
+    Returns the parity.
+*/
+
+/*!
+    \fn void UartCondition::setValue(int value)
+
+    Only match frames with \a value. -1 matches any value.
+*/
+
+/*!
+    \fn int UartCondition::value() const
+
+    Returns the value that the frame must have or -1 for any value.
+*/
+
+/*!
+    Returns true if the decoded \a segment contains a frame of the
+    configured type and value.
+*/
+bool UartCondition::matches(const CaptureSegment &segment) const
+{
+    if (!segment.hasDigitalSignal(mSignalId)) {
+        return false;
+    }
+
+    UartDecoder decoder;
+    decoder.setSignal(segment.digitalTransitions(mSignalId));
+    decoder.setSampleRate(segment.sampleRate());
+    decoder.setBaudRate(mBaudRate);
+    decoder.setDataBits(mDataBits);
+    decoder.setStopBits(mStopBits);
+    decoder.setParity(mParity);
+    decoder.decode();
+
+    DecodedFrameStore frames = decoder.frames();
+    const quint8* types = frames.constTypeData();
+    const int* values = frames.constValueData();
+
+    for (int i = 0; i < frames.size(); i++) {
+        if (types[i] == mType && (mValue == -1 || values[i] == mValue)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    Returns a copy of the condition.
+*/
+CaptureSegmentCondition* UartCondition::clone() const
+{
+    UartCondition* c = new UartCondition(mSignalId, mBaudRate, mType);
+    c->setDataBits(mDataBits);
+    c->setStopBits(mStopBits);
+    c->setParity(mParity);
+    c->setValue(mValue);
+
+    return c;
+}
+
+
+/*!
+    \class SpiCondition
+    \brief Matches a segment with a given sequence of SPI data.
+
+    \ingroup Device
+
+    The signals are decoded with a SpiDecoder and the segment matches if
+    the values of consecutive data frames equal the pattern. The pattern
+    is compared with the MOSI values unless setMatchMiso() is used.
+*/
+
+/*!
+    Constructs a condition that matches the values in \a pattern when the
+    digital signals with id \a sckSignalId, \a mosiSignalId,
+    \a misoSignalId and \a enableSignalId are decoded. The decoder uses
+    8 data bits, mode 0 and an active low enable signal until changed.
+*/
+SpiCondition::SpiCondition(int sckSignalId, int mosiSignalId,
+                           int misoSignalId, int enableSignalId,
+                           const QVector<int> &pattern)
+{
+    mSckSignalId = sckSignalId;
+    mMosiSignalId = mosiSignalId;
+    mMisoSignalId = misoSignalId;
+    mEnableSignalId = enableSignalId;
+    mPattern = pattern;
+    mDataBits = 8;
+    mMode = Types::SpiMode_0;
+    mEnableMode = Types::SpiEnableLow;
+    mMatchMiso = false;
+}
+
+/*!
+    \fn int SpiCondition::sckSignalId() const
+
+    Returns the id of the SCK signal.
+*/
+
+/*!
+    \fn int SpiCondition::mosiSignalId() const
+
+    Returns the id of the MOSI signal.
+*/
+
+/*!
+    \fn int SpiCondition::misoSignalId() const
+
+    Returns the id of the MISO signal.
+*/
+
+/*!
+    \fn int SpiCondition::enableSignalId() const
+
+    Returns the id of the Enable signal.
+*/
+
+/*!
+    \fn void SpiCondition::setDataBits(int bits)
+
+    Set the number of data bits to \a bits.
+*/
+
+/*!
+    \fn int SpiCondition::dataBits() const
+
+    Returns the number of data bits.
+*/
+
+/*!
+    \fn void SpiCondition::setMode(Types::SpiMode mode)
+
+    Set the SPI \a mode.
+*/
+
+/*!
+    \fn Types::SpiMode SpiCondition::mode() const
+
+    Returns the SPI mode.
+*/
+
+/*!
+    \fn void SpiCondition::setEnableMode(Types::SpiEnable mode)
+
+    Set the enable \a mode.
+*/
+
+/*!
+    \fn Types::SpiEnable SpiCondition::enableMode() const
+
+    Returns the enable mode.
+*/
+
+/*!
+    \fn void SpiCondition::setMatchMiso(bool miso)
+
+    Compare the pattern with the MISO values if \a miso is true, otherwise
+    with the MOSI values.
+*/
+
+/*!
+    \fn bool SpiCondition::matchMiso() const
+
+    Returns true if the pattern is compared with the MISO values.
+*/
+
+/*!
+    \fn QVector<int> SpiCondition::pattern() const
+
+    Returns the values to match.
+*/
+
+/*!
+    Returns true if the decoded \a segment contains the pattern in
+    consecutive data frames.
+*/
+bool SpiCondition::matches(const CaptureSegment &segment) const
+{
+    if (mPattern.isEmpty()
+            || !segment.hasDigitalSignal(mSckSignalId)
+            || !segment.hasDigitalSignal(mMosiSignalId)
+            || !segment.hasDigitalSignal(mMisoSignalId)
+            || !segment.hasDigitalSignal(mEnableSignalId)) {
+        return false;
+    }
+
+    SpiDecoder decoder;
+    decoder.setSignals(segment.digitalTransitions(mSckSignalId),
+                       segment.digitalTransitions(mMosiSignalId),
+                       segment.digitalTransitions(mMisoSignalId),
+                       segment.digitalTransitions(mEnableSignalId));
+    decoder.setDataBits(mDataBits);
+    decoder.setMode(mMode);
+    decoder.setEnableMode(mEnableMode);
+    decoder.decode();
+
+    DecodedFrameStore frames = decoder.frames();
+    const quint8* types = frames.constTypeData();
+    const int* values = (mMatchMiso ? frames.constSecondValueData()
+                                    : frames.constValueData());
+    const int* pattern = mPattern.constData();
+    const int patternSize = mPattern.size();
+
+    for (int i = 0; i + patternSize <= frames.size(); i++) {
+        int j = 0;
+        while (j < patternSize && types[i+j] == SpiItem::TYPE_DATA
+               && (values != NULL ? values[i+j] : 0) == pattern[j]) {
+            j++;
+        }
+
+        if (j == patternSize) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    Returns a copy of the condition.
+*/
+CaptureSegmentCondition* SpiCondition::clone() const
+{
+    SpiCondition* c = new SpiCondition(mSckSignalId, mMosiSignalId,
+                                       mMisoSignalId, mEnableSignalId,
+                                       mPattern);
+    c->setDataBits(mDataBits);
+    c->setMode(mMode);
+    c->setEnableMode(mEnableMode);
+    c->setMatchMiso(mMatchMiso);
+
+    return c;
+}
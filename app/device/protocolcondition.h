@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef PROTOCOLCONDITION_H
+#define PROTOCOLCONDITION_H
+
+#include <QtGlobal>
+#include <QVector>
+
+#include "capturesegmentcondition.h"
+#include "common/types.h"
+#include "decoder/i2cdecoder.h"
+#include "decoder/spidecoder.h"
+#include "decoder/uartdecoder.h"
+
+class I2CCondition : public CaptureSegmentCondition
+{
+public:
+    I2CCondition(int sclSignalId, int sdaSignalId, I2CItem::I2CType type);
+
+    int sclSignalId() const {return mSclSignalId;}
+    int sdaSignalId() const {return mSdaSignalId;}
+    I2CItem::I2CType type() const {return mType;}
+    void setAddress(int address) {mAddress = address;}
+    int address() const {return mAddress;}
+    void setValue(int value) {mValue = value;}
+    int value() const {return mValue;}
+
+    bool matches(const CaptureSegment &segment) const;
+    CaptureSegmentCondition* clone() const;
+
+private:
+    int mSclSignalId;
+    int mSdaSignalId;
+    I2CItem::I2CType mType;
+    int mAddress;
+    int mValue;
+};
+
+class UartCondition : public CaptureSegmentCondition
+{
+public:
+    UartCondition(int signalId, int baudRate, UartItem::ItemType type);
+
+    int signalId() const {return mSignalId;}
+    int baudRate() const {return mBaudRate;}
+    UartItem::ItemType type() const {return mType;}
+
+    void setDataBits(int bits) {mDataBits = bits;}
+    int dataBits() const {return mDataBits;}
+    void setStopBits(int bits) {mStopBits = bits;}
+    int stopBits() const {return mStopBits;}
+    void setParity(Types::UartParity parity) {mParity = parity;}
+    Types::UartParity parity() const {return mParity;}
+    void setValue(int value) {mValue = value;}
+    int value() const {return mValue;}
+
+    bool matches(const CaptureSegment &segment) const;
+    CaptureSegmentCondition* clone() const;
+
+private:
+    int mSignalId;
+    int mBaudRate;
+    UartItem::ItemType mType;
+    int mDataBits;
+    int mStopBits;
+    Types::UartParity mParity;
+    int mValue;
+};
+
+class SpiCondition : public CaptureSegmentCondition
+{
+public:
+    SpiCondition(int sckSignalId, int mosiSignalId, int misoSignalId,
+                 int enableSignalId, const QVector<int> &pattern);
+
+    int sckSignalId() const {return mSckSignalId;}
+    int mosiSignalId() const {return mMosiSignalId;}
+    int misoSignalId() const {return mMisoSignalId;}
+    int enableSignalId() const {return mEnableSignalId;}
+
+    void setDataBits(int bits) {mDataBits = bits;}
+    int dataBits() const {return mDataBits;}
+    void setMode(Types::SpiMode mode) {mMode = mode;}
+    Types::SpiMode mode() const {return mMode;}
+    void setEnableMode(Types::SpiEnable mode) {mEnableMode = mode;}
+    Types::SpiEnable enableMode() const {return mEnableMode;}
+    void setMatchMiso(bool miso) {mMatchMiso = miso;}
+    bool matchMiso() const {return mMatchMiso;}
+    QVector<int> pattern() const {return mPattern;}
+
+    bool matches(const CaptureSegment &segment) const;
+    CaptureSegmentCondition* clone() const;
+
+private:
+    int mSckSignalId;
+    int mMosiSignalId;
+    int mMisoSignalId;
+    int mEnableSignalId;
+    QVector<int> mPattern;
+    int mDataBits;
+    Types::SpiMode mMode;
+    Types::SpiEnable mEnableMode;
+    bool mMatchMiso;
+};
+
+#endif // PROTOCOLCONDITION_H
@@ -20,9 +20,7 @@
 #include <QtGlobal>
 #include <qmath.h>
 
-#include "generator/i2cgenerator.h"
-#include "generator/uartgenerator.h"
-#include "generator/spigenerator.h"
+#include "simulatorsignals.h"
 
 /*!
     \class SimulatorCaptureDevice
@@ -51,6 +49,7 @@ SimulatorCaptureDevice::SimulatorCaptureDevice(QObject *parent) :
 
     for (int i = 0; i < MaxAnalogSignals; i++) {
         mAnalogSignals[i] = NULL;
+        mAnalogMinMax[i] = NULL;
     }
 
 }
@@ -184,9 +183,9 @@ int SimulatorCaptureDevice::lastSampleIndex()
     return mEndSampleIdx;
 }
 
-QVector<int>* SimulatorCaptureDevice::digitalData(int signalId)
+DigitalSampleStore* SimulatorCaptureDevice::digitalData(int signalId)
 {
-    QVector<int>* data = NULL;
+    DigitalSampleStore* data = NULL;
 
     if (signalId < MaxDigitalSignals) {
         data = mDigitalSignals[signalId];
@@ -195,7 +194,7 @@ QVector<int>* SimulatorCaptureDevice::digitalData(int signalId)
     return data;
 }
 
-void SimulatorCaptureDevice::setDigitalData(int signalId, QVector<int> data)
+void SimulatorCaptureDevice::setDigitalData(int signalId, const DigitalSampleStore &data)
 {
     if (signalId < MaxDigitalSignals) {
 
@@ -204,21 +203,27 @@ void SimulatorCaptureDevice::setDigitalData(int signalId, QVector<int> data)
             mDigitalSignals[signalId] = NULL;
         }
 
+        // the cached transitions belong to the old data
+        if (mDigitalSignalTransitions[signalId] != NULL) {
+            delete mDigitalSignalTransitions[signalId];
+            mDigitalSignalTransitions[signalId] = NULL;
+        }
+
         if (data.size() > 0) {
             mEndSampleIdx = data.size();
 
             // Deallocation:
             //    Deleted by deleteSignalData() which is called by destructor
             //    or clearSignalData()
-            mDigitalSignals[signalId] = new QVector<int>(data);
+            mDigitalSignals[signalId] = new DigitalSampleStore(data);
         }
 
     }
 }
 
-QVector<double>* SimulatorCaptureDevice::analogData(int signalId)
+AnalogSampleStore* SimulatorCaptureDevice::analogData(int signalId)
 {
-    QVector<double>* data = NULL;
+    AnalogSampleStore* data = NULL;
 
     if (signalId < MaxAnalogSignals) {
         data = mAnalogSignals[signalId];
@@ -227,7 +232,7 @@ QVector<double>* SimulatorCaptureDevice::analogData(int signalId)
     return data;
 }
 
-void SimulatorCaptureDevice::setAnalogData(int signalId, QVector<double> data)
+void SimulatorCaptureDevice::setAnalogData(int signalId, const AnalogSampleStore &data)
 {
     if (signalId < MaxAnalogSignals) {
 
@@ -236,18 +241,42 @@ void SimulatorCaptureDevice::setAnalogData(int signalId, QVector<double> data)
             mAnalogSignals[signalId] = NULL;
         }
 
+        // the pyramid belongs to the old data
+        if (mAnalogMinMax[signalId] != NULL) {
+            delete mAnalogMinMax[signalId];
+            mAnalogMinMax[signalId] = NULL;
+        }
+
         if (data.size() > 0) {
             mEndSampleIdx = data.size();
 
             // Deallocation:
             //    Deleted by deleteSignalData() which is called by destructor
             //    or clearSignalData()
-            mAnalogSignals[signalId] = new QVector<double>(data);
+            mAnalogSignals[signalId] = new AnalogSampleStore(data);
         }
 
     }
 }
 
+AnalogMinMaxPyramid* SimulatorCaptureDevice::analogMinMax(int signalId)
+{
+    if (signalId >= MaxAnalogSignals) return NULL;
+    if (mAnalogSignals[signalId] == NULL) return NULL;
+
+    // Not in cache. Create the pyramid
+    if (mAnalogMinMax[signalId] == NULL) {
+
+        // Deallocation:
+        //    Deleted by deleteSignalData() which is called by destructor
+        //    or clearSignalData()
+        mAnalogMinMax[signalId] = new AnalogMinMaxPyramid(
+                    *mAnalogSignals[signalId]);
+    }
+
+    return mAnalogMinMax[signalId];
+}
+
 void SimulatorCaptureDevice::clearSignalData()
 {
     deleteSignalData();
@@ -263,11 +292,11 @@ void SimulatorCaptureDevice::setDigitalTriggerIndex(int idx)
     mTriggerIdx = idx;
 }
 
-void SimulatorCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
+DigitalTransitions* SimulatorCaptureDevice::digitalTransitions(int signalId)
 {
 
-    if (signalId >= MaxDigitalSignals) return;
-    if (mDigitalSignals[signalId] == NULL) return;
+    if (signalId >= MaxDigitalSignals) return NULL;
+    if (mDigitalSignals[signalId] == NULL) return NULL;
 
     // Not in cache. Create the list
     if (mDigitalSignalTransitions[signalId] == NULL) {
@@ -275,13 +304,11 @@ void SimulatorCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
         // Deallocation:
         //    Deleted by deleteSignalData() which is called by destructor
         //    or clearSignalData()
-        QList<int>* l = new QList<int>();
-
-        CaptureDevice::digitalTransitions(signalId, *l);
-        mDigitalSignalTransitions[signalId] = l;
+        mDigitalSignalTransitions[signalId] = new DigitalTransitions(
+                    DigitalTransitions::fromSamples(*mDigitalSignals[signalId]));
     }
 
-    list = *mDigitalSignalTransitions[signalId];
+    return mDigitalSignalTransitions[signalId];
 }
 
 void SimulatorCaptureDevice::reconfigure(int sampleRate)
@@ -321,7 +348,8 @@ void SimulatorCaptureDevice::generateRandomDigitalSignals()
         //    Assigned to mDigitalSignals below which is deleted by
         //    deleteSignalData() which is called by destructor or
         //    clearSignalData()
-        QVector<int> *s = new QVector<int>();
+        DigitalSampleStore *s = new DigitalSampleStore();
+        s->reserve(maxNumSamples);
         bool fast = ((qrand() % 2) == 1);
 
         if (fast) {
@@ -340,9 +368,9 @@ void SimulatorCaptureDevice::generateRandomDigitalSignals()
                     duration = maxNumSamples;
                 }
 
-                while(j < duration) {
-                    s->append(level);
-                    j++;
+                if (j < duration) {
+                    s->append(level, duration-j);
+                    j = duration;
                 }
 
             }
@@ -373,47 +401,19 @@ void SimulatorCaptureDevice::generateI2CDigitalSignals()
 
     if (mDigitalSignalList.size() < 2 || mConfigDialog == NULL) return;
 
-    I2CGenerator i2cGen;
-    i2cGen.setAddressType(mConfigDialog->i2cAddressType());
-    i2cGen.setI2CRate(mConfigDialog->i2cRate());
-    i2cGen.generateFromString("D04,S,W060,A,X16,A,X00,A,X00,A,X00,A,X40,A,P,S,W060,A,X00,A,P,S,R060,A,X3F,N,P,S,W060,A,X01,A,P,S,R060,A,X7F,N,P");
-
-    double i2cSampleTime = (double)1/i2cGen.sampleRate();
-    QVector<int> sclData = i2cGen.sclData();
-    QVector<int> sdaData = i2cGen.sdaData();
-
-    if (sclData.size() < 2) return;
-
     // Deallocation:
     //    Deleted by deleteSignalData() which is called by destructor or
     //    clearSignalData()
-    QVector<int> *scl = new QVector<int>();
-    QVector<int> *sda = new QVector<int>();
-
-
-    int maxNumSamples = numberOfSamples();
-    double sampleTime = (double)1/mUsedSampleRate;
-
-    int i2cPos = 0;
-    double nextI2CTime = i2cSampleTime;
-
-    for (int i = 0; i < maxNumSamples; i++) {
-
-        while (i*sampleTime >= nextI2CTime) {
-            i2cPos++;
-            nextI2CTime = (i2cPos+1)*i2cSampleTime;
-        }
-
-        if (i2cPos < sclData.size()) {
-            scl->append(sclData.at(i2cPos));
-            sda->append(sdaData.at(i2cPos));
-        }
-        else {
-            scl->append(scl->at(i-1));
-            sda->append(sda->at(i-1));
-        }
-
-
+    DigitalSampleStore *scl = new DigitalSampleStore();
+    DigitalSampleStore *sda = new DigitalSampleStore();
+
+    if (!SimulatorSignals::generateI2C(mConfigDialog->i2cAddressType(),
+                                       mConfigDialog->i2cRate(),
+                                       mUsedSampleRate, numberOfSamples(),
+                                       *scl, *sda)) {
+        delete scl;
+        delete sda;
+        return;
     }
 
     setDigitalSignalData(mConfigDialog->i2cSclSignalId(), scl);
@@ -429,47 +429,19 @@ void SimulatorCaptureDevice::generateUartDigitalSignals()
 
     if (mDigitalSignalList.size() < 1 || mConfigDialog == NULL) return;
 
-    UartGenerator uartGen;
-    uartGen.setBaudRate(mConfigDialog->uartBaudRate());
-    uartGen.setDataBits(mConfigDialog->uartDataBits());
-    uartGen.setStopBits(mConfigDialog->uartStopBits());
-    uartGen.setParity(mConfigDialog->uartParity());
-
-    QByteArray dataToGen = QString("Hello World abcde fghij klmno pqrst uvwxy z0123 45678 9").toLatin1();
-    uartGen.generate(dataToGen);
-
-    double uartSampleTime = (double)1/uartGen.sampleRate();
-    QVector<int> uartData = uartGen.uartData();
-
-    if (uartData.size() < 2) return;
-
     // Deallocation:
     //    Deleted by deleteSignalData() which is called by destructor or
     //    clearSignalData()
-    QVector<int> *data = new QVector<int>();
-
-
-    int maxNumSamples = numberOfSamples();
-    double sampleTime = (double)1/mUsedSampleRate;
-
-    int pos = 0;
-    double nextTime = uartSampleTime;
-
-    for (int i = 0; i < maxNumSamples; i++) {
-
-        while (i*sampleTime >= nextTime) {
-            pos++;
-            nextTime = (pos+1)*uartSampleTime;
-        }
-
-        if (pos < uartData.size()) {
-            data->append(uartData.at(pos));
-        }
-        else {
-            data->append(data->at(i-1));
-        }
-
-
+    DigitalSampleStore *data = new DigitalSampleStore();
+
+    if (!SimulatorSignals::generateUart(mConfigDialog->uartBaudRate(),
+                                        mConfigDialog->uartDataBits(),
+                                        mConfigDialog->uartStopBits(),
+                                        mConfigDialog->uartParity(),
+                                        mUsedSampleRate, numberOfSamples(),
+                                        *data)) {
+        delete data;
+        return;
     }
 
     setDigitalSignalData(mConfigDialog->uartSignalId(), data);
@@ -482,59 +454,25 @@ void SimulatorCaptureDevice::generateSpiDigitalSignals()
 {
     if (mDigitalSignalList.size() < 4 || mConfigDialog == NULL) return;
 
-    SpiGenerator spiGen;
-    spiGen.setSpiMode(mConfigDialog->spiMode());
-    spiGen.setSpiRate(mConfigDialog->spiRate());
-    spiGen.setDataBits(mConfigDialog->spiDataBits());
-    spiGen.setEnableMode(mConfigDialog->spiEnableMode());
-
-    spiGen.generateFromString("D04,E1,D03,XD1:00,XFF:19,XFF:00,D02,E0,D03,E1,D02,X91:00,XFF:64,XFF:18,D02,E0");
-
-    double spiSampleTime = (double)1/spiGen.sampleRate();
-    QVector<int> sckData = spiGen.sckData();
-    QVector<int> mosiData = spiGen.mosiData();
-    QVector<int> misoData = spiGen.misoData();
-    QVector<int> csData = spiGen.enableData();
-
-    if (sckData.size() < 2) return;
-
     // Deallocation:
     //    Deleted by deleteSignalData() which is called by destructor or
     //    clearSignalData()
-    QVector<int> *sck = new QVector<int>();
-    QVector<int> *mosi = new QVector<int>();
-    QVector<int> *miso = new QVector<int>();
-    QVector<int> *cs = new QVector<int>();
-
-
-    int maxNumSamples = numberOfSamples();
-    double sampleTime = (double)1/mUsedSampleRate;
-
-    int pos = 0;
-    double nextTime = spiSampleTime;
-
-    for (int i = 0; i < maxNumSamples; i++) {
-
-        while (i*sampleTime >= nextTime) {
-            pos++;
-            nextTime = (pos+1)*spiSampleTime;
-        }
-
-        if (pos < sckData.size()) {
-            sck->append(sckData.at(pos));
-            mosi->append(mosiData.at(pos));
-            miso->append(misoData.at(pos));
-            cs->append(csData.at(pos));
-        }
-        else {
-            sck->append(sck->at(i-1));
-            mosi->append(mosi->at(i-1));
-            miso->append(miso->at(i-1));
-            cs->append(cs->at(i-1));
-
-        }
-
-
+    DigitalSampleStore *sck = new DigitalSampleStore();
+    DigitalSampleStore *mosi = new DigitalSampleStore();
+    DigitalSampleStore *miso = new DigitalSampleStore();
+    DigitalSampleStore *cs = new DigitalSampleStore();
+
+    if (!SimulatorSignals::generateSpi(mConfigDialog->spiMode(),
+                                       mConfigDialog->spiEnableMode(),
+                                       mConfigDialog->spiRate(),
+                                       mConfigDialog->spiDataBits(),
+                                       mUsedSampleRate, numberOfSamples(),
+                                       *sck, *mosi, *miso, *cs)) {
+        delete sck;
+        delete mosi;
+        delete miso;
+        delete cs;
+        return;
     }
 
     setDigitalSignalData(mConfigDialog->spiSckSignalId(), sck);
@@ -555,10 +493,8 @@ void SimulatorCaptureDevice::generateRandomAnalogSignals()
 
         int maxNumSamples = numberOfSamples();
 
-        // Deallocation:
-        //    Deleted by deleteSignalData() which is called by destructor or
-        //    clearSignalData()
-        QVector<double> *s = new QVector<double>();
+        QVector<double> s;
+        s.reserve(maxNumSamples);
 
         for(int j = 0; j < maxNumSamples; ++j) {
 
@@ -567,7 +503,7 @@ void SimulatorCaptureDevice::generateRandomAnalogSignals()
             val -= 500;
             val /= 100.0;
 
-            s->append(val);
+            s.append(val);
         }
 
         int skips = qrand() % 5478;
@@ -576,8 +512,15 @@ void SimulatorCaptureDevice::generateRandomAnalogSignals()
         if (mAnalogSignals[id] != NULL) {
             delete mAnalogSignals[id];
         }
+        if (mAnalogMinMax[id] != NULL) {
+            delete mAnalogMinMax[id];
+            mAnalogMinMax[id] = NULL;
+        }
 
-        mAnalogSignals[id] = s;
+        // Deallocation:
+        //    Deleted by deleteSignalData() which is called by destructor or
+        //    clearSignalData()
+        mAnalogSignals[id] = new AnalogSampleStore(s);
     }
 }
 
@@ -595,10 +538,8 @@ void SimulatorCaptureDevice::generateSineAnalogSignals()
 
         if (id >= MaxAnalogSignals) continue;
 
-        // Deallocation:
-        //    Deleted by deleteSignalData() which is called by destructor or
-        //    clearSignalData()
-        QVector<double> *s = new QVector<double>();
+        QVector<double> s;
+        s.reserve(maxNumSamples);
 
         double amp = qrand() % 1000;
         amp -= 500;
@@ -610,14 +551,21 @@ void SimulatorCaptureDevice::generateSineAnalogSignals()
 
             double val = amp*qSin(2*pi*j/per);
 
-            s->append(val);
+            s.append(val);
         }
 
         if (mAnalogSignals[id] != NULL) {
             delete mAnalogSignals[id];
         }
+        if (mAnalogMinMax[id] != NULL) {
+            delete mAnalogMinMax[id];
+            mAnalogMinMax[id] = NULL;
+        }
 
-        mAnalogSignals[id] = s;
+        // Deallocation:
+        //    Deleted by deleteSignalData() which is called by destructor or
+        //    clearSignalData()
+        mAnalogSignals[id] = new AnalogSampleStore(s);
     }
 }
 
@@ -643,13 +591,18 @@ void SimulatorCaptureDevice::deleteSignalData()
             delete mAnalogSignals[i];
             mAnalogSignals[i] = NULL;
         }
+
+        if (mAnalogMinMax[i] != NULL) {
+            delete mAnalogMinMax[i];
+            mAnalogMinMax[i] = NULL;
+        }
     }
 }
 
 /*!
     Set digital signal data to \a data for signal with given \a id.
 */
-void SimulatorCaptureDevice::setDigitalSignalData(int id, QVector<int>* data)
+void SimulatorCaptureDevice::setDigitalSignalData(int id, DigitalSampleStore* data)
 {
     if (mDigitalSignals[id] != NULL) {
         delete mDigitalSignals[id];
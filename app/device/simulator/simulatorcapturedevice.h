@@ -38,17 +38,18 @@ public:
     void stop();
 
     int lastSampleIndex();
-    QVector<int>* digitalData(int signalId);
-    void setDigitalData(int signalId, QVector<int> data);
+    DigitalSampleStore* digitalData(int signalId);
+    void setDigitalData(int signalId, const DigitalSampleStore &data);
 
-    QVector<double>* analogData(int signalId);
-    void setAnalogData(int signalId, QVector<double> data);
+    AnalogSampleStore* analogData(int signalId);
+    void setAnalogData(int signalId, const AnalogSampleStore &data);
+    AnalogMinMaxPyramid* analogMinMax(int signalId);
 
     void clearSignalData();
 
     int digitalTriggerIndex();
     void setDigitalTriggerIndex(int idx);
-    void digitalTransitions(int signalId, QList<int> &list);
+    DigitalTransitions* digitalTransitions(int signalId);
 
     void reconfigure(int sampleRate = -1);
 
@@ -67,9 +68,10 @@ private:
     UiSimulatorConfigDialog* mConfigDialog;
 
     int mEndSampleIdx;
-    QVector<int>* mDigitalSignals[MaxDigitalSignals];
-    QVector<double>* mAnalogSignals[MaxAnalogSignals];
-    QList<int>* mDigitalSignalTransitions[MaxDigitalSignals];
+    DigitalSampleStore* mDigitalSignals[MaxDigitalSignals];
+    AnalogSampleStore* mAnalogSignals[MaxAnalogSignals];
+    AnalogMinMaxPyramid* mAnalogMinMax[MaxAnalogSignals];
+    DigitalTransitions* mDigitalSignalTransitions[MaxDigitalSignals];
 
     QList<double> mSupportedVPerDiv;
 
@@ -85,7 +87,7 @@ private:
     void generateRandomAnalogSignals();
     void generateSineAnalogSignals();
     void deleteSignalData();
-    void setDigitalSignalData(int id, QVector<int>* data);
+    void setDigitalSignalData(int id, DigitalSampleStore* data);
     
 };
 
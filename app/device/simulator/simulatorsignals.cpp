@@ -0,0 +1,167 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "simulatorsignals.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include "generator/i2cgenerator.h"
+#include "generator/uartgenerator.h"
+#include "generator/spigenerator.h"
+
+/*!
+    \class SimulatorSignals
+    \brief Generates the protocol signals used by the simulator.
+
+    \ingroup Device
+
+    The signals are created with the protocol generators and then resampled
+    to the sample rate of the capture. Only QtCore is needed which makes it
+    possible to feed the same signals as the SimulatorCaptureDevice to the
+    protocol decoders in tests.
+*/
+
+/*!
+    Generates I2C signal data with the address type \a addressType and the
+    bus rate \a i2cRate. The data is resampled to \a numSamples samples at
+    the sample rate \a sampleRate and appended to \a scl and \a sda.
+
+    Returns false if no signal data could be generated.
+*/
+bool SimulatorSignals::generateI2C(Types::I2CAddress addressType, int i2cRate,
+                                   int sampleRate, int numSamples,
+                                   DigitalSampleStore &scl,
+                                   DigitalSampleStore &sda)
+{
+    I2CGenerator i2cGen;
+    i2cGen.setAddressType(addressType);
+    i2cGen.setI2CRate(i2cRate);
+    i2cGen.generateFromString("D04,S,W060,A,X16,A,X00,A,X00,A,X00,A,X40,A,P,S,W060,A,X00,A,P,S,R060,A,X3F,N,P,S,W060,A,X01,A,P,S,R060,A,X7F,N,P");
+
+    QVector<int> sclData = i2cGen.sclData();
+    QVector<int> sdaData = i2cGen.sdaData();
+
+    if (sclData.size() < 2) return false;
+
+    resample(sclData, i2cGen.sampleRate(), sampleRate, numSamples, scl);
+    resample(sdaData, i2cGen.sampleRate(), sampleRate, numSamples, sda);
+
+    return true;
+}
+
+/*!
+    Generates UART signal data with the baud rate \a baudRate, \a dataBits
+    data bits, \a stopBits stop bits and the parity \a parity. The data is
+    resampled to \a numSamples samples at the sample rate \a sampleRate and
+    appended to \a data.
+
+    Returns false if no signal data could be generated.
+*/
+bool SimulatorSignals::generateUart(int baudRate, int dataBits, int stopBits,
+                                    Types::UartParity parity, int sampleRate,
+                                    int numSamples, DigitalSampleStore &data)
+{
+    UartGenerator uartGen;
+    uartGen.setBaudRate(baudRate);
+    uartGen.setDataBits(dataBits);
+    uartGen.setStopBits(stopBits);
+    uartGen.setParity(parity);
+
+    QByteArray dataToGen = QString("Hello World abcde fghij klmno pqrst uvwxy z0123 45678 9").toLatin1();
+    uartGen.generate(dataToGen);
+
+    QVector<int> uartData = uartGen.uartData();
+
+    if (uartData.size() < 2) return false;
+
+    resample(uartData, uartGen.sampleRate(), sampleRate, numSamples, data);
+
+    return true;
+}
+
+/*!
+    Generates SPI signal data with the SPI mode \a mode, the enable mode
+    \a enableMode, the bus rate \a spiRate and \a dataBits data bits. The
+    data is resampled to \a numSamples samples at the sample rate
+    \a sampleRate and appended to \a sck, \a mosi, \a miso and \a cs.
+
+    Returns false if no signal data could be generated.
+*/
+bool SimulatorSignals::generateSpi(Types::SpiMode mode,
+                                   Types::SpiEnable enableMode, int spiRate,
+                                   int dataBits, int sampleRate, int numSamples,
+                                   DigitalSampleStore &sck,
+                                   DigitalSampleStore &mosi,
+                                   DigitalSampleStore &miso,
+                                   DigitalSampleStore &cs)
+{
+    SpiGenerator spiGen;
+    spiGen.setSpiMode(mode);
+    spiGen.setSpiRate(spiRate);
+    spiGen.setDataBits(dataBits);
+    spiGen.setEnableMode(enableMode);
+
+    spiGen.generateFromString("D04,E1,D03,XD1:00,XFF:19,XFF:00,D02,E0,D03,E1,D02,X91:00,XFF:64,XFF:18,D02,E0");
+
+    QVector<int> sckData = spiGen.sckData();
+
+    if (sckData.size() < 2) return false;
+
+    resample(sckData, spiGen.sampleRate(), sampleRate, numSamples, sck);
+    resample(spiGen.mosiData(), spiGen.sampleRate(), sampleRate, numSamples, mosi);
+    resample(spiGen.misoData(), spiGen.sampleRate(), sampleRate, numSamples, miso);
+    resample(spiGen.enableData(), spiGen.sampleRate(), sampleRate, numSamples, cs);
+
+    return true;
+}
+
+/*!
+    Resamples the generated \a data with the sample rate \a dataRate to
+    \a numSamples samples at the sample rate \a sampleRate and appends them
+    to \a store. When the generated data has run out the last level is
+    repeated.
+*/
+void SimulatorSignals::resample(const QVector<int> &data, int dataRate,
+                                int sampleRate, int numSamples,
+                                DigitalSampleStore &store)
+{
+    double dataSampleTime = (double)1/dataRate;
+    double sampleTime = (double)1/sampleRate;
+
+    int pos = 0;
+    double nextTime = dataSampleTime;
+    int level = 0;
+
+    store.reserve(store.size() + numSamples);
+
+    for (int i = 0; i < numSamples; i++) {
+
+        while (i*sampleTime >= nextTime) {
+            pos++;
+            nextTime = (pos+1)*dataSampleTime;
+
+            // no need to step through the rest of the (possibly very long)
+            // time once the generated data has run out
+            if (pos >= data.size()) {
+                store.append(level, numSamples - i);
+                return;
+            }
+        }
+
+        level = data.at(pos);
+        store.append(level);
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SIMULATORSIGNALS_H
+#define SIMULATORSIGNALS_H
+
+#include <QVector>
+
+#include "common/types.h"
+#include "device/digitalsamplestore.h"
+
+class SimulatorSignals
+{
+public:
+
+    static bool generateI2C(Types::I2CAddress addressType, int i2cRate,
+                            int sampleRate, int numSamples,
+                            DigitalSampleStore &scl, DigitalSampleStore &sda);
+    static bool generateUart(int baudRate, int dataBits, int stopBits,
+                             Types::UartParity parity, int sampleRate,
+                             int numSamples, DigitalSampleStore &data);
+    static bool generateSpi(Types::SpiMode mode, Types::SpiEnable enableMode,
+                            int spiRate, int dataBits, int sampleRate,
+                            int numSamples, DigitalSampleStore &sck,
+                            DigitalSampleStore &mosi, DigitalSampleStore &miso,
+                            DigitalSampleStore &cs);
+
+private:
+    // only static functions
+    SimulatorSignals();
+
+    static void resample(const QVector<int> &data, int dataRate,
+                         int sampleRate, int numSamples,
+                         DigitalSampleStore &store);
+};
+
+#endif // SIMULATORSIGNALS_H